@@ -10,8 +10,79 @@
 #include "SimpleIMU.h"
 
 // Constructor
-SimpleIMU::SimpleIMU(uint8_t address)
+SimpleIMU::SimpleIMU(uint8_t address) : SimpleIMU(address, &SimpleIMU_WireBus)
+{
+}
+
+// Constructor on another bus
+SimpleIMU::SimpleIMU(uint8_t address, SimpleIMU_Transport *transport)
 {
-	Wire.begin(address);
 	SimpleIMU::IMU_Addr = address;
+	SimpleIMU::IMU_Transport = transport;
+	SimpleIMU::IMU_GyroOffsetX = 0;
+	SimpleIMU::IMU_GyroOffsetY = 0;
+	SimpleIMU::IMU_GyroOffsetZ = 0;
+	SimpleIMU::IMU_AccelOffsetX = 0;
+	SimpleIMU::IMU_AccelOffsetY = 0;
+	SimpleIMU::IMU_AccelOffsetZ = 0;
+	SimpleIMU::IMU_CalibTemp = 0;
+	SimpleIMU::IMU_HasCalibTemp = false;
+	SimpleIMU::IMU_HasOffsetRegs = false;
+	SimpleIMU::IMU_GyroFullScale = 0;
+	SimpleIMU::IMU_AccelFullScale = 0;
+	SimpleIMU::updateGyroScale();
+	SimpleIMU::updateAccelScale();
+	for (uint8_t i = 0; i < IMU_CONFIG_SHADOW_LENGTH; i++)
+		SimpleIMU::IMU_ConfigShadow[i] = 0;
+	SimpleIMU::IMU_ConfigDirty = 0;
+	SimpleIMU::IMU_ConfigDeferred = false;
+	SimpleIMU::IMU_FIFOSensors = 0;
+	SimpleIMU::IMU_FIFOFrameSize = 0;
+	SimpleIMU::IMU_DMPPacketSize = 0;
+	SimpleIMU::IMU_AuxSlaves = 0;
+	SimpleIMU::IMU_AuxReadSlaves = 0;
+	for (uint8_t i = 0; i < IMU_AUX_SLAVES; i++)
+		SimpleIMU::IMU_AuxLength[i] = 0;
+	SimpleIMU::IMU_AuxMasterCtrl = 0;
+	SimpleIMU::IMU_AuxDelay = 0;
+	SimpleIMU::IMU_AuxDelayed = 0;
+	SimpleIMU::IMU_RingBuffer = NULL;
+	SimpleIMU::IMU_RingMask = 0;
+	SimpleIMU::IMU_RingHead = 0;
+	SimpleIMU::IMU_RingTail = 0;
+	SimpleIMU::IMU_DataReadyCount = 0;
+	SimpleIMU::IMU_DataReadyServiced = 0;
+	SimpleIMU::IMU_RingOverruns = 0;
+	SimpleIMU::IMU_MissedSamples = 0;
+	SimpleIMU::IMU_IntPin = IMU_NO_PIN;
+	/* Motion above 40 mg for 1 ms, no zero motion or free fall until set */
+	SimpleIMU::IMU_MotionConfig[0] = 0;
+	SimpleIMU::IMU_MotionConfig[1] = 0;
+	SimpleIMU::IMU_MotionConfig[2] = 20;
+	SimpleIMU::IMU_MotionConfig[3] = 1;
+	SimpleIMU::IMU_MotionConfig[4] = 0;
+	SimpleIMU::IMU_MotionConfig[5] = 0;
+	SimpleIMU::IMU_MotionCount = 0;
+	SimpleIMU::IMU_MotionServiced = 0;
+	SimpleIMU::IMU_PendingEvents = 0;
+	SimpleIMU::IMU_PowerMgmt = 0;
+	SimpleIMU::IMU_CycleMode = false;
+	SimpleIMU::IMU_IntConfig[0] = 0;
+	SimpleIMU::IMU_IntConfig[1] = 0;
+	SimpleIMU::IMU_PowerConfig[0] = 0;
+	SimpleIMU::IMU_PowerConfig[1] = 0;
+	SimpleIMU::IMU_Retries = IMU_RETRIES;
+	SimpleIMU::IMU_AutoRecover = true;
+	SimpleIMU::IMU_Recovering = false;
+	SimpleIMU::IMU_LastError = IMU_OK;
+	SimpleIMU::IMU_ErrorCount = 0;
+	SimpleIMU::IMU_RetryCount = 0;
+	SimpleIMU::IMU_RecoveryCount = 0;
+	SimpleIMU::IMU_DataReadyTime = 0;
+	SimpleIMU::IMU_ClockScale = 1.0f;
+	SimpleIMU::IMU_NextSampleTime = 0;
+	SimpleIMU::IMU_AnchorTime = 0;
+	SimpleIMU::IMU_AnchorSamples = 0;
+	SimpleIMU::IMU_TimingLocked = false;
+	SimpleIMU::resetTimingStats();
 }
\ No newline at end of file
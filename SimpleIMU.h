@@ -10,7 +10,18 @@
 #ifndef SIMPLEIMU_H
 #define SIMPLEIMU_H
 
-#include <Wire.h>
+#include "SimpleIMU_Transport.h"
+
+/*
+ * Size of the buffers for FIFO reads. On Arduino it is the Wire buffer,
+ * often 32 bytes, and the frames are read as many as fit at a time; on a
+ * host it is a multiple of the 6, 12, 14 and 42 byte frames.
+ */
+#if defined(ARDUINO)
+#define IMU_TRANSFER_BUFFER_LENGTH IMU_WIRE_BUFFER_LENGTH
+#else
+#define IMU_TRANSFER_BUFFER_LENGTH 252
+#endif
 
 typedef struct
 {
@@ -26,12 +37,167 @@ typedef struct
 	float z;
 } GyroData;
 
+/* Accelerometer data in milli g */
+typedef struct
+{
+	int32_t x;
+	int32_t y;
+	int32_t z;
+} AccelDataFixed;
+
+/* Gyroscope data in milli degrees per second */
+typedef struct
+{
+	int32_t x;
+	int32_t y;
+	int32_t z;
+} GyroDataFixed;
+
+typedef struct
+{
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	uint32_t time; /* micros when the IMU took the sample, set by readFIFO, updateDataReady and SimpleIMU_Array */
+} IMUSample;
+
+/* Timing of the samples against the host clock */
+typedef struct
+{
+	float period;		/* micros between two samples, as learned */
+	float drift;		/* sample clock against the nominal rate in parts per million, positive when slow */
+	float jitterRms;	/* RMS of the timing errors in micros */
+	uint32_t jitterMax;	/* largest timing error in micros */
+	uint32_t samples;	/* number of timing errors measured */
+} IMUTimingStats;
+
+/* Raw counts of one sample, in the order of the data registers */
+typedef struct
+{
+	int16_t accel[3];
+	int16_t temp;
+	int16_t gyro[3];
+} IMURawSample;
+
+/* Raw counts of a block of samples, one contiguous array per axis. The
+   arrays are provided by the sketch and hold size samples each, the
+   arrays left NULL are not filled. */
+typedef struct
+{
+	int16_t *accel[3];	/* x, y, z */
+	int16_t *gyro[3];	/* x, y, z */
+	int16_t *temp;
+	uint16_t size;		/* length of every array */
+	uint16_t count;		/* number of samples held */
+	uint32_t time;		/* micros when the IMU took the first sample */
+	float period;		/* micros between two samples */
+} IMURawBlock;
+
+/* Scaled block of samples, laid out as IMURawBlock */
+typedef struct
+{
+	float *accel[3];	/* x, y, z in m/s^2 */
+	float *gyro[3];		/* x, y, z in degrees per second */
+	float *temp;		/* degree Celsius */
+	uint16_t size;		/* length of every array */
+	uint16_t count;		/* number of samples held */
+	uint32_t time;		/* micros when the IMU took the first sample */
+	float period;		/* micros between two samples */
+} IMUSampleBlock;
+
+/* Layout version of IMUCalibration, changed whenever the fields change */
+#define IMU_CALIBRATION_VERSION 1
+
+/* Calibration record that can be stored and loaded on the next start */
+typedef struct
+{
+	uint8_t version;
+	uint8_t gyroRange;
+	uint8_t accelRange;
+	uint8_t reserved;
+	int16_t gyroOffset[3];
+	int16_t accelOffset[3];
+	int16_t temperature; /* hundredths of a degree Celsius */
+	uint16_t crc;		 /* CRC-16 of all the fields above */
+} IMUCalibration;
+
+/* Sensors that can be streamed through the FIFO, combine with | */
+#define IMU_FIFO_TEMP 0x80
+#define IMU_FIFO_GYRO_X 0x40
+#define IMU_FIFO_GYRO_Y 0x20
+#define IMU_FIFO_GYRO_Z 0x10
+#define IMU_FIFO_GYRO (IMU_FIFO_GYRO_X | IMU_FIFO_GYRO_Y | IMU_FIFO_GYRO_Z)
+#define IMU_FIFO_ACCEL 0x08
+#define IMU_FIFO_AUX 0x01
+
+/* Largest FIFO frame, all sensors and 24 bytes of external sensor data */
+#define IMU_FIFO_MAX_FRAME 38
+
+/* Size of the FIFO inside the MPU6050 in bytes */
+#define IMU_FIFO_SIZE 1024
+
+/* Number of configuration registers shadowed, SMPLRT_DIV to ACCEL_CONFIG */
+#define IMU_CONFIG_SHADOW_LENGTH 4
+
+/* The MotionApps 2.0 DMP image: program start, location of the FIFO rate divider and packet size */
+#define IMU_DMP_START_ADDRESS 0x0300
+#define IMU_DMP_FIFO_RATE_ADDRESS 0x0216
+#define IMU_DMP_PACKET_SIZE 42
+
+/* Special entry of a DMP configuration table that enables the interrupts of the DMP */
+#define IMU_DMP_CONFIG_INTERRUPTS 0x01
+
+/* Number of external sensor slaves read by the auxiliary I2C master, and their data size */
+#define IMU_AUX_SLAVES 4
+#define IMU_AUX_DATA_SIZE 24
+
+/* Clock of the auxiliary I2C master, I2C_MST_CLK values */
+#define IMU_AUX_CLOCK_258KHZ 8
+#define IMU_AUX_CLOCK_400KHZ 13
+
+/* Time to wait for a single transfer on the auxiliary bus in milliseconds */
+#define IMU_AUX_TIMEOUT 50
+
+/* Pin value for beginDataReady when the interrupt is attached by the sketch */
+#define IMU_NO_PIN 0xFF
+
+/* ISRs have to be placed in RAM on the ESP boards */
+#if defined(ESP32) || defined(ESP8266)
+#define IMU_ISR_ATTR IRAM_ATTR
+#else
+#define IMU_ISR_ATTR
+#endif
+
+/* Motion events, the bits of INT_STATUS */
+#define IMU_EVENT_FREE_FALL 0x80
+#define IMU_EVENT_MOTION 0x40
+#define IMU_EVENT_ZERO_MOTION 0x20
+
+/* Set with IMU_EVENT_ZERO_MOTION when the IMU became still, clear when it moves again */
+#define IMU_EVENT_STILL 0x01
+
+/* Number of times a failed transaction is tried again before it is reported */
+#define IMU_RETRIES 2
+
+/* Wake up rates of the accelerometer only cycle mode, the LP_WAKE_CTRL values */
+#define IMU_WAKE_1_25HZ 0
+#define IMU_WAKE_5HZ 1
+#define IMU_WAKE_20HZ 2
+#define IMU_WAKE_40HZ 3
+
 class SimpleIMU
 {
+	friend class SimpleIMU_Calibrator;
+	friend class SimpleIMU_Array;
+	friend class SimpleIMU_TempComp;
+
 private:
 	/* The address of the IMU */
 	uint8_t IMU_Addr;
 
+	/* The bus the IMU is on */
+	SimpleIMU_Transport *IMU_Transport;
+
 	/* The gyroscope offset about the x axis*/
 	int16_t IMU_GyroOffsetX;
 
@@ -50,98 +216,1335 @@ private:
 	/* The accelerometer offset along the z axis*/
 	int16_t IMU_AccelOffsetZ;
 
+	/* The temperature the offsets were taken at in hundredths of a degree, valid once taken or loaded */
+	int16_t IMU_CalibTemp;
+	bool IMU_HasCalibTemp;
+
+	/* The offset registers as written by applyHardwareOffsets, gyroscope then accelerometer, valid once written */
+	uint8_t IMU_OffsetRegs[12];
+	bool IMU_HasOffsetRegs;
+
 	/* The gyroscope sensitivity */
 	uint8_t IMU_GyroFullScale;
 
 	/* The accelerometer sensitivity */
 	uint8_t IMU_AccelFullScale;
 
-public:
+	/* The factor from gyroscope counts to degrees per second */
+	float IMU_GyroScale;
+
+	/* The factor from accelerometer counts to m/s^2 */
+	float IMU_AccelScale;
+
+	/* The multiplier from gyroscope counts to milli degrees per second */
+	int16_t IMU_GyroFixedMult;
+
+	/* The shift applied after IMU_GyroFixedMult */
+	uint8_t IMU_GyroFixedShift;
+
+	/* The shift from accelerometer counts times 1000 to milli g */
+	uint8_t IMU_AccelFixedShift;
+
+	/* Copy of the SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG registers */
+	uint8_t IMU_ConfigShadow[IMU_CONFIG_SHADOW_LENGTH];
+
+	/* The shadowed registers not yet written to the IMU, one bit per register */
+	uint8_t IMU_ConfigDirty;
+
+	/* Whether configuration writes are held back until commitConfig */
+	bool IMU_ConfigDeferred;
+
+	/* The sensors written to the FIFO, as IMU_FIFO_* flags */
+	uint8_t IMU_FIFOSensors;
+
+	/* The number of bytes in one FIFO frame */
+	uint8_t IMU_FIFOFrameSize;
+
+	/* The number of bytes in one DMP packet, 0 when the DMP is not running */
+	uint8_t IMU_DMPPacketSize;
+
+	/* The slaves of the auxiliary I2C master that are enabled, and those that read */
+	uint8_t IMU_AuxSlaves;
+	uint8_t IMU_AuxReadSlaves;
+
+	/* The number of bytes read by each slave into EXT_SENS_DATA */
+	uint8_t IMU_AuxLength[IMU_AUX_SLAVES];
+
+	/* The I2C_SLVx_ADDR, I2C_SLVx_REG and I2C_SLVx_CTRL values of each slave, and I2C_SLVx_DO of those that write */
+	uint8_t IMU_AuxSlaveConfig[IMU_AUX_SLAVES][3];
+	uint8_t IMU_AuxSlaveOut[IMU_AUX_SLAVES];
+
+	/* The I2C_MST_CTRL value without the slave 3 FIFO bit */
+	uint8_t IMU_AuxMasterCtrl;
+
+	/* The slaves read every (1 + IMU_AuxDelay) samples */
+	uint8_t IMU_AuxDelay;
+	uint8_t IMU_AuxDelayed;
+
+	/* The sample ring buffer filled on data ready, provided by the sketch */
+	IMUSample *IMU_RingBuffer;
+
+	/* The size of the ring buffer minus one, the size is a power of two */
+	uint8_t IMU_RingMask;
+
+	/* The index of the next slot to be written, only changed by the producer */
+	volatile uint8_t IMU_RingHead;
+
+	/* The index of the next slot to be read, only changed by the consumer */
+	volatile uint8_t IMU_RingTail;
+
+	/* The number of data ready interrupts, only changed by the ISR */
+	volatile uint8_t IMU_DataReadyCount;
+
+	/* The micros of the last data ready interrupt, only changed by the ISR */
+	volatile uint32_t IMU_DataReadyTime;
+
+	/* The number of data ready interrupts already serviced */
+	uint8_t IMU_DataReadyServiced;
+
+	/* The number of samples dropped because the ring buffer was full */
+	uint16_t IMU_RingOverruns;
+
+	/* The number of samples overwritten in the IMU before they were read */
+	uint16_t IMU_MissedSamples;
+
+	/* The pin the data ready interrupt is attached to */
+	uint8_t IMU_IntPin;
+
+	/* The IMU serviced by the data ready interrupt attached by beginDataReady */
+	static SimpleIMU *IMU_DataReadyInstance;
+
+	/* FF_THR, FF_DUR, MOT_THR, MOT_DUR, ZRMOT_THR and ZRMOT_DUR in register order */
+	uint8_t IMU_MotionConfig[6];
+
+	/* The number of motion interrupts, only changed by the ISR */
+	volatile uint8_t IMU_MotionCount;
+
+	/* The number of motion interrupts already serviced */
+	uint8_t IMU_MotionServiced;
+
+	/* Motion events cleared from INT_STATUS by reads for other purposes, like readFIFO */
+	uint8_t IMU_PendingEvents;
+
+	/* PWR_MGMT_1 before the cycle mode, restored by endMotionEvents */
+	uint8_t IMU_PowerMgmt;
+
+	/* Whether the IMU is in the accelerometer only cycle mode */
+	bool IMU_CycleMode;
+
+	/* The IMU serviced by the motion interrupt attached by beginMotionEvents */
+	static SimpleIMU *IMU_MotionInstance;
+
+	/* INT_PIN_CFG and INT_ENABLE as last written, restored by recover */
+	uint8_t IMU_IntConfig[2];
+
+	/* PWR_MGMT_1 and PWR_MGMT_2 as last written, restored by recover */
+	uint8_t IMU_PowerConfig[2];
+
+	/* The number of times a failed transaction is tried again */
+	uint8_t IMU_Retries;
+
+	/* Whether a transaction that timed out recovers the bus */
+	bool IMU_AutoRecover;
+
+	/* Whether recover is running, failures then are not retried */
+	bool IMU_Recovering;
+
+	/* The status of the last transaction that failed */
+	uint8_t IMU_LastError;
+
+	/* The number of transactions that failed, retried and bus recoveries */
+	uint16_t IMU_ErrorCount;
+	uint16_t IMU_RetryCount;
+	uint16_t IMU_RecoveryCount;
+
+	/* The sample period against the host clock over the nominal one */
+	float IMU_ClockScale;
+
+	/* The expected micros of the next sample to be read */
+	uint32_t IMU_NextSampleTime;
+
+	/* The micros of the sample the period is measured from, and the samples since */
+	uint32_t IMU_AnchorTime;
+	uint32_t IMU_AnchorSamples;
+
+	/* Whether IMU_NextSampleTime follows the samples */
+	bool IMU_TimingLocked;
+
+	/* The largest timing error, the sum of the squared errors and their number */
+	uint32_t IMU_JitterMax;
+	float IMU_JitterSquares;
+	uint32_t IMU_JitterCount;
+
 	/*
-	 * Constructor for SimpleIMU object.
+	 * Interrupt service routine attached by beginDataReady.
 	 *
-	 * params: address I2C address of the IMU
-	 * returns: SimpleIMU object
+	 * params: None
+	 * returns: None
 	 */
-	SimpleIMU(uint8_t address);
+	static void dataReadyISR();
 
 	/*
-	 * Function to initialize the IMU.
+	 * Interrupt service routine attached by beginMotionEvents.
 	 *
 	 * params: None
-	 * returns: bool, true if initialization is successful, false otherwise
+	 * returns: None
 	 */
-	bool init();
+	static void motionISR();
 
 	/*
-	 * Function to set the gyroscope sensitivity.
+	 * Function to write a single register of the IMU.
 	 *
-	 * params: range, the sensitivity range of the gyroscope.
-	 *     			  Can be 0, 1, 2, 3 for 250, 500, 1000, 2000 degrees
-	 * 				  per second respectively.
+	 * params: reg, address of the register
+	 * 		   value, value to be written
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t writeRegister(uint8_t reg, uint8_t value);
+
+	/*
+	 * Function to read consecutive registers of the IMU in one transaction.
+	 *
+	 * params: reg, address of the first register
+	 * 		   buffer, pointer to the array to store the values
+	 * 		   length, number of registers to read, at most getMaxTransfer()
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t readRegisters(uint8_t reg, uint8_t *buffer, uint8_t length);
+
+	/*
+	 * Function to do several register reads, in one bus transfer where the
+	 * transport can queue them.
+	 *
+	 * params: reads, the reads
+	 * 		   count, number of reads
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t readRegisters(const IMURegisterRead *reads, uint8_t count);
+
+	/*
+	 * Function to write consecutive registers of the IMU in one transaction.
+	 *
+	 * params: reg, address of the first register
+	 * 		   buffer, values to be written
+	 * 		   length, number of registers
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t writeRegisters(uint8_t reg, const uint8_t *buffer, uint8_t length);
+
+	/*
+	 * Function to decide whether a failed transaction is tried again. The
+	 * transaction is retried IMU_Retries times, then once more after a bus
+	 * recovery if it timed out. A transaction given up on is counted.
+	 *
+	 * params: status, the status of the transaction
+	 * 		   attempts, the number of retries so far, updated
+	 * returns: bool, true to try again
+	 */
+	bool retryTransaction(uint8_t status, uint8_t *attempts);
+
+	/*
+	 * Function to get the status of the transactions since an error count,
+	 * so a function made of several transactions reports a failure of any.
+	 *
+	 * params: errors, the value of IMU_ErrorCount at the start
+	 * returns: uint8_t, IMU_OK or the last error since then
+	 */
+	uint8_t statusSince(uint16_t errors);
+
+	/*
+	 * Function to read the temperature the offsets are being taken at and
+	 * keep it for getCalibration.
+	 *
+	 * params: None
 	 * returns: None
 	 */
-	void setGyroRange(uint8_t range);
+	void sampleCalibTemp();
 
 	/*
-	 * Function to get the sensititvity range of the gyroscope.
+	 * Function to check that the device answering is an MPU6050 or a clone.
 	 *
 	 * params: None
-	 * returns: uint8_t, the sensistivity range of the gyroscope.
-	 * 				     Can be 0, 1, 2, 3 for 250, 500, 1000, 2000 deg/s
-	 * 					 respectively.
+	 * returns: uint8_t, IMU_OK or the error
 	 */
-	uint8_t getGyroRange();
+	uint8_t checkDevice();
 
 	/*
-	 * Function to calibrate the gyroscope.
+	 * Function to write the cached configuration back into the IMU. A DMP
+	 * lost with a reset of the IMU is stopped and counted as an error.
 	 *
-	 * params: samples, number of samples to take for calibration
+	 * params: None
 	 * returns: None
 	 */
-	void calibGyro(int samples = 100);
+	void restoreConfig();
 
 	/*
-	 * Function to read the gyroscope data.
+	 * Function to get the largest number of bytes read in one transaction.
 	 *
-	 * params: gyro, pointer to GyroData struct to store the gyroscope data
+	 * params: None
+	 * returns: uint16_t, number of bytes, at most IMU_TRANSFER_BUFFER_LENGTH and 255
+	 */
+	uint16_t getMaxTransfer();
+
+	/*
+	 * Function to get the number of whole frames waiting in the FIFO. On
+	 * overflow the FIFO is reset.
+	 *
+	 * params: maxFrames, the largest number of frames wanted
+	 * returns: int, number of frames up to maxFrames, -1 if the FIFO
+	 * 				 overflowed or the read failed
+	 */
+	int getFIFOFrames(int maxFrames);
+
+	/*
+	 * Function to follow the FIFO with the sample timeline. The newest
+	 * frame counted was taken within the period before the count was read,
+	 * the timeline is only moved when it places the frame outside of that.
+	 *
+	 * params: frames, number of whole frames in the FIFO
+	 * 		   time, micros when the count was read
 	 * returns: None
 	 */
-	void readGyro(GyroData *gyro);
+	void trackFIFO(uint16_t frames, uint32_t time);
 
 	/*
-	 * Function to set the sensitivity range of the accelerometer.
+	 * Function to follow the data ready interrupts with the sample timeline.
 	 *
-	 * params: range, the sensitivity range of the accelerometer.
-	 *   			  Can be 0, 1, 2, 3 for 2, 4, 8, 16 g respectively.
+	 * params: samples, number of interrupts since the last call
+	 * 		   time, micros of the last interrupt
 	 * returns: None
 	 */
-	void setAccelRange(uint8_t range);
+	void trackDataReady(uint8_t samples, uint32_t time);
 
 	/*
-	 * Function to get the sensitivity range of the accelerometer.
+	 * Function to move the sample timeline by a timing error. The period
+	 * is then measured from the anchor to the next sample, so it follows
+	 * the clock of the IMU with an error of the timing errors over the
+	 * number of samples in between.
+	 *
+	 * params: error, micros the sample came after the timeline, negative if before
+	 * returns: None
+	 */
+	void correctTiming(float error);
+
+	/*
+	 * Function to place samples on the timeline.
+	 *
+	 * params: samples, number of samples read
+	 * returns: uint32_t, the micros of the first of them
+	 */
+	uint32_t advanceTiming(uint16_t samples);
+
+	/*
+	 * Function to add a timing error to the jitter statistics.
+	 *
+	 * params: jitter, the error in micros
+	 * returns: None
+	 */
+	void recordJitter(uint32_t jitter);
+
+	/*
+	 * Function to read consecutive registers or FIFO bytes in as many
+	 * transactions as the transport needs.
+	 *
+	 * params: reg, address of the first register, FIFO_R_W is not incremented
+	 * 		   buffer, pointer to the array to store the values
+	 * 		   length, number of bytes to read
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t readRegisterBlock(uint8_t reg, uint8_t *buffer, uint16_t length);
+
+	/*
+	 * Function to set up the registers of an auxiliary slave.
+	 *
+	 * params: slave, the slave from 0 to 3
+	 * 		   address, 7 bit I2C address, with bit 7 set for a read
+	 * 		   reg, the register of the external sensor
+	 * 		   ctrl, the I2C_SLVx_CTRL value
+	 * 		   delayed, true to access the slave every (1 + delay) samples
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t setAuxSlave(uint8_t slave, uint8_t address, uint8_t reg, uint8_t ctrl, bool delayed);
+
+	/*
+	 * Function to write the cached auxiliary master and slaves back into the IMU.
 	 *
 	 * params: None
-	 * returns: uint8_t, the sensitivity range of the accelerometer.
-	 * 					 Can be 0, 1, 2, 3 for 2, 4, 8, 16 g respectively.
+	 * returns: uint8_t, IMU_OK or the error
 	 */
-	uint8_t getAccelRange();
+	uint8_t restoreAux();
 
 	/*
-	 * Function to calibrate the accelerometer.
+	 * Function to do a single transfer on the auxiliary bus through slave 4.
 	 *
-	 * params: samples, number of samples to take for calibration
+	 * params: address, 7 bit I2C address of the external sensor
+	 * 		   reg, the register
+	 * 		   value, the byte to write, or the byte read
+	 * 		   read, true to read
+	 * returns: bool, true if the sensor acknowledged in time
+	 */
+	bool auxTransfer(uint8_t address, uint8_t reg, uint8_t *value, bool read);
+
+	/*
+	 * Function to change bits of a shadowed configuration register. The
+	 * register is written right away unless beginConfig was called.
+	 *
+	 * params: reg, address of the register, SMPLRT_DIV to ACCEL_CONFIG
+	 * 		   mask, the bits to be changed
+	 * 		   value, the new value of the bits
+	 * returns: uint8_t, IMU_OK or the error of the write
+	 */
+	uint8_t setConfigBits(uint8_t reg, uint8_t mask, uint8_t value);
+
+	/*
+	 * Function to write all dirty shadowed registers in a single burst. The
+	 * registers stay dirty if the write fails.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error of the write
+	 */
+	uint8_t flushConfig();
+
+	/*
+	 * Function to write a block into the memory of the DMP, in chunks of
+	 * MPU6050_DMP_MEMORY_CHUNK_SIZE bytes that do not cross a bank.
+	 *
+	 * params: data, pointer to the bytes, in PROGMEM if progmem is true
+	 * 		   size, number of bytes
+	 * 		   address, the memory address, bank in the high byte
+	 * 		   progmem, whether data is stored in program memory
+	 * returns: bool, true if every chunk read back the same as written
+	 */
+	bool writeMemoryBlock(const uint8_t *data, uint16_t size, uint16_t address, bool progmem);
+
+	/*
+	 * Function to apply a DMP configuration table. Each entry is the bank,
+	 * the address and the length of a block followed by its bytes; an entry
+	 * of length 0 is followed by one special byte instead.
+	 *
+	 * params: config, pointer to the table, in PROGMEM if progmem is true
+	 * 		   size, number of bytes of the table
+	 * 		   progmem, whether the table is stored in program memory
+	 * returns: bool, true if every entry was written and verified
+	 */
+	bool writeDMPConfig(const uint8_t *config, uint16_t size, bool progmem);
+
+	/*
+	 * Function to convert offset corrected gyroscope counts to degrees per second.
+	 *
+	 * params: x, y, z, offset corrected raw gyroscope values
+	 * 		   gyro, pointer to GyroData struct to store the scaled values
 	 * returns: None
 	 */
-	void calibAccel(int samples = 100);
+	void scaleGyro(int16_t x, int16_t y, int16_t z, GyroData *gyro);
 
 	/*
-	 * Function to read the accelerometer data.
+	 * Function to convert offset corrected accelerometer counts to m/s^2.
 	 *
-	 * params: accel, pointer to AccelData struct to store the accelerometer data
+	 * params: x, y, z, offset corrected raw accelerometer values
+	 * 		   accel, pointer to AccelData struct to store the scaled values
+	 * returns: None
+	 */
+	void scaleAccel(int16_t x, int16_t y, int16_t z, AccelData *accel);
+
+	/*
+	 * Function to convert offset corrected gyroscope counts to milli degrees
+	 * per second without floating point operations.
+	 *
+	 * params: x, y, z, offset corrected raw gyroscope values
+	 * 		   gyro, pointer to GyroDataFixed struct to store the scaled values
+	 * returns: None
+	 */
+	void scaleGyroFixed(int16_t x, int16_t y, int16_t z, GyroDataFixed *gyro);
+
+	/*
+	 * Function to convert offset corrected accelerometer counts to milli g
+	 * without floating point operations.
+	 *
+	 * params: x, y, z, offset corrected raw accelerometer values
+	 * 		   accel, pointer to AccelDataFixed struct to store the scaled values
+	 * returns: None
+	 */
+	void scaleAccelFixed(int16_t x, int16_t y, int16_t z, AccelDataFixed *accel);
+
+	/*
+	 * Function to convert a raw temperature value to degree Celsius.
+	 *
+	 * params: t, raw temperature value
+	 * returns: float, the temperature in degree Celsius
+	 */
+	float scaleTemp(int16_t t);
+
+	/*
+	 * Function to convert a raw temperature value to hundredths of a degree
+	 * Celsius without floating point operations.
+	 *
+	 * params: t, raw temperature value
+	 * returns: int16_t, the temperature in hundredths of a degree Celsius
+	 */
+	int16_t scaleTempFixed(int16_t t);
+
+	/*
+	 * Function to compute the gyroscope scale factors once for the current
+	 * range, so reads only need one multiplication per axis.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void updateGyroScale();
+
+	/*
+	 * Function to compute the accelerometer scale factors once for the
+	 * current range, so reads only need one multiplication per axis.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void updateAccelScale();
+
+	/*
+	 * Function to convert an offset in raw counts from one range to another.
+	 *
+	 * params: offset, the offset in raw counts
+	 * 		   from, the range the offset was taken at
+	 * 		   to, the range to convert the offset to
+	 * returns: int16_t, the offset in raw counts of the new range
+	 */
+	int16_t rescaleOffset(int16_t offset, uint8_t from, uint8_t to);
+
+public:
+	/*
+	 * Constructor for SimpleIMU object on Wire. The bus is started by init.
+	 *
+	 * params: address I2C address of the IMU
+	 * returns: SimpleIMU object
+	 */
+	SimpleIMU(uint8_t address);
+
+	/*
+	 * Constructor for SimpleIMU object on another bus than Wire.
+	 *
+	 * params: address I2C address of the IMU
+	 * 		   transport, the bus the IMU is on
+	 * returns: SimpleIMU object
+	 */
+	SimpleIMU(uint8_t address, SimpleIMU_Transport *transport);
+
+	/*
+	 * Function to initialize the IMU.
+	 *
+	 * params: None
+	 * returns: bool, true if initialization is successful, false otherwise,
+	 * 				  getLastError tells why
+	 */
+	bool init();
+
+	/*
+	 * Function to set the gyroscope sensitivity.
+	 *
+	 * params: range, the sensitivity range of the gyroscope.
+	 *     			  Can be 0, 1, 2, 3 for 250, 500, 1000, 2000 degrees
+	 * 				  per second respectively.
+	 * returns: uint8_t, IMU_OK, IMU_ERROR_ARGUMENT for an invalid range or the error
+	 */
+	uint8_t setGyroRange(uint8_t range);
+
+	/*
+	 * Function to get the sensititvity range of the gyroscope.
+	 *
+	 * params: None
+	 * returns: uint8_t, the sensistivity range of the gyroscope.
+	 * 				     Can be 0, 1, 2, 3 for 250, 500, 1000, 2000 deg/s
+	 * 					 respectively.
+	 */
+	uint8_t getGyroRange();
+
+	/*
+	 * Function to calibrate the gyroscope.
+	 *
+	 * params: samples, number of samples to take for calibration
+	 * returns: uint8_t, IMU_OK or the error, the offsets are left unchanged if no sample was read
+	 */
+	uint8_t calibGyro(int samples = 100);
+
+	/*
+	 * Function to read the gyroscope data.
+	 *
+	 * params: gyro, pointer to GyroData struct to store the gyroscope data
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readGyro(GyroData *gyro);
+
+	/*
+	 * Function to set the sensitivity range of the accelerometer.
+	 *
+	 * params: range, the sensitivity range of the accelerometer.
+	 *   			  Can be 0, 1, 2, 3 for 2, 4, 8, 16 g respectively.
+	 * returns: uint8_t, IMU_OK, IMU_ERROR_ARGUMENT for an invalid range or the error
+	 */
+	uint8_t setAccelRange(uint8_t range);
+
+	/*
+	 * Function to get the sensitivity range of the accelerometer.
+	 *
+	 * params: None
+	 * returns: uint8_t, the sensitivity range of the accelerometer.
+	 * 					 Can be 0, 1, 2, 3 for 2, 4, 8, 16 g respectively.
+	 */
+	uint8_t getAccelRange();
+
+	/*
+	 * Function to calibrate the accelerometer.
+	 *
+	 * params: samples, number of samples to take for calibration
+	 * returns: uint8_t, IMU_OK or the error, the offsets are left unchanged if no sample was read
+	 */
+	uint8_t calibAccel(int samples = 100);
+
+	/*
+	 * Function to write the offsets found by calibGyro and calibAccel into
+	 * the offset registers of the IMU. The IMU then outputs corrected data,
+	 * also into the FIFO, the offsets stay valid when the range changes and
+	 * no correction is done in software anymore. Unlike calibAccel, the
+	 * axis closest to gravity keeps reading 1 g. The registers are reset to
+	 * the factory values on power up.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t applyHardwareOffsets();
+
+	/*
+	 * Function to export the current calibration, to be stored and loaded
+	 * with setCalibration on the next start. The temperature is the one
+	 * kept when the offsets were taken by calibGyro, calibAccel, the
+	 * calibrator or the temperature compensation, or loaded with
+	 * setCalibration; it is read from the IMU only if none was kept.
+	 * Export before applyHardwareOffsets, which clears the offsets.
+	 *
+	 * params: cal, pointer to IMUCalibration struct to store the calibration
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t getCalibration(IMUCalibration *cal);
+
+	/*
+	 * Function to load a calibration exported with getCalibration. The
+	 * offsets are converted to the current ranges.
+	 *
+	 * params: cal, pointer to the IMUCalibration struct to load
+	 * 		   maxTempDelta, the largest difference to the calibration temperature
+	 * 		   				 in hundredths of a degree, 0 to skip the check
+	 * returns: bool, true if loaded, false if the record is corrupt, of another
+	 * 				  version or stale and calibration has to be done again, or
+	 * 				  if the temperature could not be read
+	 */
+	bool setCalibration(const IMUCalibration *cal, int16_t maxTempDelta = 0);
+
+	/*
+	 * Function to read the accelerometer data.
+	 *
+	 * params: accel, pointer to AccelData struct to store the accelerometer data
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readAccel(AccelData *accel);
+
+	/*
+	 * Function to read the gyroscope data without floating point operations.
+	 *
+	 * params: gyro, pointer to GyroDataFixed struct to store the gyroscope
+	 * 				 data in milli degrees per second
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readGyroFixed(GyroDataFixed *gyro);
+
+	/*
+	 * Function to read the accelerometer data without floating point operations.
+	 *
+	 * params: accel, pointer to AccelDataFixed struct to store the
+	 * 				  accelerometer data in milli g
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readAccelFixed(AccelDataFixed *accel);
+
+	/*
+	 * Function to set the sample rate divider. The IMU outputs a new sample
+	 * every (1 + divider) cycles of the gyroscope output rate.
+	 *
+	 * params: divider, the sample rate divider, 0 to 255
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t setSampleRateDivider(uint8_t divider);
+
+	/*
+	 * Function to get the sample rate divider.
+	 *
+	 * params: None
+	 * returns: uint8_t, the sample rate divider
+	 */
+	uint8_t getSampleRateDivider();
+
+	/*
+	 * Function to set the bandwidth of the digital low pass filter.
+	 * The filter is disabled with 0, which raises the gyroscope output
+	 * rate from 1 kHz to 8 kHz.
+	 *
+	 * params: mode, the bandwidth of the filter.
+	 * 				 Can be 0, 1, 2, 3, 4, 5, 6 for 256, 188, 98, 42, 20, 10, 5 Hz
+	 * 				 respectively.
+	 * returns: uint8_t, IMU_OK, IMU_ERROR_ARGUMENT for an invalid mode or the error
+	 */
+	uint8_t setDLPFMode(uint8_t mode);
+
+	/*
+	 * Function to get the bandwidth of the digital low pass filter.
+	 *
+	 * params: None
+	 * returns: uint8_t, the bandwidth of the filter.
+	 * 					 Can be 0, 1, 2, 3, 4, 5, 6 for 256, 188, 98, 42, 20, 10, 5 Hz
+	 * 					 respectively.
+	 */
+	uint8_t getDLPFMode();
+
+	/*
+	 * Function to get the rate at which the IMU outputs new samples. This is
+	 * the rate of the data ready interrupt and of the frames in the FIFO.
+	 * The accelerometer itself is only sampled at 1 kHz.
+	 *
+	 * params: None
+	 * returns: float, the output data rate in Hz
+	 */
+	float getOutputDataRate();
+
+	/*
+	 * Function to hold back configuration writes. The range, sample rate
+	 * and filter setters only update the copy of the registers kept in
+	 * memory until commitConfig is called.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void beginConfig();
+
+	/*
+	 * Function to write the configuration changes made since beginConfig
+	 * in a single I2C transaction.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t commitConfig();
+
+	/*
+	 * Function to read the accelerometer, temperature and gyroscope data
+	 * in a single I2C transaction. All three values come from the same
+	 * sample, and the bus is only addressed once.
+	 *
+	 * params: accel, pointer to AccelData struct to store the accelerometer data
+	 * 		   gyro, pointer to GyroData struct to store the gyroscope data
+	 * 		   temp, pointer to a float to store the temperature in degree Celsius.
+	 * 		   		 Can be NULL if the temperature is not needed.
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readMotion(AccelData *accel, GyroData *gyro, float *temp = NULL);
+
+	/*
+	 * Function to read the accelerometer, temperature and gyroscope data
+	 * in a single I2C transaction without floating point operations.
+	 *
+	 * params: accel, pointer to AccelDataFixed struct to store the
+	 * 				  accelerometer data in milli g
+	 * 		   gyro, pointer to GyroDataFixed struct to store the gyroscope
+	 * 				 data in milli degrees per second
+	 * 		   temp, pointer to an int16_t to store the temperature in
+	 * 				 hundredths of a degree Celsius. Can be NULL.
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readMotionFixed(AccelDataFixed *accel, GyroDataFixed *gyro, int16_t *temp = NULL);
+
+	/*
+	 * Function to read the raw accelerometer, temperature and gyroscope
+	 * counts in a single I2C transaction, without offsets or scaling.
+	 *
+	 * params: raw, pointer to IMURawSample struct to store the counts
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readMotionRaw(IMURawSample *raw);
+
+	/*
+	 * Function to start streaming samples into the FIFO of the IMU.
+	 * The FIFO and its overflow flag are cleared and the DMP is disabled, as
+	 * it shares the FIFO.
+	 * Each sample becomes one frame in the FIFO, which holds IMU_FIFO_SIZE
+	 * bytes, so readFIFO has to be called at least every
+	 * (IMU_FIFO_SIZE / getFIFOFrameSize()) samples to not lose any data.
+	 *
+	 * params: sensors, the sensors to be written to the FIFO.
+	 * 				    Combination of IMU_FIFO_ACCEL, IMU_FIFO_TEMP, IMU_FIFO_GYRO
+	 * 					or the single axis IMU_FIFO_GYRO_X/Y/Z flags, and
+	 * 					IMU_FIFO_AUX for the data of the auxiliary slaves.
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t beginFIFO(uint8_t sensors = IMU_FIFO_ACCEL | IMU_FIFO_GYRO);
+
+	/*
+	 * Function to stop streaming samples into the FIFO.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t endFIFO();
+
+	/*
+	 * Function to clear the FIFO. This is the recovery path after an
+	 * overflow, as the oldest bytes are overwritten by then and the
+	 * remaining data is no longer aligned to frames.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t resetFIFO();
+
+	/*
+	 * Function to get the number of bytes in the FIFO.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of bytes waiting in the FIFO
+	 */
+	uint16_t getFIFOCount();
+
+	/*
+	 * Function to get the size of one FIFO frame.
+	 *
+	 * params: None
+	 * returns: uint8_t, number of bytes per sample in the FIFO
+	 */
+	uint8_t getFIFOFrameSize();
+
+	/*
+	 * Function to check whether the FIFO has overflowed. Reading the
+	 * interrupt status clears all the interrupt flags of the IMU.
+	 *
+	 * params: None
+	 * returns: bool, true if the FIFO overflowed since the last check
+	 */
+	bool fifoOverflow();
+
+	/*
+	 * Function to read all complete frames from the FIFO. The frames are
+	 * read in as few transactions as the Wire buffer allows. Sensors not
+	 * enabled in beginFIFO are left untouched in the samples.
+	 * On overflow or a failed frame read, the FIFO is reset and -1 is
+	 * returned, the samples lost cannot be recovered and streaming
+	 * continues with the next sample.
+	 * The time of every sample is placed on a timeline kept from the FIFO
+	 * count and the learned sample period, without further bus reads. It
+	 * settles within a few seconds after beginFIFO or an overflow.
+	 *
+	 * params: samples, pointer to an array of IMUSample to store the data
+	 * 		   maxSamples, length of the samples array
+	 * 		   aux, array of maxSamples * getAuxLength() bytes to store the
+	 * 				external sensor data with IMU_FIFO_AUX, NULL to drop it
+	 * returns: int, number of samples read, -1 if the FIFO overflowed or a read failed
+	 */
+	int readFIFO(IMUSample *samples, int maxSamples, uint8_t *aux = NULL);
+
+	/*
+	 * Function to read all complete frames from the FIFO into a block,
+	 * after the samples it already holds, as raw counts without offsets.
+	 * Set block->count to 0 to start a new block, its time and period are
+	 * then set from the FIFO timeline. The axes not enabled in beginFIFO
+	 * are left untouched. On overflow or a failed frame read the
+	 * FIFO is reset, as with readFIFO.
+	 *
+	 * params: block, pointer to the IMURawBlock to store the counts
+	 * 		   aux, array of block->size * getAuxLength() bytes to store the
+	 * 				external sensor data with IMU_FIFO_AUX, NULL to drop it
+	 * returns: int, number of samples added, -1 if the FIFO overflowed or a read failed
+	 */
+	int readFIFOBlock(IMURawBlock *block, uint8_t *aux = NULL);
+
+	/*
+	 * Function to read samples into a block with one burst each, after the
+	 * samples it already holds, as raw counts without offsets. The bursts
+	 * are spaced by getSamplePeriod, so this blocks for count periods; use
+	 * the FIFO to read a block without waiting. Starting an empty block
+	 * sets its time to the first burst.
+	 *
+	 * params: block, pointer to the IMURawBlock to store the counts
+	 * 		   count, number of samples to read, limited by the free space
+	 * returns: uint8_t, IMU_OK or the error, block->count tells the samples read
+	 */
+	uint8_t readMotionBlock(IMURawBlock *block, uint16_t count);
+
+	/*
+	 * Function to apply the offsets and the scale to a block of raw counts,
+	 * one loop over each axis array. The arrays left NULL in either block
+	 * are skipped.
+	 *
+	 * params: raw, pointer to the IMURawBlock holding the counts
+	 * 		   block, pointer to the IMUSampleBlock to store the scaled values,
+	 * 				  its count is set to the samples converted
+	 * returns: None
+	 */
+	void scaleBlock(const IMURawBlock *raw, IMUSampleBlock *block);
+
+	/*
+	 * Function to convert raw frames into a block, after the samples it
+	 * already holds, with the offsets and scale of the IMU. The frames are
+	 * laid out as the FIFO frames of beginFIFO, or as the 14 byte burst of
+	 * the data registers while the FIFO is off. On hosts with SIMD the
+	 * kernels of SimpleIMU_Convert.h do the work. The time and period of
+	 * the block are left unchanged.
+	 *
+	 * params: frames, pointer to the frames as read from the IMU
+	 * 		   count, number of frames, limited by the free space of the block
+	 * 		   block, pointer to the IMUSampleBlock to store the values
+	 * returns: uint16_t, number of frames converted
+	 */
+	uint16_t convertFrames(const uint8_t *frames, uint16_t count, IMUSampleBlock *block);
+
+	/*
+	 * Function to load a firmware image into the DMP and start it. The
+	 * DMP then fuses the sensors on the IMU and writes quaternion packets
+	 * into the FIFO at 200 Hz / (1 + divider). The image is not part of the
+	 * library, use the 1929 byte MotionApps 2.0 image from InvenSense with
+	 * its configuration table followed by its update table, both as
+	 * entries of bank, address, length and bytes. The IMU is reset and set
+	 * to 2000 deg/s, 2 g, 42 Hz filter and 200 Hz, which replaces the FIFO
+	 * and data ready configuration, the tables are applied and the program
+	 * is started at 0x0300.
+	 *
+	 * params: firmware, pointer to the firmware image, in PROGMEM if progmem is true
+	 * 		   size, number of bytes of the image
+	 * 		   config, pointer to the configuration and update tables, in PROGMEM if progmem is true
+	 * 		   configSize, number of bytes of the tables
+	 * 		   packetSize, number of bytes of one packet the image writes to the FIFO, at least 16
+	 * 		   progmem, whether the image and the tables are stored in program memory
+	 * returns: bool, true if the image and the tables were written and verified
+	 */
+	bool beginDMP(const uint8_t *firmware, uint16_t size, const uint8_t *config, uint16_t configSize, uint8_t packetSize = IMU_DMP_PACKET_SIZE, bool progmem = true);
+
+	/*
+	 * Function to stop the DMP.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t endDMP();
+
+	/*
+	 * Function to set the rate of the DMP packets.
+	 *
+	 * params: divider, the DMP writes a packet every (1 + divider) cycles of 200 Hz
+	 * returns: bool, true if the value was written and verified
+	 */
+	bool setDMPOutputRate(uint8_t divider);
+
+	/*
+	 * Function to read the oldest DMP packet from the FIFO. Call it again
+	 * while it returns 1 to catch up with older packets.
+	 *
+	 * params: q, array of 4 floats to store the quaternion w, x, y, z
+	 * returns: int, 1 if a quaternion was read, 0 if no packet is waiting,
+	 * 			-1 if the FIFO overflowed or a read failed and it was reset
+	 */
+	int readDMPQuaternion(float *q);
+
+	/*
+	 * Function to start the auxiliary I2C master, which reads external
+	 * sensors on the AUX_DA and AUX_CL pins into EXT_SENS_DATA on every
+	 * sample. The bypass to the host bus is turned off. The data ready
+	 * interrupt waits for the external data.
+	 *
+	 * params: clock, the bus clock, IMU_AUX_CLOCK_400KHZ or an I2C_MST_CLK value
+	 * 		   delay, delayed slaves are accessed every (1 + delay) samples, up to 31
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t beginAuxMaster(uint8_t clock = IMU_AUX_CLOCK_400KHZ, uint8_t delay = 0);
+
+	/*
+	 * Function to stop the auxiliary I2C master and disable all slaves.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t endAuxMaster();
+
+	/*
+	 * Function to read registers of an external sensor on every sample.
+	 * The data of the reading slaves is placed in EXT_SENS_DATA in the
+	 * order of the slave number, getAuxOffset gives where.
+	 *
+	 * params: slave, the slave from 0 to 3
+	 * 		   address, 7 bit I2C address of the external sensor
+	 * 		   reg, the first register
+	 * 		   length, number of registers, 1 to 15
+	 * 		   swapBytes, true to swap the bytes of each pair, for little endian sensors
+	 * 		   delayed, true to read every (1 + delay) samples only
+	 * returns: bool, false if the slave or length is invalid, the data does not fit
+	 * 				  or the slave could not be written
+	 */
+	bool addAuxRead(uint8_t slave, uint8_t address, uint8_t reg, uint8_t length, bool swapBytes = false,
+					bool delayed = false);
+
+	/*
+	 * Function to write a register of an external sensor on every sample,
+	 * like the trigger of a single measurement.
+	 *
+	 * params: slave, the slave from 0 to 3
+	 * 		   address, 7 bit I2C address of the external sensor
+	 * 		   reg, the register
+	 * 		   value, the value written
+	 * 		   delayed, true to write every (1 + delay) samples only
+	 * returns: bool, false if the slave is invalid or could not be written
+	 */
+	bool addAuxWrite(uint8_t slave, uint8_t address, uint8_t reg, uint8_t value, bool delayed = false);
+
+	/*
+	 * Function to disable a slave of the auxiliary I2C master.
+	 *
+	 * params: slave, the slave from 0 to 3
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t removeAuxSlave(uint8_t slave);
+
+	/*
+	 * Function to write a register of an external sensor once, to set it
+	 * up. The transfer happens on the next sample, so the sensor must not
+	 * be sleeping.
+	 *
+	 * params: address, 7 bit I2C address of the external sensor
+	 * 		   reg, the register
+	 * 		   value, the value written
+	 * returns: bool, true if the sensor acknowledged
+	 */
+	bool writeAux(uint8_t address, uint8_t reg, uint8_t value);
+
+	/*
+	 * Function to read a register of an external sensor once.
+	 *
+	 * params: address, 7 bit I2C address of the external sensor
+	 * 		   reg, the register
+	 * 		   value, pointer to store the value
+	 * returns: bool, true if the sensor acknowledged
+	 */
+	bool readAux(uint8_t address, uint8_t reg, uint8_t *value);
+
+	/*
+	 * Function to get the number of bytes of external sensor data.
+	 *
+	 * params: None
+	 * returns: uint8_t, number of bytes read by all slaves
+	 */
+	uint8_t getAuxLength();
+
+	/*
+	 * Function to get where the data of a slave is in the external sensor data.
+	 *
+	 * params: slave, the slave from 0 to 3
+	 * returns: uint8_t, offset in bytes
+	 */
+	uint8_t getAuxOffset(uint8_t slave);
+
+	/*
+	 * Function to read the accelerometer, temperature, gyroscope and the
+	 * external sensor data in one burst, in two when the burst does not fit
+	 * the Wire buffer.
+	 *
+	 * params: accel, pointer to AccelData struct to store the data
+	 * 		   gyro, pointer to GyroData struct to store the data
+	 * 		   temp, pointer to store the temperature in degree Celsius, NULL to skip
+	 * 		   aux, array of getAuxLength() bytes to store the external sensor data
+	 * returns: uint8_t, IMU_OK or the error, the data is left unchanged on an error
+	 */
+	uint8_t readMotionAux(AccelData *accel, GyroData *gyro, float *temp, uint8_t *aux);
+
+	/*
+	 * Function to start the interrupt driven acquisition. The IMU raises
+	 * its INT pin on every new sample and the ISR records the event.
+	 * updateDataReady then reads exactly one sample per event into a
+	 * single producer, single consumer ring buffer that is drained with
+	 * readSample. The I2C read is not done in the ISR itself since Wire
+	 * depends on interrupts, which are disabled while an ISR runs.
+	 *
+	 * params: pin, the pin connected to the INT pin of the IMU. With
+	 * 			    IMU_NO_PIN no interrupt is attached and the sketch has
+	 * 				to call handleDataReady from its own ISR.
+	 * 		   buffer, pointer to an array of IMUSample used as ring buffer
+	 * 		   size, length of the buffer, has to be a power of two up to 128
+	 * returns: bool, true if the acquisition was started, false if the size is invalid
+	 * 				  or the interrupt could not be configured
+	 */
+	bool beginDataReady(uint8_t pin, IMUSample *buffer, uint8_t size);
+
+	/*
+	 * Function to stop the interrupt driven acquisition.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t endDataReady();
+
+	/*
+	 * Function to record a data ready event. To be called from an ISR,
+	 * it takes the time of the sample from micros.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void handleDataReady();
+
+	/*
+	 * Function to read the pending sample into the ring buffer. This is the
+	 * producer side of the ring buffer, call it from loop or from a single
+	 * task. Only the latest sample is held by the IMU, if more than one
+	 * event happened since the last call the older samples are counted as
+	 * missed, as is a sample whose read failed. Every event is counted
+	 * once, read, missed or dropped.
+	 *
+	 * params: None
+	 * returns: bool, true if a new sample was added to the ring buffer
+	 */
+	bool updateDataReady();
+
+	/*
+	 * Function to get the number of samples in the ring buffer.
+	 *
+	 * params: None
+	 * returns: uint8_t, number of samples that can be read
+	 */
+	uint8_t availableSamples();
+
+	/*
+	 * Function to take the oldest sample from the ring buffer. This is the
+	 * consumer side of the ring buffer.
+	 *
+	 * params: sample, pointer to IMUSample struct to store the sample
+	 * returns: bool, true if a sample was read, false if the buffer is empty
+	 */
+	bool readSample(IMUSample *sample);
+
+	/*
+	 * Function to get the number of samples dropped because the ring
+	 * buffer was full.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of dropped samples
+	 */
+	uint16_t getOverrunCount();
+
+	/*
+	 * Function to get the number of samples that were overwritten in the
+	 * IMU before updateDataReady could read them, or whose read failed.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of missed samples
+	 */
+	uint16_t getMissedCount();
+
+	/*
+	 * Function to set the motion detection. Motion is detected when the high
+	 * pass filtered acceleration of any axis exceeds the threshold for the
+	 * duration.
+	 *
+	 * params: threshold, in units of 2 mg
+	 * 		   duration, in milliseconds
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t setMotionDetection(uint8_t threshold, uint8_t duration);
+
+	/*
+	 * Function to set the zero motion detection. Zero motion is detected when
+	 * the high pass filtered acceleration of all axes stays below the
+	 * threshold for the duration, and again when the IMU moves afterwards.
+	 *
+	 * params: threshold, in units of 2 mg
+	 * 		   duration, in units of 64 milliseconds
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t setZeroMotionDetection(uint8_t threshold, uint8_t duration);
+
+	/*
+	 * Function to set the free fall detection. Free fall is detected when the
+	 * acceleration of all axes stays below the threshold for the duration.
+	 *
+	 * params: threshold, in units of 2 mg
+	 * 		   duration, in milliseconds
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t setFreeFallDetection(uint8_t threshold, uint8_t duration);
+
+	/*
+	 * Function to start delivering motion events through the INT pin with
+	 * the IMU running at full power. The thresholds are written in one burst.
+	 * Data ready and motion events share the INT pin, stop one before
+	 * starting the other.
+	 *
+	 * params: pin, the pin connected to the INT pin of the IMU. With
+	 * 			    IMU_NO_PIN no interrupt is attached and every call of
+	 * 				getMotionEvents reads the interrupt status.
+	 * 		   events, IMU_EVENT_MOTION, IMU_EVENT_ZERO_MOTION and
+	 * 				   IMU_EVENT_FREE_FALL combined with |
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t beginMotionEvents(uint8_t pin, uint8_t events);
+
+	/*
+	 * Function to put the IMU into the accelerometer only cycle mode. The
+	 * gyroscope and temperature sensor are stopped and the accelerometer
+	 * wakes up at the given rate to compare one sample against the motion
+	 * threshold. The reference is the acceleration at the time of the call,
+	 * so the IMU should be at rest. Only motion events are delivered, zero
+	 * motion and free fall need the full sample rate. The bus stays idle
+	 * until the INT pin rises.
+	 *
+	 * params: pin, the pin connected to the INT pin of the IMU, IMU_NO_PIN to poll
+	 * 		   rate, IMU_WAKE_1_25HZ, IMU_WAKE_5HZ, IMU_WAKE_20HZ or IMU_WAKE_40HZ
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t beginWakeOnMotion(uint8_t pin, uint8_t rate = IMU_WAKE_5HZ);
+
+	/*
+	 * Function to stop the motion events and return to full power, where
+	 * the high rate streaming can be started.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	uint8_t endMotionEvents();
+
+	/*
+	 * Function to record a motion interrupt. To be called from an ISR.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void handleMotion();
+
+	/*
+	 * Function to get the motion events since the last call. With an
+	 * attached pin the IMU is only read after an interrupt.
+	 *
+	 * params: None
+	 * returns: uint8_t, the IMU_EVENT bits, 0 if nothing happened or the read failed
+	 */
+	uint8_t getMotionEvents();
+
+	/*
+	 * Function to check if the IMU is in the accelerometer only cycle mode.
+	 *
+	 * params: None
+	 * returns: bool, true between beginWakeOnMotion and endMotionEvents
+	 */
+	bool isCycleMode();
+
+	/*
+	 * Function to set how often a failed transaction is tried again before
+	 * it is reported. A read then takes at most (retries + 2) bus timeouts,
+	 * one for every try and one for the check after a bus recovery.
+	 *
+	 * params: retries, number of retries, IMU_RETRIES by default
+	 * returns: None
+	 */
+	void setRetries(uint8_t retries);
+
+	/*
+	 * Function to turn the automatic bus recovery on or off. It is on by
+	 * default: once a transaction that timed out or hit a bus error has
+	 * used up its retries, recover is called and the transaction is tried
+	 * once more.
+	 *
+	 * params: enable, true to recover the bus automatically
+	 * returns: None
+	 */
+	void setBusRecovery(bool enable);
+
+	/*
+	 * Function to free a hung bus and bring the IMU back to the cached
+	 * configuration, in case it was reset with the bus. The range, sample
+	 * rate and filter, the motion detection, the interrupt and power
+	 * settings, the offset registers written by applyHardwareOffsets and
+	 * the auxiliary master with its slaves are written again and the FIFO
+	 * is restarted. The DMP firmware is not cached: a DMP lost with a
+	 * reset of the IMU is stopped, readDMPQuaternion returns 0 until
+	 * beginDMP is called again, and recover returns IMU_ERROR_DEVICE.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK if the IMU answered and took the configuration
+	 */
+	uint8_t recover();
+
+	/*
+	 * Function to get the status of the last transaction that failed after
+	 * its retries.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_ERROR code, IMU_OK if none failed since resetErrorCounts
+	 */
+	uint8_t getLastError();
+
+	/*
+	 * Function to get the number of transactions that failed after their retries.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of failed transactions
+	 */
+	uint16_t getErrorCount();
+
+	/*
+	 * Function to get the number of times a failed transaction was tried again.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of retries
+	 */
+	uint16_t getRetryCount();
+
+	/*
+	 * Function to get the number of bus recoveries.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of calls of recover, automatic or not
+	 */
+	uint16_t getRecoveryCount();
+
+	/*
+	 * Function to set the error, retry and recovery counts to 0 and the
+	 * last error to IMU_OK.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void resetErrorCounts();
+
+	/*
+	 * Function to get the time between two samples against the host clock.
+	 * It starts at the period of getOutputDataRate and follows the clock
+	 * of the IMU, which runs off by up to a few percent, while the FIFO or
+	 * the data ready interrupt is read.
+	 *
+	 * params: None
+	 * returns: float, the period in micros
+	 */
+	float getSamplePeriod();
+
+	/*
+	 * Function to get the timing statistics of the samples. With the data
+	 * ready interrupt the errors are the distances of the interrupts from
+	 * the learned timeline, caused by the interrupt latency. With the FIFO
+	 * only the time of the count is seen, an error is counted when the
+	 * count is off the timeline by more than the period.
+	 *
+	 * params: stats, pointer to IMUTimingStats struct to store the statistics
+	 * returns: None
+	 */
+	void getTimingStats(IMUTimingStats *stats);
+
+	/*
+	 * Function to clear the jitter statistics. The learned period is kept.
+	 *
+	 * params: None
 	 * returns: None
 	 */
-	void readAccel(AccelData *accel);
+	void resetTimingStats();
 };
 
 #endif /* SIMPLEIMU_H */
\ No newline at end of file
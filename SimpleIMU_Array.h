@@ -0,0 +1,114 @@
+/*
+ *  Header for reading several IMUs together in SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  The IMUs are read one burst each, grouped by transport so IMUs behind
+ *  the same TCA9548A channel are read without a select in between. The
+ *  order is reversed on every pass, so the channel read last is read first
+ *  on the next pass and needs no select either. IMUs on the bus of the
+ *  switch itself are given its upstream transport, so no channel is left
+ *  connected while they are read.
+ */
+
+#ifndef SIMPLEIMU_ARRAY_H
+#define SIMPLEIMU_ARRAY_H
+
+#include "SimpleIMU.h"
+
+/* Maximum number of IMUs in an array */
+#ifndef IMU_ARRAY_MAX_SENSORS
+#define IMU_ARRAY_MAX_SENSORS 8
+#endif
+
+/* One sample of every IMU of an array, in the order the IMUs were added */
+typedef struct
+{
+	uint32_t timestamp;								/* mean of the times of the samples read, micros */
+	uint32_t spread;								/* time between the first and the last sample read, micros */
+	uint8_t count;									/* number of IMUs */
+	uint32_t sampleTime[IMU_ARRAY_MAX_SENSORS];		/* middle of the burst read of each IMU, micros */
+	IMUSample sample[IMU_ARRAY_MAX_SENSORS];		/* the samples */
+} IMUSampleSet;
+
+class SimpleIMU_Array
+{
+private:
+	/* The IMUs in the order they were added */
+	SimpleIMU *ARR_Sensors[IMU_ARRAY_MAX_SENSORS];
+
+	/* The indices of the IMUs in read order */
+	uint8_t ARR_Order[IMU_ARRAY_MAX_SENSORS];
+
+	/* The number of IMUs */
+	uint8_t ARR_Count;
+
+	/* Whether the next pass goes backwards */
+	bool ARR_Reverse;
+
+	/* The time between two sample sets in micros, 0 for the output data rate */
+	uint32_t ARR_Period;
+
+	/* The time of the next sample set in micros */
+	uint32_t ARR_NextRead;
+
+public:
+	SimpleIMU_Array();
+
+	/*
+	 * Function to add an IMU to the array.
+	 *
+	 * params: imu, the IMU
+	 * returns: bool, false if the array is full
+	 */
+	bool add(SimpleIMU *imu);
+
+	/*
+	 * Function to get the number of IMUs in the array.
+	 *
+	 * params: None
+	 * returns: uint8_t, number of IMUs
+	 */
+	uint8_t getSensorCount();
+
+	/*
+	 * Function to initialize all IMUs with the same sample rate and filter,
+	 * so they sample at the same rate.
+	 *
+	 * params: divider, the sample rate divider
+	 * 		   dlpfMode, the digital low pass filter mode
+	 * returns: bool, true if all IMUs were initialized
+	 */
+	bool begin(uint8_t divider = 0, uint8_t dlpfMode = 1);
+
+	/*
+	 * Function to set the time between sample sets read by poll.
+	 *
+	 * params: period, the time in micros, 0 for the output data rate
+	 * returns: None
+	 */
+	void setPeriod(uint32_t period);
+
+	/*
+	 * Function to read one sample of every IMU. An IMU that failed keeps
+	 * the sample and the time of the set before, the others are still
+	 * read; the timestamp and the spread cover the samples read only.
+	 *
+	 * params: set, the IMUSampleSet to store the samples
+	 * returns: uint8_t, IMU_OK or the error of the first IMU that failed
+	 */
+	uint8_t read(IMUSampleSet *set);
+
+	/*
+	 * Function to read a sample set when the period has passed.
+	 *
+	 * params: set, the IMUSampleSet to store the samples
+	 * returns: bool, true if a set was read
+	 */
+	bool poll(IMUSampleSet *set);
+};
+
+#endif /* SIMPLEIMU_ARRAY_H */
@@ -0,0 +1,95 @@
+/*
+ *  Calibration storage helpers for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Include this header in the sketch to store an IMUCalibration record in
+ *  EEPROM, or in a file when building on a PC. It is kept apart from
+ *  SimpleIMU.h so boards without EEPROM can still use the library.
+ */
+
+#ifndef SIMPLEIMU_CALIBRATION_H
+#define SIMPLEIMU_CALIBRATION_H
+
+#include "SimpleIMU.h"
+
+#if defined(ARDUINO)
+#include <EEPROM.h>
+
+/*
+ * Function to store a calibration record in EEPROM.
+ *
+ * params: address, the EEPROM address to store the record at
+ * 		   cal, pointer to the IMUCalibration struct to store
+ * returns: None
+ */
+inline void saveCalibrationEEPROM(int address, const IMUCalibration *cal)
+{
+#if defined(ESP8266) || defined(ESP32)
+	EEPROM.begin(address + sizeof(IMUCalibration));
+#endif
+	EEPROM.put(address, *cal);
+#if defined(ESP8266) || defined(ESP32)
+	EEPROM.commit();
+#endif
+}
+
+/*
+ * Function to load a calibration record from EEPROM. The record still
+ * has to be validated by SimpleIMU::setCalibration.
+ *
+ * params: address, the EEPROM address the record is stored at
+ * 		   cal, pointer to IMUCalibration struct to store the record
+ * returns: None
+ */
+inline void loadCalibrationEEPROM(int address, IMUCalibration *cal)
+{
+#if defined(ESP8266) || defined(ESP32)
+	EEPROM.begin(address + sizeof(IMUCalibration));
+#endif
+	EEPROM.get(address, *cal);
+}
+
+#else
+#include <stdio.h>
+
+/*
+ * Function to store a calibration record in a file.
+ *
+ * params: path, the path of the file
+ * 		   cal, pointer to the IMUCalibration struct to store
+ * returns: bool, true if the record was written
+ */
+inline bool saveCalibrationFile(const char *path, const IMUCalibration *cal)
+{
+	FILE *file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+	bool written = fwrite(cal, sizeof(IMUCalibration), 1, file) == 1;
+	return fclose(file) == 0 && written;
+}
+
+/*
+ * Function to load a calibration record from a file. The record still
+ * has to be validated by SimpleIMU::setCalibration.
+ *
+ * params: path, the path of the file
+ * 		   cal, pointer to IMUCalibration struct to store the record
+ * returns: bool, true if a whole record was read
+ */
+inline bool loadCalibrationFile(const char *path, IMUCalibration *cal)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+	bool read = fread(cal, sizeof(IMUCalibration), 1, file) == 1;
+	fclose(file);
+	return read;
+}
+
+#endif /* ARDUINO */
+
+#endif /* SIMPLEIMU_CALIBRATION_H */
@@ -0,0 +1,169 @@
+/*
+ *  Header for the non-blocking calibration of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#ifndef SIMPLEIMU_CALIBRATOR_H
+#define SIMPLEIMU_CALIBRATOR_H
+
+#include "SimpleIMU.h"
+
+/* Sensors to calibrate, combine with | */
+#define IMU_CALIB_GYRO 0x01
+#define IMU_CALIB_ACCEL 0x02
+
+/* Calibration states returned by poll */
+#define IMU_CALIB_IDLE 0
+#define IMU_CALIB_RUNNING 1
+#define IMU_CALIB_DONE 2
+#define IMU_CALIB_FAILED 3
+
+/* Number of windows with motion after which the calibration gives up */
+#ifndef IMU_CALIB_MAX_REJECTED
+#define IMU_CALIB_MAX_REJECTED 32
+#endif
+
+class SimpleIMU_Calibrator
+{
+private:
+	/* The IMU being calibrated */
+	SimpleIMU *CAL_IMU;
+
+	/* The current state, one of IMU_CALIB_* */
+	uint8_t CAL_State;
+
+	/* The sensors being calibrated, as IMU_CALIB_* flags */
+	uint8_t CAL_Sensors;
+
+	/* The number of samples in one window */
+	uint8_t CAL_WindowSize;
+
+	/* The number of samples to accept in total */
+	uint16_t CAL_Samples;
+
+	/* The number of windows rejected because of motion */
+	uint16_t CAL_Rejected;
+
+	/* The time between two samples of the IMU in microseconds */
+	uint32_t CAL_Period;
+
+	/* The time the last sample was taken at in microseconds */
+	uint32_t CAL_LastSample;
+
+	/* The largest variance of a window at rest, in counts^2, for gyro and accel */
+	float CAL_MaxVariance[2];
+
+	/* The number of samples in the current window */
+	uint8_t CAL_WindowCount;
+
+	/* The running mean of the current window, accel x, y, z then gyro x, y, z */
+	float CAL_WindowMean[6];
+
+	/* The running sum of squared differences of the current window */
+	float CAL_WindowM2[6];
+
+	/* The number of samples accepted */
+	uint16_t CAL_Count;
+
+	/* The mean of all accepted windows */
+	float CAL_Mean[6];
+
+	/* The sum of squared differences of all accepted windows */
+	float CAL_M2[6];
+
+	/* The raw temperature of the last sample */
+	int16_t CAL_Temp;
+
+	/*
+	 * Function to add the current window to the accepted samples, or to
+	 * reject it if the variance shows the IMU was moving.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void closeWindow();
+
+	/*
+	 * Function to write the offsets into the IMU once enough samples are accepted.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void finish();
+
+public:
+	/*
+	 * Constructor for SimpleIMU_Calibrator object.
+	 *
+	 * params: imu, pointer to the SimpleIMU object to calibrate
+	 * returns: SimpleIMU_Calibrator object
+	 */
+	SimpleIMU_Calibrator(SimpleIMU *imu);
+
+	/*
+	 * Function to start a calibration. Calibration then proceeds on calls
+	 * to poll, one sample per new sample of the IMU, so loop keeps running.
+	 * Samples are grouped in windows and a window is thrown away when its
+	 * standard deviation shows the IMU was moving.
+	 *
+	 * params: sensors, the sensors to calibrate, IMU_CALIB_GYRO and/or IMU_CALIB_ACCEL
+	 * 		   samples, number of samples at rest to average
+	 * 		   window, number of samples in one window
+	 * 		   maxGyroNoise, largest standard deviation of the gyroscope at rest in deg/s
+	 * 		   maxAccelNoise, largest standard deviation of the accelerometer at rest in m/s^2
+	 * returns: None
+	 */
+	void begin(uint8_t sensors = IMU_CALIB_GYRO | IMU_CALIB_ACCEL, uint16_t samples = 100, uint8_t window = 20,
+			   float maxGyroNoise = 0.5, float maxAccelNoise = 0.2);
+
+	/*
+	 * Function to advance the calibration. Call it from loop. A sample is
+	 * taken when INT_STATUS shows data ready, so a clock of the IMU off by
+	 * a few percent neither repeats nor skips samples, and a failed read
+	 * is left out.
+	 *
+	 * params: None
+	 * returns: uint8_t, the state of the calibration, one of IMU_CALIB_*
+	 */
+	uint8_t poll();
+
+	/*
+	 * Function to get the state of the calibration.
+	 *
+	 * params: None
+	 * returns: uint8_t, the state of the calibration, one of IMU_CALIB_*
+	 */
+	uint8_t getState();
+
+	/*
+	 * Function to get the quality of the calibration, the largest standard
+	 * deviation of the gyroscope axes over the accepted samples. The
+	 * uncertainty of the offsets is this value over sqrt(samples).
+	 *
+	 * params: None
+	 * returns: float, the noise of the gyroscope in deg/s
+	 */
+	float getQuality();
+
+	/*
+	 * Function to get the number of windows rejected because of motion.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of rejected windows
+	 */
+	uint16_t getRejectedWindows();
+
+	/*
+	 * Function to get the number of samples accepted so far.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of accepted samples
+	 */
+	uint16_t getSampleCount();
+};
+
+#endif /* SIMPLEIMU_CALIBRATOR_H */
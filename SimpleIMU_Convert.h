@@ -0,0 +1,76 @@
+/*
+ *  Header for the conversion of raw frame blocks of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  A frame is a run of big endian int16_t channels followed by any other
+ *  bytes, as read from the data registers or the FIFO. A block of frames is
+ *  converted into one float array per channel, each value byte swapped,
+ *  less its bias and scaled. Where the host has SSE2, AVX2 or NEON eight
+ *  frames are converted at once, the scalar reference converts the rest
+ *  and is the only kernel on the boards. All kernels give identical floats.
+ */
+
+#ifndef SIMPLEIMU_CONVERT_H
+#define SIMPLEIMU_CONVERT_H
+
+#include <Arduino.h>
+
+/* Conversion kernels */
+#define IMU_CONVERT_SCALAR 0
+#define IMU_CONVERT_SSE2 1
+#define IMU_CONVERT_AVX2 2
+#define IMU_CONVERT_NEON 3
+
+/* Frames converted per pass over the channels, so the frames stay in the cache between passes */
+#define IMU_CONVERT_CHUNK 256
+
+/*
+ * Function to convert a block of frames with the fastest kernel of the
+ * host. Every value is computed as ((float)raw - bias) * scale.
+ *
+ * params: frames, pointer to the first frame, no alignment needed
+ * 		   frameSize, bytes from one frame to the next
+ * 		   count, number of frames
+ * 		   channels, number of int16_t channels at the start of each frame
+ * 		   bias, array of channels floats subtracted from the counts
+ * 		   scale, array of channels floats the differences are multiplied with
+ * 		   out, array of channels pointers to arrays of count floats, the
+ * 				channels with a NULL pointer are skipped
+ * returns: None
+ */
+void SimpleIMU_ConvertFrames(const uint8_t *frames, uint8_t frameSize, uint32_t count, uint8_t channels,
+							 const float *bias, const float *scale, float *const *out);
+
+/*
+ * Function to convert a block of frames one value at a time. It is the
+ * reference the other kernels are checked against.
+ *
+ * params: as SimpleIMU_ConvertFrames
+ * returns: None
+ */
+void SimpleIMU_ConvertFramesScalar(const uint8_t *frames, uint8_t frameSize, uint32_t count, uint8_t channels,
+								   const float *bias, const float *scale, float *const *out);
+
+/*
+ * Function to get the kernel used by SimpleIMU_ConvertFrames. The first
+ * call picks the fastest one the processor supports.
+ *
+ * params: None
+ * returns: uint8_t, one of IMU_CONVERT_SCALAR, IMU_CONVERT_SSE2, IMU_CONVERT_AVX2 or IMU_CONVERT_NEON
+ */
+uint8_t SimpleIMU_GetConvertKernel();
+
+/*
+ * Function to choose the kernel used by SimpleIMU_ConvertFrames, to
+ * compare the kernels with each other.
+ *
+ * params: kernel, one of IMU_CONVERT_SCALAR, IMU_CONVERT_SSE2, IMU_CONVERT_AVX2 or IMU_CONVERT_NEON
+ * returns: bool, false if the kernel is not built in or the processor lacks it
+ */
+bool SimpleIMU_SetConvertKernel(uint8_t kernel);
+
+#endif /* SIMPLEIMU_CONVERT_H */
@@ -0,0 +1,267 @@
+/*
+ *  Header for the filter and decimation stages of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  A SimpleIMU_Filter is one stage filtering up to IMU_FILTER_MAX_CHANNELS
+ *  channels, stages are chained with setNext into a pipeline. A stage is
+ *  either Q15, working on the raw int16_t counts with Q15 or Q14
+ *  coefficients and Q31 sums, or float, working on scaled values. The sums
+ *  wrap like the two's complement hardware, only the output is saturated,
+ *  so a sum may overflow on the way as long as the output is in range.
+ */
+
+#ifndef SIMPLEIMU_FILTER_H
+#define SIMPLEIMU_FILTER_H
+
+#include "SimpleIMU.h"
+
+/*
+ * Stage types. Cost per channel and sample, in multiplications and
+ * additions of the data type, Q15 multiplications are 16 x 16 bits:
+ *   IMU_FILTER_BIQUAD          5 multiplications, 4 additions, DF1 in Q15, DF2T in float
+ *   IMU_FILTER_FIR             length multiplications and additions
+ *   IMU_FILTER_MOVING_AVERAGE  2 additions and a shift for power of two lengths,
+ *                              else a 32 bit division in Q15 or a multiplication in float
+ *   IMU_FILTER_DECIMATOR       order additions, and per output order subtractions and a
+ *                              shift for power of two gains, else a 32 bit division
+ * On a 16 MHz AVR a Q15 multiplication and addition take roughly 25 cycles,
+ * a 32 bit division roughly 600, a float operation 100 to 150.
+ */
+#define IMU_FILTER_NONE 0
+#define IMU_FILTER_BIQUAD 1
+#define IMU_FILTER_FIR 2
+#define IMU_FILTER_MOVING_AVERAGE 3
+#define IMU_FILTER_DECIMATOR 4
+
+/* Number formats of a stage */
+#define IMU_FILTER_Q15 0
+#define IMU_FILTER_FLOAT 1
+
+/* Most channels of a stage, three for the axes of a sensor */
+#ifndef IMU_FILTER_MAX_CHANNELS
+#define IMU_FILTER_MAX_CHANNELS 3
+#endif
+
+/* Highest order of a Q15 decimator, float decimators are of order 1 */
+#define IMU_FILTER_MAX_ORDER 3
+
+/* Lowest cutoff of Q15 low and high passes as a fraction of the rate, below it the rounded coefficients are far off */
+#define IMU_FILTER_MIN_CUTOFF 0.005f
+
+class SimpleIMU_Filter
+{
+private:
+	/* The stage type, one of IMU_FILTER_* */
+	uint8_t FLT_Type;
+
+	/* The number format, IMU_FILTER_Q15 or IMU_FILTER_FLOAT */
+	uint8_t FLT_Format;
+
+	/* The number of channels */
+	uint8_t FLT_Channels;
+
+	/* The stage fed by this one, NULL at the end of the pipeline */
+	SimpleIMU_Filter *FLT_Next;
+
+	/* The biquad coefficients b0, b1, b2, a1, a2 in Q14 and as float */
+	int16_t FLT_Biquad[5];
+	float FLT_BiquadFloat[5];
+
+	/* The FIR taps, in Q15 or float as the format */
+	const void *FLT_Taps;
+
+	/* The history of FIR and moving average stages, length values per channel */
+	void *FLT_History;
+
+	/* The FIR or moving average length, or the decimation factor */
+	uint8_t FLT_Length;
+
+	/* The position in the history, or the samples into the current decimation */
+	uint8_t FLT_Position;
+
+	/* The decimator order */
+	uint8_t FLT_Order;
+
+	/* The shift dividing by the gain, 0xFF if the gain is not a power of two */
+	uint8_t FLT_Shift;
+
+	/* The gain of moving average and decimator stages, and its inverse for float stages */
+	uint32_t FLT_Gain;
+	float FLT_InverseGain;
+
+	/* The state of each channel: DF1 x1, x2, y1, y2 and the rounding carry; DF2T s1, s2; running sum; integrators then combs */
+	union
+	{
+		int32_t q[IMU_FILTER_MAX_CHANNELS][2 * IMU_FILTER_MAX_ORDER];
+		float f[IMU_FILTER_MAX_CHANNELS][2 * IMU_FILTER_MAX_ORDER];
+	} FLT_State;
+
+	/*
+	 * Function to set the type and clear the state and history.
+	 *
+	 * params: type, the stage type
+	 * 		   length, the length or decimation factor
+	 * returns: None
+	 */
+	void configure(uint8_t type, uint8_t length);
+
+	/*
+	 * Function to set the gain of moving average and decimator stages.
+	 *
+	 * params: gain, the sum of the weights
+	 * returns: None
+	 */
+	void setGain(uint32_t gain);
+
+	/*
+	 * Function to run this stage on one sample.
+	 *
+	 * params: values, array of the channels, replaced by the output
+	 * returns: bool, true if the stage put out a sample
+	 */
+	bool process(int16_t *values);
+	bool process(float *values);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_Filter object. The stage passes samples
+	 * through until it is configured.
+	 *
+	 * params: channels, number of channels, at most IMU_FILTER_MAX_CHANNELS
+	 * 		   format, IMU_FILTER_Q15 for raw counts or IMU_FILTER_FLOAT for scaled values
+	 * returns: SimpleIMU_Filter object
+	 */
+	SimpleIMU_Filter(uint8_t channels = 3, uint8_t format = IMU_FILTER_Q15);
+
+	/*
+	 * Function to set the stage fed with the output of this one. Both
+	 * have to have the same channels and format.
+	 *
+	 * params: next, pointer to the next SimpleIMU_Filter, NULL to end the pipeline here
+	 * returns: bool, false if the channels or format differ
+	 */
+	bool setNext(SimpleIMU_Filter *next);
+
+	/*
+	 * Function to make the stage a biquad from its coefficients, normalized
+	 * so that a0 is 1. Q15 stages take them in Q14, between -2 and 2.
+	 *
+	 * params: coeffs, array of the 5 coefficients b0, b1, b2, a1, a2
+	 * returns: bool, false if a coefficient is out of range or the poles,
+	 * 				  after rounding for Q15, are not stable
+	 */
+	bool setBiquad(const float *coeffs);
+
+	/*
+	 * Function to make the stage a second order Butterworth low pass. Q15
+	 * stages lose accuracy towards IMU_FILTER_MIN_CUTOFF of the rate.
+	 *
+	 * params: cutoff, the -3 dB frequency in Hz, below half of the rate and for Q15
+	 * 				  at least IMU_FILTER_MIN_CUTOFF of it
+	 * 		   rate, the sample rate in Hz
+	 * returns: bool, false if the cutoff is out of range
+	 */
+	bool setLowPass(float cutoff, float rate);
+
+	/*
+	 * Function to make the stage a second order Butterworth high pass, as
+	 * to remove gravity or a slow drift. Q15 stages lose accuracy towards
+	 * IMU_FILTER_MIN_CUTOFF of the rate.
+	 *
+	 * params: cutoff, the -3 dB frequency in Hz, below half of the rate and for Q15
+	 * 				  at least IMU_FILTER_MIN_CUTOFF of it
+	 * 		   rate, the sample rate in Hz
+	 * returns: bool, false if the cutoff is out of range
+	 */
+	bool setHighPass(float cutoff, float rate);
+
+	/*
+	 * Function to make the stage a FIR filter. The taps are not copied.
+	 *
+	 * params: taps, array of length taps in Q15 for Q15 stages or float for float stages
+	 * 		   length, number of taps, 1 to 255
+	 * 		   history, array of length * channels values of the same type for the past samples
+	 * returns: bool, false if the type does not match the format or the length is 0
+	 */
+	bool setFIR(const int16_t *taps, uint8_t length, int16_t *history);
+	bool setFIR(const float *taps, uint8_t length, float *history);
+
+	/*
+	 * Function to make the stage a moving average. Powers of two are cheapest.
+	 *
+	 * params: length, number of samples averaged, 1 to 255
+	 * 		   history, array of length * channels values for the past samples
+	 * returns: bool, false if the type does not match the format or the length is 0
+	 */
+	bool setMovingAverage(uint8_t length, int16_t *history);
+	bool setMovingAverage(uint8_t length, float *history);
+
+	/*
+	 * Function to make the stage a CIC decimator, one output for every
+	 * factor samples, the average of the last factor samples filtered order
+	 * times. Powers of two are cheapest. The gain factor^order has to be at
+	 * most 65536 so the sums keep 16 bits for the data.
+	 *
+	 * params: factor, the decimation, 1 to 255
+	 * 		   order, the number of integrator and comb pairs, 1 to IMU_FILTER_MAX_ORDER,
+	 * 				  only 1 for float stages
+	 * returns: bool, false if the factor, order or gain is out of range
+	 */
+	bool setDecimator(uint8_t factor, uint8_t order = 1);
+
+	/*
+	 * Function to clear the state of this stage and the following ones,
+	 * as after a gap in the samples.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void reset();
+
+	/*
+	 * Function to get the decimation of this stage and the following ones.
+	 *
+	 * params: None
+	 * returns: uint16_t, input samples per output sample
+	 */
+	uint16_t getDecimation();
+
+	/*
+	 * Function to run one sample through the pipeline from this stage on.
+	 *
+	 * params: values, array of the channels, replaced by the output of the
+	 * 				   last stage when there is one
+	 * returns: bool, true if the pipeline put out a sample, false while a
+	 * 				  decimator collects samples or on a format mismatch
+	 */
+	bool update(int16_t *values);
+	bool update(float *values);
+
+	/*
+	 * Function to run one scaled sample of a 3 channel float pipeline.
+	 *
+	 * params: accel or gyro, pointer to the data, replaced by the output
+	 * returns: bool, true if the pipeline put out a sample
+	 */
+	bool update(AccelData *accel);
+	bool update(GyroData *gyro);
+
+	/*
+	 * Function to run a block through the pipeline from this stage on, one
+	 * stage over the whole block after the other. The output is written
+	 * over the start of the arrays, so a block of IMURawBlock or
+	 * IMUSampleBlock axes can be filtered where it is.
+	 *
+	 * params: data, array of channels pointers to count values each
+	 * 		   count, number of samples
+	 * returns: uint16_t, number of samples put out
+	 */
+	uint16_t updateBlock(int16_t *const *data, uint16_t count);
+	uint16_t updateBlock(float *const *data, uint16_t count);
+};
+
+#endif /* SIMPLEIMU_FILTER_H */
@@ -0,0 +1,218 @@
+/*
+ *  Header for the orientation estimation of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#ifndef SIMPLEIMU_FUSION_H
+#define SIMPLEIMU_FUSION_H
+
+#include "SimpleIMU.h"
+
+/*
+ * Algorithms for the orientation estimation. Cost of one update with a
+ * valid accelerometer sample, in float operations:
+ *   IMU_FUSION_COMPLEMENTARY  45 multiplications, 28 additions, 2 inverse square roots
+ *   IMU_FUSION_MAHONY         47 multiplications, 27 additions, 2 inverse square roots,
+ *                             9 multiplications and 6 additions more with an integral gain
+ *   IMU_FUSION_MADGWICK       82 multiplications, 44 additions, 3 inverse square roots
+ * No trigonometric function is used in update. The fast inverse square
+ * root costs 5 multiplications and 3 additions. On a 16 MHz AVR a float
+ * multiplication or addition takes roughly 100 to 150 cycles, so a Mahony
+ * update takes about 0.75 ms and a Madgwick update about 1.3 ms.
+ */
+#define IMU_FUSION_COMPLEMENTARY 0
+#define IMU_FUSION_MAHONY 1
+#define IMU_FUSION_MADGWICK 2
+
+/* Use the bit level inverse square root approximation, default on AVR */
+#if !defined(IMU_FUSION_FAST_INVSQRT) && defined(__AVR__)
+#define IMU_FUSION_FAST_INVSQRT 1
+#endif
+
+class SimpleIMU_Fusion
+{
+private:
+	/* The algorithm used, one of IMU_FUSION_* */
+	uint8_t FUS_Algorithm;
+
+	/* The orientation quaternion, w, x, y, z */
+	float FUS_Q[4];
+
+	/* The weight of the gyroscope in the complementary filter */
+	float FUS_Alpha;
+
+	/* The proportional gain of the Mahony filter */
+	float FUS_Kp;
+
+	/* The integral gain of the Mahony filter */
+	float FUS_Ki;
+
+	/* The integral of the error in the Mahony filter, in rad/s */
+	float FUS_Integral[3];
+
+	/* The gradient descent step of the Madgwick filter */
+	float FUS_Beta;
+
+	/* The time of the last timestamped sample, valid after the first one */
+	uint32_t FUS_LastTime;
+	bool FUS_HasTime;
+
+	/*
+	 * Function to compute the inverse square root.
+	 *
+	 * params: x, the value
+	 * returns: float, 1 / sqrt(x)
+	 */
+	static float invSqrt(float x);
+
+	/*
+	 * Function to update the orientation with the complementary or Mahony filter.
+	 *
+	 * params: gx, gy, gz, angular rate in rad/s
+	 * 		   ax, ay, az, acceleration in any unit
+	 * 		   dt, time since the last update in seconds
+	 * returns: None
+	 */
+	void updateMahony(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+	/*
+	 * Function to update the orientation with the Madgwick filter.
+	 *
+	 * params: gx, gy, gz, angular rate in rad/s
+	 * 		   ax, ay, az, acceleration in any unit
+	 * 		   dt, time since the last update in seconds
+	 * returns: None
+	 */
+	void updateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_Fusion object.
+	 *
+	 * params: algorithm, the algorithm to use, one of IMU_FUSION_*
+	 * returns: SimpleIMU_Fusion object
+	 */
+	SimpleIMU_Fusion(uint8_t algorithm = IMU_FUSION_MAHONY);
+
+	/*
+	 * Function to select the algorithm. The orientation is kept.
+	 *
+	 * params: algorithm, the algorithm to use, one of IMU_FUSION_*
+	 * returns: None
+	 */
+	void setAlgorithm(uint8_t algorithm);
+
+	/*
+	 * Function to set the weight of the gyroscope in the complementary
+	 * filter. The accelerometer pulls the orientation by (1 - alpha) of
+	 * the error on every update.
+	 *
+	 * params: alpha, the weight of the gyroscope, 0 to 1. Default 0.98.
+	 * returns: None
+	 */
+	void setComplementaryAlpha(float alpha);
+
+	/*
+	 * Function to set the gains of the Mahony filter.
+	 *
+	 * params: kp, the proportional gain. Default 1.0.
+	 * 		   ki, the integral gain, which also estimates the gyroscope bias. Default 0.
+	 * returns: None
+	 */
+	void setMahonyGains(float kp, float ki);
+
+	/*
+	 * Function to set the gain of the Madgwick filter.
+	 *
+	 * params: beta, the gradient descent step in rad/s. Default 0.1.
+	 * returns: None
+	 */
+	void setMadgwickBeta(float beta);
+
+	/*
+	 * Function to reset the orientation to level and pointing along x.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void reset();
+
+	/*
+	 * Function to set the orientation from the gravity vector, so the
+	 * filter does not have to converge after start. The yaw is set to 0.
+	 *
+	 * params: accel, pointer to AccelData struct measured at rest
+	 * returns: None
+	 */
+	void initFromAccel(const AccelData *accel);
+
+	/*
+	 * Function to update the orientation with a new sample.
+	 *
+	 * params: accel, pointer to AccelData struct with the accelerometer data
+	 * 		   gyro, pointer to GyroData struct with the gyroscope data
+	 * 		   dt, time since the last update in seconds
+	 * returns: None
+	 */
+	void update(const AccelData *accel, const GyroData *gyro, float dt);
+
+	/*
+	 * Function to update the orientation with a new sample from readMotionFixed.
+	 *
+	 * params: accel, pointer to AccelDataFixed struct with the accelerometer data
+	 * 		   gyro, pointer to GyroDataFixed struct with the gyroscope data
+	 * 		   dt, time since the last update in seconds
+	 * returns: None
+	 */
+	void update(const AccelDataFixed *accel, const GyroDataFixed *gyro, float dt);
+
+	/*
+	 * Function to update the orientation with a sample from the FIFO or the ring buffer.
+	 *
+	 * params: sample, pointer to IMUSample struct
+	 * 		   dt, time since the last update in seconds
+	 * returns: None
+	 */
+	void update(const IMUSample *sample, float dt);
+
+	/*
+	 * Function to update the orientation with a sample from the FIFO or
+	 * the ring buffer, with the time since the last one taken from the
+	 * time of the samples. The first sample after reset only sets the time.
+	 *
+	 * params: sample, pointer to IMUSample struct
+	 * returns: bool, true if the orientation was updated
+	 */
+	bool update(const IMUSample *sample);
+
+	/*
+	 * Function to get the orientation quaternion.
+	 *
+	 * params: q, array of 4 floats to store w, x, y, z
+	 * returns: None
+	 */
+	void getQuaternion(float *q);
+
+	/*
+	 * Function to get the direction of gravity in the sensor frame. This
+	 * needs no trigonometric function.
+	 *
+	 * params: gravity, array of 3 floats to store the unit vector x, y, z
+	 * returns: None
+	 */
+	void getGravity(float *gravity);
+
+	/*
+	 * Function to get the orientation as Euler angles.
+	 *
+	 * params: roll, pitch, yaw, pointers to floats to store the angles in degrees
+	 * returns: None
+	 */
+	void getEuler(float *roll, float *pitch, float *yaw);
+};
+
+#endif /* SIMPLEIMU_FUSION_H */
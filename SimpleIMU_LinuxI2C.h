@@ -0,0 +1,120 @@
+/*
+ *  Header for the Linux i2c-dev bus access of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Every register read is one I2C_RDWR ioctl with the register address
+ *  write and the data read joined by a repeated start. Batched reads put up
+ *  to IMU_LINUX_I2C_MAX_READS of them in a single ioctl.
+ */
+
+#ifndef SIMPLEIMU_LINUX_I2C_H
+#define SIMPLEIMU_LINUX_I2C_H
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include "SimpleIMU_Transport.h"
+#include <linux/i2c.h>
+
+/* Largest read or write of data bytes, the kernel takes up to 8192 bytes per message */
+#define IMU_LINUX_I2C_MAX_TRANSFER 256
+
+/* Register reads in one ioctl, two messages each out of the 42 the kernel takes */
+#define IMU_LINUX_I2C_MAX_READS 21
+
+class SimpleIMU_LinuxI2C : public SimpleIMU_Transport
+{
+private:
+	/* The path of the bus device */
+	const char *I2C_Device;
+
+	/* The open bus device, -1 if closed */
+	int I2C_Fd;
+
+	/* Whether the device is closed by this object */
+	bool I2C_OwnsFd;
+
+	/* The number of ioctl calls made */
+	uint32_t I2C_Transfers;
+
+	/* The transaction timeout in microseconds */
+	uint32_t I2C_Timeout;
+
+	/*
+	 * Function to pass the timeout to the bus driver.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void applyTimeout();
+
+protected:
+	/*
+	 * Function to run messages as one combined transaction. Override to run
+	 * the transport without a bus.
+	 *
+	 * params: messages, the messages
+	 * 		   count, number of messages
+	 * returns: uint8_t, IMU_OK if all messages were acknowledged, the error otherwise
+	 */
+	virtual uint8_t transfer(struct i2c_msg *messages, uint8_t count);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_LinuxI2C object on a bus opened by begin.
+	 *
+	 * params: device, path of the bus, like "/dev/i2c-1"
+	 * returns: SimpleIMU_LinuxI2C object
+	 */
+	SimpleIMU_LinuxI2C(const char *device);
+
+	/*
+	 * Constructor for SimpleIMU_LinuxI2C object on a bus already open.
+	 * The file descriptor is not closed by the object.
+	 *
+	 * params: fd, the open bus device
+	 * returns: SimpleIMU_LinuxI2C object
+	 */
+	SimpleIMU_LinuxI2C(int fd);
+
+	~SimpleIMU_LinuxI2C();
+
+	bool begin();
+	uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count);
+	uint16_t getMaxTransfer();
+
+	/*
+	 * Function to set the transaction timeout, IMU_BUS_TIMEOUT by default.
+	 * The driver counts in steps of 10 ms, the timeout is rounded up. Stuck
+	 * buses are recovered by the bus driver where the controller supports it.
+	 *
+	 * params: timeout, the time in microseconds, 0 for the default of the driver
+	 * returns: None
+	 */
+	void setTimeout(uint32_t timeout);
+
+	/*
+	 * Function to get the number of ioctl calls made.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of calls
+	 */
+	uint32_t getTransferCount();
+
+	/*
+	 * Function to set the number of ioctl calls made to 0.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void resetTransferCount();
+};
+
+#endif
+
+#endif /* SIMPLEIMU_LINUX_I2C_H */
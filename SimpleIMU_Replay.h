@@ -0,0 +1,231 @@
+/*
+ *  Header for recording and replaying the bus traffic of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  SimpleIMU_Recorder sits between SimpleIMU and its bus and writes every
+ *  transaction to a file, SimpleIMU_Replay gives the recorded bytes back
+ *  in place of the bus. A program making the same calls as the one that
+ *  recorded reads the same bytes, so the whole processing chain can be run
+ *  again on captured motion, as fast as the host allows or at the pace of
+ *  the recording, and its results compared bit for bit. The reads of the
+ *  clock the samples are stamped with are recorded as well, so the samples
+ *  and the timing learned from them come out the same.
+ *
+ *  The file starts with the magic "SIMR", the version, a reserved byte
+ *  and the largest transfer of the bus as uint16_t. Each record is the
+ *  kind in the low nibble and the status in the high nibble of one byte,
+ *  the device address, the register, the micros from the end of the
+ *  previous record to the end of this one and the data length as varints,
+ *  then the data: the bytes read, the bytes written, or the uint32_t read
+ *  from the clock. Multi byte fields are little endian, varints are 7 bits
+ *  per byte, lowest first, the top bit set on all but the last byte.
+ *
+ *  The replay brings the clock of the host up to the time of each record
+ *  before giving it back. On the simulated clock of the host build that
+ *  takes no time, after hostSetRealTime(true) it keeps the pace of the
+ *  recording. The data ready interrupt is not raised, so the FIFO and the
+ *  burst reads are what can be replayed.
+ */
+
+#ifndef SIMPLEIMU_REPLAY_H
+#define SIMPLEIMU_REPLAY_H
+
+#if !defined(ARDUINO)
+
+#include "SimpleIMU_Transport.h"
+#include <stdio.h>
+
+/* Layout version of the recording, changed whenever the layout changes */
+#define IMU_RECORD_VERSION 2
+
+/* Bytes before the first record */
+#define IMU_RECORD_HEADER 8
+
+/* Kinds of record */
+#define IMU_RECORD_READ 1
+#define IMU_RECORD_WRITE 2
+#define IMU_RECORD_RECOVER 3
+#define IMU_RECORD_TIME 4
+
+class SimpleIMU_Recorder : public SimpleIMU_Transport
+{
+private:
+	/* The bus recorded */
+	SimpleIMU_Transport *REC_Bus;
+
+	/* The recording, NULL while closed */
+	FILE *REC_File;
+
+	/* The micros of the previous record */
+	uint32_t REC_Last;
+
+	/* The number of records written */
+	uint32_t REC_Records;
+
+	/*
+	 * Function to write one record.
+	 *
+	 * params: kind, one of IMU_RECORD_READ, IMU_RECORD_WRITE, IMU_RECORD_RECOVER, IMU_RECORD_TIME
+	 * 		   status, the status of the transaction
+	 * 		   address, 7 bit I2C address of the device
+	 * 		   reg, the first register
+	 * 		   data, the bytes read or written
+	 * 		   length, number of bytes
+	 * 		   time, micros when the transaction ended
+	 * returns: None
+	 */
+	void record(uint8_t kind, uint8_t status, uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length,
+				uint32_t time);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_Recorder object.
+	 *
+	 * params: bus, the bus the transactions are passed on to
+	 * returns: SimpleIMU_Recorder object
+	 */
+	SimpleIMU_Recorder(SimpleIMU_Transport *bus = &SimpleIMU_WireBus);
+
+	~SimpleIMU_Recorder();
+
+	/*
+	 * Function to start recording into a file, replacing it. Transactions
+	 * are passed on to the bus whether or not a file is open.
+	 *
+	 * params: path, the path of the file
+	 * returns: bool, true if the file was created
+	 */
+	bool open(const char *path);
+
+	/*
+	 * Function to stop recording and close the file.
+	 *
+	 * params: None
+	 * returns: bool, true if all records were written
+	 */
+	bool close();
+
+	/*
+	 * Function to get the number of records written.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of records
+	 */
+	uint32_t getRecordCount();
+
+	bool begin();
+	uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count);
+	uint16_t getMaxTransfer();
+	void setTimeout(uint32_t timeout);
+	bool recover();
+	uint32_t getTime();
+};
+
+class SimpleIMU_Replay : public SimpleIMU_Transport
+{
+private:
+	/* The recording, loaded whole */
+	uint8_t *RPL_Data;
+	size_t RPL_Size;
+
+	/* The offset of the next record */
+	size_t RPL_Position;
+
+	/* The largest transfer of the recorded bus */
+	uint16_t RPL_MaxTransfer;
+
+	/* The micros when the first record was replayed, and the recorded micros since it */
+	uint32_t RPL_Start;
+	uint32_t RPL_Elapsed;
+
+	/* The number of records replayed and of transactions that did not match the next record */
+	uint32_t RPL_Records;
+	uint32_t RPL_Mismatches;
+
+	/*
+	 * Function to take the next record if it is the transaction asked for,
+	 * once the clock has reached its time.
+	 *
+	 * params: kind, one of IMU_RECORD_READ, IMU_RECORD_WRITE, IMU_RECORD_RECOVER, IMU_RECORD_TIME
+	 * 		   address, 7 bit I2C address of the device
+	 * 		   reg, the first register
+	 * 		   length, number of bytes
+	 * 		   written, the bytes of a write to compare, NULL for the other kinds
+	 * 		   data, to store the pointer to the recorded bytes
+	 * returns: uint8_t, the recorded status, IMU_ERROR_DEVICE if the record
+	 * 				     does not match, IMU_ERROR_NACK after the last record
+	 */
+	uint8_t next(uint8_t kind, uint8_t address, uint8_t reg, uint16_t length, const uint8_t *written,
+				 const uint8_t **data);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_Replay object.
+	 *
+	 * params: None
+	 * returns: SimpleIMU_Replay object
+	 */
+	SimpleIMU_Replay();
+
+	~SimpleIMU_Replay();
+
+	/*
+	 * Function to load a recording and start from its first record.
+	 *
+	 * params: path, the path of the file
+	 * returns: bool, false if the file cannot be read or is not a recording of this version
+	 */
+	bool open(const char *path);
+
+	/*
+	 * Function to start again from the first record and clear the counters.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void rewind();
+
+	/*
+	 * Function to check whether all records were replayed.
+	 *
+	 * params: None
+	 * returns: bool, true after the last record
+	 */
+	bool isFinished();
+
+	/*
+	 * Function to get the number of records replayed.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of records
+	 */
+	uint32_t getRecordCount();
+
+	/*
+	 * Function to get the number of transactions that did not match the
+	 * next record. The record is kept, so a program that went a different
+	 * way keeps failing; any mismatch means the results differ.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of mismatches
+	 */
+	uint32_t getMismatchCount();
+
+	bool begin();
+	uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length);
+	using SimpleIMU_Transport::readRegisters;
+	uint16_t getMaxTransfer();
+	bool recover();
+	uint32_t getTime();
+};
+
+#endif
+
+#endif /* SIMPLEIMU_REPLAY_H */
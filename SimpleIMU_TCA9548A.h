@@ -0,0 +1,188 @@
+/*
+ *  Header for the TCA9548A I2C switch support of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Every channel of the switch is a transport for SimpleIMU objects. The
+ *  switch remembers the selected channel and only writes its control
+ *  register when a transfer goes to another channel. Devices on the bus
+ *  of the switch itself are given upstream() as transport, which turns
+ *  all channels off before their transfers, so a device on a channel
+ *  cannot answer in their place.
+ */
+
+#ifndef SIMPLEIMU_TCA9548A_H
+#define SIMPLEIMU_TCA9548A_H
+
+#include "SimpleIMU_Transport.h"
+
+/* Address of the switch with A0, A1 and A2 low */
+#define IMU_TCA9548A_ADDRESS 0x70
+
+/* Number of downstream channels */
+#define IMU_TCA9548A_CHANNELS 8
+
+class SimpleIMU_TCA9548A;
+
+/*
+ * Transport to the devices on one channel of a TCA9548A.
+ */
+class SimpleIMU_MuxChannel : public SimpleIMU_Transport
+{
+	friend class SimpleIMU_TCA9548A;
+
+private:
+	/* The switch */
+	SimpleIMU_TCA9548A *CHAN_Mux;
+
+	/* The channel, IMU_TCA9548A_CHANNELS for the bus of the switch */
+	uint8_t CHAN_Channel;
+
+	/*
+	 * Function to connect the channel, or to disconnect all for the bus of the switch.
+	 *
+	 * params: None
+	 * returns: uint8_t, IMU_OK or the error of the write
+	 */
+	uint8_t select();
+
+public:
+	SimpleIMU_MuxChannel();
+
+	bool begin();
+	uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count);
+	uint16_t getMaxTransfer();
+	void setTimeout(uint32_t timeout);
+	bool recover();
+	uint32_t getTime();
+
+	/*
+	 * Function to get the channel of the transport.
+	 *
+	 * params: None
+	 * returns: uint8_t, the channel from 0 to 7, IMU_TCA9548A_CHANNELS for the bus of the switch
+	 */
+	uint8_t getChannel();
+};
+
+class SimpleIMU_TCA9548A
+{
+	friend class SimpleIMU_MuxChannel;
+
+private:
+	/* The bus the switch is on */
+	SimpleIMU_Transport *MUX_Bus;
+
+	/* The address of the switch */
+	uint8_t MUX_Addr;
+
+	/* The control register as last written, 0xFF before the first write */
+	uint8_t MUX_Selected;
+
+	/* The number of writes to the control register */
+	uint32_t MUX_Selects;
+
+	/* The transports of the channels, then the one of the bus of the switch */
+	SimpleIMU_MuxChannel MUX_Channels[IMU_TCA9548A_CHANNELS + 1];
+
+	/*
+	 * Function to write the control register unless it already holds the value.
+	 *
+	 * params: control, one bit per channel
+	 * returns: uint8_t, IMU_OK or the error of the write
+	 */
+	uint8_t writeControl(uint8_t control);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_TCA9548A object.
+	 *
+	 * params: address, I2C address of the switch, 0x70 to 0x77
+	 * 		   bus, the bus the switch is on
+	 * returns: SimpleIMU_TCA9548A object
+	 */
+	SimpleIMU_TCA9548A(uint8_t address = IMU_TCA9548A_ADDRESS, SimpleIMU_Transport *bus = &SimpleIMU_WireBus);
+
+	/*
+	 * Function to start the bus and turn all channels off.
+	 *
+	 * params: None
+	 * returns: bool, true if the switch acknowledged
+	 */
+	bool begin();
+
+	/*
+	 * Function to get the transport of a channel, to be given to SimpleIMU.
+	 *
+	 * params: channel, the channel from 0 to 7
+	 * returns: SimpleIMU_Transport*, the transport, NULL for an invalid channel
+	 */
+	SimpleIMU_Transport *channel(uint8_t channel);
+
+	/*
+	 * Function to get the transport of the devices on the bus of the
+	 * switch, to be given to SimpleIMU. All channels are turned off before
+	 * its transfers, nothing is written while they already are.
+	 *
+	 * params: None
+	 * returns: SimpleIMU_Transport*, the transport
+	 */
+	SimpleIMU_Transport *upstream();
+
+	/*
+	 * Function to connect a channel to the bus. Nothing is written when the
+	 * channel is already the only one selected.
+	 *
+	 * params: channel, the channel from 0 to 7
+	 * returns: bool, true if the channel is selected
+	 */
+	bool select(uint8_t channel);
+
+	/*
+	 * Function to disconnect all channels.
+	 *
+	 * params: None
+	 * returns: bool, true if the switch acknowledged
+	 */
+	bool disable();
+
+	/*
+	 * Function to free a hung bus. The switch may have been reset with it,
+	 * so the control register is written again on the next select.
+	 *
+	 * params: None
+	 * returns: bool, true if the bus is free again
+	 */
+	bool recover();
+
+	/*
+	 * Function to get the bus the switch is on.
+	 *
+	 * params: None
+	 * returns: SimpleIMU_Transport*, the bus
+	 */
+	SimpleIMU_Transport *getBus();
+
+	/*
+	 * Function to get the number of writes to the control register.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of writes
+	 */
+	uint32_t getSelectCount();
+
+	/*
+	 * Function to set the number of writes to the control register to 0.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void resetSelectCount();
+};
+
+#endif /* SIMPLEIMU_TCA9548A_H */
@@ -0,0 +1,278 @@
+/*
+ *  Header for the binary telemetry frames of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  A telemetry frame carries a run of raw samples over a byte stream such
+ *  as Serial, in place of printing them as text. All fields are little
+ *  endian:
+ *
+ *    0   2  sync, 0xA5 0x5A
+ *    2   1  version in the high nibble, encoding in the low nibble
+ *    3   1  channels, combination of IMU_TELEMETRY_ACCEL_X ... IMU_TELEMETRY_GYRO_Z
+ *    4   1  count, number of samples
+ *    5   2  length, number of payload bytes
+ *    7   2  sequence number of the first sample, counting samples and wrapping
+ *    9   4  micros when the IMU took the first sample
+ *   13   4  micros between two samples, in 1/256 us
+ *   17      payload, each channel in turn with its count values
+ *    +   2  CRC-16 of the bytes from the version to the end of the payload
+ *
+ *  The payload holds the counts as int16_t (IMU_TELEMETRY_RAW), as zigzag
+ *  varints (IMU_TELEMETRY_VARINT), or as the first count and the zigzag
+ *  varint differences of the following ones (IMU_TELEMETRY_DELTA). A
+ *  varint is 7 bits per byte, lowest first, the top bit set on all but
+ *  the last byte. Zigzag maps 0, -1, 1, -2 ... to 0, 1, 2, 3 ... so small
+ *  values of either sign take one byte.
+ *
+ *  At 1 kHz the six motion channels take 12 bytes per sample raw, more
+ *  than the 11520 bytes per second of 115200 baud. The differences of a
+ *  still or slowly moving IMU mostly fit one or two bytes, so delta
+ *  frames of 16 samples take 8 to 10 bytes per sample with the header.
+ */
+
+#ifndef SIMPLEIMU_TELEMETRY_H
+#define SIMPLEIMU_TELEMETRY_H
+
+#include "SimpleIMU.h"
+
+/* Channels of a frame, in the order of IMURawSample, combine with | */
+#define IMU_TELEMETRY_ACCEL_X 0x01
+#define IMU_TELEMETRY_ACCEL_Y 0x02
+#define IMU_TELEMETRY_ACCEL_Z 0x04
+#define IMU_TELEMETRY_TEMP 0x08
+#define IMU_TELEMETRY_GYRO_X 0x10
+#define IMU_TELEMETRY_GYRO_Y 0x20
+#define IMU_TELEMETRY_GYRO_Z 0x40
+#define IMU_TELEMETRY_ACCEL (IMU_TELEMETRY_ACCEL_X | IMU_TELEMETRY_ACCEL_Y | IMU_TELEMETRY_ACCEL_Z)
+#define IMU_TELEMETRY_GYRO (IMU_TELEMETRY_GYRO_X | IMU_TELEMETRY_GYRO_Y | IMU_TELEMETRY_GYRO_Z)
+#define IMU_TELEMETRY_MOTION (IMU_TELEMETRY_ACCEL | IMU_TELEMETRY_GYRO)
+#define IMU_TELEMETRY_ALL (IMU_TELEMETRY_MOTION | IMU_TELEMETRY_TEMP)
+
+/* Payload encodings */
+#define IMU_TELEMETRY_RAW 0
+#define IMU_TELEMETRY_VARINT 1
+#define IMU_TELEMETRY_DELTA 2
+
+/* Frame layout version, changed whenever the layout changes */
+#define IMU_TELEMETRY_VERSION 1
+
+/* The two bytes starting every frame */
+#define IMU_TELEMETRY_SYNC0 0xA5
+#define IMU_TELEMETRY_SYNC1 0x5A
+
+/* Bytes before the payload */
+#define IMU_TELEMETRY_HEADER 17
+
+/* Most samples in one frame, this sets the buffer of the decoder */
+#ifndef IMU_TELEMETRY_MAX_SAMPLES
+#define IMU_TELEMETRY_MAX_SAMPLES 32
+#endif
+
+/* Largest frame of samples with channels channels, a varint takes at most 3 bytes */
+#define IMU_TELEMETRY_FRAME_SIZE(samples, channels) (IMU_TELEMETRY_HEADER + (samples) * (channels) * 3 + 2)
+#define IMU_TELEMETRY_MAX_FRAME IMU_TELEMETRY_FRAME_SIZE(IMU_TELEMETRY_MAX_SAMPLES, 7)
+
+/* Counters of a decoder */
+typedef struct
+{
+	uint32_t frames;	/* frames with a good CRC */
+	uint32_t samples;	/* samples in those frames */
+	uint32_t lost;		/* samples missing from the sequence numbers */
+	uint32_t crcErrors; /* frames dropped for a bad CRC or a bad header */
+	uint32_t skipped;	/* bytes dropped while looking for a frame */
+} IMUTelemetryStats;
+
+class SimpleIMU_Telemetry
+{
+private:
+	/* The payload encoding, one of IMU_TELEMETRY_RAW, IMU_TELEMETRY_VARINT, IMU_TELEMETRY_DELTA */
+	uint8_t TLM_Encoding;
+
+	/* The channels sent */
+	uint8_t TLM_Channels;
+
+	/* The sequence number of the next sample */
+	uint16_t TLM_Sequence;
+
+	/*
+	 * Function to encode a frame from one int16_t pointer per channel.
+	 *
+	 * params: channels, array of 7 pointers to the first value of each channel in
+	 * 				     IMURawSample order, the channels with a NULL pointer are left out
+	 * 		   stride, values from one sample to the next
+	 * 		   count, number of samples
+	 * 		   time, micros of the first sample
+	 * 		   period, micros between two samples
+	 * 		   frame, buffer for the frame
+	 * 		   size, size of the buffer
+	 * returns: uint16_t, length of the frame, 0 if it does not fit
+	 */
+	uint16_t encodeFrame(const int16_t *const *channels, uint8_t stride, uint8_t count, uint32_t time, float period,
+						 uint8_t *frame, uint16_t size);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_Telemetry object, the encoder of the frames.
+	 *
+	 * params: encoding, IMU_TELEMETRY_RAW, IMU_TELEMETRY_VARINT or IMU_TELEMETRY_DELTA
+	 * 		   channels, the channels to send, IMU_TELEMETRY_MOTION by default
+	 * returns: SimpleIMU_Telemetry object
+	 */
+	SimpleIMU_Telemetry(uint8_t encoding = IMU_TELEMETRY_DELTA, uint8_t channels = IMU_TELEMETRY_MOTION);
+
+	/*
+	 * Function to set the payload encoding of the next frames.
+	 *
+	 * params: encoding, IMU_TELEMETRY_RAW, IMU_TELEMETRY_VARINT or IMU_TELEMETRY_DELTA
+	 * returns: bool, false if the encoding is unknown
+	 */
+	bool setEncoding(uint8_t encoding);
+
+	/*
+	 * Function to set the channels of the next frames.
+	 *
+	 * params: channels, combination of IMU_TELEMETRY_ACCEL_X ... IMU_TELEMETRY_GYRO_Z
+	 * returns: bool, false if no channel or an unknown one is given
+	 */
+	bool setChannels(uint8_t channels);
+
+	/*
+	 * Function to get the sequence number the next frame starts with.
+	 *
+	 * params: None
+	 * returns: uint16_t, the sequence number
+	 */
+	uint16_t getSequence();
+
+	/*
+	 * Function to encode the samples of a block into one frame, to be
+	 * written with Serial.write(frame, length). The channels whose array
+	 * is NULL in the block are left out of the frame.
+	 *
+	 * params: block, pointer to the IMURawBlock, 1 to IMU_TELEMETRY_MAX_SAMPLES samples
+	 * 		   frame, buffer for the frame, IMU_TELEMETRY_FRAME_SIZE(count, channels)
+	 * 				  bytes always suffice
+	 * 		   size, size of the buffer
+	 * returns: uint16_t, length of the frame, 0 if the count is out of range or it does not fit
+	 */
+	uint16_t encode(const IMURawBlock *block, uint8_t *frame, uint16_t size);
+
+	/*
+	 * Function to encode an array of raw samples into one frame, as read
+	 * with readMotionRaw.
+	 *
+	 * params: samples, array of count IMURawSample
+	 * 		   count, number of samples, 1 to IMU_TELEMETRY_MAX_SAMPLES
+	 * 		   time, micros when the IMU took the first sample
+	 * 		   period, micros between two samples
+	 * 		   frame, buffer for the frame
+	 * 		   size, size of the buffer
+	 * returns: uint16_t, length of the frame, 0 if the count is out of range or it does not fit
+	 */
+	uint16_t encode(const IMURawSample *samples, uint8_t count, uint32_t time, float period, uint8_t *frame,
+					uint16_t size);
+};
+
+class SimpleIMU_TelemetryDecoder
+{
+private:
+	/* The bytes received, a frame starts at the beginning once synchronized */
+	uint8_t TLM_Buffer[IMU_TELEMETRY_MAX_FRAME];
+
+	/* The number of bytes in the buffer */
+	uint16_t TLM_Length;
+
+	/* The length of the checked frame at the start of the buffer, 0 if there is none */
+	uint16_t TLM_Frame;
+
+	/* The sequence number expected for the next frame, and whether one was received yet */
+	uint16_t TLM_Expected;
+	bool TLM_Started;
+
+	/* The counters */
+	IMUTelemetryStats TLM_Stats;
+
+	/*
+	 * Function to drop bytes from the start of the buffer.
+	 *
+	 * params: count, number of bytes
+	 * returns: None
+	 */
+	void drop(uint16_t count);
+
+	/*
+	 * Function to look for a frame at the start of the buffer, dropping
+	 * the bytes that cannot start one.
+	 *
+	 * params: None
+	 * returns: bool, true if a checked frame is at the start
+	 */
+	bool parse();
+
+public:
+	/*
+	 * Constructor for SimpleIMU_TelemetryDecoder object.
+	 *
+	 * params: None
+	 * returns: SimpleIMU_TelemetryDecoder object
+	 */
+	SimpleIMU_TelemetryDecoder();
+
+	/*
+	 * Function to add one received byte. Bytes that are not part of a
+	 * frame with a good CRC are skipped, so the decoder finds the next
+	 * frame after a lost or corrupted byte by itself.
+	 *
+	 * params: byte, the byte
+	 * returns: bool, true if a frame was completed, it can be read until the next call
+	 */
+	bool push(uint8_t byte);
+
+	/*
+	 * Function to get the channels of the completed frame.
+	 *
+	 * params: None
+	 * returns: uint8_t, combination of IMU_TELEMETRY_ACCEL_X ... IMU_TELEMETRY_GYRO_Z, 0 if there is no frame
+	 */
+	uint8_t getChannels();
+
+	/*
+	 * Function to get the sequence number of the first sample of the completed frame.
+	 *
+	 * params: None
+	 * returns: uint16_t, the sequence number
+	 */
+	uint16_t getSequence();
+
+	/*
+	 * Function to decode the completed frame into a block. The block is
+	 * filled from the start, the arrays of the channels missing from the
+	 * frame are left unchanged.
+	 *
+	 * params: block, pointer to the IMURawBlock to store the samples
+	 * returns: bool, false if there is no frame, the block is too small or the payload is malformed
+	 */
+	bool read(IMURawBlock *block);
+
+	/*
+	 * Function to get the counters of the decoder.
+	 *
+	 * params: stats, pointer to the IMUTelemetryStats struct to store the counters
+	 * returns: None
+	 */
+	void getStats(IMUTelemetryStats *stats);
+
+	/*
+	 * Function to clear the counters of the decoder.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void resetStats();
+};
+
+#endif /* SIMPLEIMU_TELEMETRY_H */
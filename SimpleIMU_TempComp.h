@@ -0,0 +1,183 @@
+/*
+ *  Header for the temperature compensation of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  The gyroscope bias is learned per temperature bin whenever the IMU is at
+ *  rest and the offsets of the IMU follow the temperature by interpolation
+ *  between the learned bins. The samples are the ones the sketch reads
+ *  anyway, the temperature comes free in the 14 byte burst of readMotion.
+ */
+
+#ifndef SIMPLEIMU_TEMPCOMP_H
+#define SIMPLEIMU_TEMPCOMP_H
+
+#include "SimpleIMU.h"
+
+/* Number of temperature bins of the table */
+#ifndef IMU_TEMPCOMP_BINS
+#define IMU_TEMPCOMP_BINS 16
+#endif
+
+/* Number of windows after which a bin follows new windows with a fixed weight */
+#define IMU_TEMPCOMP_MAX_WEIGHT 32
+
+/* Layout version of IMUTempTable, changed whenever the fields change */
+#define IMU_TEMPCOMP_VERSION 1
+
+/* Learned bias table that can be stored and loaded on the next start */
+typedef struct
+{
+	uint8_t version;
+	int8_t minTemp;							 /* centre of bin 0 in degree Celsius */
+	uint8_t binWidth;						 /* degree Celsius between two bins */
+	uint8_t reserved;
+	int16_t bias[IMU_TEMPCOMP_BINS][3];		 /* gyroscope bias in thousandths of deg/s */
+	uint8_t weight[IMU_TEMPCOMP_BINS];		 /* windows learned, 0 for an empty bin */
+	uint16_t crc;							 /* CRC-16 of all the fields above */
+} IMUTempTable;
+
+class SimpleIMU_TempComp
+{
+private:
+	/* The IMU being compensated */
+	SimpleIMU *CMP_IMU;
+
+	/* The learned table */
+	IMUTempTable CMP_Table;
+
+	/* The number of samples in one window */
+	uint8_t CMP_WindowSize;
+
+	/* The largest variance of a window at rest, in (deg/s)^2 and (m/s^2)^2 */
+	float CMP_MaxVariance[2];
+
+	/* The largest mean rate of a window at rest after compensation, in deg/s */
+	float CMP_MaxDrift;
+
+	/* The number of samples in the current window */
+	uint8_t CMP_WindowCount;
+
+	/* The running mean of the current window, gyro x, y, z, accel x, y, z, temperature */
+	float CMP_WindowMean[7];
+
+	/* The running sum of squared differences of the current window */
+	float CMP_WindowM2[6];
+
+	/* The number of windows accepted and rejected */
+	uint16_t CMP_Accepted;
+	uint16_t CMP_Rejected;
+
+	/*
+	 * Function to learn the current window if the IMU was at rest, then
+	 * move the offsets of the IMU to the current temperature.
+	 *
+	 * params: None
+	 * returns: bool, true if the offsets were changed
+	 */
+	bool closeWindow();
+
+	/*
+	 * Function to find the bin a temperature belongs to.
+	 *
+	 * params: temp, the temperature in degree Celsius
+	 * returns: int, the bin, -1 if outside the table
+	 */
+	int findBin(float temp);
+
+public:
+	/*
+	 * Constructor for SimpleIMU_TempComp object.
+	 *
+	 * params: imu, pointer to the SimpleIMU object to compensate
+	 * returns: SimpleIMU_TempComp object
+	 */
+	SimpleIMU_TempComp(SimpleIMU *imu);
+
+	/*
+	 * Function to start with an empty table. Bin i is centred at
+	 * minTemp + i * binWidth degree Celsius. A steady rotation has no
+	 * variance, so a window is only taken as rest if its mean rate is also
+	 * close to the current offsets. Start from calibGyro or a stored
+	 * calibration so the first windows pass.
+	 *
+	 * params: minTemp, centre of the first bin in degree Celsius
+	 * 		   binWidth, degree Celsius between two bins
+	 * 		   window, number of samples in one window
+	 * 		   maxGyroNoise, largest standard deviation of the gyroscope at rest in deg/s
+	 * 		   maxAccelNoise, largest standard deviation of the accelerometer at rest in m/s^2
+	 * 		   maxDrift, largest mean rate of any axis at rest in deg/s
+	 * returns: None
+	 */
+	void begin(int8_t minTemp = -10, uint8_t binWidth = 5, uint8_t window = 50, float maxGyroNoise = 0.5,
+			   float maxAccelNoise = 0.2, float maxDrift = 1.0);
+
+	/*
+	 * Function to feed one sample as returned by readMotion. At the end of
+	 * every window the bias is learned if the IMU was at rest, and the
+	 * gyroscope offsets of the IMU are set by linear interpolation between
+	 * the learned bins around the current temperature. Between windows the
+	 * cost is a running mean and variance, the read path is unchanged.
+	 *
+	 * params: accel, pointer to the AccelData of the sample
+	 * 		   gyro, pointer to the GyroData of the sample
+	 * 		   temp, the temperature of the sample in degree Celsius
+	 * returns: bool, true if the offsets of the IMU were changed
+	 */
+	bool update(const AccelData *accel, const GyroData *gyro, float temp);
+
+	/*
+	 * Function to get the bias at a temperature, interpolated between the
+	 * learned bins and held constant beyond the outermost ones.
+	 *
+	 * params: temp, the temperature in degree Celsius
+	 * 		   bias, pointer to GyroData struct to store the bias in deg/s
+	 * returns: bool, false if no bin has been learned yet
+	 */
+	bool getBias(float temp, GyroData *bias);
+
+	/*
+	 * Function to get the number of bins learned so far.
+	 *
+	 * params: None
+	 * returns: uint8_t, number of bins with at least one window
+	 */
+	uint8_t getLearnedBins();
+
+	/*
+	 * Function to get the number of windows learned.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of windows at rest
+	 */
+	uint16_t getAcceptedWindows();
+
+	/*
+	 * Function to get the number of windows rejected because of motion.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of rejected windows
+	 */
+	uint16_t getRejectedWindows();
+
+	/*
+	 * Function to export the learned table, to be stored.
+	 *
+	 * params: table, pointer to IMUTempTable struct to store the table
+	 * returns: None
+	 */
+	void getTable(IMUTempTable *table);
+
+	/*
+	 * Function to load a stored table. Learning continues from it.
+	 *
+	 * params: table, pointer to the IMUTempTable struct
+	 * returns: bool, false if the version or CRC do not match
+	 */
+	bool setTable(const IMUTempTable *table);
+};
+
+#endif /* SIMPLEIMU_TEMPCOMP_H */
@@ -0,0 +1,219 @@
+/*
+ *  Header for the bus access of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#ifndef SIMPLEIMU_TRANSPORT_H
+#define SIMPLEIMU_TRANSPORT_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/* Number of bytes that can be received in one Wire transaction */
+#if defined(BUFFER_LENGTH)
+#define IMU_WIRE_BUFFER_LENGTH BUFFER_LENGTH
+#elif defined(I2C_BUFFER_LENGTH)
+#define IMU_WIRE_BUFFER_LENGTH I2C_BUFFER_LENGTH
+#else
+#define IMU_WIRE_BUFFER_LENGTH 32
+#endif
+
+/* Time a transaction may take before the bus is given up, in microseconds */
+#define IMU_BUS_TIMEOUT 25000
+
+/* SDA and SCL pins of Wire for bus recovery, 0xFF where the core does not name them */
+#if defined(PIN_WIRE_SDA) && defined(PIN_WIRE_SCL)
+#define IMU_WIRE_SDA PIN_WIRE_SDA
+#define IMU_WIRE_SCL PIN_WIRE_SCL
+#else
+#define IMU_WIRE_SDA 0xFF
+#define IMU_WIRE_SCL 0xFF
+#endif
+
+/* Status of a transaction or of a SimpleIMU function */
+#define IMU_OK 0
+#define IMU_ERROR_NACK 1	   /* the device did not acknowledge */
+#define IMU_ERROR_SHORT_READ 2 /* the device sent fewer bytes than requested */
+#define IMU_ERROR_TIMEOUT 3	   /* the transaction did not finish in time, the bus may be hung */
+#define IMU_ERROR_BUS 4		   /* arbitration lost, bus error or a transfer too long */
+#define IMU_ERROR_DEVICE 5	   /* the device answering is not an MPU6050 */
+#define IMU_ERROR_ARGUMENT 6   /* a parameter is out of range, nothing was written */
+
+/* One read of consecutive registers in a batch */
+typedef struct
+{
+	uint8_t reg;
+	uint8_t *buffer;
+	uint16_t length;
+} IMURegisterRead;
+
+/*
+ * Register access to a device on a bus. A register read is a write of the
+ * register address followed by a read with a repeated start.
+ */
+class SimpleIMU_Transport
+{
+public:
+	virtual ~SimpleIMU_Transport() {}
+
+	/*
+	 * Function to prepare the bus.
+	 *
+	 * params: None
+	 * returns: bool, true if the bus can be used
+	 */
+	virtual bool begin();
+
+	/*
+	 * Function to write consecutive registers.
+	 *
+	 * params: address, 7 bit I2C address of the device
+	 * 		   reg, the first register
+	 * 		   data, the values to be written
+	 * 		   length, number of registers, at most getMaxTransfer() - 1
+	 * returns: uint8_t, IMU_OK or the error
+	 */
+	virtual uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length) = 0;
+
+	/*
+	 * Function to read consecutive registers.
+	 *
+	 * params: address, 7 bit I2C address of the device
+	 * 		   reg, the first register
+	 * 		   data, array to store the values
+	 * 		   length, number of registers, at most getMaxTransfer()
+	 * returns: uint8_t, IMU_OK if all bytes were read, the error otherwise
+	 */
+	virtual uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length) = 0;
+
+	/*
+	 * Function to do several register reads. Buses that can queue transfers
+	 * do them together, otherwise they are done one after the other.
+	 *
+	 * params: address, 7 bit I2C address of the device
+	 * 		   reads, the reads
+	 * 		   count, number of reads
+	 * returns: uint8_t, IMU_OK if all reads succeeded, the first error otherwise
+	 */
+	virtual uint8_t readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count);
+
+	/*
+	 * Function to get the largest number of bytes in one transfer.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of bytes
+	 */
+	virtual uint16_t getMaxTransfer() = 0;
+
+	/*
+	 * Function to set how long a transaction may take before it fails with
+	 * IMU_ERROR_TIMEOUT. Buses without a timeout ignore it.
+	 *
+	 * params: timeout, the time in microseconds, 0 to wait forever
+	 * returns: None
+	 */
+	virtual void setTimeout(uint32_t timeout);
+
+	/*
+	 * Function to free a bus held by a device that was interrupted in the
+	 * middle of a transfer. Buses that cannot do it return false.
+	 *
+	 * params: None
+	 * returns: bool, true if the bus is free again
+	 */
+	virtual bool recover();
+
+	/*
+	 * Function to read the clock the samples are stamped with, micros by
+	 * default. A bus that is recorded or replayed gives the recorded clock.
+	 *
+	 * params: None
+	 * returns: uint32_t, the time in microseconds
+	 */
+	virtual uint32_t getTime();
+};
+
+/*
+ * Transport over an Arduino TwoWire bus, the default of SimpleIMU.
+ */
+class SimpleIMU_WireTransport : public SimpleIMU_Transport
+{
+private:
+	/* The bus */
+	TwoWire *TRANSPORT_Wire;
+
+	/* Whether the bus was started, it is started once for all devices */
+	bool TRANSPORT_Started;
+
+	/* The transaction timeout in microseconds */
+	uint32_t TRANSPORT_Timeout;
+
+	/* The bus clock in Hz set through the transport, 0 for the default of Wire */
+	uint32_t TRANSPORT_Clock;
+
+	/* The pins of the bus, 0xFF if unknown */
+	uint8_t TRANSPORT_SDA;
+	uint8_t TRANSPORT_SCL;
+
+	/*
+	 * Function to pass the timeout to the Wire library of the core.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void applyTimeout();
+
+public:
+	/*
+	 * Constructor for SimpleIMU_WireTransport object. The pins are only
+	 * used by recover, give them on cores that do not name them.
+	 *
+	 * params: wire, the bus
+	 * 		   sda, the SDA pin of the bus
+	 * 		   scl, the SCL pin of the bus
+	 * returns: SimpleIMU_WireTransport object
+	 */
+	SimpleIMU_WireTransport(TwoWire *wire = &Wire, uint8_t sda = IMU_WIRE_SDA, uint8_t scl = IMU_WIRE_SCL);
+
+	bool begin();
+	uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length);
+	uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length);
+	using SimpleIMU_Transport::readRegisters;
+	uint16_t getMaxTransfer();
+
+	/*
+	 * Function to set the transaction timeout, IMU_BUS_TIMEOUT by default.
+	 * Cores without a Wire timeout wait as long as their Wire library does.
+	 *
+	 * params: timeout, the time in microseconds, 0 to wait forever
+	 * returns: None
+	 */
+	void setTimeout(uint32_t timeout);
+
+	/*
+	 * Function to set the bus clock. Wire starts at its default clock after
+	 * a recovery, a clock set here is set again.
+	 *
+	 * params: clock, the clock in Hz
+	 * returns: None
+	 */
+	void setClock(uint32_t clock);
+
+	/*
+	 * Function to free the bus by clocking SCL until the device holding
+	 * SDA has sent out its byte, then sending a stop and starting Wire again.
+	 *
+	 * params: None
+	 * returns: bool, true if SDA and SCL are both high afterwards
+	 */
+	bool recover();
+};
+
+/* The transport over Wire used by SimpleIMU objects without a transport */
+extern SimpleIMU_WireTransport SimpleIMU_WireBus;
+
+#endif /* SIMPLEIMU_TRANSPORT_H */
@@ -0,0 +1,70 @@
+#include <SimpleIMU.h>
+
+// An HMC5883L on the auxiliary bus (XDA/XCL) of the MPU6050
+#define HMC5883L_ADDRESS 0x1E
+
+SimpleIMU mpu(0x68);
+
+void setup()
+{
+	Serial.begin(115200);
+
+	// Initialize the MPU6050, sampling at 1 kHz / (1 + 9) = 100 Hz
+	while (!mpu.init())
+	{
+		Serial.println("MPU initialization failed. Please check your wiring.");
+		delay(1000);
+	}
+	mpu.setSampleRateDivider(9);
+	Serial.println("MPU initialized successfully!");
+
+	// Start the auxiliary I2C master and set up the magnetometer once
+	mpu.beginAuxMaster();
+	uint8_t id;
+	while (!mpu.readAux(HMC5883L_ADDRESS, 0x0A, &id) || id != 'H')
+	{
+		Serial.println("HMC5883L not found. Please check your wiring.");
+		delay(1000);
+	}
+	mpu.writeAux(HMC5883L_ADDRESS, 0x00, 0x18); // 75 Hz output rate
+	mpu.writeAux(HMC5883L_ADDRESS, 0x02, 0x00); // Continuous measurement
+
+	// Let the MPU read the 6 data bytes with every sample
+	mpu.addAuxRead(0, HMC5883L_ADDRESS, 0x03, 6);
+}
+
+void loop()
+{
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	uint8_t aux[IMU_AUX_DATA_SIZE];
+
+	// Accelerometer, gyroscope and magnetometer in one burst
+	mpu.readMotionAux(&accel, &gyro, &temp, aux);
+
+	// Magnetometer data is big endian in X, Z, Y order, 1090 counts per gauss
+	int16_t mx = (int16_t)(aux[0] << 8 | aux[1]);
+	int16_t mz = (int16_t)(aux[2] << 8 | aux[3]);
+	int16_t my = (int16_t)(aux[4] << 8 | aux[5]);
+
+	Serial.print(accel.x);
+	Serial.print(" ");
+	Serial.print(accel.y);
+	Serial.print(" ");
+	Serial.print(accel.z);
+	Serial.print(" | ");
+	Serial.print(gyro.x);
+	Serial.print(" ");
+	Serial.print(gyro.y);
+	Serial.print(" ");
+	Serial.print(gyro.z);
+	Serial.print(" | ");
+	Serial.print(mx / 1090.0);
+	Serial.print(" ");
+	Serial.print(my / 1090.0);
+	Serial.print(" ");
+	Serial.println(mz / 1090.0);
+
+	delay(10);
+}
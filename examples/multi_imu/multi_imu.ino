@@ -0,0 +1,53 @@
+#include <SimpleIMU.h>
+#include <SimpleIMU_Array.h>
+#include <SimpleIMU_TCA9548A.h>
+
+// A TCA9548A at 0x70 with two MPU6050s on channel 0 (AD0 low and high)
+// and one on channel 1
+SimpleIMU_TCA9548A mux(0x70);
+SimpleIMU imu0(0x68, mux.channel(0));
+SimpleIMU imu1(0x69, mux.channel(0));
+SimpleIMU imu2(0x68, mux.channel(1));
+SimpleIMU_Array imus;
+
+void setup()
+{
+	Serial.begin(115200);
+
+	// Add the MPUs, the array reads them with as few channel switches as possible
+	imus.add(&imu0);
+	imus.add(&imu1);
+	imus.add(&imu2);
+
+	// Initialize the switch and the MPUs, all sampling at 1 kHz / (1 + 9) = 100 Hz
+	mux.begin();
+	Wire.setClock(400000);
+	while (!imus.begin(9, 1))
+	{
+		Serial.println("MPU initialization failed. Please check your wiring.");
+		delay(1000);
+	}
+	Serial.println("MPUs initialized successfully!");
+}
+
+void loop()
+{
+	IMUSampleSet set;
+
+	// Read one sample of every MPU at the output data rate
+	if (!imus.poll(&set))
+		return;
+
+	// Print the time of the set and the accelerometer of every MPU
+	Serial.print(set.timestamp);
+	for (uint8_t i = 0; i < set.count; i++)
+	{
+		Serial.print(" | ");
+		Serial.print(set.sample[i].accel.x);
+		Serial.print(" ");
+		Serial.print(set.sample[i].accel.y);
+		Serial.print(" ");
+		Serial.print(set.sample[i].accel.z);
+	}
+	Serial.println();
+}
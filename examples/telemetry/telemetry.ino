@@ -0,0 +1,41 @@
+#include <SimpleIMU.h>
+#include <SimpleIMU_Telemetry.h>
+
+// Samples per frame, the header and CRC take 19 bytes per frame
+#define BLOCK_SIZE 16
+
+SimpleIMU mpu(0x68);
+SimpleIMU_Telemetry telemetry(IMU_TELEMETRY_DELTA, IMU_TELEMETRY_MOTION);
+
+int16_t raw[6][BLOCK_SIZE];
+IMURawBlock block = {{raw[0], raw[1], raw[2]}, {raw[3], raw[4], raw[5]}, NULL, BLOCK_SIZE, 0};
+uint8_t frame[IMU_TELEMETRY_FRAME_SIZE(BLOCK_SIZE, 6)];
+
+void setup()
+{
+	Serial.begin(115200);
+
+	// Initialize the MPU6050, streaming at 1 kHz
+	while (!mpu.init())
+	{
+		Serial.println("MPU initialization failed. Please check your wiring.");
+		delay(1000);
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(0);
+	mpu.beginFIFO(IMU_FIFO_ACCEL | IMU_FIFO_GYRO);
+
+	// From here on only frames are written, decode them on the PC with
+	// imu_decode /dev/ttyUSB0 motion.csv
+}
+
+void loop()
+{
+	// Send the FIFO in frames of up to 16 samples, about 9 bytes per sample
+	// for a handheld IMU, so the whole 1 kHz stream fits 115200 baud
+	block.count = 0;
+	if (mpu.readFIFOBlock(&block) <= 0)
+		return;
+	uint16_t length = telemetry.encode(&block, frame, sizeof(frame));
+	Serial.write(frame, length);
+}
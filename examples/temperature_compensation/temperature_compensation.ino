@@ -0,0 +1,54 @@
+#include <SimpleIMU.h>
+#include <SimpleIMU_TempComp.h>
+
+SimpleIMU mpu(0x68);
+SimpleIMU_TempComp comp(&mpu);
+
+void setup()
+{
+	Serial.begin(115200);
+
+	// Initialize the MPU6050, sampling at 1 kHz / (1 + 9) = 100 Hz
+	while (!mpu.init())
+	{
+		Serial.println("MPU initialization failed. Please check your wiring.");
+		delay(1000);
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(9);
+	Serial.println("MPU initialized successfully!");
+
+	// Calibrate once at rest, the table takes over as the temperature changes
+	mpu.calibGyro();
+
+	// Bins every 5 degrees from -10 degrees, half a second per window
+	comp.begin(-10, 5, 50);
+}
+
+void loop()
+{
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+
+	// The temperature comes with the motion data in one burst
+	mpu.readMotion(&accel, &gyro, &temp);
+
+	// Learn the bias whenever the MPU rests, the offsets follow the temperature
+	if (comp.update(&accel, &gyro, temp))
+	{
+		Serial.print("Offsets updated at ");
+		Serial.print(temp);
+		Serial.print(" C, ");
+		Serial.print(comp.getLearnedBins());
+		Serial.println(" bins learned");
+	}
+
+	Serial.print(gyro.x);
+	Serial.print(" ");
+	Serial.print(gyro.y);
+	Serial.print(" ");
+	Serial.println(gyro.z);
+
+	delay(10);
+}
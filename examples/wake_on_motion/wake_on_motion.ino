@@ -0,0 +1,67 @@
+#include <SimpleIMU.h>
+
+// INT of the MPU6050 on an interrupt capable pin
+#define INT_PIN 2
+
+SimpleIMU mpu(0x68);
+IMUSample samples[16];
+
+void setup()
+{
+	Serial.begin(115200);
+
+	// Initialize the MPU6050, streaming at 1 kHz / (1 + 9) = 100 Hz when awake
+	while (!mpu.init())
+	{
+		Serial.println("MPU initialization failed. Please check your wiring.");
+		delay(1000);
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(9);
+	Serial.println("MPU initialized successfully!");
+
+	// Wake on 80 mg, sleep again after 20 mg or less for 8 * 64 ms
+	mpu.setMotionDetection(40, 1);
+	mpu.setZeroMotionDetection(10, 8);
+
+	// Accelerometer only cycle mode at 5 Hz, the IMU is not read until it is moved
+	mpu.beginWakeOnMotion(INT_PIN, IMU_WAKE_5HZ);
+}
+
+void loop()
+{
+	uint8_t events = mpu.getMotionEvents();
+
+	if (mpu.isCycleMode())
+	{
+		// Moved, start streaming and watch for the IMU to become still
+		if (events & IMU_EVENT_MOTION)
+		{
+			Serial.println("Wake up");
+			mpu.endMotionEvents();
+			mpu.beginMotionEvents(INT_PIN, IMU_EVENT_ZERO_MOTION);
+			mpu.beginFIFO(IMU_FIFO_ACCEL);
+		}
+		return;
+	}
+
+	// Print the accelerometer while awake
+	int count = mpu.readFIFO(samples, 16);
+	for (int i = 0; i < count; i++)
+	{
+		Serial.print(samples[i].accel.x);
+		Serial.print(" ");
+		Serial.print(samples[i].accel.y);
+		Serial.print(" ");
+		Serial.println(samples[i].accel.z);
+	}
+
+	// Still again, back to the cycle mode
+	if ((events & IMU_EVENT_ZERO_MOTION) && (events & IMU_EVENT_STILL))
+	{
+		Serial.println("Sleep");
+		mpu.endFIFO();
+		mpu.endMotionEvents();
+		mpu.beginWakeOnMotion(INT_PIN, IMU_WAKE_5HZ);
+	}
+}
@@ -0,0 +1,195 @@
+/*
+ *  Arduino core stand-in for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "Arduino.h"
+#include <chrono>
+
+#define HOST_MAX_PINS 64
+#define HOST_MAX_TIME_HANDLERS 4
+#define HOST_MAX_PIN_HANDLERS 4
+
+static uint64_t hostTime = 0;
+static bool hostRealTime = false;
+static std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+static void (*hostTimeHandlers[HOST_MAX_TIME_HANDLERS])(uint64_t);
+static void (*hostISR[HOST_MAX_PINS])(void);
+static void (*hostPinHandlers[HOST_MAX_PIN_HANDLERS])(uint8_t, uint8_t);
+static uint8_t hostPinLevel[HOST_MAX_PINS];
+static uint8_t hostPinLatch[HOST_MAX_PINS];
+static uint8_t hostPinMode[HOST_MAX_PINS];
+static bool hostPinHeld[HOST_MAX_PINS];
+static bool hostInterruptsEnabled = true;
+
+// Notify time handlers
+static void hostTick()
+{
+	if (hostRealTime)
+		hostTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostStart).count();
+	/* An ISR raised by a handler may read the time, the devices are already up to date */
+	static bool ticking = false;
+	if (ticking)
+		return;
+	ticking = true;
+	for (uint8_t i = 0; i < HOST_MAX_TIME_HANDLERS; i++)
+		if (hostTimeHandlers[i] != NULL)
+			hostTimeHandlers[i](hostTime);
+	ticking = false;
+}
+
+uint64_t hostNanos()
+{
+	hostTick();
+	return hostTime;
+}
+
+void hostAdvanceNanos(uint64_t ns)
+{
+	if (hostRealTime)
+	{
+		/* Busy wait, sleeping is far too coarse for bus timing */
+		uint64_t end = hostNanos() + ns;
+		while (hostNanos() < end)
+			;
+		return;
+	}
+	hostTime += ns;
+	hostTick();
+}
+
+void hostSetRealTime(bool enable)
+{
+	hostStart = std::chrono::steady_clock::now() - std::chrono::nanoseconds(hostTime);
+	hostRealTime = enable;
+}
+
+bool hostAddTimeHandler(void (*handler)(uint64_t now))
+{
+	for (uint8_t i = 0; i < HOST_MAX_TIME_HANDLERS; i++)
+	{
+		if (hostTimeHandlers[i] == handler)
+			return true;
+		if (hostTimeHandlers[i] == NULL)
+		{
+			hostTimeHandlers[i] = handler;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Drive a pin and notify pin handlers of a change
+static void hostDrivePin(uint8_t pin, uint8_t level)
+{
+	if (hostPinLevel[pin] == level)
+		return;
+	hostPinLevel[pin] = level;
+	for (uint8_t i = 0; i < HOST_MAX_PIN_HANDLERS; i++)
+		if (hostPinHandlers[i] != NULL)
+			hostPinHandlers[i](pin, level);
+}
+
+void hostHoldPin(uint8_t pin, bool low)
+{
+	if (pin < HOST_MAX_PINS)
+		hostPinHeld[pin] = low;
+}
+
+bool hostAddPinHandler(void (*handler)(uint8_t pin, uint8_t level))
+{
+	for (uint8_t i = 0; i < HOST_MAX_PIN_HANDLERS; i++)
+	{
+		if (hostPinHandlers[i] == handler)
+			return true;
+		if (hostPinHandlers[i] == NULL)
+		{
+			hostPinHandlers[i] = handler;
+			return true;
+		}
+	}
+	return false;
+}
+
+void hostTriggerInterrupt(uint8_t pin)
+{
+	if (pin < HOST_MAX_PINS && hostISR[pin] != NULL && hostInterruptsEnabled)
+		hostISR[pin]();
+}
+
+unsigned long millis()
+{
+	return hostNanos() / 1000000;
+}
+
+unsigned long micros()
+{
+	/* Keep polling loops moving in simulated time */
+	if (!hostRealTime)
+		hostTime += 1000;
+	return hostNanos() / 1000;
+}
+
+void delay(unsigned long ms)
+{
+	hostAdvanceNanos((uint64_t)ms * 1000000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	hostAdvanceNanos((uint64_t)us * 1000);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (pin >= HOST_MAX_PINS)
+		return;
+	hostPinMode[pin] = mode;
+	if (mode == INPUT_PULLUP)
+		hostDrivePin(pin, HIGH);
+	else if (mode == OUTPUT)
+		hostDrivePin(pin, hostPinLatch[pin]);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+	if (pin >= HOST_MAX_PINS)
+		return;
+	hostPinLatch[pin] = value;
+	if (hostPinMode[pin] != INPUT_PULLUP)
+		hostDrivePin(pin, value);
+}
+
+int digitalRead(uint8_t pin)
+{
+	if (pin >= HOST_MAX_PINS || hostPinHeld[pin])
+		return LOW;
+	return hostPinLevel[pin];
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode)
+{
+	(void)mode;
+	if (interrupt < HOST_MAX_PINS)
+		hostISR[interrupt] = isr;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+	if (interrupt < HOST_MAX_PINS)
+		hostISR[interrupt] = NULL;
+}
+
+void noInterrupts()
+{
+	hostInterruptsEnabled = false;
+}
+
+void interrupts()
+{
+	hostInterruptsEnabled = true;
+}
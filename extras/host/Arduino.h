@@ -0,0 +1,119 @@
+/*
+ *  Arduino core stand-in for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Only the parts of the Arduino core used by the library are provided.
+ *  Time is simulated: it advances with every call to delay, by the modeled
+ *  duration of every I2C transaction and by 1 us on every call to micros,
+ *  so programs run as fast as the host allows and give the same result on
+ *  every run. hostSetRealTime switches to the clock of the host.
+ */
+
+#ifndef SIMPLEIMU_HOST_ARDUINO_H
+#define SIMPLEIMU_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+#define digitalPinToInterrupt(pin) (pin)
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+void noInterrupts();
+void interrupts();
+
+/*
+ * Function to get the simulated time with full resolution.
+ *
+ * params: None
+ * returns: uint64_t, the time since start in nanoseconds
+ */
+uint64_t hostNanos();
+
+/*
+ * Function to let simulated time pass, as done by delay and the I2C bus.
+ *
+ * params: ns, the time to pass in nanoseconds
+ * returns: None
+ */
+void hostAdvanceNanos(uint64_t ns);
+
+/*
+ * Function to follow the clock of the host instead of simulated time.
+ *
+ * params: enable, true to follow the host clock
+ * returns: None
+ */
+void hostSetRealTime(bool enable);
+
+/*
+ * Function to register a function called whenever time changes, used by
+ * the simulated devices to produce samples on time.
+ *
+ * params: handler, the function, receives the time in nanoseconds
+ * returns: bool, true if registered, false if all slots are in use
+ */
+bool hostAddTimeHandler(void (*handler)(uint64_t now));
+
+/*
+ * Function to run the ISR attached to a pin, called by simulated devices
+ * when they raise their interrupt pin.
+ *
+ * params: pin, the pin driven by the device
+ * returns: None
+ */
+void hostTriggerInterrupt(uint8_t pin);
+
+/*
+ * Function to hold a pin low from outside, as a device pulling an open
+ * drain line does. digitalRead returns LOW while the pin is held.
+ *
+ * params: pin, the pin
+ * 		   low, true to hold the pin low, false to release it
+ * returns: None
+ */
+void hostHoldPin(uint8_t pin, bool low);
+
+/*
+ * Function to register a function called whenever the sketch changes the
+ * level it drives a pin to, used by simulated devices to follow lines
+ * driven by hand such as a bus recovery.
+ *
+ * params: handler, the function, receives the pin and the new level
+ * returns: bool, true if registered, false if all slots are in use
+ */
+bool hostAddPinHandler(void (*handler)(uint8_t pin, uint8_t level));
+
+#endif /* SIMPLEIMU_HOST_ARDUINO_H */
@@ -0,0 +1,87 @@
+/*
+ *  Simulated HMC5883L magnetometer for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "SimulatedHMC5883L.h"
+
+/* Counts per gauss for each gain setting of configuration register B */
+static const uint16_t SIM_HMC_GAINS[8] = {1370, 1090, 820, 660, 440, 390, 330, 230};
+
+// Constructor
+SimulatedHMC5883L::SimulatedHMC5883L(TwoWire *bus)
+	: SimulatedI2CDevice(0x1E)
+{
+	memset(SimulatedHMC5883L::SIM_Regs, 0, SIM_HMC_REGISTERS);
+	SimulatedHMC5883L::SIM_Regs[0x00] = 0x10;
+	SimulatedHMC5883L::SIM_Regs[0x01] = 0x20;
+	SimulatedHMC5883L::SIM_Regs[0x02] = 0x01;
+	SimulatedHMC5883L::SIM_Regs[0x0A] = 'H';
+	SimulatedHMC5883L::SIM_Regs[0x0B] = '4';
+	SimulatedHMC5883L::SIM_Regs[0x0C] = '3';
+	SimulatedHMC5883L::SIM_Pointer = 0;
+	for (uint8_t i = 0; i < 3; i++)
+		SimulatedHMC5883L::SIM_Field[i] = 0;
+	if (bus != NULL)
+		bus->attachDevice(this);
+}
+
+// Register value, data registers in X, Z, Y order
+uint8_t SimulatedHMC5883L::readRegister(uint8_t reg)
+{
+	static const uint8_t order[3] = {0, 2, 1};
+	if (reg >= 0x03 && reg <= 0x08)
+	{
+		float field = SimulatedHMC5883L::SIM_Field[order[(reg - 0x03) / 2]];
+		int32_t count = (int32_t)(field * SimulatedHMC5883L::getGain());
+		/* Overflow reads as -4096 like the real sensor */
+		if (count < -2048 || count > 2047)
+			count = -4096;
+		return ((reg - 0x03) % 2 == 0) ? (uint8_t)((uint16_t)count >> 8) : (uint8_t)count;
+	}
+	if (reg < SIM_HMC_REGISTERS)
+		return SimulatedHMC5883L::SIM_Regs[reg];
+	return 0;
+}
+
+// First byte sets the pointer, the rest are written to the registers
+bool SimulatedHMC5883L::receive(const uint8_t *data, uint8_t length)
+{
+	if (length == 0)
+		return true;
+	SimulatedHMC5883L::SIM_Pointer = data[0];
+	for (uint8_t i = 1; i < length; i++)
+	{
+		uint8_t reg = SimulatedHMC5883L::SIM_Pointer++;
+		if (reg <= 0x02)
+			SimulatedHMC5883L::SIM_Regs[reg] = data[i];
+	}
+	return true;
+}
+
+// Bytes from the pointer onwards
+uint8_t SimulatedHMC5883L::request(uint8_t *data, uint8_t length)
+{
+	for (uint8_t i = 0; i < length; i++)
+	{
+		data[i] = SimulatedHMC5883L::readRegister(SimulatedHMC5883L::SIM_Pointer);
+		SimulatedHMC5883L::SIM_Pointer = (SimulatedHMC5883L::SIM_Pointer + 1) % SIM_HMC_REGISTERS;
+	}
+	return length;
+}
+
+void SimulatedHMC5883L::setField(float x, float y, float z)
+{
+	SimulatedHMC5883L::SIM_Field[0] = x;
+	SimulatedHMC5883L::SIM_Field[1] = y;
+	SimulatedHMC5883L::SIM_Field[2] = z;
+}
+
+uint16_t SimulatedHMC5883L::getGain()
+{
+	return SIM_HMC_GAINS[SimulatedHMC5883L::SIM_Regs[0x01] >> 5];
+}
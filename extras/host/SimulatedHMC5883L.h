@@ -0,0 +1,72 @@
+/*
+ *  Simulated HMC5883L magnetometer for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  The register pointer increments after every byte. The data registers
+ *  hold the field in X, Z, Y order, big endian, scaled by the gain set in
+ *  configuration register B.
+ */
+
+#ifndef SIMPLEIMU_SIMULATED_HMC5883L_H
+#define SIMPLEIMU_SIMULATED_HMC5883L_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/* Number of registers of the HMC5883L */
+#define SIM_HMC_REGISTERS 13
+
+class SimulatedHMC5883L : public SimulatedI2CDevice
+{
+private:
+	/* The register file */
+	uint8_t SIM_Regs[SIM_HMC_REGISTERS];
+
+	/* The register pointer */
+	uint8_t SIM_Pointer;
+
+	/* The field seen by the sensor in gauss */
+	float SIM_Field[3];
+
+	/*
+	 * Function to get a register, the data registers follow the field.
+	 *
+	 * params: reg, the register
+	 * returns: uint8_t, the value
+	 */
+	uint8_t readRegister(uint8_t reg);
+
+public:
+	/*
+	 * Constructor for SimulatedHMC5883L object.
+	 *
+	 * params: bus, the bus the magnetometer is on, NULL for an auxiliary bus
+	 * returns: SimulatedHMC5883L object
+	 */
+	SimulatedHMC5883L(TwoWire *bus = NULL);
+
+	bool receive(const uint8_t *data, uint8_t length);
+	uint8_t request(uint8_t *data, uint8_t length);
+
+	/*
+	 * Function to set the field seen by the sensor.
+	 *
+	 * params: x, y, z, field in gauss
+	 * returns: None
+	 */
+	void setField(float x, float y, float z);
+
+	/*
+	 * Function to get the counts per gauss of the current gain.
+	 *
+	 * params: None
+	 * returns: uint16_t, counts per gauss
+	 */
+	uint16_t getGain();
+};
+
+#endif /* SIMPLEIMU_SIMULATED_HMC5883L_H */
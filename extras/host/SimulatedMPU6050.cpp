@@ -0,0 +1,629 @@
+/*
+ *  Simulated MPU6050 for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "SimulatedMPU6050.h"
+#include "../../utility/SimpleIMU_MPU6050.h"
+
+using namespace MPU6050_IMU;
+
+/* Counts per deg/s of the gyroscope ranges */
+static const float simGyroSensitivity[4] = {131.0f, 65.5f, 32.8f, 16.4f};
+
+/* Sample periods of the LP_WAKE_CTRL rates in nanoseconds */
+static const uint64_t simWakePeriod[4] = {800000000, 200000000, 50000000, 25000000};
+
+/* Cut off frequencies of the DHPF settings 1 to 4 in Hz */
+static const float simHighPass[4] = {5.0f, 2.5f, 1.25f, 0.63f};
+
+// Constructor
+SimulatedMPU6050::SimulatedMPU6050(uint8_t address, uint8_t intPin, TwoWire *bus)
+	: SimulatedI2CDevice(address)
+{
+	SimulatedMPU6050::SIM_IntPin = intPin;
+	SimulatedMPU6050::SIM_NextSample = 0;
+	SimulatedMPU6050::SIM_Samples = 0;
+	SimulatedMPU6050::SIM_LastSample = 0;
+	SimulatedMPU6050::SIM_ClockError = 0.0f;
+	SimulatedMPU6050::SIM_Seed = 0x2545F491;
+	SimulatedMPU6050::SIM_AccelNoise = 0.004f;
+	SimulatedMPU6050::SIM_GyroNoise = 0.05f;
+	SimulatedMPU6050::SIM_Temperature = 25.0f;
+	SimulatedMPU6050::SIM_GyroTempCoeff = 0.0f;
+	SimulatedMPU6050::SIM_Motion = NULL;
+	SimulatedMPU6050::SIM_MotionContext = NULL;
+	SimulatedMPU6050::SIM_MemoryFault = -1;
+	for (uint8_t i = 0; i < SIM_AUX_DEVICES; i++)
+		SimulatedMPU6050::SIM_AuxDevices[i] = NULL;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		SimulatedMPU6050::SIM_Accel[i] = i == 2 ? 1.0f : 0.0f;
+		SimulatedMPU6050::SIM_Gyro[i] = 0.0f;
+		SimulatedMPU6050::SIM_AccelBias[i] = 0.0f;
+		SimulatedMPU6050::SIM_GyroBias[i] = 0.0f;
+	}
+
+	/* Factory trim of the accelerometer, bit 0 is the reserved TC bit */
+	SimulatedMPU6050::SIM_FactoryTrim[0] = -1231;
+	SimulatedMPU6050::SIM_FactoryTrim[1] = 845;
+	SimulatedMPU6050::SIM_FactoryTrim[2] = 1517;
+	SimulatedMPU6050::reset();
+	if (bus != NULL)
+		bus->attachDevice(this);
+}
+
+// Set power on values
+void SimulatedMPU6050::reset()
+{
+	memset(SimulatedMPU6050::SIM_Regs, 0, sizeof(SimulatedMPU6050::SIM_Regs));
+	for (uint8_t i = 0; i < 3; i++)
+		SimulatedMPU6050::SIM_Reference[i] = 0.0f;
+	SimulatedMPU6050::SIM_MotionTime = 0;
+	SimulatedMPU6050::SIM_StillTime = 0;
+	SimulatedMPU6050::SIM_FallTime = 0;
+	SimulatedMPU6050::SIM_Still = false;
+	memset(SimulatedMPU6050::SIM_Memory, 0, sizeof(SimulatedMPU6050::SIM_Memory));
+	SimulatedMPU6050::SIM_FIFO.clear();
+	SimulatedMPU6050::SIM_Pointer = 0;
+	SimulatedMPU6050::SIM_Regs[MPU6050_RA_PWR_MGMT_1] = 1 << MPU6050_PWR1_SLEEP_BIT;
+	SimulatedMPU6050::SIM_Regs[MPU6050_RA_WHO_AM_I] = 0x68;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		SimulatedMPU6050::SIM_Regs[MPU6050_RA_XA_OFFS_H + 2 * i] = (uint16_t)SimulatedMPU6050::SIM_FactoryTrim[i] >> 8;
+		SimulatedMPU6050::SIM_Regs[MPU6050_RA_XA_OFFS_H + 2 * i + 1] = SimulatedMPU6050::SIM_FactoryTrim[i] & 0xFF;
+	}
+}
+
+// Normally distributed random number
+float SimulatedMPU6050::gaussian()
+{
+	float u[2];
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		uint32_t x = SimulatedMPU6050::SIM_Seed;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		SimulatedMPU6050::SIM_Seed = x;
+		u[i] = (x + 1.0f) / 4294967296.0f;
+	}
+	return sqrtf(-2.0f * logf(u[0])) * cosf(6.2831853f * u[1]);
+}
+
+// Sample period
+uint64_t SimulatedMPU6050::samplePeriod()
+{
+	uint64_t period;
+	if (SimulatedMPU6050::SIM_Regs[MPU6050_RA_PWR_MGMT_1] & (1 << MPU6050_PWR1_CYCLE_BIT))
+		period = simWakePeriod[SimulatedMPU6050::SIM_Regs[MPU6050_RA_PWR_MGMT_2] >> 6];
+	else
+	{
+		uint8_t dlpf = SimulatedMPU6050::SIM_Regs[MPU6050_RA_CONFIG] & 0x07;
+		uint64_t gyroPeriod = (dlpf == 0 || dlpf == 7) ? 125000 : 1000000;
+		period = gyroPeriod * (1 + SimulatedMPU6050::SIM_Regs[MPU6050_RA_SMPLRT_DIV]);
+	}
+	if (SimulatedMPU6050::SIM_ClockError != 0.0f)
+		period += (int64_t)llround(period * (double)SimulatedMPU6050::SIM_ClockError * 1e-6);
+	return period;
+}
+
+// Produce samples up to now
+void SimulatedMPU6050::advance(uint64_t now)
+{
+	if (SimulatedMPU6050::SIM_Regs[MPU6050_RA_PWR_MGMT_1] & (1 << MPU6050_PWR1_SLEEP_BIT))
+	{
+		SimulatedMPU6050::SIM_NextSample = now + SimulatedMPU6050::samplePeriod();
+		return;
+	}
+	while (SimulatedMPU6050::SIM_NextSample <= now)
+	{
+		SimulatedMPU6050::sample(SimulatedMPU6050::SIM_NextSample);
+		SimulatedMPU6050::SIM_NextSample += SimulatedMPU6050::samplePeriod();
+	}
+}
+
+// Convert to a saturated count
+static int16_t simCounts(float value)
+{
+	if (value > 32767.0f)
+		return 32767;
+	if (value < -32768.0f)
+		return -32768;
+	return (int16_t)lrintf(value);
+}
+
+// Produce one sample
+void SimulatedMPU6050::sample(uint64_t now)
+{
+	uint8_t *regs = SimulatedMPU6050::SIM_Regs;
+	float accel[3], gyro[3];
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		accel[i] = SimulatedMPU6050::SIM_Accel[i];
+		gyro[i] = SimulatedMPU6050::SIM_Gyro[i];
+	}
+	if (SimulatedMPU6050::SIM_Motion != NULL)
+		SimulatedMPU6050::SIM_Motion(now, accel, gyro, SimulatedMPU6050::SIM_MotionContext);
+
+	int16_t counts[7];
+	uint8_t accelRange = (regs[MPU6050_RA_ACCEL_CONFIG] >> 3) & 0x03;
+	uint8_t gyroRange = (regs[MPU6050_RA_GYRO_CONFIG] >> 3) & 0x03;
+	float drift = SimulatedMPU6050::SIM_GyroTempCoeff * (SimulatedMPU6050::SIM_Temperature - 25.0f);
+	float measured[3];
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		/* Accelerometer offset registers count 2048 per g on top of the factory trim */
+		int16_t offset = (int16_t)(regs[MPU6050_RA_XA_OFFS_H + 2 * i] << 8 | regs[MPU6050_RA_XA_OFFS_H + 2 * i + 1]);
+		float g = accel[i] + SimulatedMPU6050::SIM_AccelBias[i] + SimulatedMPU6050::SIM_AccelNoise * SimulatedMPU6050::gaussian() +
+				  (offset - SimulatedMPU6050::SIM_FactoryTrim[i]) / 2048.0f;
+		counts[i] = simCounts(g * (16384 >> accelRange));
+		measured[i] = g;
+
+		/* Gyroscope offset registers count 32.8 per deg/s */
+		offset = (int16_t)(regs[MPU6050_RA_XG_OFFS_USRH + 2 * i] << 8 | regs[MPU6050_RA_XG_OFFS_USRH + 2 * i + 1]);
+		float w = gyro[i] + SimulatedMPU6050::SIM_GyroBias[i] + drift + SimulatedMPU6050::SIM_GyroNoise * SimulatedMPU6050::gaussian() +
+				  offset / 32.8f;
+		counts[4 + i] = simCounts(w * simGyroSensitivity[gyroRange]);
+
+		/* Gyroscopes in standby read zero, STBY_XG is bit 2 */
+		if (regs[MPU6050_RA_PWR_MGMT_2] & (1 << (2 - i)))
+			counts[4 + i] = 0;
+	}
+	counts[3] = simCounts((SimulatedMPU6050::SIM_Temperature - 36.53f) * 340.0f);
+
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		regs[MPU6050_RA_ACCEL_XOUT_H + 2 * i] = (uint16_t)counts[i] >> 8;
+		regs[MPU6050_RA_ACCEL_XOUT_H + 2 * i + 1] = counts[i] & 0xFF;
+	}
+
+	SimulatedMPU6050::detectMotion(measured, SimulatedMPU6050::samplePeriod());
+
+	if (regs[MPU6050_RA_USER_CTRL] & (1 << MPU6050_USERCTRL_I2C_MST_EN_BIT))
+		SimulatedMPU6050::runAuxMaster();
+
+	/* Frame in register order: accel, temperature, gyro x, y, z, external sensors */
+	if (regs[MPU6050_RA_USER_CTRL] & (1 << MPU6050_USERCTRL_FIFO_EN_BIT))
+	{
+		std::deque<uint8_t> &fifo = SimulatedMPU6050::SIM_FIFO;
+		uint8_t fifoEn = regs[MPU6050_RA_FIFO_EN];
+		if (fifoEn & (1 << MPU6050_ACCEL_FIFO_EN_BIT))
+			for (uint8_t i = 0; i < 6; i++)
+				fifo.push_back(regs[MPU6050_RA_ACCEL_XOUT_H + i]);
+		if (fifoEn & (1 << MPU6050_TEMP_FIFO_EN_BIT))
+			for (uint8_t i = 0; i < 2; i++)
+				fifo.push_back(regs[MPU6050_RA_TEMP_OUT_H + i]);
+		if (fifoEn & (1 << MPU6050_XG_FIFO_EN_BIT))
+			for (uint8_t i = 0; i < 2; i++)
+				fifo.push_back(regs[MPU6050_RA_GYRO_XOUT_H + i]);
+		if (fifoEn & (1 << MPU6050_YG_FIFO_EN_BIT))
+			for (uint8_t i = 0; i < 2; i++)
+				fifo.push_back(regs[MPU6050_RA_GYRO_YOUT_H + i]);
+		if (fifoEn & (1 << MPU6050_ZG_FIFO_EN_BIT))
+			for (uint8_t i = 0; i < 2; i++)
+				fifo.push_back(regs[MPU6050_RA_GYRO_ZOUT_H + i]);
+		SimulatedMPU6050::pushExternalData(fifo);
+
+		/* On overflow the oldest bytes are overwritten */
+		if (fifo.size() > 1024)
+		{
+			while (fifo.size() > 1024)
+				fifo.pop_front();
+			SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_FIFO_OFLOW_BIT);
+		}
+	}
+
+	SimulatedMPU6050::SIM_Samples++;
+	SimulatedMPU6050::SIM_LastSample = now;
+	SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_DATA_RDY_BIT);
+}
+
+// Motion, zero motion and free fall detection
+void SimulatedMPU6050::detectMotion(const float *accel, uint64_t period)
+{
+	uint8_t *regs = SimulatedMPU6050::SIM_Regs;
+	uint8_t hpf = regs[MPU6050_RA_ACCEL_CONFIG] & 0x07;
+	float filtered[3];
+	bool moving = false, still = true, falling = true;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		/* Reset follows the input, hold keeps the reference, the rest low pass it */
+		if (hpf == MPU6050_DHPF_RESET)
+			SimulatedMPU6050::SIM_Reference[i] = accel[i];
+		else if (hpf >= MPU6050_DHPF_5 && hpf <= MPU6050_DHPF_0P63)
+		{
+			float k = 6.2831853f * simHighPass[hpf - 1] * period * 1e-9f;
+			SimulatedMPU6050::SIM_Reference[i] += (k < 1.0f ? k : 1.0f) * (accel[i] - SimulatedMPU6050::SIM_Reference[i]);
+		}
+		filtered[i] = accel[i] - SimulatedMPU6050::SIM_Reference[i];
+
+		/* Thresholds count 2 mg */
+		if (fabsf(filtered[i]) > regs[MPU6050_RA_MOT_THR] * 0.002f)
+			moving = true;
+		if (fabsf(filtered[i]) >= regs[MPU6050_RA_ZRMOT_THR] * 0.002f)
+			still = false;
+		if (fabsf(accel[i]) >= regs[MPU6050_RA_FF_THR] * 0.002f)
+			falling = false;
+	}
+
+	/* Motion for MOT_DUR ms, signalled once when the duration is reached */
+	uint64_t before = SimulatedMPU6050::SIM_MotionTime;
+	SimulatedMPU6050::SIM_MotionTime = moving ? before + period : 0;
+	uint64_t duration = regs[MPU6050_RA_MOT_DUR] * 1000000ULL;
+	if (moving && regs[MPU6050_RA_MOT_THR] != 0 && before <= duration && SimulatedMPU6050::SIM_MotionTime > duration)
+	{
+		uint8_t direction = 0;
+		for (uint8_t i = 0; i < 3; i++)
+			if (fabsf(filtered[i]) > regs[MPU6050_RA_MOT_THR] * 0.002f)
+				direction |= 1 << (filtered[i] < 0 ? MPU6050_MOTION_MOT_XNEG_BIT - 2 * i : MPU6050_MOTION_MOT_XPOS_BIT - 2 * i);
+		regs[MPU6050_RA_MOT_DETECT_STATUS] = (regs[MPU6050_RA_MOT_DETECT_STATUS] & 0x01) | direction;
+		SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_MOT_BIT);
+	}
+
+	/* Zero motion for ZRMOT_DUR * 64 ms, signalled again when motion resumes */
+	SimulatedMPU6050::SIM_StillTime = still ? SimulatedMPU6050::SIM_StillTime + period : 0;
+	if (regs[MPU6050_RA_ZRMOT_THR] != 0)
+	{
+		bool zero = SimulatedMPU6050::SIM_StillTime >= regs[MPU6050_RA_ZRMOT_DUR] * 64000000ULL && still;
+		if (zero != SimulatedMPU6050::SIM_Still)
+		{
+			SimulatedMPU6050::SIM_Still = zero;
+			regs[MPU6050_RA_MOT_DETECT_STATUS] = (regs[MPU6050_RA_MOT_DETECT_STATUS] & 0xFE) | (zero ? 1 : 0);
+			SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_ZMOT_BIT);
+		}
+	}
+
+	/* Free fall for FF_DUR ms, signalled once */
+	before = SimulatedMPU6050::SIM_FallTime;
+	SimulatedMPU6050::SIM_FallTime = falling ? before + period : 0;
+	duration = regs[MPU6050_RA_FF_DUR] * 1000000ULL;
+	if (falling && regs[MPU6050_RA_FF_THR] != 0 && before <= duration && SimulatedMPU6050::SIM_FallTime > duration)
+		SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_FF_BIT);
+}
+
+// One transfer on the auxiliary bus
+bool SimulatedMPU6050::auxTransfer(uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, bool skipReg)
+{
+	SimulatedI2CDevice *device = NULL;
+	for (uint8_t i = 0; i < SIM_AUX_DEVICES && device == NULL; i++)
+		if (SimulatedMPU6050::SIM_AuxDevices[i] != NULL)
+			device = SimulatedMPU6050::SIM_AuxDevices[i]->route(address & 0x7F);
+	if (device == NULL)
+		return false;
+
+	if (address & 0x80)
+	{
+		if (!skipReg && !device->receive(&reg, 1))
+			return false;
+		return device->request(data, length) == length;
+	}
+	uint8_t buffer[17];
+	uint8_t count = 0;
+	if (!skipReg)
+		buffer[count++] = reg;
+	for (uint8_t i = 0; i < length && count < sizeof(buffer); i++)
+		buffer[count++] = data[i];
+	return device->receive(buffer, count);
+}
+
+// Transfers of the auxiliary I2C master for one sample
+void SimulatedMPU6050::runAuxMaster()
+{
+	uint8_t *regs = SimulatedMPU6050::SIM_Regs;
+	uint8_t delay = regs[MPU6050_RA_I2C_SLV4_CTRL] & 0x1F;
+	bool delaySample = (SimulatedMPU6050::SIM_Samples % (1 + delay)) != 0;
+	uint8_t offset = 0;
+
+	/* Reading slaves fill EXT_SENS_DATA in the order of the slave number */
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		uint8_t address = regs[MPU6050_RA_I2C_SLV0_ADDR + 3 * i];
+		uint8_t reg = regs[MPU6050_RA_I2C_SLV0_REG + 3 * i];
+		uint8_t ctrl = regs[MPU6050_RA_I2C_SLV0_CTRL + 3 * i];
+		uint8_t length = ctrl & 0x0F;
+		if (!(ctrl & 0x80) || length == 0)
+			continue;
+		bool read = address & 0x80;
+		bool skip = delaySample && (regs[MPU6050_RA_I2C_MST_DELAY_CTRL] & (1 << i));
+		if (read && offset + length > 24)
+			break;
+
+		bool ack = true;
+		if (!skip)
+		{
+			uint8_t data[15];
+			if (read)
+			{
+				ack = SimulatedMPU6050::auxTransfer(address, reg, data, length, ctrl & 0x20);
+				if (ack)
+				{
+					if (ctrl & 0x40)
+						for (uint8_t j = 0; j + 1 < length; j += 2)
+						{
+							uint8_t t = data[j];
+							data[j] = data[j + 1];
+							data[j + 1] = t;
+						}
+					memcpy(&regs[MPU6050_RA_EXT_SENS_DATA_00 + offset], data, length);
+				}
+			}
+			else
+				ack = SimulatedMPU6050::auxTransfer(address, reg, &regs[MPU6050_RA_I2C_SLV0_DO + i], 1, ctrl & 0x20);
+		}
+		if (!ack)
+			regs[MPU6050_RA_I2C_MST_STATUS] |= 1 << i;
+		if (read)
+			offset += length;
+	}
+
+	/* Slave 4 makes a single transfer and clears its enable bit */
+	uint8_t ctrl4 = regs[MPU6050_RA_I2C_SLV4_CTRL];
+	if (ctrl4 & 0x80)
+	{
+		uint8_t address = regs[MPU6050_RA_I2C_SLV4_ADDR];
+		uint8_t reg = regs[MPU6050_RA_I2C_SLV4_REG];
+		bool ack = (address & 0x80) ? SimulatedMPU6050::auxTransfer(address, reg, &regs[MPU6050_RA_I2C_SLV4_DI], 1, ctrl4 & 0x20)
+									: SimulatedMPU6050::auxTransfer(address, reg, &regs[MPU6050_RA_I2C_SLV4_DO], 1, ctrl4 & 0x20);
+		regs[MPU6050_RA_I2C_SLV4_CTRL] = ctrl4 & 0x7F;
+		regs[MPU6050_RA_I2C_MST_STATUS] |= 1 << (ack ? MPU6050_MST_I2C_SLV4_DONE_BIT : MPU6050_MST_I2C_SLV4_NACK_BIT);
+		if (ctrl4 & 0x40)
+			SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_I2C_MST_INT_BIT);
+	}
+}
+
+// External sensor data of the slaves enabled in the FIFO
+void SimulatedMPU6050::pushExternalData(std::deque<uint8_t> &fifo)
+{
+	uint8_t *regs = SimulatedMPU6050::SIM_Regs;
+	uint8_t enabled = (regs[MPU6050_RA_FIFO_EN] & 0x07) | ((regs[MPU6050_RA_I2C_MST_CTRL] & 0x20) ? 0x08 : 0x00);
+	uint8_t offset = 0;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		uint8_t ctrl = regs[MPU6050_RA_I2C_SLV0_CTRL + 3 * i];
+		if (!(ctrl & 0x80) || !(regs[MPU6050_RA_I2C_SLV0_ADDR + 3 * i] & 0x80))
+			continue;
+		uint8_t length = ctrl & 0x0F;
+		if (enabled & (1 << i))
+			for (uint8_t j = 0; j < length && offset + j < 24; j++)
+				fifo.push_back(regs[MPU6050_RA_EXT_SENS_DATA_00 + offset + j]);
+		offset += length;
+	}
+}
+
+// Set interrupt status and drive INT
+void SimulatedMPU6050::raiseInterrupt(uint8_t bit)
+{
+	SimulatedMPU6050::SIM_Regs[MPU6050_RA_INT_STATUS] |= 1 << bit;
+	if ((SimulatedMPU6050::SIM_Regs[MPU6050_RA_INT_ENABLE] & (1 << bit)) && SimulatedMPU6050::SIM_IntPin != SIM_NO_PIN)
+		hostTriggerInterrupt(SimulatedMPU6050::SIM_IntPin);
+}
+
+// Write transaction
+bool SimulatedMPU6050::receive(const uint8_t *data, uint8_t length)
+{
+	if (length == 0)
+		return true;
+	SimulatedMPU6050::SIM_Pointer = data[0] & 0x7F;
+	for (uint8_t i = 1; i < length; i++)
+	{
+		uint8_t reg = SimulatedMPU6050::SIM_Pointer;
+		SimulatedMPU6050::writeRegister(reg, data[i]);
+		if (reg != MPU6050_RA_FIFO_R_W && reg != MPU6050_RA_MEM_R_W)
+			SimulatedMPU6050::SIM_Pointer = (reg + 1) & 0x7F;
+	}
+	return true;
+}
+
+// Read transaction
+uint8_t SimulatedMPU6050::request(uint8_t *data, uint8_t length)
+{
+	for (uint8_t i = 0; i < length; i++)
+	{
+		uint8_t reg = SimulatedMPU6050::SIM_Pointer;
+		data[i] = SimulatedMPU6050::readRegister(reg);
+		if (reg != MPU6050_RA_FIFO_R_W && reg != MPU6050_RA_MEM_R_W)
+			SimulatedMPU6050::SIM_Pointer = (reg + 1) & 0x7F;
+	}
+	return length;
+}
+
+// Write a register
+void SimulatedMPU6050::writeRegister(uint8_t reg, uint8_t value)
+{
+	uint8_t *regs = SimulatedMPU6050::SIM_Regs;
+	switch (reg)
+	{
+	case MPU6050_RA_PWR_MGMT_1:
+		if (value & (1 << MPU6050_PWR1_DEVICE_RESET_BIT))
+			SimulatedMPU6050::reset();
+		else
+			regs[reg] = value;
+		break;
+	case MPU6050_RA_USER_CTRL:
+		if (value & (1 << MPU6050_USERCTRL_FIFO_RESET_BIT))
+			SimulatedMPU6050::SIM_FIFO.clear();
+		/* The reset bits clear themselves */
+		regs[reg] = value & 0xF0;
+		break;
+	case MPU6050_RA_FIFO_R_W:
+		if (SimulatedMPU6050::SIM_FIFO.size() < 1024)
+			SimulatedMPU6050::SIM_FIFO.push_back(value);
+		break;
+	case MPU6050_RA_MEM_R_W:
+	{
+		/* The address wraps within the bank, a burst never reaches the next one */
+		uint8_t bank = regs[MPU6050_RA_BANK_SEL] & 0x07;
+		uint8_t offset = regs[MPU6050_RA_MEM_START_ADDR]++;
+		if (SimulatedMPU6050::SIM_MemoryFault != (int32_t)(bank << 8 | offset))
+			SimulatedMPU6050::SIM_Memory[bank][offset] = value;
+		break;
+	}
+	case MPU6050_RA_INT_STATUS:
+	case MPU6050_RA_I2C_MST_STATUS:
+	case MPU6050_RA_I2C_SLV4_DI:
+	case MPU6050_RA_MOT_DETECT_STATUS:
+	case MPU6050_RA_FIFO_COUNTH:
+	case MPU6050_RA_FIFO_COUNTL:
+	case MPU6050_RA_WHO_AM_I:
+		break;
+	default:
+		/* Sensor data registers are read only */
+		if (reg >= MPU6050_RA_ACCEL_XOUT_H && reg <= MPU6050_RA_EXT_SENS_DATA_23)
+			break;
+		regs[reg] = value;
+		break;
+	}
+}
+
+// Read a register
+uint8_t SimulatedMPU6050::readRegister(uint8_t reg)
+{
+	uint8_t *regs = SimulatedMPU6050::SIM_Regs;
+	uint8_t value;
+	switch (reg)
+	{
+	case MPU6050_RA_INT_STATUS:
+		value = regs[reg];
+		regs[reg] = 0;
+		return value;
+	case MPU6050_RA_I2C_MST_STATUS:
+		value = regs[reg];
+		regs[reg] = 0;
+		return value;
+	case MPU6050_RA_MOT_DETECT_STATUS:
+		/* The direction bits clear when read, MOT_ZRMOT stays */
+		value = regs[reg];
+		regs[reg] &= 0x01;
+		return value;
+	case MPU6050_RA_FIFO_COUNTH:
+		value = SimulatedMPU6050::SIM_FIFO.size() >> 8;
+		break;
+	case MPU6050_RA_FIFO_COUNTL:
+		value = SimulatedMPU6050::SIM_FIFO.size() & 0xFF;
+		break;
+	case MPU6050_RA_FIFO_R_W:
+		if (SimulatedMPU6050::SIM_FIFO.empty())
+			return 0xFF;
+		value = SimulatedMPU6050::SIM_FIFO.front();
+		SimulatedMPU6050::SIM_FIFO.pop_front();
+		break;
+	case MPU6050_RA_MEM_R_W:
+		value = SimulatedMPU6050::SIM_Memory[regs[MPU6050_RA_BANK_SEL] & 0x07][regs[MPU6050_RA_MEM_START_ADDR]++];
+		break;
+	default:
+		value = regs[reg];
+		break;
+	}
+
+	/* With INT_RD_CLEAR any read clears the interrupt status */
+	if (regs[MPU6050_RA_INT_PIN_CFG] & (1 << MPU6050_INTCFG_INT_RD_CLEAR_BIT))
+		regs[MPU6050_RA_INT_STATUS] = 0;
+	return value;
+}
+
+void SimulatedMPU6050::setMotion(const float *accel, const float *gyro)
+{
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		SimulatedMPU6050::SIM_Accel[i] = accel[i];
+		SimulatedMPU6050::SIM_Gyro[i] = gyro[i];
+	}
+	SimulatedMPU6050::SIM_Motion = NULL;
+}
+
+void SimulatedMPU6050::setMotion(SimulatedMotion motion, void *context)
+{
+	SimulatedMPU6050::SIM_Motion = motion;
+	SimulatedMPU6050::SIM_MotionContext = context;
+}
+
+void SimulatedMPU6050::setBias(const float *accel, const float *gyro)
+{
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		SimulatedMPU6050::SIM_AccelBias[i] = accel[i];
+		SimulatedMPU6050::SIM_GyroBias[i] = gyro[i];
+	}
+}
+
+void SimulatedMPU6050::setNoise(float accel, float gyro)
+{
+	SimulatedMPU6050::SIM_AccelNoise = accel;
+	SimulatedMPU6050::SIM_GyroNoise = gyro;
+}
+
+void SimulatedMPU6050::setTemperature(float celsius, float gyroCoeff)
+{
+	SimulatedMPU6050::SIM_Temperature = celsius;
+	SimulatedMPU6050::SIM_GyroTempCoeff = gyroCoeff;
+}
+
+bool SimulatedMPU6050::attachAuxDevice(SimulatedI2CDevice *device)
+{
+	for (uint8_t i = 0; i < SIM_AUX_DEVICES; i++)
+	{
+		if (SimulatedMPU6050::SIM_AuxDevices[i] == NULL)
+		{
+			SimulatedMPU6050::SIM_AuxDevices[i] = device;
+			return true;
+		}
+	}
+	return false;
+}
+
+void SimulatedMPU6050::setSeed(uint32_t seed)
+{
+	SimulatedMPU6050::SIM_Seed = seed ? seed : 1;
+}
+
+uint8_t SimulatedMPU6050::peekRegister(uint8_t reg)
+{
+	return SimulatedMPU6050::SIM_Regs[reg & 0x7F];
+}
+
+uint8_t SimulatedMPU6050::peekMemory(uint16_t address)
+{
+	return SimulatedMPU6050::SIM_Memory[(address >> 8) & 0x07][address & 0xFF];
+}
+
+void SimulatedMPU6050::setMemoryFault(int32_t address)
+{
+	SimulatedMPU6050::SIM_MemoryFault = address;
+}
+
+void SimulatedMPU6050::pushFIFO(const uint8_t *data, uint16_t length)
+{
+	std::deque<uint8_t> &fifo = SimulatedMPU6050::SIM_FIFO;
+	fifo.insert(fifo.end(), data, data + length);
+	if (fifo.size() > 1024)
+	{
+		while (fifo.size() > 1024)
+			fifo.pop_front();
+		SimulatedMPU6050::raiseInterrupt(MPU6050_INTERRUPT_FIFO_OFLOW_BIT);
+	}
+}
+
+uint16_t SimulatedMPU6050::getFIFOCount()
+{
+	return SimulatedMPU6050::SIM_FIFO.size();
+}
+
+uint32_t SimulatedMPU6050::getSampleCount()
+{
+	return SimulatedMPU6050::SIM_Samples;
+}
+
+uint64_t SimulatedMPU6050::getLastSampleTime()
+{
+	return SimulatedMPU6050::SIM_LastSample;
+}
+
+void SimulatedMPU6050::setClockError(float ppm)
+{
+	SimulatedMPU6050::SIM_ClockError = ppm;
+}
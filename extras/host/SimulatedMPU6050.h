@@ -0,0 +1,348 @@
+/*
+ *  Simulated MPU6050 for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Models the register file with auto incrementing burst access, the FIFO
+ *  with overflow, the DMP memory, the offset registers and samples produced
+ *  at the rate set by SMPLRT_DIV and CONFIG, with bias and gaussian noise.
+ *  The motion seen by the sensor is constant or given by a callback. The
+ *  auxiliary I2C master reads and writes devices on its own bus, slaves 0
+ *  to 3 with every sample and slave 4 once. In cycle mode only the
+ *  accelerometer is sampled, at the wake up rate.
+ */
+
+#ifndef SIMPLEIMU_SIMULATED_MPU6050_H
+#define SIMPLEIMU_SIMULATED_MPU6050_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <deque>
+
+/* Pin value when the INT pin of the simulated IMU is not connected */
+#define SIM_NO_PIN 0xFF
+
+/* Maximum number of devices on the auxiliary bus */
+#define SIM_AUX_DEVICES 4
+
+/*
+ * Function giving the motion of the sensor at a point in time.
+ *
+ * params: now, the time in nanoseconds
+ * 		   accel, array of 3 floats to store the specific force in g
+ * 		   gyro, array of 3 floats to store the angular rate in deg/s
+ * 		   context, the pointer given to setMotion
+ * returns: None
+ */
+typedef void (*SimulatedMotion)(uint64_t now, float *accel, float *gyro, void *context);
+
+class SimulatedMPU6050 : public SimulatedI2CDevice
+{
+private:
+	/* The register file */
+	uint8_t SIM_Regs[128];
+
+	/* The register pointer */
+	uint8_t SIM_Pointer;
+
+	/* The DMP memory */
+	uint8_t SIM_Memory[8][256];
+
+	/* The address of a DMP memory byte that ignores writes, -1 for none */
+	int32_t SIM_MemoryFault;
+
+	/* The FIFO */
+	std::deque<uint8_t> SIM_FIFO;
+
+	/* The factory trim of the accelerometer offset registers */
+	int16_t SIM_FactoryTrim[3];
+
+	/* The pin driven by INT */
+	uint8_t SIM_IntPin;
+
+	/* The time of the next sample in nanoseconds */
+	uint64_t SIM_NextSample;
+
+	/* The number of samples produced */
+	uint32_t SIM_Samples;
+
+	/* The time of the last sample in nanoseconds */
+	uint64_t SIM_LastSample;
+
+	/* The error of the sample clock in parts per million, positive when slow */
+	float SIM_ClockError;
+
+	/* The motion, bias and noise of the sensor */
+	float SIM_Accel[3];
+	float SIM_Gyro[3];
+	float SIM_AccelBias[3];
+	float SIM_GyroBias[3];
+	float SIM_AccelNoise;
+	float SIM_GyroNoise;
+	float SIM_Temperature;
+	float SIM_GyroTempCoeff;
+	SimulatedMotion SIM_Motion;
+	void *SIM_MotionContext;
+
+	/* The state of the noise generator */
+	uint32_t SIM_Seed;
+
+	/* The devices on the auxiliary bus */
+	SimulatedI2CDevice *SIM_AuxDevices[SIM_AUX_DEVICES];
+
+	/* The acceleration removed by the high pass filter in g */
+	float SIM_Reference[3];
+
+	/* How long the motion, zero motion and free fall conditions have held in nanoseconds */
+	uint64_t SIM_MotionTime;
+	uint64_t SIM_StillTime;
+	uint64_t SIM_FallTime;
+
+	/* Whether zero motion was signalled last */
+	bool SIM_Still;
+
+	/*
+	 * Function to set all registers to their power on values.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void reset();
+
+	/*
+	 * Function to draw a normally distributed random number.
+	 *
+	 * params: None
+	 * returns: float, random number with mean 0 and standard deviation 1
+	 */
+	float gaussian();
+
+	/*
+	 * Function to produce one sample into the data registers and the FIFO.
+	 *
+	 * params: now, the time of the sample in nanoseconds
+	 * returns: None
+	 */
+	void sample(uint64_t now);
+
+	/*
+	 * Function to run the motion, zero motion and free fall detection on a sample.
+	 *
+	 * params: accel, the acceleration in g
+	 * 		   period, the time since the last sample in nanoseconds
+	 * returns: None
+	 */
+	void detectMotion(const float *accel, uint64_t period);
+
+	/*
+	 * Function to get the time between two samples.
+	 *
+	 * params: None
+	 * returns: uint64_t, the sample period in nanoseconds
+	 */
+	uint64_t samplePeriod();
+
+	/*
+	 * Function to write a register with its side effects.
+	 *
+	 * params: reg, the register
+	 * 		   value, the value written
+	 * returns: None
+	 */
+	void writeRegister(uint8_t reg, uint8_t value);
+
+	/*
+	 * Function to read a register with its side effects.
+	 *
+	 * params: reg, the register
+	 * returns: uint8_t, the value read
+	 */
+	uint8_t readRegister(uint8_t reg);
+
+	/*
+	 * Function to set an interrupt status bit and drive INT if it is enabled.
+	 *
+	 * params: bit, the bit of INT_STATUS
+	 * returns: None
+	 */
+	void raiseInterrupt(uint8_t bit);
+
+	/*
+	 * Function to run the transfers of the auxiliary I2C master for one sample.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void runAuxMaster();
+
+	/*
+	 * Function to do one transfer on the auxiliary bus.
+	 *
+	 * params: address, the address register of the slave, bit 7 set for a read
+	 * 		   reg, the register of the external device
+	 * 		   data, the bytes written, or array to store the bytes read
+	 * 		   length, number of bytes
+	 * 		   skipReg, true to leave out the register address
+	 * returns: bool, false if no device acknowledged
+	 */
+	bool auxTransfer(uint8_t address, uint8_t reg, uint8_t *data, uint8_t length, bool skipReg);
+
+	/*
+	 * Function to add the external sensor data of the slaves enabled in the
+	 * FIFO to a FIFO frame.
+	 *
+	 * params: fifo, the FIFO
+	 * returns: None
+	 */
+	void pushExternalData(std::deque<uint8_t> &fifo);
+
+public:
+	/*
+	 * Constructor for SimulatedMPU6050 object. The IMU is put on the bus.
+	 *
+	 * params: address, I2C address of the IMU
+	 * 		   intPin, the pin INT is connected to, SIM_NO_PIN if not connected
+	 * 		   bus, the bus the IMU is on, NULL to attach it to a bus switch
+	 * returns: SimulatedMPU6050 object
+	 */
+	SimulatedMPU6050(uint8_t address = 0x68, uint8_t intPin = SIM_NO_PIN, TwoWire *bus = &Wire);
+
+	bool receive(const uint8_t *data, uint8_t length);
+	uint8_t request(uint8_t *data, uint8_t length);
+	void advance(uint64_t now);
+
+	/*
+	 * Function to set a constant motion. The sensor is level at rest by default.
+	 *
+	 * params: accel, array of 3 floats with the specific force in g
+	 * 		   gyro, array of 3 floats with the angular rate in deg/s
+	 * returns: None
+	 */
+	void setMotion(const float *accel, const float *gyro);
+
+	/*
+	 * Function to take the motion from a function of time.
+	 *
+	 * params: motion, the function, NULL for constant motion
+	 * 		   context, pointer passed to the function
+	 * returns: None
+	 */
+	void setMotion(SimulatedMotion motion, void *context = NULL);
+
+	/*
+	 * Function to set the bias of the sensors.
+	 *
+	 * params: accel, array of 3 floats with the accelerometer bias in g
+	 * 		   gyro, array of 3 floats with the gyroscope bias in deg/s
+	 * returns: None
+	 */
+	void setBias(const float *accel, const float *gyro);
+
+	/*
+	 * Function to set the noise of the sensors.
+	 *
+	 * params: accel, standard deviation of the accelerometer in g
+	 * 		   gyro, standard deviation of the gyroscope in deg/s
+	 * returns: None
+	 */
+	void setNoise(float accel, float gyro);
+
+	/*
+	 * Function to set the temperature of the sensor.
+	 *
+	 * params: celsius, the temperature in degree Celsius
+	 * 		   gyroCoeff, drift of the gyroscope bias in deg/s per degree away from 25
+	 * returns: None
+	 */
+	void setTemperature(float celsius, float gyroCoeff = 0);
+
+	/*
+	 * Function to put a device on the auxiliary bus, created without a bus.
+	 *
+	 * params: device, the device
+	 * returns: bool, false if the auxiliary bus is full
+	 */
+	bool attachAuxDevice(SimulatedI2CDevice *device);
+
+	/*
+	 * Function to restart the noise generator.
+	 *
+	 * params: seed, the seed, not 0
+	 * returns: None
+	 */
+	void setSeed(uint32_t seed);
+
+	/*
+	 * Function to read a register without side effects.
+	 *
+	 * params: reg, the register
+	 * returns: uint8_t, the value
+	 */
+	uint8_t peekRegister(uint8_t reg);
+
+	/*
+	 * Function to read a byte of the DMP memory without side effects.
+	 *
+	 * params: address, the memory address, bank in the high byte
+	 * returns: uint8_t, the value
+	 */
+	uint8_t peekMemory(uint16_t address);
+
+	/*
+	 * Function to break a byte of the DMP memory, so it keeps its value
+	 * when written and the upload of an image fails its verification.
+	 *
+	 * params: address, the memory address, bank in the high byte, -1 to repair it
+	 * returns: None
+	 */
+	void setMemoryFault(int32_t address);
+
+	/*
+	 * Function to put bytes into the FIFO as the DMP writes its packets,
+	 * the simulation does not run the DMP.
+	 *
+	 * params: data, the bytes
+	 * 		   length, number of bytes
+	 * returns: None
+	 */
+	void pushFIFO(const uint8_t *data, uint16_t length);
+
+	/*
+	 * Function to get the number of bytes in the FIFO.
+	 *
+	 * params: None
+	 * returns: uint16_t, number of bytes
+	 */
+	uint16_t getFIFOCount();
+
+	/*
+	 * Function to get the number of samples produced so far.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of samples
+	 */
+	uint32_t getSampleCount();
+
+	/*
+	 * Function to get the time of the last sample produced.
+	 *
+	 * params: None
+	 * returns: uint64_t, the time in nanoseconds
+	 */
+	uint64_t getLastSampleTime();
+
+	/*
+	 * Function to let the sample clock of the sensor run off the host
+	 * clock, as the internal oscillator of the MPU6050 does by up to a few
+	 * percent.
+	 *
+	 * params: ppm, the error in parts per million, positive for a slow clock
+	 * returns: None
+	 */
+	void setClockError(float ppm);
+};
+
+#endif /* SIMPLEIMU_SIMULATED_MPU6050_H */
@@ -0,0 +1,90 @@
+/*
+ *  Simulated TCA9548A I2C switch for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "SimulatedTCA9548A.h"
+
+// Constructor
+SimulatedTCA9548A::SimulatedTCA9548A(uint8_t address, TwoWire *bus)
+	: SimulatedI2CDevice(address)
+{
+	for (uint8_t c = 0; c < 8; c++)
+		for (uint8_t i = 0; i < SIM_MUX_DEVICES; i++)
+			SimulatedTCA9548A::SIM_Devices[c][i] = NULL;
+	SimulatedTCA9548A::SIM_Control = 0;
+	SimulatedTCA9548A::SIM_Selects = 0;
+	if (bus != NULL)
+		bus->attachDevice(this);
+}
+
+// Every byte written replaces the control register
+bool SimulatedTCA9548A::receive(const uint8_t *data, uint8_t length)
+{
+	if (length > 0)
+	{
+		SimulatedTCA9548A::SIM_Control = data[length - 1];
+		SimulatedTCA9548A::SIM_Selects++;
+	}
+	return true;
+}
+
+// Reads return the control register
+uint8_t SimulatedTCA9548A::request(uint8_t *data, uint8_t length)
+{
+	for (uint8_t i = 0; i < length; i++)
+		data[i] = SimulatedTCA9548A::SIM_Control;
+	return length;
+}
+
+// The switch itself or a device on an enabled channel
+SimulatedI2CDevice *SimulatedTCA9548A::route(uint8_t address)
+{
+	if (address == SimulatedTCA9548A::getAddress())
+		return this;
+	for (uint8_t c = 0; c < 8; c++)
+	{
+		if (!(SimulatedTCA9548A::SIM_Control & (1 << c)))
+			continue;
+		for (uint8_t i = 0; i < SIM_MUX_DEVICES; i++)
+		{
+			SimulatedI2CDevice *device = SimulatedTCA9548A::SIM_Devices[c][i];
+			if (device != NULL && device->route(address) != NULL)
+				return device->route(address);
+		}
+	}
+	return NULL;
+}
+
+// Devices keep running while their channel is off
+void SimulatedTCA9548A::advance(uint64_t now)
+{
+	for (uint8_t c = 0; c < 8; c++)
+		for (uint8_t i = 0; i < SIM_MUX_DEVICES; i++)
+			if (SimulatedTCA9548A::SIM_Devices[c][i] != NULL)
+				SimulatedTCA9548A::SIM_Devices[c][i]->advance(now);
+}
+
+bool SimulatedTCA9548A::attachDevice(uint8_t channel, SimulatedI2CDevice *device)
+{
+	if (channel >= 8)
+		return false;
+	for (uint8_t i = 0; i < SIM_MUX_DEVICES; i++)
+	{
+		if (SimulatedTCA9548A::SIM_Devices[channel][i] == NULL)
+		{
+			SimulatedTCA9548A::SIM_Devices[channel][i] = device;
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t SimulatedTCA9548A::getSelectCount()
+{
+	return SimulatedTCA9548A::SIM_Selects;
+}
@@ -0,0 +1,67 @@
+/*
+ *  Simulated TCA9548A I2C switch for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  The control register selects the downstream channels, transactions to
+ *  other addresses reach the devices on the selected channels.
+ */
+
+#ifndef SIMPLEIMU_SIMULATED_TCA9548A_H
+#define SIMPLEIMU_SIMULATED_TCA9548A_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/* Maximum number of devices on one downstream channel */
+#define SIM_MUX_DEVICES 4
+
+class SimulatedTCA9548A : public SimulatedI2CDevice
+{
+private:
+	/* The devices on the channels */
+	SimulatedI2CDevice *SIM_Devices[8][SIM_MUX_DEVICES];
+
+	/* The control register, one bit per enabled channel */
+	uint8_t SIM_Control;
+
+	/* The number of writes to the control register */
+	uint32_t SIM_Selects;
+
+public:
+	/*
+	 * Constructor for SimulatedTCA9548A object. The switch is put on the bus.
+	 *
+	 * params: address, I2C address of the switch
+	 * 		   bus, the bus the switch is on
+	 * returns: SimulatedTCA9548A object
+	 */
+	SimulatedTCA9548A(uint8_t address = 0x70, TwoWire *bus = &Wire);
+
+	bool receive(const uint8_t *data, uint8_t length);
+	uint8_t request(uint8_t *data, uint8_t length);
+	SimulatedI2CDevice *route(uint8_t address);
+	void advance(uint64_t now);
+
+	/*
+	 * Function to put a device on a channel.
+	 *
+	 * params: channel, the channel from 0 to 7
+	 * 		   device, the device, created without a bus
+	 * returns: bool, false if the channel is full
+	 */
+	bool attachDevice(uint8_t channel, SimulatedI2CDevice *device);
+
+	/*
+	 * Function to get the number of writes to the control register.
+	 *
+	 * params: None
+	 * returns: uint32_t, number of writes
+	 */
+	uint32_t getSelectCount();
+};
+
+#endif /* SIMPLEIMU_SIMULATED_TCA9548A_H */
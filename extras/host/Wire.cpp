@@ -0,0 +1,315 @@
+/*
+ *  Wire stand-in for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+// Time handler for the default bus
+static void wireTimeHandler(uint64_t now)
+{
+	Wire.advance(now);
+}
+
+// Pin handler for the default bus
+static void wirePinHandler(uint8_t pin, uint8_t level)
+{
+	Wire.pinChanged(pin, level);
+}
+
+// Constructor
+SimulatedI2CDevice::SimulatedI2CDevice(uint8_t address)
+{
+	SimulatedI2CDevice::DEV_Addr = address;
+}
+
+SimulatedI2CDevice::~SimulatedI2CDevice()
+{
+}
+
+uint8_t SimulatedI2CDevice::getAddress()
+{
+	return SimulatedI2CDevice::DEV_Addr;
+}
+
+SimulatedI2CDevice *SimulatedI2CDevice::route(uint8_t address)
+{
+	return address == SimulatedI2CDevice::DEV_Addr ? this : NULL;
+}
+
+void SimulatedI2CDevice::advance(uint64_t now)
+{
+	(void)now;
+}
+
+// Constructor
+TwoWire::TwoWire()
+{
+	for (uint8_t i = 0; i < WIRE_MAX_DEVICES; i++)
+		TwoWire::WIRE_Devices[i] = NULL;
+	TwoWire::WIRE_Clock = 100000;
+	TwoWire::WIRE_TxAddr = 0;
+	TwoWire::WIRE_TxLength = 0;
+	TwoWire::WIRE_RxLength = 0;
+	TwoWire::WIRE_RxIndex = 0;
+	TwoWire::WIRE_Timeout = 0;
+	TwoWire::WIRE_TimeoutFlag = false;
+	TwoWire::WIRE_InjectedNacks = 0;
+	TwoWire::WIRE_HoldClocks = 0;
+	TwoWire::resetStats();
+}
+
+void TwoWire::begin()
+{
+}
+
+void TwoWire::begin(uint8_t address)
+{
+	(void)address;
+}
+
+void TwoWire::begin(int address)
+{
+	(void)address;
+}
+
+void TwoWire::end()
+{
+}
+
+void TwoWire::setClock(uint32_t clock)
+{
+	TwoWire::WIRE_Clock = clock;
+}
+
+uint32_t TwoWire::getClock()
+{
+	return TwoWire::WIRE_Clock;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+	TwoWire::WIRE_TxAddr = address;
+	TwoWire::WIRE_TxLength = 0;
+}
+
+void TwoWire::beginTransmission(int address)
+{
+	TwoWire::beginTransmission((uint8_t)address);
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+	if (TwoWire::WIRE_TxLength >= BUFFER_LENGTH)
+		return 0;
+	TwoWire::WIRE_TxBuffer[TwoWire::WIRE_TxLength++] = data;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+	for (size_t i = 0; i < quantity; i++)
+		if (!TwoWire::write(data[i]))
+			return i;
+	return quantity;
+}
+
+// Returns 0 on success, 2 on a NACK of the address and 5 on a timeout, as the AVR Wire library
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+	(void)sendStop;
+	TwoWire::WIRE_Stats.writes++;
+	if (TwoWire::stalled())
+	{
+		TwoWire::WIRE_TxLength = 0;
+		return TwoWire::WIRE_Timeout != 0 ? 5 : 4;
+	}
+	SimulatedI2CDevice *device = TwoWire::findDevice(TwoWire::WIRE_TxAddr);
+	if (TwoWire::WIRE_InjectedNacks > 0)
+	{
+		TwoWire::WIRE_InjectedNacks--;
+		device = NULL;
+	}
+	if (device == NULL || !device->receive(TwoWire::WIRE_TxBuffer, TwoWire::WIRE_TxLength))
+	{
+		TwoWire::account(0, false);
+		TwoWire::WIRE_TxLength = 0;
+		return 2;
+	}
+	TwoWire::WIRE_Stats.bytesWritten += TwoWire::WIRE_TxLength;
+	TwoWire::account(TwoWire::WIRE_TxLength, true);
+	TwoWire::WIRE_TxLength = 0;
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(int address, int quantity, int sendStop)
+{
+	(void)sendStop;
+	if (quantity > BUFFER_LENGTH)
+		quantity = BUFFER_LENGTH;
+	TwoWire::WIRE_RxIndex = 0;
+	TwoWire::WIRE_RxLength = 0;
+	TwoWire::WIRE_Stats.reads++;
+	if (TwoWire::stalled())
+		return 0;
+	SimulatedI2CDevice *device = TwoWire::findDevice((uint8_t)address);
+	if (TwoWire::WIRE_InjectedNacks > 0)
+	{
+		TwoWire::WIRE_InjectedNacks--;
+		device = NULL;
+	}
+	if (device == NULL || quantity <= 0)
+	{
+		TwoWire::account(0, false);
+		return 0;
+	}
+	TwoWire::WIRE_RxLength = device->request(TwoWire::WIRE_RxBuffer, (uint8_t)quantity);
+	TwoWire::WIRE_Stats.bytesRead += TwoWire::WIRE_RxLength;
+	TwoWire::account(TwoWire::WIRE_RxLength, true);
+	return TwoWire::WIRE_RxLength;
+}
+
+int TwoWire::available()
+{
+	return TwoWire::WIRE_RxLength - TwoWire::WIRE_RxIndex;
+}
+
+int TwoWire::read()
+{
+	if (TwoWire::WIRE_RxIndex >= TwoWire::WIRE_RxLength)
+		return -1;
+	return TwoWire::WIRE_RxBuffer[TwoWire::WIRE_RxIndex++];
+}
+
+int TwoWire::peek()
+{
+	if (TwoWire::WIRE_RxIndex >= TwoWire::WIRE_RxLength)
+		return -1;
+	return TwoWire::WIRE_RxBuffer[TwoWire::WIRE_RxIndex];
+}
+
+// The simulated bus has no hardware to reset, reset_with_timeout is ignored
+void TwoWire::setWireTimeout(uint32_t timeout, bool reset_with_timeout)
+{
+	(void)reset_with_timeout;
+	TwoWire::WIRE_Timeout = timeout;
+}
+
+bool TwoWire::getWireTimeoutFlag()
+{
+	return TwoWire::WIRE_TimeoutFlag;
+}
+
+void TwoWire::clearWireTimeoutFlag()
+{
+	TwoWire::WIRE_TimeoutFlag = false;
+}
+
+void TwoWire::injectNacks(uint8_t count)
+{
+	TwoWire::WIRE_InjectedNacks = count;
+}
+
+void TwoWire::holdBus(uint8_t clocks)
+{
+	if (this == &Wire)
+		hostAddPinHandler(wirePinHandler);
+	TwoWire::WIRE_HoldClocks = clocks;
+	hostHoldPin(PIN_WIRE_SDA, clocks != 0);
+}
+
+// The device lets go of SDA once it has seen enough rising edges of SCL
+void TwoWire::pinChanged(uint8_t pin, uint8_t level)
+{
+	if (pin != PIN_WIRE_SCL || level != HIGH || TwoWire::WIRE_HoldClocks == 0)
+		return;
+	if (--TwoWire::WIRE_HoldClocks == 0)
+		hostHoldPin(PIN_WIRE_SDA, false);
+}
+
+// Fail a transaction on a held bus
+bool TwoWire::stalled()
+{
+	if (TwoWire::WIRE_HoldClocks == 0)
+		return false;
+	TwoWire::WIRE_Stats.transactions++;
+	TwoWire::WIRE_Stats.timeouts++;
+	TwoWire::WIRE_TimeoutFlag = TwoWire::WIRE_Timeout != 0;
+
+	/* Without a timeout the AVR core hangs for good, the simulation gives up after a second */
+	uint32_t timeout = TwoWire::WIRE_Timeout != 0 ? TwoWire::WIRE_Timeout : 1000000;
+	hostAdvanceNanos((uint64_t)timeout * 1000);
+	return true;
+}
+
+bool TwoWire::attachDevice(SimulatedI2CDevice *device)
+{
+	if (this == &Wire)
+		hostAddTimeHandler(wireTimeHandler);
+	for (uint8_t i = 0; i < WIRE_MAX_DEVICES; i++)
+	{
+		if (TwoWire::WIRE_Devices[i] == NULL)
+		{
+			TwoWire::WIRE_Devices[i] = device;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TwoWire::detachDevice(SimulatedI2CDevice *device)
+{
+	for (uint8_t i = 0; i < WIRE_MAX_DEVICES; i++)
+		if (TwoWire::WIRE_Devices[i] == device)
+			TwoWire::WIRE_Devices[i] = NULL;
+}
+
+SimulatedI2CDevice *TwoWire::findDevice(uint8_t address)
+{
+	for (uint8_t i = 0; i < WIRE_MAX_DEVICES; i++)
+	{
+		if (TwoWire::WIRE_Devices[i] == NULL)
+			continue;
+		SimulatedI2CDevice *device = TwoWire::WIRE_Devices[i]->route(address);
+		if (device != NULL)
+			return device;
+	}
+	return NULL;
+}
+
+// Count a transaction and let its time on the wire pass
+void TwoWire::account(uint8_t bytes, bool ack)
+{
+	TwoWire::WIRE_Stats.transactions++;
+	if (!ack)
+		TwoWire::WIRE_Stats.nacks++;
+
+	/* Start, address and data bytes with their acknowledge bit, stop */
+	uint32_t bits = 1 + 9 * (1 + bytes) + 1;
+	uint64_t ns = (uint64_t)bits * 1000000000 / TwoWire::WIRE_Clock;
+	TwoWire::WIRE_Stats.busNanos += ns;
+	hostAdvanceNanos(ns);
+}
+
+WireStats TwoWire::getStats()
+{
+	return TwoWire::WIRE_Stats;
+}
+
+void TwoWire::resetStats()
+{
+	memset(&(TwoWire::WIRE_Stats), 0, sizeof(WireStats));
+}
+
+void TwoWire::advance(uint64_t now)
+{
+	for (uint8_t i = 0; i < WIRE_MAX_DEVICES; i++)
+		if (TwoWire::WIRE_Devices[i] != NULL)
+			TwoWire::WIRE_Devices[i]->advance(now);
+}
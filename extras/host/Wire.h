@@ -0,0 +1,270 @@
+/*
+ *  Wire stand-in for building SimpleIMU on a PC
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Transactions are passed to simulated devices attached to the bus. Every
+ *  transaction and byte is counted and the time it takes on the wire at
+ *  the configured clock is added to the simulated time. Faults can be
+ *  injected: NACKed transactions and a device holding SDA low until the
+ *  master clocks SCL by hand, which ends in the timeout of the AVR core.
+ */
+
+#ifndef SIMPLEIMU_HOST_WIRE_H
+#define SIMPLEIMU_HOST_WIRE_H
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32
+
+/* The pins of the bus, as on the Arduino Mega */
+#define PIN_WIRE_SDA 20
+#define PIN_WIRE_SCL 21
+
+/* setWireTimeout and the timeout flag are provided, as in the AVR core */
+#define WIRE_HAS_TIMEOUT 1
+
+/* Maximum number of devices on one simulated bus */
+#define WIRE_MAX_DEVICES 8
+
+/* Device on the simulated bus */
+class SimulatedI2CDevice
+{
+private:
+	/* The 7 bit address of the device */
+	uint8_t DEV_Addr;
+
+public:
+	/*
+	 * Constructor for SimulatedI2CDevice object.
+	 *
+	 * params: address, 7 bit I2C address of the device
+	 * returns: SimulatedI2CDevice object
+	 */
+	SimulatedI2CDevice(uint8_t address);
+
+	virtual ~SimulatedI2CDevice();
+
+	/*
+	 * Function to get the address of the device.
+	 *
+	 * params: None
+	 * returns: uint8_t, the 7 bit address
+	 */
+	uint8_t getAddress();
+
+	/*
+	 * Function to handle a write transaction.
+	 *
+	 * params: data, the bytes written by the master
+	 * 		   length, number of bytes
+	 * returns: bool, false to NACK the transaction
+	 */
+	virtual bool receive(const uint8_t *data, uint8_t length) = 0;
+
+	/*
+	 * Function to handle a read transaction.
+	 *
+	 * params: data, array to store the bytes sent to the master
+	 * 		   length, number of bytes requested
+	 * returns: uint8_t, number of bytes sent
+	 */
+	virtual uint8_t request(uint8_t *data, uint8_t length) = 0;
+
+	/*
+	 * Function to find the device answering an address through this device.
+	 * Bus switches override it to reach the devices behind them.
+	 *
+	 * params: address, the 7 bit address
+	 * returns: SimulatedI2CDevice*, the device or NULL
+	 */
+	virtual SimulatedI2CDevice *route(uint8_t address);
+
+	/*
+	 * Function to let the device catch up with the simulated time.
+	 *
+	 * params: now, the time in nanoseconds
+	 * returns: None
+	 */
+	virtual void advance(uint64_t now);
+};
+
+/* Bus traffic counters */
+typedef struct
+{
+	uint32_t transactions;	/* write and read transactions, including NACKed ones */
+	uint32_t writes;		/* write transactions */
+	uint32_t reads;			/* read transactions */
+	uint32_t nacks;			/* transactions not acknowledged */
+	uint32_t timeouts;		/* transactions that timed out on a held bus */
+	uint64_t bytesWritten;	/* data bytes from master to device, without address bytes */
+	uint64_t bytesRead;		/* data bytes from device to master */
+	uint64_t busNanos;		/* time on the wire at the configured clock */
+} WireStats;
+
+class TwoWire
+{
+private:
+	/* The devices on the bus */
+	SimulatedI2CDevice *WIRE_Devices[WIRE_MAX_DEVICES];
+
+	/* The bus clock in Hz */
+	uint32_t WIRE_Clock;
+
+	/* The address of the transmission in progress */
+	uint8_t WIRE_TxAddr;
+
+	/* The bytes of the transmission in progress */
+	uint8_t WIRE_TxBuffer[BUFFER_LENGTH];
+	uint8_t WIRE_TxLength;
+
+	/* The bytes received by the last requestFrom */
+	uint8_t WIRE_RxBuffer[BUFFER_LENGTH];
+	uint8_t WIRE_RxLength;
+	uint8_t WIRE_RxIndex;
+
+	/* The bus traffic so far */
+	WireStats WIRE_Stats;
+
+	/* The transaction timeout in micros, 0 to wait forever */
+	uint32_t WIRE_Timeout;
+
+	/* Whether a transaction timed out since the flag was cleared */
+	bool WIRE_TimeoutFlag;
+
+	/* The number of transactions still to be NACKed */
+	uint8_t WIRE_InjectedNacks;
+
+	/* The SCL clocks until the device holding SDA lets go, 0 when free */
+	uint8_t WIRE_HoldClocks;
+
+	/*
+	 * Function to find the device at an address.
+	 *
+	 * params: address, the 7 bit address
+	 * returns: SimulatedI2CDevice*, the device or NULL
+	 */
+	SimulatedI2CDevice *findDevice(uint8_t address);
+
+	/*
+	 * Function to count a transaction and let its time pass.
+	 *
+	 * params: bytes, number of data bytes, without the address byte
+	 * 		   ack, whether the device acknowledged
+	 * returns: None
+	 */
+	void account(uint8_t bytes, bool ack);
+
+	/*
+	 * Function to fail a transaction on a held bus, after the timeout.
+	 *
+	 * params: None
+	 * returns: bool, true if the bus is held and the transaction failed
+	 */
+	bool stalled();
+
+public:
+	TwoWire();
+
+	void begin();
+	void begin(uint8_t address);
+	void begin(int address);
+	void end();
+	void setClock(uint32_t clock);
+	void beginTransmission(uint8_t address);
+	void beginTransmission(int address);
+	uint8_t endTransmission(bool sendStop = true);
+	uint8_t requestFrom(int address, int quantity, int sendStop = 1);
+	size_t write(uint8_t data);
+	size_t write(const uint8_t *data, size_t quantity);
+	int available();
+	int read();
+	int peek();
+	void setWireTimeout(uint32_t timeout = 25000, bool reset_with_timeout = false);
+	bool getWireTimeoutFlag();
+	void clearWireTimeoutFlag();
+
+	/*
+	 * Function to put a simulated device on the bus.
+	 *
+	 * params: device, pointer to the device, has to outlive the bus
+	 * returns: bool, true if attached, false if the bus is full
+	 */
+	bool attachDevice(SimulatedI2CDevice *device);
+
+	/*
+	 * Function to remove a simulated device from the bus.
+	 *
+	 * params: device, pointer to the device
+	 * returns: None
+	 */
+	void detachDevice(SimulatedI2CDevice *device);
+
+	/*
+	 * Function to get the bus clock.
+	 *
+	 * params: None
+	 * returns: uint32_t, the clock in Hz
+	 */
+	uint32_t getClock();
+
+	/*
+	 * Function to get the bus traffic since the last resetStats.
+	 *
+	 * params: None
+	 * returns: WireStats, the counters
+	 */
+	WireStats getStats();
+
+	/*
+	 * Function to clear the bus traffic counters.
+	 *
+	 * params: None
+	 * returns: None
+	 */
+	void resetStats();
+
+	/*
+	 * Function to NACK the next transactions, as a device busy or
+	 * disturbed by noise does.
+	 *
+	 * params: count, number of transactions to NACK
+	 * returns: None
+	 */
+	void injectNacks(uint8_t count);
+
+	/*
+	 * Function to let a device hold SDA low, as after a reset of the master
+	 * in the middle of a read. Every transaction then times out until SCL
+	 * has been clocked by hand the given number of times.
+	 *
+	 * params: clocks, number of SCL pulses until SDA is released, 0 to release now
+	 * returns: None
+	 */
+	void holdBus(uint8_t clocks);
+
+	/*
+	 * Function to follow a bus pin driven by hand. Called by the pin
+	 * handler of the default bus.
+	 *
+	 * params: pin, the pin that changed
+	 * 		   level, the new level
+	 * returns: None
+	 */
+	void pinChanged(uint8_t pin, uint8_t level);
+
+	/*
+	 * Function to let all devices catch up with the simulated time.
+	 *
+	 * params: now, the time in nanoseconds
+	 * returns: None
+	 */
+	void advance(uint64_t now);
+};
+
+extern TwoWire Wire;
+
+#endif /* SIMPLEIMU_HOST_WIRE_H */
@@ -0,0 +1,603 @@
+/*
+ *  Bus and CPU cost of the SimpleIMU API against a simulated MPU6050
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Every benchmark runs at 100 kHz and 400 kHz and reports, per call or per
+ *  sample, the I2C transactions, the bytes written and read, the modeled bus
+ *  time at both clocks and the host CPU time. The output is CSV.
+ *
+ *  usage: benchmark [--baseline file] [--cpu-tolerance fraction]
+ *
+ *  With a baseline, the exit status is 1 when a bus cost is more than 1%
+ *  above the baseline or a benchmark of the baseline is missing. CPU time
+ *  depends on the host, it is only checked when a tolerance is given.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Fusion.h>
+#include <SimpleIMU_Filter.h>
+#include <SimulatedMPU6050.h>
+#include <SimpleIMU_MPU6050.h>
+
+#define BENCH_INT_PIN 2
+#define BENCH_MAX_RESULTS 64
+#define BENCH_BUS_TOLERANCE 0.01
+
+typedef struct
+{
+	char name[32];
+	char unit[8];
+	double transactions;
+	double bytesWritten;
+	double bytesRead;
+	double busMicros100k;
+	double busMicros400k;
+	double cpuNanos;
+} BenchResult;
+
+typedef struct
+{
+	const char *name;
+	const char *unit;
+	void (*setup)();
+	uint32_t (*body)();
+} Benchmark;
+
+static SimulatedMPU6050 *sensor;
+static SimpleIMU *mpu;
+static SimpleIMU_Fusion fusion;
+static SimpleIMU_Filter filterQ15(3, IMU_FILTER_Q15);
+static SimpleIMU_Filter filterFloat(3, IMU_FILTER_FLOAT);
+static int16_t firTaps[16];
+static int16_t firHistory[3 * 16];
+static IMUSample samples[32];
+static int16_t rawData[7][32];
+static float scaledData[7][32];
+static IMURawBlock rawBlock = {{rawData[0], rawData[1], rawData[2]}, {rawData[4], rawData[5], rawData[6]}, rawData[3], 32, 0};
+static IMUSampleBlock scaledBlock = {{scaledData[0], scaledData[1], scaledData[2]}, {scaledData[4], scaledData[5], scaledData[6]}, scaledData[3], 32, 0};
+static uint8_t frameData[32 * 14];
+static BenchResult results[BENCH_MAX_RESULTS];
+static int resultCount = 0;
+
+/* Registers held in memory, readMotion on them times the decode and scale without the bus */
+class BenchMemoryBus : public SimpleIMU_Transport
+{
+public:
+	uint8_t regs[128];
+
+	uint8_t writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length)
+	{
+		(void)address;
+		if (reg + length > sizeof(regs))
+			return IMU_ERROR_ARGUMENT;
+		memcpy(&regs[reg], data, length);
+		return IMU_OK;
+	}
+
+	uint8_t readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length)
+	{
+		(void)address;
+		if (reg + length > sizeof(regs))
+			return IMU_ERROR_ARGUMENT;
+		memcpy(data, &regs[reg], length);
+		return IMU_OK;
+	}
+	using SimpleIMU_Transport::readRegisters;
+
+	uint16_t getMaxTransfer()
+	{
+		return sizeof(regs);
+	}
+};
+
+static BenchMemoryBus memoryBus;
+static SimpleIMU memoryIMU(0x68, &memoryBus);
+
+// Host CPU time of the process in nanoseconds
+static uint64_t cpuNanos()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t benchInit()
+{
+	for (int i = 0; i < 20; i++)
+		mpu->init();
+	return 20;
+}
+
+static uint32_t benchSetGyroRange()
+{
+	for (int i = 0; i < 1000; i++)
+		mpu->setGyroRange(i & 3);
+	mpu->setGyroRange(0);
+	return 1000;
+}
+
+static uint32_t benchSetAccelRange()
+{
+	for (int i = 0; i < 1000; i++)
+		mpu->setAccelRange(i & 3);
+	mpu->setAccelRange(0);
+	return 1000;
+}
+
+static uint32_t benchSetSampleRateDivider()
+{
+	for (int i = 0; i < 1000; i++)
+		mpu->setSampleRateDivider(i & 7);
+	mpu->setSampleRateDivider(0);
+	return 1000;
+}
+
+static uint32_t benchSetDLPFMode()
+{
+	for (int i = 0; i < 1000; i++)
+		mpu->setDLPFMode(1 + (i & 3));
+	mpu->setDLPFMode(1);
+	return 1000;
+}
+
+static uint32_t benchConfigBatch()
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		mpu->beginConfig();
+		mpu->setGyroRange(i & 3);
+		mpu->setAccelRange(i & 3);
+		mpu->setSampleRateDivider(i & 7);
+		mpu->setDLPFMode(1 + (i & 3));
+		mpu->commitConfig();
+	}
+	mpu->beginConfig();
+	mpu->setGyroRange(0);
+	mpu->setAccelRange(0);
+	mpu->setSampleRateDivider(0);
+	mpu->setDLPFMode(1);
+	mpu->commitConfig();
+	return 1000;
+}
+
+static uint32_t benchCalibGyro()
+{
+	for (int i = 0; i < 5; i++)
+		mpu->calibGyro();
+	return 5;
+}
+
+static uint32_t benchCalibAccel()
+{
+	for (int i = 0; i < 5; i++)
+		mpu->calibAccel();
+	return 5;
+}
+
+static uint32_t benchApplyHardwareOffsets()
+{
+	for (int i = 0; i < 100; i++)
+		mpu->applyHardwareOffsets();
+	return 100;
+}
+
+static uint32_t benchReadGyro()
+{
+	GyroData gyro;
+	for (int i = 0; i < 10000; i++)
+		mpu->readGyro(&gyro);
+	return 10000;
+}
+
+static uint32_t benchReadAccel()
+{
+	AccelData accel;
+	for (int i = 0; i < 10000; i++)
+		mpu->readAccel(&accel);
+	return 10000;
+}
+
+static uint32_t benchReadGyroFixed()
+{
+	GyroDataFixed gyro;
+	for (int i = 0; i < 10000; i++)
+		mpu->readGyroFixed(&gyro);
+	return 10000;
+}
+
+static uint32_t benchReadAccelFixed()
+{
+	AccelDataFixed accel;
+	for (int i = 0; i < 10000; i++)
+		mpu->readAccelFixed(&accel);
+	return 10000;
+}
+
+static uint32_t benchReadMotion()
+{
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	for (int i = 0; i < 10000; i++)
+		mpu->readMotion(&accel, &gyro, &temp);
+	return 10000;
+}
+
+static uint32_t benchReadMotionFixed()
+{
+	AccelDataFixed accel;
+	GyroDataFixed gyro;
+	int16_t temp;
+	for (int i = 0; i < 10000; i++)
+		mpu->readMotionFixed(&accel, &gyro, &temp);
+	return 10000;
+}
+
+static uint32_t benchReadMotionRaw()
+{
+	IMURawSample raw;
+	for (int i = 0; i < 10000; i++)
+		mpu->readMotionRaw(&raw);
+	return 10000;
+}
+
+static void setupFIFO()
+{
+	mpu->beginFIFO();
+}
+
+/* The FIFO is drained every 16 ms, so the frames per drain do not depend on where the previous benchmark left the clock */
+static uint32_t benchReadFIFO()
+{
+	uint32_t total = 0;
+	while (total < 2000)
+	{
+		delay(16);
+		int count = 32;
+		while (count == 32)
+		{
+			count = mpu->readFIFO(samples, 32);
+			total += count > 0 ? count : 0;
+		}
+	}
+	mpu->endFIFO();
+	return total;
+}
+
+static uint32_t benchReadFIFOBlock()
+{
+	uint32_t total = 0;
+	while (total < 2000)
+	{
+		delay(16);
+		int count = 32;
+		while (count == 32)
+		{
+			rawBlock.count = 0;
+			count = mpu->readFIFOBlock(&rawBlock);
+			total += count > 0 ? count : 0;
+		}
+	}
+	mpu->endFIFO();
+	return total;
+}
+
+static void setupMemoryBus()
+{
+	static const uint8_t burst[14] = {0x12, 0x34, 0xF0, 0x0F, 0x40, 0x00, 0xF5, 0x10, 0x00, 0x83, 0xFF, 0x21, 0x01, 0x9C};
+	memoryBus.regs[MPU6050_IMU::MPU6050_RA_WHO_AM_I] = 0x68;
+	memoryIMU.init();
+	memcpy(&memoryBus.regs[MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H], burst, sizeof(burst));
+}
+
+static uint32_t benchScaleFloat()
+{
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	for (int i = 0; i < 100000; i++)
+		memoryIMU.readMotion(&accel, &gyro, &temp);
+	return 100000;
+}
+
+static uint32_t benchScaleFixed()
+{
+	AccelDataFixed accel;
+	GyroDataFixed gyro;
+	int16_t temp;
+	for (int i = 0; i < 100000; i++)
+		memoryIMU.readMotionFixed(&accel, &gyro, &temp);
+	return 100000;
+}
+
+static void setupScaleBlock()
+{
+	rawBlock.count = 0;
+	mpu->readMotionBlock(&rawBlock, 32);
+}
+
+static uint32_t benchScaleBlock()
+{
+	for (int i = 0; i < 1000; i++)
+		mpu->scaleBlock(&rawBlock, &scaledBlock);
+	return 1000 * scaledBlock.count;
+}
+
+static void setupConvertFrames()
+{
+	for (unsigned int i = 0; i < sizeof(frameData); i++)
+		frameData[i] = i * 7;
+}
+
+static uint32_t benchConvertFrames()
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		scaledBlock.count = 0;
+		mpu->convertFrames(frameData, 32, &scaledBlock);
+	}
+	return 1000 * scaledBlock.count;
+}
+
+static void setupDataReady()
+{
+	mpu->beginDataReady(BENCH_INT_PIN, samples, 32);
+}
+
+static uint32_t benchDataReady()
+{
+	IMUSample sample;
+	uint32_t total = 0;
+	for (int i = 0; i < 1000; i++)
+	{
+		delay(1);
+		while (mpu->updateDataReady())
+			;
+		while (mpu->readSample(&sample))
+			total++;
+	}
+	mpu->endDataReady();
+	return total;
+}
+
+static uint32_t benchFusion()
+{
+	AccelData accel = {0.0f, 4.9f, 8.5f};
+	GyroData gyro = {0.5f, -0.2f, 10.0f};
+	for (int i = 0; i < 100000; i++)
+		fusion.update(&accel, &gyro, 0.001f);
+	return 100000;
+}
+
+static void setupComplementary()
+{
+	fusion.setAlgorithm(IMU_FUSION_COMPLEMENTARY);
+}
+
+static void setupMahony()
+{
+	fusion.setAlgorithm(IMU_FUSION_MAHONY);
+}
+
+static void setupMadgwick()
+{
+	fusion.setAlgorithm(IMU_FUSION_MADGWICK);
+}
+
+static void setupBiquadQ15()
+{
+	filterQ15.setLowPass(50, 1000);
+}
+
+static void setupBiquadFloat()
+{
+	filterFloat.setLowPass(50, 1000);
+}
+
+static void setupFIR()
+{
+	for (int i = 0; i < 16; i++)
+		firTaps[i] = 32768 / 16;
+	filterQ15.setFIR(firTaps, 16, firHistory);
+}
+
+static void setupCIC()
+{
+	filterQ15.setDecimator(8, 3);
+}
+
+static uint32_t benchFilterQ15()
+{
+	int16_t *data[3] = {rawData[0], rawData[1], rawData[2]};
+	for (int i = 0; i < 1000; i++)
+	{
+		for (int n = 0; n < 32; n++)
+			rawData[0][n] = rawData[1][n] = rawData[2][n] = (n * 1021) & 0x3FFF;
+		filterQ15.updateBlock(data, 32);
+	}
+	return 1000 * 32;
+}
+
+static uint32_t benchFilterFloat()
+{
+	float *data[3] = {scaledData[0], scaledData[1], scaledData[2]};
+	for (int i = 0; i < 1000; i++)
+	{
+		for (int n = 0; n < 32; n++)
+			scaledData[0][n] = scaledData[1][n] = scaledData[2][n] = ((n * 1021) & 0x3FFF) / 16384.0f;
+		filterFloat.updateBlock(data, 32);
+	}
+	return 1000 * 32;
+}
+
+static const Benchmark benchmarks[] = {
+	{"init", "call", NULL, benchInit},
+	{"setGyroRange", "call", NULL, benchSetGyroRange},
+	{"setAccelRange", "call", NULL, benchSetAccelRange},
+	{"setSampleRateDivider", "call", NULL, benchSetSampleRateDivider},
+	{"setDLPFMode", "call", NULL, benchSetDLPFMode},
+	{"commitConfig", "call", NULL, benchConfigBatch},
+	{"calibGyro", "call", NULL, benchCalibGyro},
+	{"calibAccel", "call", NULL, benchCalibAccel},
+	{"applyHardwareOffsets", "call", NULL, benchApplyHardwareOffsets},
+	{"readGyro", "sample", NULL, benchReadGyro},
+	{"readAccel", "sample", NULL, benchReadAccel},
+	{"readGyroFixed", "sample", NULL, benchReadGyroFixed},
+	{"readAccelFixed", "sample", NULL, benchReadAccelFixed},
+	{"readMotion", "sample", NULL, benchReadMotion},
+	{"readMotionFixed", "sample", NULL, benchReadMotionFixed},
+	{"readMotionRaw", "sample", NULL, benchReadMotionRaw},
+	{"readFIFO", "sample", setupFIFO, benchReadFIFO},
+	{"readFIFOBlock", "sample", setupFIFO, benchReadFIFOBlock},
+	{"updateDataReady", "sample", setupDataReady, benchDataReady},
+	{"fusion.complementary", "sample", setupComplementary, benchFusion},
+	{"fusion.mahony", "sample", setupMahony, benchFusion},
+	{"fusion.madgwick", "sample", setupMadgwick, benchFusion},
+	{"scaleBlock", "sample", setupScaleBlock, benchScaleBlock},
+	{"convertFrames", "sample", setupConvertFrames, benchConvertFrames},
+	{"filter.biquad.q15", "sample", setupBiquadQ15, benchFilterQ15},
+	{"filter.biquad.float", "sample", setupBiquadFloat, benchFilterFloat},
+	{"filter.fir.q15", "sample", setupFIR, benchFilterQ15},
+	{"filter.cic.q15", "sample", setupCIC, benchFilterQ15},
+	{"scale.float", "sample", setupMemoryBus, benchScaleFloat},
+	{"scale.fixed", "sample", setupMemoryBus, benchScaleFixed},
+};
+
+// Run a benchmark at both bus clocks
+static void run(const Benchmark *bench)
+{
+	const uint32_t clocks[2] = {100000, 400000};
+	BenchResult *result = &results[resultCount++];
+	memset(result, 0, sizeof(BenchResult));
+	snprintf(result->name, sizeof(result->name), "%s", bench->name);
+	snprintf(result->unit, sizeof(result->unit), "%s", bench->unit);
+	result->cpuNanos = -1;
+
+	for (uint8_t c = 0; c < 2; c++)
+	{
+		Wire.setClock(clocks[c]);
+		if (bench->setup != NULL)
+			bench->setup();
+		Wire.resetStats();
+		uint64_t start = cpuNanos();
+		uint32_t units = bench->body();
+		uint64_t cpu = cpuNanos() - start;
+		WireStats stats = Wire.getStats();
+		if (units == 0)
+			units = 1;
+
+		result->transactions = (double)stats.transactions / units;
+		result->bytesWritten = (double)stats.bytesWritten / units;
+		result->bytesRead = (double)stats.bytesRead / units;
+		if (c == 0)
+			result->busMicros100k = stats.busNanos / 1000.0 / units;
+		else
+			result->busMicros400k = stats.busNanos / 1000.0 / units;
+		if (result->cpuNanos < 0 || (double)cpu / units < result->cpuNanos)
+			result->cpuNanos = (double)cpu / units;
+	}
+}
+
+// Compare with a baseline written by an earlier run, returns number of regressions
+static int compare(const char *path, double cpuTolerance)
+{
+	FILE *file = fopen(path, "r");
+	if (file == NULL)
+	{
+		fprintf(stderr, "cannot open baseline %s\n", path);
+		return 1;
+	}
+
+	int regressions = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		BenchResult base;
+		if (sscanf(line, "%31[^,],%7[^,],%lf,%lf,%lf,%lf,%lf,%lf", base.name, base.unit, &base.transactions,
+				   &base.bytesWritten, &base.bytesRead, &base.busMicros100k, &base.busMicros400k,
+				   &base.cpuNanos) != 8)
+			continue;
+
+		bool found = false;
+		for (int i = 0; i < resultCount; i++)
+		{
+			BenchResult *now = &results[i];
+			if (strcmp(now->name, base.name) != 0)
+				continue;
+			found = true;
+			const char *columns[5] = {"transactions", "bytes_written", "bytes_read", "bus_us_100k", "bus_us_400k"};
+			double was[5] = {base.transactions, base.bytesWritten, base.bytesRead, base.busMicros100k, base.busMicros400k};
+			double is[5] = {now->transactions, now->bytesWritten, now->bytesRead, now->busMicros100k, now->busMicros400k};
+			for (uint8_t c = 0; c < 5; c++)
+			{
+				if (is[c] > was[c] * (1 + BENCH_BUS_TOLERANCE) + 1e-9)
+				{
+					fprintf(stderr, "regression: %s %s %.3f -> %.3f\n", now->name, columns[c], was[c], is[c]);
+					regressions++;
+				}
+			}
+			if (cpuTolerance > 0 && now->cpuNanos > base.cpuNanos * (1 + cpuTolerance))
+			{
+				fprintf(stderr, "regression: %s cpu_ns %.1f -> %.1f\n", now->name, base.cpuNanos, now->cpuNanos);
+				regressions++;
+			}
+		}
+		if (!found)
+		{
+			fprintf(stderr, "missing: %s is in the baseline but was not run\n", base.name);
+			regressions++;
+		}
+	}
+	fclose(file);
+	return regressions;
+}
+
+int main(int argc, char **argv)
+{
+	const char *baseline = NULL;
+	double cpuTolerance = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+			baseline = argv[++i];
+		else if (strcmp(argv[i], "--cpu-tolerance") == 0 && i + 1 < argc)
+			cpuTolerance = atof(argv[++i]);
+		else
+		{
+			fprintf(stderr, "usage: %s [--baseline file] [--cpu-tolerance fraction]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	SimulatedMPU6050 simulated(0x68, BENCH_INT_PIN);
+	SimpleIMU imu(0x68);
+	sensor = &simulated;
+	mpu = &imu;
+	if (!mpu->init())
+	{
+		fprintf(stderr, "MPU initialization failed\n");
+		return 2;
+	}
+	mpu->setDLPFMode(1);
+
+	for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+		run(&benchmarks[i]);
+
+	printf("name,unit,transactions,bytes_written,bytes_read,bus_us_100k,bus_us_400k,cpu_ns\n");
+	for (int i = 0; i < resultCount; i++)
+	{
+		BenchResult *r = &results[i];
+		printf("%s,%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f\n", r->name, r->unit, r->transactions, r->bytesWritten,
+			   r->bytesRead, r->busMicros100k, r->busMicros400k, r->cpuNanos);
+	}
+
+	if (baseline != NULL)
+		return compare(baseline, cpuTolerance) > 0 ? 1 : 0;
+	return 0;
+}
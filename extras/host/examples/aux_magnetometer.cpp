@@ -0,0 +1,83 @@
+/*
+ *  Reads a simulated HMC5883L through the auxiliary I2C master of a simulated MPU6050
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <SimpleIMU.h>
+#include <SimulatedMPU6050.h>
+#include <SimulatedHMC5883L.h>
+
+#define HMC5883L_ADDRESS 0x1E
+
+// Magnetometer data is big endian in X, Z, Y order
+static void printField(const uint8_t *data)
+{
+	int16_t x = (int16_t)(data[0] << 8 | data[1]);
+	int16_t z = (int16_t)(data[2] << 8 | data[3]);
+	int16_t y = (int16_t)(data[4] << 8 | data[5]);
+	printf("mag   %.3f %.3f %.3f gauss\n", x / 1090.0, y / 1090.0, z / 1090.0);
+}
+
+int main()
+{
+	SimulatedMPU6050 simulated(0x68);
+	SimulatedHMC5883L magnetometer;
+	magnetometer.setField(0.22f, -0.05f, 0.41f);
+	simulated.attachAuxDevice(&magnetometer);
+
+	Wire.setClock(400000);
+	SimpleIMU imu(0x68);
+	if (!imu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	imu.setSampleRateDivider(9);
+
+	// Configure the magnetometer once through slave 4, then read it with every sample
+	imu.beginAuxMaster();
+	uint8_t id[3];
+	bool found = imu.readAux(HMC5883L_ADDRESS, 0x0A, &id[0]) && imu.readAux(HMC5883L_ADDRESS, 0x0B, &id[1]) &&
+				 imu.readAux(HMC5883L_ADDRESS, 0x0C, &id[2]);
+	if (!found || id[0] != 'H' || id[1] != '4' || id[2] != '3')
+	{
+		printf("HMC5883L not found\n");
+		return 1;
+	}
+	imu.writeAux(HMC5883L_ADDRESS, 0x00, 0x18); /* 75 Hz output rate */
+	imu.writeAux(HMC5883L_ADDRESS, 0x02, 0x00); /* Continuous measurement */
+	imu.addAuxRead(0, HMC5883L_ADDRESS, 0x03, 6);
+	delay(20);
+
+	// 9 axes in one burst
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	uint8_t aux[IMU_AUX_DATA_SIZE];
+	Wire.resetStats();
+	imu.readMotionAux(&accel, &gyro, &temp, aux);
+	WireStats stats = Wire.getStats();
+	printf("accel %.3f %.3f %.3f m/s^2\n", accel.x, accel.y, accel.z);
+	printf("gyro  %.3f %.3f %.3f deg/s\n", gyro.x, gyro.y, gyro.z);
+	printField(aux + imu.getAuxOffset(0));
+	printf("%lu transactions, %lu bytes read for %u bytes\n", (unsigned long)stats.transactions,
+		   (unsigned long)stats.bytesRead, 14 + imu.getAuxLength());
+
+	// The magnetometer in the FIFO frames
+	imu.beginFIFO(IMU_FIFO_ACCEL | IMU_FIFO_GYRO | IMU_FIFO_AUX);
+	delay(50);
+	IMUSample samples[8];
+	uint8_t fifoAux[8 * IMU_AUX_DATA_SIZE];
+	int n = imu.readFIFO(samples, 8, fifoAux);
+	printf("%d FIFO frames of %u bytes\n", n, imu.getFIFOFrameSize());
+	if (n > 0)
+		printField(fifoAux + (n - 1) * imu.getAuxLength());
+	imu.endFIFO();
+	imu.endAuxMaster();
+	return n > 0 ? 0 : 1;
+}
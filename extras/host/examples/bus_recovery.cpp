@@ -0,0 +1,174 @@
+/*
+ *  Injects bus faults under a simulated MPU6050: NACKs absorbed by the
+ *  retries, a held bus freed by the recovery together with a reset of the
+ *  sensor, and a bus held too long that is reported and freed later. A
+ *  reset under a FIFO with a magnetometer and offset registers is restored
+ *  whole, a reset under the DMP is reported
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_MPU6050.h>
+#include <SimulatedMPU6050.h>
+#include <SimulatedHMC5883L.h>
+
+#define HMC5883L_ADDRESS 0x1E
+
+static const char *errorName(uint8_t status)
+{
+	switch (status)
+	{
+	case IMU_OK:
+		return "OK";
+	case IMU_ERROR_NACK:
+		return "NACK";
+	case IMU_ERROR_SHORT_READ:
+		return "SHORT_READ";
+	case IMU_ERROR_TIMEOUT:
+		return "TIMEOUT";
+	case IMU_ERROR_BUS:
+		return "BUS";
+	case IMU_ERROR_DEVICE:
+		return "DEVICE";
+	default:
+		return "ARGUMENT";
+	}
+}
+
+// Reset the sensor, as in a brown out, and hold the bus for some clocks
+static void resetSensor(uint8_t clocks)
+{
+	Wire.beginTransmission(0x68);
+	Wire.write(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1);
+	Wire.write(1 << MPU6050_IMU::MPU6050_PWR1_DEVICE_RESET_BIT);
+	Wire.endTransmission();
+	if (clocks > 0)
+		Wire.holdBus(clocks);
+}
+
+// Read one sample and print how it went
+static uint8_t readAndReport(SimpleIMU *mpu, const char *name)
+{
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	unsigned long start = micros();
+	uint8_t status = mpu->readMotion(&accel, &gyro, &temp);
+	unsigned long latency = micros() - start;
+	printf("%-12s %-8s %6lu us  retries %u  recoveries %u  errors %u\n", name, errorName(status), latency,
+		   mpu->getRetryCount(), mpu->getRecoveryCount(), mpu->getErrorCount());
+	mpu->resetErrorCounts();
+	return status;
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	SimpleIMU mpu(0x68);
+
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setGyroRange(2);
+	mpu.setSampleRateDivider(9);
+	int failures = 0;
+
+	// A few NACKs, as from noise on the bus, never reach the sketch
+	Wire.injectNacks(IMU_RETRIES);
+	if (readAndReport(&mpu, "nacks") != IMU_OK)
+		failures++;
+
+	// The sensor browns out and comes back holding SDA low in the middle of a byte
+	resetSensor(9);
+	if (readAndReport(&mpu, "held bus") != IMU_OK)
+		failures++;
+	if (sensor.peekRegister(MPU6050_IMU::MPU6050_RA_GYRO_CONFIG) != 0x10 ||
+		sensor.peekRegister(MPU6050_IMU::MPU6050_RA_SMPLRT_DIV) != 9 || sensor.peekRegister(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1) != 0)
+	{
+		printf("configuration not restored\n");
+		failures++;
+	}
+
+	// Longer than one recovery can clock out, the read fails within a bounded time
+	Wire.holdBus(20);
+	if (readAndReport(&mpu, "stuck bus") != IMU_ERROR_TIMEOUT)
+		failures++;
+	int reads = 1;
+	while (readAndReport(&mpu, "retry later") != IMU_OK && reads < 10)
+		reads++;
+	if (reads >= 10)
+		failures++;
+
+	// The offset registers and the magnetometer behind the auxiliary master come back before the FIFO restarts
+	SimulatedHMC5883L magnetometer;
+	magnetometer.setField(0.22f, -0.05f, 0.41f);
+	sensor.attachAuxDevice(&magnetometer);
+	const float accelBias[3] = {0.0f, 0.0f, 0.0f};
+	const float gyroBias[3] = {3.0f, -2.0f, 1.0f};
+	sensor.setBias(accelBias, gyroBias);
+	mpu.calibGyro();
+	mpu.applyHardwareOffsets();
+	mpu.beginAuxMaster();
+	mpu.writeAux(HMC5883L_ADDRESS, 0x00, 0x18); /* 75 Hz output rate */
+	mpu.writeAux(HMC5883L_ADDRESS, 0x02, 0x00); /* Continuous measurement */
+	mpu.addAuxRead(0, HMC5883L_ADDRESS, 0x03, 6);
+	mpu.beginFIFO(IMU_FIFO_ACCEL | IMU_FIFO_GYRO | IMU_FIFO_AUX);
+	uint8_t before[32];
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		before[i] = sensor.peekRegister(MPU6050_IMU::MPU6050_RA_XG_OFFS_USRH + i);
+		before[6 + i] = sensor.peekRegister(MPU6050_IMU::MPU6050_RA_XA_OFFS_H + i);
+	}
+	for (uint8_t i = 0; i < 3; i++)
+		before[12 + i] = sensor.peekRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV0_ADDR + i);
+	resetSensor(9);
+	if (readAndReport(&mpu, "aux reset") != IMU_OK)
+		failures++;
+	uint8_t restored = 0;
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		restored += sensor.peekRegister(MPU6050_IMU::MPU6050_RA_XG_OFFS_USRH + i) == before[i];
+		restored += sensor.peekRegister(MPU6050_IMU::MPU6050_RA_XA_OFFS_H + i) == before[6 + i];
+	}
+	for (uint8_t i = 0; i < 3; i++)
+		restored += sensor.peekRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV0_ADDR + i) == before[12 + i];
+	restored += (sensor.peekRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL) >> MPU6050_IMU::MPU6050_USERCTRL_I2C_MST_EN_BIT) & 1;
+	delay(20);
+	IMUSample samples[8];
+	uint8_t aux[8 * IMU_AUX_DATA_SIZE];
+	int n = mpu.readFIFO(samples, 8, aux);
+	int16_t fieldX = n > 0 ? (int16_t)(aux[(n - 1) * 6] << 8 | aux[(n - 1) * 6 + 1]) : 0;
+	float drift = n > 0 ? fabsf(samples[n - 1].gyro.x) + fabsf(samples[n - 1].gyro.y) + fabsf(samples[n - 1].gyro.z) : 0;
+	printf("%u of 16 registers restored, %d FIFO frames, field x %d counts, gyro %.2f deg/s\n", restored, n, fieldX, drift);
+	if (restored != 16 || n <= 0 || abs(fieldX - 240) > 2 || drift > 0.5f)
+	{
+		printf("auxiliary master or offsets not restored\n");
+		failures++;
+	}
+	mpu.endFIFO();
+	mpu.endAuxMaster();
+
+	// The DMP firmware is not cached, a reset under it is reported and the DMP stopped
+	static const uint8_t image[64] = {0};
+	float q[4];
+	bool started = mpu.beginDMP(image, sizeof(image), NULL, 0, IMU_DMP_PACKET_SIZE, false);
+	resetSensor(0);
+	uint8_t status = mpu.recover();
+	printf("DMP reset     %-8s\n", errorName(status));
+	if (!started || status != IMU_ERROR_DEVICE || mpu.readDMPQuaternion(q) != 0)
+		failures++;
+
+	WireStats stats = Wire.getStats();
+	printf("%lu transactions, %lu NACKed, %lu timed out\n", (unsigned long)stats.transactions, (unsigned long)stats.nacks,
+		   (unsigned long)stats.timeouts);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+/*
+ *  Calibrates the gyroscope of a simulated MPU6050 without blocking, with
+ *  the clock of the IMU a few percent slow and fast and with a noisy bus
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Every sample of the IMU has to be taken once: a repeated sample shows
+ *  as fewer samples produced than accepted, a skipped one as more.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Calibrator.h>
+#include <SimpleIMU_MPU6050.h>
+#include <SimulatedMPU6050.h>
+
+#define SAMPLES 200
+
+// Calibrate, NACKing a transaction every nackEvery polls, and report the samples produced and the rate left at rest
+static int calibrate(SimulatedMPU6050 *sensor, SimpleIMU *mpu, const char *name, float ppm, int nackEvery)
+{
+	sensor->setClockError(ppm);
+	SimpleIMU_Calibrator calibrator(mpu);
+	calibrator.begin(IMU_CALIB_GYRO, SAMPLES, 20);
+	uint32_t start = sensor->getSampleCount();
+	int polls = 0;
+	while (calibrator.poll() == IMU_CALIB_RUNNING && polls < 1000000)
+	{
+		if (nackEvery > 0 && ++polls % nackEvery == 0)
+			Wire.injectNacks(IMU_RETRIES + 1);
+		delayMicroseconds(20);
+	}
+	uint32_t produced = sensor->getSampleCount() - start;
+
+	AccelData a;
+	GyroData g;
+	float temp;
+	delay(10);
+	mpu->readMotion(&a, &g, &temp);
+	float rate = fabsf(g.x) + fabsf(g.y) + fabsf(g.z);
+	printf("%-12s %u accepted, %lu produced, %u windows rejected, gyro %.3f deg/s\n", name, calibrator.getSampleCount(),
+		   (unsigned long)produced, calibrator.getRejectedWindows(), rate);
+
+	int failures = 0;
+	if (calibrator.getState() != IMU_CALIB_DONE || rate > 0.2f)
+	{
+		printf("calibration did not converge\n");
+		failures++;
+	}
+	if (nackEvery == 0 && (produced < SAMPLES - 1 || produced > SAMPLES + 2))
+	{
+		printf("samples repeated or skipped\n");
+		failures++;
+	}
+	return failures;
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	SimpleIMU mpu(0x68);
+	const float accelBias[3] = {0.0f, 0.0f, 0.0f};
+	const float gyroBias[3] = {1.5f, -0.8f, 0.4f};
+	sensor.setBias(accelBias, gyroBias);
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setDLPFMode(MPU6050_IMU::MPU6050_DLPF_BW_42);
+	mpu.setSampleRateDivider(9);
+
+	int failures = 0;
+	failures += calibrate(&sensor, &mpu, "slow clock", 50000, 0);
+	failures += calibrate(&sensor, &mpu, "fast clock", -50000, 0);
+	failures += calibrate(&sensor, &mpu, "noisy bus", 0, 7);
+	return failures == 0 ? 0 : 1;
+}
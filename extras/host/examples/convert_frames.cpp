@@ -0,0 +1,154 @@
+/*
+ *  Checks every conversion kernel of the host against the scalar reference
+ *  on random frames of every size, then converts a large block of 14 byte
+ *  frames with each of them and prints the throughput
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Convert.h>
+#include <SimulatedMPU6050.h>
+
+#define CHECK_FRAMES 1000
+#define SPEED_FRAMES 1000000
+
+static const char *kernelNames[] = {"scalar", "sse2", "avx2", "neon"};
+
+// Wall time in nanoseconds
+static uint64_t nanos()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Compare a kernel with the reference on every frame size and alignment, returns the mismatches
+static int check(uint8_t kernel)
+{
+	static uint8_t frames[CHECK_FRAMES * IMU_FIFO_MAX_FRAME + 1];
+	static float expected[IMU_FIFO_MAX_FRAME / 2][CHECK_FRAMES];
+	static float actual[IMU_FIFO_MAX_FRAME / 2][CHECK_FRAMES];
+	int mismatches = 0;
+	for (uint8_t frameSize = 2; frameSize <= IMU_FIFO_MAX_FRAME; frameSize += 2)
+	{
+		for (uint8_t align = 0; align < 2; align++)
+		{
+			/* Every count up to a few vectors, then a block over several chunks */
+			uint32_t count = frameSize <= 16 ? frameSize + 1 : CHECK_FRAMES;
+			uint8_t channels = frameSize / 2;
+			float bias[IMU_FIFO_MAX_FRAME / 2], scale[IMU_FIFO_MAX_FRAME / 2];
+			float *outExpected[IMU_FIFO_MAX_FRAME / 2], *outActual[IMU_FIFO_MAX_FRAME / 2];
+			for (uint8_t c = 0; c < channels; c++)
+			{
+				bias[c] = (rand() % 65536 - 32768) / 16.0f;
+				scale[c] = (rand() % 1000 + 1) / 65536.0f;
+				outExpected[c] = expected[c];
+				outActual[c] = c == 1 ? NULL : actual[c];
+			}
+			for (uint32_t i = 0; i < sizeof(frames); i++)
+				frames[i] = rand();
+			frames[align] = 0x80; /* the extremes of the counts */
+			frames[align + 1] = 0x00;
+			frames[align + frameSize] = 0x7F;
+			frames[align + frameSize + 1] = 0xFF;
+
+			SimpleIMU_SetConvertKernel(kernel);
+			for (uint32_t n = 0; n <= count; n += frameSize <= 16 ? 1 : count)
+			{
+				SimpleIMU_ConvertFramesScalar(frames + align, frameSize, n, channels, bias, scale, outExpected);
+				memset(actual, 0, sizeof(actual));
+				SimpleIMU_ConvertFrames(frames + align, frameSize, n, channels, bias, scale, outActual);
+				for (uint8_t c = 0; c < channels; c++)
+					if (outActual[c] != NULL && memcmp(expected[c], actual[c], n * sizeof(float)) != 0)
+						mismatches++;
+			}
+		}
+	}
+	return mismatches;
+}
+
+int main()
+{
+	srand(1);
+	int failures = 0;
+	uint8_t fastest = SimpleIMU_GetConvertKernel();
+	for (uint8_t kernel = IMU_CONVERT_SCALAR; kernel <= IMU_CONVERT_NEON; kernel++)
+	{
+		if (!SimpleIMU_SetConvertKernel(kernel))
+		{
+			printf("%-6s not available\n", kernelNames[kernel]);
+			continue;
+		}
+		int mismatches = check(kernel);
+		failures += mismatches;
+
+		// Accel, temperature and gyro of a million readMotion bursts
+		static uint8_t frames[SPEED_FRAMES * 14];
+		static float data[7][SPEED_FRAMES];
+		float bias[7] = {0};
+		float scale[7] = {1.0f / 16384, 1.0f / 16384, 1.0f / 16384, 1.0f / 340, 1.0f / 131, 1.0f / 131, 1.0f / 131};
+		float *out[7];
+		for (uint8_t c = 0; c < 7; c++)
+			out[c] = data[c];
+		for (uint32_t i = 0; i < sizeof(frames); i++)
+			frames[i] = i * 7;
+		uint64_t best = 0;
+		for (int run = 0; run < 5; run++)
+		{
+			uint64_t start = nanos();
+			SimpleIMU_ConvertFrames(frames, 14, SPEED_FRAMES, 7, bias, scale, out);
+			uint64_t time = nanos() - start;
+			if (best == 0 || time < best)
+				best = time;
+		}
+		printf("%-6s %s  %6.2f ns/frame  %7.1f MB/s in\n", kernelNames[kernel], mismatches == 0 ? "matches  " : "MISMATCH ",
+			   (double)best / SPEED_FRAMES, sizeof(frames) * 1000.0 / best);
+	}
+	SimpleIMU_SetConvertKernel(fastest);
+
+	// The IMU layout, a block of bursts converted as readMotion scales them
+	SimulatedMPU6050 sensor(0x68);
+	float accel[3] = {0.1f, -0.2f, 0.97f};
+	float gyro[3] = {12.5f, -3.0f, 0.25f};
+	sensor.setMotion(accel, gyro);
+	sensor.setNoise(0, 0);
+	SimpleIMU mpu(0x68);
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	AccelData a;
+	GyroData g;
+	float t;
+	IMURawSample raw;
+	mpu.readMotion(&a, &g, &t);
+	mpu.readMotionRaw(&raw);
+	uint8_t burst[14];
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		burst[2 * i] = raw.accel[i] >> 8;
+		burst[2 * i + 1] = raw.accel[i];
+		burst[8 + 2 * i] = raw.gyro[i] >> 8;
+		burst[8 + 2 * i + 1] = raw.gyro[i];
+	}
+	burst[6] = raw.temp >> 8;
+	burst[7] = raw.temp;
+	float values[7];
+	IMUSampleBlock block = {{&values[0], &values[1], &values[2]}, {&values[4], &values[5], &values[6]}, &values[3], 1, 0, 0, 0};
+	mpu.convertFrames(burst, 1, &block);
+	if (values[0] != a.x || values[1] != a.y || values[2] != a.z || values[4] != g.x || values[5] != g.y || values[6] != g.z)
+	{
+		printf("convertFrames differs from readMotion\n");
+		failures++;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ *  Uploads a dummy DMP image and configuration table into a simulated
+ *  MPU6050 and checks them byte by byte across the memory banks, checks
+ *  that a memory fault fails the verification, and decodes synthetic
+ *  quaternion packets from the FIFO
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  The simulation does not run the DMP, so the packets are put into the
+ *  FIFO by hand as the DMP would write them.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimulatedMPU6050.h>
+#include <SimpleIMU_MPU6050.h>
+
+#define IMAGE_SIZE 1929 /* as the MotionApps 2.0 image, 8 banks of 256 bytes hold 2048 */
+#define PACKET_SIZE IMU_DMP_PACKET_SIZE
+
+static uint8_t image[IMAGE_SIZE];
+
+/* Entries of bank, address, length and bytes as in MotionApps 2.0: blocks, the rate, the interrupts */
+static const uint8_t config[] = {0x03, 0x7B, 0x06, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+								 0x02, 0x16, 0x02, 0x00, 0x01,
+								 0x00, 0x00, 0x00, IMU_DMP_CONFIG_INTERRUPTS,
+								 0x07, 0x46, 0x01, 0x9A};
+
+// A packet with the quaternion in Q30 at its start and filler after it
+static void makePacket(const float *q, uint8_t *packet)
+{
+	for (uint8_t i = 0; i < PACKET_SIZE; i++)
+		packet[i] = 0xA0 + i;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		int32_t value = lround(q[i] * 1073741824.0);
+		packet[4 * i] = (uint32_t)value >> 24;
+		packet[4 * i + 1] = (uint32_t)value >> 16;
+		packet[4 * i + 2] = (uint32_t)value >> 8;
+		packet[4 * i + 3] = value;
+	}
+}
+
+// Print a check and count it if it failed
+static int check(const char *name, bool passed)
+{
+	printf("%-44s %s\n", name, passed ? "ok" : "FAILED");
+	return passed ? 0 : 1;
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	SimpleIMU mpu(0x68);
+	Wire.setClock(400000);
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	for (uint16_t i = 0; i < IMAGE_SIZE; i++)
+		image[i] = (i * 31 + 7) ^ (i >> 8);
+	int failures = 0;
+
+	// The image spans banks 0 to 7, every chunk has to land in its own bank, the table is written over it
+	static uint8_t memory[2048];
+	memcpy(memory, image, IMAGE_SIZE);
+	for (uint16_t i = 0; i < sizeof(config); i += 3 + (config[i + 2] > 0 ? config[i + 2] : 1))
+		memcpy(memory + (config[i] << 8 | config[i + 1]), config + i + 3, config[i + 2]);
+	bool loaded = mpu.beginDMP(image, IMAGE_SIZE, config, sizeof(config), PACKET_SIZE, false);
+	uint16_t wrong = 0;
+	for (uint16_t i = 0; i < 2048; i++)
+		if (sensor.peekMemory(i) != memory[i])
+			wrong++;
+	printf("%u bytes in %u banks, %u wrong\n", IMAGE_SIZE, (IMAGE_SIZE + 255) / 256, wrong);
+	failures += check("image and table uploaded and verified", loaded && wrong == 0);
+
+	// MotionApps 2.0 starts at 0x0300, its interrupts are left on for the packets and the overflow
+	failures += check("program started at 0x0300",
+					  sensor.peekRegister(MPU6050_IMU::MPU6050_RA_DMP_CFG_1) == 0x03 && sensor.peekRegister(MPU6050_IMU::MPU6050_RA_DMP_CFG_2) == 0x00);
+	failures += check("interrupts on packets and overflow", sensor.peekRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE) == 0x12);
+
+	// A packet shorter than the quaternion is refused
+	failures += check("packet shorter than a quaternion refused", !mpu.beginDMP(image, IMAGE_SIZE, config, sizeof(config), 12, false));
+
+	// A table cut short or with an unknown special entry is refused
+	static const uint8_t unknown[] = {0x00, 0x00, 0x00, 0x02};
+	failures += check("truncated table refused", !mpu.beginDMP(image, IMAGE_SIZE, config, sizeof(config) - 1, PACKET_SIZE, false));
+	failures += check("unknown special entry refused", !mpu.beginDMP(image, IMAGE_SIZE, unknown, sizeof(unknown), PACKET_SIZE, false));
+	mpu.beginDMP(image, IMAGE_SIZE, config, sizeof(config), PACKET_SIZE, false);
+
+	// The rate divider sits inside bank 2, away from a chunk boundary, the table set it to 1
+	bool rate = mpu.setDMPOutputRate(4);
+	failures += check("output rate written",
+					  rate && sensor.peekMemory(IMU_DMP_FIFO_RATE_ADDRESS) == 0 && sensor.peekMemory(IMU_DMP_FIFO_RATE_ADDRESS + 1) == 4);
+
+	// A bank select that fails after the retries fails the write, the block would land in the wrong bank
+	Wire.injectNacks(IMU_RETRIES + 1);
+	failures += check("failed bank select fails the output rate", !mpu.setDMPOutputRate(4));
+
+	// Packets are decoded in order, the part of a packet past the Wire buffer is read and dropped
+	float q[4];
+	failures += check("no packet waiting", mpu.readDMPQuaternion(q) == 0);
+	const float expected[2][4] = {{0.70710677f, -0.5f, 0.25f, -0.43301270f}, {-1.0f, 0.0f, 0.99999994f, -0.00001f}};
+	uint8_t packet[PACKET_SIZE];
+	for (uint8_t p = 0; p < 2; p++)
+	{
+		makePacket(expected[p], packet);
+		sensor.pushFIFO(packet, PACKET_SIZE);
+	}
+	float error = 0;
+	int read = 0;
+	while (mpu.readDMPQuaternion(q) == 1)
+	{
+		for (uint8_t i = 0; i < 4 && read < 2; i++)
+			error = fmaxf(error, fabsf(q[i] - expected[read][i]));
+		read++;
+	}
+	printf("%d packets, largest error %g\n", read, error);
+	failures += check("Q30 quaternions decoded", read == 2 && error < 1e-6f && sensor.getFIFOCount() == 0);
+
+	// A full FIFO has lost packets and is reset
+	uint8_t junk[1100];
+	memset(junk, 0x55, sizeof(junk));
+	sensor.pushFIFO(junk, sizeof(junk));
+	failures += check("overflowed FIFO reset", mpu.readDMPQuaternion(q) == -1 && sensor.getFIFOCount() == 0);
+
+	// The overflow is caught by its flag once a packet was taken from the full FIFO
+	sensor.pushFIFO(junk, sizeof(junk));
+	Wire.beginTransmission(0x68);
+	Wire.write(MPU6050_IMU::MPU6050_RA_FIFO_R_W);
+	Wire.endTransmission(false);
+	Wire.requestFrom(0x68, PACKET_SIZE);
+	while (Wire.available())
+		Wire.read();
+	failures += check("overflow flag resets the FIFO", mpu.readDMPQuaternion(q) == -1 && sensor.getFIFOCount() == 0);
+
+	// A byte that does not take its value fails the upload and the rate
+	sensor.setMemoryFault(0x0305);
+	failures += check("memory fault fails the upload", !mpu.beginDMP(image, IMAGE_SIZE, config, sizeof(config), PACKET_SIZE, false));
+	sensor.setMemoryFault(IMU_DMP_FIFO_RATE_ADDRESS + 1);
+	failures += check("memory fault fails the output rate", !mpu.setDMPOutputRate(9));
+	sensor.setMemoryFault(-1);
+	failures += check("image uploaded again once repaired", mpu.beginDMP(image, IMAGE_SIZE, config, sizeof(config), PACKET_SIZE, false));
+
+	// More than the 8 banks hold is refused
+	static uint8_t large[2049];
+	failures += check("image larger than the memory refused", !mpu.beginDMP(large, sizeof(large), config, sizeof(config), PACKET_SIZE, false));
+	return failures == 0 ? 0 : 1;
+}
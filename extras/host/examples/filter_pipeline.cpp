@@ -0,0 +1,155 @@
+/*
+ *  Filters the accelerometer of a simulated MPU6050 sampling at 1 kHz with
+ *  a 40 Hz low pass and a CIC decimator down to 125 Hz, once on the raw
+ *  counts in Q15 and once on the scaled values in float, and checks the
+ *  pass band, the stop band and that both pipelines agree
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Filter.h>
+#include <SimulatedMPU6050.h>
+
+#define BLOCK_SIZE 64
+#define SETTLE_OUTPUTS 125 /* one second at the output rate */
+
+// A 0.5 g tone at 300 Hz on x, a 0.25 g swing at 5 Hz on y and gravity on z
+static void motion(uint64_t now, float *accel, float *gyro, void *context)
+{
+	(void)context;
+	double t = now / 1e9;
+	accel[0] = 0.5f * sin(2 * M_PI * 300 * t);
+	accel[1] = 0.25f * sin(2 * M_PI * 5 * t);
+	accel[2] = 1.0f;
+	gyro[0] = gyro[1] = gyro[2] = 0.0f;
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	sensor.setMotion(motion);
+	sensor.setNoise(0, 0);
+	SimpleIMU mpu(0x68);
+	Wire.setClock(400000);
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(0); /* 1 kHz */
+
+	// The same pipeline in Q15 on the counts, in float on blocks and in float a sample at a time
+	SimpleIMU_Filter lowPassQ15(3, IMU_FILTER_Q15), decimateQ15(3, IMU_FILTER_Q15);
+	SimpleIMU_Filter lowPassFloat(3, IMU_FILTER_FLOAT), decimateFloat(3, IMU_FILTER_FLOAT);
+	SimpleIMU_Filter lowPassSample(3, IMU_FILTER_FLOAT), decimateSample(3, IMU_FILTER_FLOAT);
+	lowPassQ15.setLowPass(40, 1000);
+	decimateQ15.setDecimator(8, 1);
+	lowPassQ15.setNext(&decimateQ15);
+	lowPassFloat.setLowPass(40, 1000);
+	decimateFloat.setDecimator(8, 1);
+	lowPassFloat.setNext(&decimateFloat);
+	lowPassSample.setLowPass(40, 1000);
+	decimateSample.setDecimator(8, 1);
+	lowPassSample.setNext(&decimateSample);
+	if (lowPassQ15.getDecimation() != 8)
+	{
+		printf("Decimation is %u, not 8\n", lowPassQ15.getDecimation());
+		return 1;
+	}
+
+	int16_t raw[7][BLOCK_SIZE];
+	float scaled[7][BLOCK_SIZE];
+	IMURawBlock rawBlock = {{raw[0], raw[1], raw[2]}, {raw[4], raw[5], raw[6]}, NULL, BLOCK_SIZE, 0};
+	IMUSampleBlock block = {{scaled[0], scaled[1], scaled[2]}, {scaled[4], scaled[5], scaled[6]}, NULL, BLOCK_SIZE, 0, 0, 0};
+	int16_t *rawAccel[3] = {raw[0], raw[1], raw[2]};
+	float *scaledAccel[3] = {scaled[0], scaled[1], scaled[2]};
+
+	mpu.beginFIFO(IMU_FIFO_ACCEL);
+	uint32_t inputs = 0, outputs = 0;
+	float low[3] = {1e9f, 1e9f, 1e9f}, high[3] = {-1e9f, -1e9f, -1e9f};
+	float maxDifference = 0.0f, maxSampleDifference = 0.0f;
+	int failures = 0;
+	while (millis() < 5000)
+	{
+		delay(20);
+		rawBlock.count = 0;
+		int count = mpu.readFIFOBlock(&rawBlock);
+		if (count < 0)
+		{
+			printf("FIFO read failed\n");
+			return 1;
+		}
+		inputs += count;
+		mpu.scaleBlock(&rawBlock, &block);
+
+		// A sample at a time first, as the block pipelines write over the inputs
+		float sampleOut[BLOCK_SIZE / 8 + 1][3];
+		uint16_t sampleCount = 0;
+		for (int i = 0; i < count; i++)
+		{
+			AccelData accel = {scaled[0][i], scaled[1][i], scaled[2][i]};
+			if (lowPassSample.update(&accel))
+			{
+				sampleOut[sampleCount][0] = accel.x;
+				sampleOut[sampleCount][1] = accel.y;
+				sampleOut[sampleCount][2] = accel.z;
+				sampleCount++;
+			}
+		}
+		uint16_t q15Count = lowPassQ15.updateBlock(rawAccel, count);
+		uint16_t floatCount = lowPassFloat.updateBlock(scaledAccel, count);
+		if (q15Count != floatCount || sampleCount != floatCount)
+		{
+			printf("Pipelines put out %u, %u and %u samples\n", q15Count, floatCount, sampleCount);
+			return 1;
+		}
+
+		for (uint16_t i = 0; i < floatCount; i++, outputs++)
+		{
+			if (outputs < SETTLE_OUTPUTS)
+				continue;
+			for (uint8_t a = 0; a < 3; a++)
+			{
+				float value = scaled[a][i] / 9.80665f; /* in g */
+				float fixed = raw[a][i] / 16384.0f;
+				if (value < low[a])
+					low[a] = value;
+				if (value > high[a])
+					high[a] = value;
+				if (fabsf(fixed - value) > maxDifference)
+					maxDifference = fabsf(fixed - value);
+				if (fabsf(sampleOut[i][a] - scaled[a][i]) > maxSampleDifference)
+					maxSampleDifference = fabsf(sampleOut[i][a] - scaled[a][i]);
+			}
+		}
+	}
+	mpu.endFIFO();
+
+	printf("inputs %lu  outputs %lu\n", (unsigned long)inputs, (unsigned long)outputs);
+	printf("300 Hz tone    x %+.4f to %+.4f g\n", low[0], high[0]);
+	printf("5 Hz swing     y %+.4f to %+.4f g\n", low[1], high[1]);
+	printf("gravity        z %+.4f to %+.4f g\n", low[2], high[2]);
+	printf("Q15 against float %.5f g, sample against block %.7f m/s^2\n", maxDifference, maxSampleDifference);
+
+	if (outputs * 8 > inputs || outputs * 8 + 8 <= inputs)
+		failures++;
+	/* Two poles at 40 Hz and the sinc of the decimator take 0.5 g at 300 Hz below 5 mg */
+	if (low[0] < -0.005f || high[0] > 0.005f)
+		failures++;
+	/* The 5 Hz swing passes, sampled at 125 Hz its peaks are seen within 1 % */
+	if (fabsf(high[1] - 0.25f) > 0.01f || fabsf(low[1] + 0.25f) > 0.01f)
+		failures++;
+	if (fabsf(low[2] - 1.0f) > 0.005f || fabsf(high[2] - 1.0f) > 0.005f)
+		failures++;
+	if (maxDifference > 0.002f || maxSampleDifference > 1e-5f)
+		failures++;
+	printf("%s\n", failures == 0 ? "passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
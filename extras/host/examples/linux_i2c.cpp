@@ -0,0 +1,105 @@
+/*
+ *  Runs SimpleIMU over the Linux i2c-dev transport against a simulated MPU6050
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  The ioctl is replaced by a function handing the messages to the simulated
+ *  sensor, so the transport runs without a bus. On a board with an MPU6050
+ *  use SimpleIMU_LinuxI2C bus("/dev/i2c-1") and call hostSetRealTime(true).
+ */
+
+#include <stdio.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_LinuxI2C.h>
+#include <SimpleIMU_MPU6050.h>
+#include <SimulatedMPU6050.h>
+
+class FakeI2C : public SimpleIMU_LinuxI2C
+{
+private:
+	SimulatedMPU6050 *FAKE_Sensor;
+
+protected:
+	// Hand the messages of one ioctl to the sensor
+	uint8_t transfer(struct i2c_msg *messages, uint8_t count)
+	{
+		for (uint8_t i = 0; i < count; i++)
+		{
+			if (messages[i].addr != FAKE_Sensor->getAddress())
+				return IMU_ERROR_NACK;
+			if (messages[i].flags & I2C_M_RD)
+				FAKE_Sensor->request(messages[i].buf, messages[i].len);
+			else
+				FAKE_Sensor->receive(messages[i].buf, messages[i].len);
+		}
+		return IMU_OK;
+	}
+
+public:
+	FakeI2C(SimulatedMPU6050 *sensor) : SimpleIMU_LinuxI2C(-1)
+	{
+		FAKE_Sensor = sensor;
+	}
+
+	// There is no device file to open
+	bool begin()
+	{
+		return true;
+	}
+};
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	FakeI2C bus(&sensor);
+	SimpleIMU mpu(0x68, &bus);
+
+	bus.begin();
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.beginConfig();
+	mpu.setGyroRange(1);
+	mpu.setAccelRange(1);
+	mpu.setSampleRateDivider(0);
+	mpu.setDLPFMode(1);
+	mpu.commitConfig();
+	printf("init and configuration: %lu ioctl calls\n", (unsigned long)bus.getTransferCount());
+
+	bus.resetTransferCount();
+	mpu.calibGyro();
+	printf("calibGyro: %lu ioctl calls\n", (unsigned long)bus.getTransferCount());
+
+	bus.resetTransferCount();
+	AccelData accel;
+	GyroData gyro;
+	float temp;
+	for (int i = 0; i < 100; i++)
+		mpu.readMotion(&accel, &gyro, &temp);
+	printf("readMotion: %.2f ioctl calls per sample\n", bus.getTransferCount() / 100.0);
+
+	/* 50 samples of 12 bytes, the FIFO holds 85 */
+	mpu.beginFIFO();
+	delay(50);
+	bus.resetTransferCount();
+	IMUSample samples[64];
+	int total = 0, count;
+	while ((count = mpu.readFIFO(samples, 64)) > 0)
+		total += count;
+	printf("readFIFO: %d samples, %.3f ioctl calls per sample\n", total, (double)bus.getTransferCount() / total);
+
+	/* The largest transfer the bus reports is taken both ways, one byte more is refused */
+	uint16_t maxTransfer = bus.getMaxTransfer();
+	uint8_t block[IMU_LINUX_I2C_MAX_TRANSFER + 1] = {0};
+	bool limits = bus.writeRegisters(0x68, MPU6050_IMU::MPU6050_RA_MEM_R_W, block, maxTransfer) == IMU_OK &&
+				  bus.readRegisters(0x68, MPU6050_IMU::MPU6050_RA_MEM_R_W, block, maxTransfer) == IMU_OK &&
+				  bus.writeRegisters(0x68, MPU6050_IMU::MPU6050_RA_MEM_R_W, block, maxTransfer + 1) == IMU_ERROR_ARGUMENT &&
+				  bus.readRegisters(0x68, MPU6050_IMU::MPU6050_RA_MEM_R_W, block, maxTransfer + 1) == IMU_ERROR_ARGUMENT;
+	printf("transfers of %u bytes: %s\n", maxTransfer, limits ? "ok" : "FAILED");
+	return total > 0 && limits ? 0 : 1;
+}
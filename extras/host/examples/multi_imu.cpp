@@ -0,0 +1,147 @@
+/*
+ *  Reads five simulated MPU6050s as an array: 0x68 and 0x69 on the bus
+ *  itself, and three more behind a TCA9548A, two of them at 0x68 as well
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  Every sensor is tilted its own way, so a sample read from the wrong
+ *  one is caught. The devices on the bus itself are read through the
+ *  upstream transport of the switch, which turns its channels off first;
+ *  the simulated switch lets a connected channel answer in their place.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Array.h>
+#include <SimpleIMU_TCA9548A.h>
+#include <SimulatedMPU6050.h>
+#include <SimulatedTCA9548A.h>
+
+#define SENSORS 5
+#define SETS 1000
+
+int main()
+{
+	// 0x68 and 0x69 on channel 0 of the switch, 0x68 on channel 3, 0x68 and 0x69 on the bus
+	SimulatedTCA9548A simulatedMux(0x70);
+	SimulatedMPU6050 simulated[SENSORS] = {SimulatedMPU6050(0x68, SIM_NO_PIN, NULL), SimulatedMPU6050(0x68, SIM_NO_PIN, NULL),
+										   SimulatedMPU6050(0x69, SIM_NO_PIN, NULL), SimulatedMPU6050(0x68),
+										   SimulatedMPU6050(0x69)};
+	simulatedMux.attachDevice(0, &simulated[0]);
+	simulatedMux.attachDevice(3, &simulated[1]);
+	simulatedMux.attachDevice(0, &simulated[2]);
+	for (int i = 0; i < SENSORS; i++)
+	{
+		const float accel[3] = {0.1f * (i + 1), 0.0f, 1.0f};
+		const float gyro[3] = {0.0f, 0.0f, 0.0f};
+		simulated[i].setMotion(accel, gyro);
+		simulated[i].setSeed(i + 1);
+	}
+
+	Wire.setClock(400000);
+	SimpleIMU_TCA9548A mux(0x70);
+	SimpleIMU imu[SENSORS] = {SimpleIMU(0x68, mux.channel(0)), SimpleIMU(0x68, mux.channel(3)),
+							  SimpleIMU(0x69, mux.channel(0)), SimpleIMU(0x68, mux.upstream()),
+							  SimpleIMU(0x69, mux.upstream())};
+
+	SimpleIMU_Array array;
+	for (int i = 0; i < SENSORS; i++)
+		array.add(&imu[i]);
+	mux.begin();
+	if (!array.begin(0, 1))
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+
+	Wire.resetStats();
+	mux.resetSelectCount();
+	IMUSampleSet set;
+	int sets = 0, wrong = 0;
+	uint32_t widest = 0;
+	while (sets < SETS)
+	{
+		if (!array.poll(&set))
+		{
+			delayMicroseconds(10);
+			continue;
+		}
+		sets++;
+		if (set.spread > widest)
+			widest = set.spread;
+		for (int i = 0; i < set.count; i++)
+			if (fabsf(set.sample[i].accel.x / set.sample[i].accel.z - 0.1f * (i + 1)) > 0.02f)
+				wrong++;
+	}
+	WireStats stats = Wire.getStats();
+	double selects = (double)mux.getSelectCount() / sets;
+	printf("%d sets, %.2f selects and %.2f transactions per set\n", sets, selects, (double)stats.transactions / sets);
+	printf("last set at %lu us, spread %lu us, widest %lu us\n", (unsigned long)set.timestamp,
+		   (unsigned long)set.spread, (unsigned long)widest);
+	for (int i = 0; i < set.count; i++)
+		printf("imu%d at %lu us: accel %6.2f %6.2f %6.2f m/s^2\n", i, (unsigned long)set.sampleTime[i],
+			   set.sample[i].accel.x, set.sample[i].accel.y, set.sample[i].accel.z);
+
+	// A sensor that fails keeps its sample and time, the timestamp and spread cover the others
+	IMUSampleSet before = set;
+	delay(10);
+	Wire.injectNacks(IMU_RETRIES + 1);
+	uint8_t status = array.read(&set);
+	int stale = 0, fresh = 0;
+	uint32_t oldest = 0, newest = 0;
+	uint64_t total = 0;
+	for (int i = 0; i < set.count; i++)
+	{
+		if (set.sampleTime[i] == before.sampleTime[i] && set.sample[i].time == before.sample[i].time)
+		{
+			stale++;
+			continue;
+		}
+		if (fresh == 0 || (int32_t)(set.sampleTime[i] - oldest) < 0)
+			oldest = set.sampleTime[i];
+		if (fresh == 0 || (int32_t)(set.sampleTime[i] - newest) > 0)
+			newest = set.sampleTime[i];
+		total += set.sampleTime[i];
+		fresh++;
+	}
+	uint32_t mean = fresh > 0 ? total / fresh : 0;
+	printf("failed read: %d stale, timestamp %lu us, mean of the others %lu us\n", stale, (unsigned long)set.timestamp,
+		   (unsigned long)mean);
+
+	/*
+	 * Three groups are read per set, channel 0, channel 3 and the bus,
+	 * alternately forwards and backwards, so two selects a set after the
+	 * first. The five bursts of 14 bytes at 400 kHz take about 2 ms.
+	 */
+	int failures = 0;
+	if (sets != SETS || set.count != SENSORS)
+	{
+		printf("%d sets of %u samples\n", sets, set.count);
+		failures++;
+	}
+	if (wrong != 0)
+	{
+		printf("%d samples from the wrong sensor\n", wrong);
+		failures++;
+	}
+	if (selects > 2.01)
+	{
+		printf("more selects than the read order needs\n");
+		failures++;
+	}
+	if (widest > 2500)
+	{
+		printf("the sets are spread too wide\n");
+		failures++;
+	}
+	if (status == IMU_OK || stale != 1 || (uint32_t)(mean - set.timestamp + 1) > 2 || set.spread != newest - oldest)
+	{
+		printf("a failed sample is stamped or counted in the set\n");
+		failures++;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+/*
+ *  Records the bus traffic of a simulated MPU6050 streaming its FIFO at
+ *  1 kHz into a Mahony filter, then replays the recording through the
+ *  same driver and filter, as fast as the host allows and at the pace of
+ *  the recording, and checks that the samples, their times, the learned
+ *  timing and the orientation come out bit for bit the same and that a
+ *  program going another way is caught
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  usage: record_replay [file]
+ *
+ *  The recording is written to the file, record_replay.simr by default.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Fusion.h>
+#include <SimpleIMU_Replay.h>
+#include <SimulatedMPU6050.h>
+
+#define BLOCK_SIZE 16
+#define SECONDS 1
+
+/* What a run produced, compared between the runs */
+typedef struct
+{
+	uint32_t samples;
+	uint32_t hash;
+	float q[4];
+} RunResult;
+
+// A 0.5 Hz sway of 0.3 g and a slow turn
+static void motion(uint64_t now, float *accel, float *gyro, void *context)
+{
+	(void)context;
+	double t = now / 1e9;
+	accel[0] = 0.3f * sin(M_PI * t);
+	accel[1] = 0.1f * cos(M_PI * t);
+	accel[2] = 1.0f;
+	gyro[0] = 20.0f * cos(M_PI * t);
+	gyro[1] = 0.0f;
+	gyro[2] = 5.0f;
+}
+
+// Fold bytes into an FNV-1a hash
+static uint32_t hashBytes(uint32_t hash, const void *data, size_t length)
+{
+	const uint8_t *bytes = (const uint8_t *)data;
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ bytes[i]) * 16777619u;
+	return hash;
+}
+
+// Wall clock of the host in micros, the simulated clock does not show the cost of the replay
+static double wallMicros()
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Configure the IMU, stream the FIFO through the filter until the time is up or the replay ends
+static bool run(SimpleIMU *mpu, SimpleIMU_Replay *replay, RunResult *result)
+{
+	if (!mpu->init())
+		return false;
+	mpu->setDLPFMode(1);
+	mpu->setSampleRateDivider(0); /* 1 kHz */
+	mpu->beginFIFO(IMU_FIFO_ACCEL | IMU_FIFO_GYRO);
+
+	IMUSample samples[BLOCK_SIZE];
+	SimpleIMU_Fusion fusion(IMU_FUSION_MAHONY);
+	result->samples = 0;
+	result->hash = 2166136261u;
+	unsigned long end = millis() + SECONDS * 1000;
+	while (replay != NULL ? !replay->isFinished() : millis() < end)
+	{
+		delay(BLOCK_SIZE);
+		int count = BLOCK_SIZE;
+		while (count == BLOCK_SIZE)
+		{
+			count = mpu->readFIFO(samples, BLOCK_SIZE);
+			if (count < 0)
+				return false;
+			for (int i = 0; i < count; i++)
+			{
+				/* The time between the samples comes from their timestamps */
+				fusion.update(&samples[i]);
+				result->hash = hashBytes(result->hash, &samples[i].accel, sizeof(AccelData));
+				result->hash = hashBytes(result->hash, &samples[i].gyro, sizeof(GyroData));
+				result->hash = hashBytes(result->hash, &samples[i].time, sizeof(uint32_t));
+			}
+			result->samples += count;
+		}
+	}
+	IMUTimingStats stats;
+	mpu->getTimingStats(&stats);
+	fusion.getQuaternion(result->q);
+	result->hash = hashBytes(result->hash, &stats, sizeof(stats));
+	result->hash = hashBytes(result->hash, result->q, sizeof(result->q));
+	return true;
+}
+
+// Replay the recording and compare it with the recorded run
+static int replayRun(const char *path, bool realTime, const RunResult *recorded, unsigned long recordedMillis)
+{
+	SimpleIMU_Replay replay;
+	if (!replay.open(path))
+	{
+		printf("Could not read %s\n", path);
+		return 1;
+	}
+	hostSetRealTime(realTime);
+	SimpleIMU mpu(0x68, &replay);
+	RunResult result;
+	double start = wallMicros();
+	bool completed = run(&mpu, &replay, &result);
+	double elapsed = wallMicros() - start;
+	bool matches = completed && replay.getMismatchCount() == 0 && result.samples == recorded->samples &&
+				   result.hash == recorded->hash;
+	printf("%-9s %lu records in %8.1f ms, %10.0f samples/s  hash %08lx  %s\n", realTime ? "real time" : "fast",
+		   (unsigned long)replay.getRecordCount(), elapsed / 1000, result.samples / (elapsed / 1e6),
+		   (unsigned long)result.hash, matches ? "matches" : "MISMATCH");
+	if (!matches)
+		return 1;
+	/* Paced, the replay takes as long as the recording on the wall clock */
+	if (realTime && fabs(elapsed / 1000 - recordedMillis) > 0.05 * recordedMillis)
+	{
+		printf("real time replay took %.1f ms, the recording %lu ms\n", elapsed / 1000, recordedMillis);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = argc > 1 ? argv[1] : "record_replay.simr";
+	SimulatedMPU6050 sensor(0x68);
+	sensor.setMotion(motion);
+	Wire.setClock(400000);
+
+	// Record the run on the simulated bus
+	SimpleIMU_Recorder recorder(&SimpleIMU_WireBus);
+	if (!recorder.open(path))
+	{
+		printf("Could not create %s\n", path);
+		return 1;
+	}
+	SimpleIMU mpu(0x68, &recorder);
+	RunResult recorded;
+	unsigned long start = millis();
+	if (!run(&mpu, NULL, &recorded))
+	{
+		printf("MPU initialization or FIFO read failed\n");
+		return 1;
+	}
+	unsigned long recordedMillis = millis() - start;
+	if (!recorder.close())
+	{
+		printf("Could not write %s\n", path);
+		return 1;
+	}
+	long size = 0;
+	FILE *file = fopen(path, "rb");
+	if (file != NULL)
+	{
+		fseek(file, 0, SEEK_END);
+		size = ftell(file);
+		fclose(file);
+	}
+	printf("recorded  %lu records, %lu samples in %lu ms, %ld bytes  hash %08lx\n",
+		   (unsigned long)recorder.getRecordCount(), (unsigned long)recorded.samples, recordedMillis, size,
+		   (unsigned long)recorded.hash);
+
+	// Replay without the sensor, first on the simulated clock as fast as possible, then on the clock of the host
+	int failures = replayRun(path, false, &recorded, recordedMillis);
+	failures += replayRun(path, true, &recorded, recordedMillis);
+
+	// A program going a different way, here to another address, is caught on its first transaction
+	SimpleIMU_Replay replay;
+	replay.open(path);
+	SimpleIMU other(0x69, &replay);
+	bool diverged = !other.init() && replay.getMismatchCount() > 0 && replay.getRecordCount() == 0;
+	printf("diverging program: %lu mismatches  %s\n", (unsigned long)replay.getMismatchCount(),
+		   diverged ? "caught" : "MISSED");
+	if (!diverged)
+		failures++;
+	return failures == 0 ? 0 : 1;
+}
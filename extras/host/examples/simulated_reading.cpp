@@ -0,0 +1,71 @@
+/*
+ *  Reads a simulated MPU6050 on a PC and prints the bus traffic
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <SimpleIMU.h>
+#include <SimulatedMPU6050.h>
+
+// Print the bus traffic since the last reset
+static void printStats(const char *name)
+{
+	WireStats stats = Wire.getStats();
+	printf("%-12s %6lu transactions %7lu bytes written %7lu bytes read %9.3f ms on the bus\n", name,
+		   (unsigned long)stats.transactions, (unsigned long)stats.bytesWritten,
+		   (unsigned long)stats.bytesRead, stats.busNanos / 1e6);
+	Wire.resetStats();
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	SimpleIMU mpu(0x68);
+
+	// A sensor with bias, tilted 30 degrees around x
+	const float accelBias[3] = {0.02f, -0.03f, 0.05f};
+	const float gyroBias[3] = {1.5f, -0.8f, 0.4f};
+	const float accel[3] = {0.0f, 0.5f, 0.866f};
+	const float gyro[3] = {0.0f, 0.0f, 10.0f};
+	sensor.setBias(accelBias, gyroBias);
+
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setGyroRange(1);
+	mpu.setAccelRange(1);
+	mpu.setSampleRateDivider(9);
+	printStats("init");
+
+	mpu.calibGyro();
+	mpu.calibAccel();
+	printStats("calibration");
+
+	sensor.setMotion(accel, gyro);
+	AccelData a;
+	GyroData g;
+	float temp;
+	delay(10);
+	mpu.readMotion(&a, &g, &temp);
+	printf("accel %7.3f %7.3f %7.3f m/s^2  gyro %7.2f %7.2f %7.2f dps  temp %5.1f C\n",
+		   a.x, a.y, a.z, g.x, g.y, g.z, temp);
+	printStats("readMotion");
+
+	mpu.beginFIFO();
+	delay(100);
+	IMUSample samples[16];
+	int total = 0, count;
+	while ((count = mpu.readFIFO(samples, 16)) > 0)
+		total += count;
+	mpu.endFIFO();
+	printf("%d FIFO samples at %.0f Hz, %lu produced by the sensor\n", total, mpu.getOutputDataRate(),
+		   (unsigned long)sensor.getSampleCount());
+	printStats("readFIFO");
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ *  Streams the 1 kHz accelerometer and gyroscope of a simulated MPU6050
+ *  as telemetry frames in each encoding, decodes the streams and checks
+ *  them sample by sample, then corrupts the delta stream and checks that
+ *  the decoder drops only the damaged frames
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  usage: telemetry [file]
+ *
+ *  With a file, the delta stream is written to it for imu_decode.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Telemetry.h>
+#include <SimulatedMPU6050.h>
+
+#define BLOCK_SIZE 16
+#define SECONDS 5
+#define UART_BYTES_PER_SECOND 11520 /* 115200 baud, 10 bits per byte */
+
+static const char *encodingNames[] = {"raw", "varint", "delta"};
+
+// A 1 Hz sway of 0.3 g and 30 deg/s
+static void motion(uint64_t now, float *accel, float *gyro, void *context)
+{
+	(void)context;
+	double t = now / 1e9;
+	accel[0] = 0.3f * sin(2 * M_PI * t);
+	accel[1] = 0.0f;
+	accel[2] = 1.0f;
+	gyro[0] = 0.0f;
+	gyro[1] = 30.0f * cos(2 * M_PI * t);
+	gyro[2] = 0.0f;
+}
+
+// Decode a stream, check every sample against the ones sent, returns the mismatches
+static int decode(const std::vector<uint8_t> &stream, const std::vector<IMURawSample> &sent, IMUTelemetryStats *stats)
+{
+	SimpleIMU_TelemetryDecoder decoder;
+	int16_t data[7][IMU_TELEMETRY_MAX_SAMPLES];
+	IMURawBlock block = {{data[0], data[1], data[2]}, {data[4], data[5], data[6]}, data[3], IMU_TELEMETRY_MAX_SAMPLES, 0};
+	int mismatches = 0;
+	for (size_t i = 0; i < stream.size(); i++)
+	{
+		if (!decoder.push(stream[i]))
+			continue;
+		uint16_t sequence = decoder.getSequence();
+		if (!decoder.read(&block))
+		{
+			mismatches++;
+			continue;
+		}
+		for (uint16_t s = 0; s < block.count; s++)
+		{
+			const IMURawSample *expected = &sent[sequence + s];
+			for (uint8_t a = 0; a < 3; a++)
+			{
+				if (block.accel[a][s] != expected->accel[a] || block.gyro[a][s] != expected->gyro[a])
+					mismatches++;
+			}
+		}
+	}
+	decoder.getStats(stats);
+	return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+	SimulatedMPU6050 sensor(0x68);
+	sensor.setMotion(motion);
+	SimpleIMU mpu(0x68);
+	Wire.setClock(400000);
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(0); /* 1 kHz */
+
+	// Read the samples once, every encoding sends the same ones
+	int16_t raw[7][BLOCK_SIZE];
+	IMURawBlock block = {{raw[0], raw[1], raw[2]}, {raw[4], raw[5], raw[6]}, NULL, BLOCK_SIZE, 0};
+	std::vector<IMURawSample> sent;
+	std::vector<uint8_t> blockStream;
+	SimpleIMU_Telemetry blockTelemetry(IMU_TELEMETRY_DELTA, IMU_TELEMETRY_ALL); /* temp is left out, its array is NULL */
+	uint8_t blockFrame[IMU_TELEMETRY_FRAME_SIZE(BLOCK_SIZE, 7)];
+	mpu.beginFIFO();
+	while (millis() < SECONDS * 1000)
+	{
+		delay(BLOCK_SIZE);
+		while (true)
+		{
+			block.count = 0;
+			int count = mpu.readFIFOBlock(&block);
+			if (count < 0)
+			{
+				printf("FIFO read failed\n");
+				return 1;
+			}
+			for (int i = 0; i < count; i++)
+			{
+				IMURawSample sample;
+				for (uint8_t a = 0; a < 3; a++)
+				{
+					sample.accel[a] = raw[a][i];
+					sample.gyro[a] = raw[4 + a][i];
+				}
+				sample.temp = 0;
+				sent.push_back(sample);
+			}
+			if (count > 0)
+			{
+				uint16_t length = blockTelemetry.encode(&block, blockFrame, sizeof(blockFrame));
+				blockStream.insert(blockStream.end(), blockFrame, blockFrame + length);
+			}
+			if (count < BLOCK_SIZE)
+				break;
+		}
+	}
+	mpu.endFIFO();
+
+	// The frames encoded straight from the blocks as they were read
+	int failures = 0;
+	IMUTelemetryStats blockStats;
+	int blockMismatches = decode(blockStream, sent, &blockStats);
+	printf("blocks %6.2f bytes/sample  %s\n", (double)blockStream.size() / sent.size(),
+		   blockMismatches == 0 && blockStats.samples == sent.size() ? "matches" : "MISMATCH");
+	if (blockMismatches != 0 || blockStats.samples != sent.size())
+		failures++;
+
+	std::vector<uint8_t> delta;
+	for (uint8_t encoding = IMU_TELEMETRY_RAW; encoding <= IMU_TELEMETRY_DELTA; encoding++)
+	{
+		SimpleIMU_Telemetry telemetry(encoding, IMU_TELEMETRY_MOTION);
+		std::vector<uint8_t> stream;
+		std::vector<size_t> starts;
+		uint8_t frame[IMU_TELEMETRY_FRAME_SIZE(BLOCK_SIZE, 6)];
+		for (size_t first = 0; first < sent.size(); first += BLOCK_SIZE)
+		{
+			uint8_t count = sent.size() - first < BLOCK_SIZE ? sent.size() - first : BLOCK_SIZE;
+			uint16_t length = telemetry.encode(&sent[first], count, first * 1000, 1000.0f, frame, sizeof(frame));
+			if (length == 0)
+			{
+				printf("%s frame did not fit\n", encodingNames[encoding]);
+				return 1;
+			}
+			starts.push_back(stream.size());
+			stream.insert(stream.end(), frame, frame + length);
+		}
+
+		IMUTelemetryStats stats;
+		int mismatches = decode(stream, sent, &stats);
+		double perSample = (double)stream.size() / sent.size();
+		printf("%-6s %6.2f bytes/sample  %6.0f bytes/s at 1 kHz, %s 115200 baud  %s\n", encodingNames[encoding],
+			   perSample, perSample * 1000, perSample * 1000 <= UART_BYTES_PER_SECOND ? "fits" : "exceeds",
+			   mismatches == 0 && stats.samples == sent.size() ? "matches" : "MISMATCH");
+		if (mismatches != 0 || stats.samples != sent.size() || stats.crcErrors != 0 || stats.skipped != 0)
+			failures++;
+		if (encoding == IMU_TELEMETRY_DELTA)
+		{
+			if (perSample * 1000 > UART_BYTES_PER_SECOND)
+				failures++;
+			delta = stream;
+
+			// Flip a byte in the payload of one frame and lose a byte of another
+			std::vector<uint8_t> damaged = stream;
+			damaged[starts[10] + IMU_TELEMETRY_HEADER + 3] ^= 0x10;
+			damaged.erase(damaged.begin() + starts[20] + 5);
+			mismatches = decode(damaged, sent, &stats);
+			printf("damaged stream: %lu frames, %lu lost samples, %lu CRC errors, %lu bytes skipped  %s\n",
+				   (unsigned long)stats.frames, (unsigned long)stats.lost, (unsigned long)stats.crcErrors,
+				   (unsigned long)stats.skipped, mismatches == 0 ? "matches" : "MISMATCH");
+			if (mismatches != 0 || stats.frames != starts.size() - 2 || stats.lost != 2 * BLOCK_SIZE)
+				failures++;
+		}
+	}
+
+	if (argc > 1)
+	{
+		FILE *file = fopen(argv[1], "wb");
+		if (file == NULL || fwrite(delta.data(), 1, delta.size(), file) != delta.size() || fclose(file) != 0)
+		{
+			printf("Could not write %s\n", argv[1]);
+			return 1;
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/*
+ *  Learns the temperature drift of a simulated MPU6050 while it warms up
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_TempComp.h>
+#include <SimulatedMPU6050.h>
+
+// At rest, turned at 30 deg/s for 2 s out of every 20 s
+static void turns(uint64_t now, float *accel, float *gyro, void *context)
+{
+	(void)context;
+	accel[0] = 0.0f;
+	accel[1] = 0.0f;
+	accel[2] = 1.0f;
+	gyro[0] = 0.0f;
+	gyro[1] = 0.0f;
+	gyro[2] = (now / 1000000000ULL) % 20 < 2 ? 30.0f : 0.0f;
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68);
+	const float accelBias[3] = {0.0f, 0.0f, 0.0f};
+	const float gyroBias[3] = {1.5f, -0.8f, 0.4f};
+	sensor.setBias(accelBias, gyroBias);
+	sensor.setTemperature(20.0f, 0.04f);
+	sensor.setMotion(turns, NULL);
+
+	SimpleIMU mpu(0x68);
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(9);
+	delay(3000);
+	mpu.calibGyro();
+	IMUCalibration start;
+	mpu.getCalibration(&start);
+
+	// Warm up from 20 to 50 degrees over 15 minutes, reading at 100 Hz
+	SimpleIMU_TempComp comp(&mpu);
+	comp.begin(20, 5);
+	double error = 0, staticError = 0;
+	long count = 0;
+	unsigned long begin = millis();
+	unsigned long next = 150000;
+	while (millis() - begin < 900000)
+	{
+		unsigned long ms = millis();
+		float t = 20.0f + 30.0f * (ms - begin) / 900000.0f;
+		sensor.setTemperature(t, 0.04f);
+		delay(10);
+
+		AccelData accel;
+		GyroData gyro;
+		float temp;
+		mpu.readMotion(&accel, &gyro, &temp);
+		comp.update(&accel, &gyro, temp);
+
+		// Error of the rate at rest, and what it would be with the start calibration only
+		if ((ms / 1000) % 20 >= 3 && (ms / 1000) % 20 < 19)
+		{
+			IMUCalibration now;
+			mpu.getCalibration(&now);
+			float scale = 1.0f / 131.0f;
+			float z = gyro.z + (now.gyroOffset[2] - start.gyroOffset[2]) * scale;
+			error += fabs(gyro.z);
+			staticError += fabs(z);
+			count++;
+		}
+		if (ms - begin >= next)
+		{
+			next += 150000;
+			printf("%3lu s %5.1f C  %2u bins  %4u windows at rest  %3u moving\n", ms / 1000, temp, comp.getLearnedBins(),
+				   comp.getAcceptedWindows(), comp.getRejectedWindows());
+		}
+	}
+
+	GyroData bias;
+	comp.getBias(50.0f, &bias);
+	printf("learned bias at 50 C  %6.3f %6.3f %6.3f deg/s\n", bias.x, bias.y, bias.z);
+	printf("mean |gyro z| at rest %6.3f deg/s compensated, %6.3f deg/s with the start calibration\n", error / count,
+		   staticError / count);
+	return error < staticError ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+ *  Timestamps the samples of a simulated MPU6050 whose clock runs 1.5 %
+ *  slow, first from the FIFO count and then from the data ready interrupt,
+ *  and compares the stamps and the learned drift with the simulator, and
+ *  that every data ready event is read or counted with reads failing
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Fusion.h>
+#include <SimulatedMPU6050.h>
+
+#define INT_PIN 2
+#define CLOCK_ERROR 15000.0f /* ppm */
+
+// Print the timing statistics and check them against the simulator
+static int report(SimpleIMU *mpu, const char *name, long error, long maxError)
+{
+	IMUTimingStats stats;
+	mpu->getTimingStats(&stats);
+	printf("%-10s period %8.2f us  drift %7.0f ppm  jitter rms %5.1f us max %4lu us  stamp error %4ld us\n", name,
+		   stats.period, stats.drift, stats.jitterRms, (unsigned long)stats.jitterMax, error);
+	int failures = 0;
+	if (fabsf(stats.drift - CLOCK_ERROR) > 500.0f)
+		failures++;
+	if (labs(error) > maxError)
+		failures++;
+	return failures;
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68, INT_PIN);
+	sensor.setClockError(CLOCK_ERROR);
+	float still[3] = {0.0f, 0.0f, 1.0f};
+	float turn[3] = {0.0f, 0.0f, 5.0f};
+	sensor.setMotion(still, turn);
+	SimpleIMU mpu(0x68);
+	Wire.setClock(400000);
+
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setGyroRange(1);
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(9); /* 100 Hz nominal */
+	int failures = 0;
+
+	// FIFO polled every 50 ms, the stamps come from the count alone
+	mpu.beginFIFO();
+	IMUSample samples[16];
+	long error = 0;
+	SimpleIMU_Fusion fusionStamped(IMU_FUSION_COMPLEMENTARY);
+	SimpleIMU_Fusion fusionNominal(IMU_FUSION_COMPLEMENTARY);
+	bool settled = false;
+	while (millis() < 30000)
+	{
+		delay(50);
+		uint32_t produced = sensor.getSampleCount();
+		uint64_t newest = sensor.getLastSampleTime();
+		int count, read = 0;
+		while ((count = mpu.readFIFO(samples, 16)) > 0)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				fusionStamped.update(&samples[i]);
+				fusionNominal.update(&samples[i].accel, &samples[i].gyro, 0.01f);
+			}
+			read += count;
+			if (count < 16)
+				break;
+		}
+		if (count < 0)
+		{
+			printf("FIFO overflow\n");
+			return 1;
+		}
+		// Compared only when no sample came during the reads
+		if (read > 0 && sensor.getSampleCount() == produced)
+			error = (long)(samples[(read - 1) % 16].time - (unsigned long)(newest / 1000));
+		if (!settled && millis() >= 10000)
+		{
+			// Only the errors once the timeline has settled
+			mpu.resetTimingStats();
+			settled = true;
+		}
+	}
+	failures += report(&mpu, "FIFO", error, 1000);
+
+	// 30 s of a 5 deg/s turn, integrated with the stamps and with the nominal period
+	float roll, pitch, stamped, nominal;
+	fusionStamped.getEuler(&roll, &pitch, &stamped);
+	fusionNominal.getEuler(&roll, &pitch, &nominal);
+	printf("%-10s yaw %7.2f deg with stamps, %7.2f deg with the nominal period\n", "fusion", stamped, nominal);
+	if (fabsf(fabsf(stamped) - 150.0f) > 0.5f)
+		failures++;
+
+	// Data ready interrupt, the ISR takes the time of every sample
+	mpu.endFIFO();
+	IMUSample ring[16];
+	if (!mpu.beginDataReady(INT_PIN, ring, 16))
+	{
+		printf("data ready could not be started\n");
+		return 1;
+	}
+	mpu.resetTimingStats();
+	uint32_t first = sensor.getSampleCount();
+	unsigned long stop = millis() + 20000, received = 0;
+	for (unsigned long polls = 1; millis() < stop; polls++)
+	{
+		delayMicroseconds(100);
+
+		// A read NACKed past the retries now and then, its sample is missed
+		if (polls % 1000 == 0)
+			Wire.injectNacks(IMU_RETRIES + 1);
+		if (!mpu.updateDataReady())
+			continue;
+		IMUSample sample;
+		while (mpu.readSample(&sample))
+		{
+			error = (long)(sample.time - (unsigned long)(sensor.getLastSampleTime() / 1000));
+			received++;
+		}
+	}
+	mpu.updateDataReady();
+	IMUSample sample;
+	while (mpu.readSample(&sample))
+		received++;
+	unsigned long events = sensor.getSampleCount() - first;
+	mpu.endDataReady();
+	failures += report(&mpu, "data ready", error, 200);
+
+	// Every event is read, missed or dropped
+	printf("%-10s %lu events, %lu read, %u missed, %u dropped\n", "accounting", events, received, mpu.getMissedCount(),
+		   mpu.getOverrunCount());
+	if (events != received + mpu.getMissedCount() + mpu.getOverrunCount() || mpu.getMissedCount() == 0)
+		failures++;
+	return failures == 0 ? 0 : 1;
+}
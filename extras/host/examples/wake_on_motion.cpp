@@ -0,0 +1,101 @@
+/*
+ *  Sleeps a simulated MPU6050 in cycle mode until it is moved, streams while
+ *  it moves and goes back to sleep when it is still again
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <SimpleIMU.h>
+#include <SimulatedMPU6050.h>
+
+#define INT_PIN 2
+
+// At rest, shaken at 4 Hz from 3 s to 5 s
+static void shake(uint64_t now, float *accel, float *gyro, void *context)
+{
+	(void)context;
+	double t = now / 1e9;
+	accel[0] = 0.0f;
+	accel[1] = 0.0f;
+	accel[2] = 1.0f;
+	for (int i = 0; i < 3; i++)
+		gyro[i] = 0.0f;
+	if (t >= 3.0 && t < 5.0)
+	{
+		accel[0] = 0.5f * sin(2 * M_PI * 4 * t);
+		gyro[2] = 90.0f * cos(2 * M_PI * 4 * t);
+	}
+}
+
+// Print the bus traffic since the last reset
+static void printStats(const char *name, unsigned long ms)
+{
+	WireStats stats = Wire.getStats();
+	printf("%-8s %5lu ms %6lu transactions %7lu bytes\n", name, ms, (unsigned long)stats.transactions,
+		   (unsigned long)(stats.bytesWritten + stats.bytesRead));
+	Wire.resetStats();
+}
+
+int main()
+{
+	SimulatedMPU6050 sensor(0x68, INT_PIN);
+	sensor.setMotion(shake, NULL);
+	SimpleIMU mpu(0x68);
+	Wire.setClock(400000);
+
+	if (!mpu.init())
+	{
+		printf("MPU initialization failed\n");
+		return 1;
+	}
+	mpu.setDLPFMode(1);
+	mpu.setSampleRateDivider(9);
+	mpu.setMotionDetection(40, 1);	   /* 80 mg */
+	mpu.setZeroMotionDetection(10, 8); /* 20 mg for 512 ms */
+	mpu.beginWakeOnMotion(INT_PIN, IMU_WAKE_5HZ);
+	Wire.resetStats();
+
+	unsigned long since = millis();
+	unsigned long samples = 0;
+	IMUSample buffer[16];
+	while (millis() < 8000)
+	{
+		uint8_t events = mpu.getMotionEvents();
+		if (mpu.isCycleMode())
+		{
+			// Asleep, no bus traffic until the INT pin rises
+			if (events & IMU_EVENT_MOTION)
+			{
+				printStats("asleep", millis() - since);
+				since = millis();
+				mpu.endMotionEvents();
+				mpu.beginMotionEvents(INT_PIN, IMU_EVENT_ZERO_MOTION);
+				mpu.beginFIFO();
+				samples = 0;
+			}
+		}
+		else
+		{
+			int count;
+			while ((count = mpu.readFIFO(buffer, 16)) > 0)
+				samples += count;
+			if ((events & IMU_EVENT_ZERO_MOTION) && (events & IMU_EVENT_STILL))
+			{
+				mpu.endFIFO();
+				printStats("awake", millis() - since);
+				printf("         %5lu samples streamed\n", samples);
+				since = millis();
+				mpu.endMotionEvents();
+				mpu.beginWakeOnMotion(INT_PIN, IMU_WAKE_5HZ);
+			}
+		}
+		delay(20);
+	}
+	printStats(mpu.isCycleMode() ? "asleep" : "awake", millis() - since);
+	return 0;
+}
@@ -0,0 +1,194 @@
+/*
+ *  Decodes a stream of SimpleIMU telemetry frames into CSV or fixed size
+ *  binary records
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ *
+ *  usage: imu_decode [--binary] [--baud rate] input [output]
+ *
+ *  The input is a file, - for the standard input, or a serial port, which
+ *  is set to raw mode at the given baud rate, 115200 by default, and read
+ *  until interrupted. The output is the standard output when left out.
+ *
+ *  CSV has one line per sample:
+ *    sequence,time_us,accel_x,accel_y,accel_z,temp,gyro_x,gyro_y,gyro_z
+ *  with the channels missing from a frame left empty. Binary records are
+ *  21 bytes, little endian: uint16_t sequence, uint32_t time in micros,
+ *  uint8_t channels as in the frame, then the 7 channels as int16_t in the
+ *  order above, 0 when missing. The counters of the decoder are printed to
+ *  the standard error at the end, the exit status is 1 if no frame was found.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <SimpleIMU.h>
+#include <SimpleIMU_Telemetry.h>
+
+#define RECORD_SIZE 21
+
+// Baud rate constant of a rate, B0 if it has none
+static speed_t baudConstant(long baud)
+{
+	switch (baud)
+	{
+	case 9600:
+		return B9600;
+	case 19200:
+		return B19200;
+	case 38400:
+		return B38400;
+	case 57600:
+		return B57600;
+	case 115200:
+		return B115200;
+	case 230400:
+		return B230400;
+#ifdef B460800
+	case 460800:
+		return B460800;
+#endif
+#ifdef B921600
+	case 921600:
+		return B921600;
+#endif
+	default:
+		return B0;
+	}
+}
+
+// Open the input, a serial port is set to raw mode
+static int openInput(const char *path, long baud)
+{
+	if (strcmp(path, "-") == 0)
+		return STDIN_FILENO;
+	int fd = open(path, O_RDONLY | O_NOCTTY);
+	if (fd < 0 || !isatty(fd))
+		return fd;
+	struct termios tty;
+	speed_t speed = baudConstant(baud);
+	if (speed == B0 || tcgetattr(fd, &tty) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	cfmakeraw(&tty);
+	cfsetispeed(&tty, speed);
+	cfsetospeed(&tty, speed);
+	tty.c_cflag |= CLOCAL | CREAD;
+	tty.c_cc[VMIN] = 1;
+	tty.c_cc[VTIME] = 0;
+	if (tcsetattr(fd, TCSANOW, &tty) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// Write the samples of a decoded frame
+static void writeFrame(FILE *out, bool binary, uint16_t sequence, uint8_t channels, const IMURawBlock *block)
+{
+	int16_t *values[7] = {block->accel[0], block->accel[1], block->accel[2], block->temp,
+						  block->gyro[0], block->gyro[1], block->gyro[2]};
+	for (uint16_t i = 0; i < block->count; i++)
+	{
+		uint32_t time = block->time + (uint32_t)(i * block->period + 0.5f);
+		uint16_t seq = sequence + i;
+		if (binary)
+		{
+			uint8_t record[RECORD_SIZE] = {(uint8_t)seq, (uint8_t)(seq >> 8), (uint8_t)time, (uint8_t)(time >> 8),
+										   (uint8_t)(time >> 16), (uint8_t)(time >> 24), channels};
+			for (uint8_t c = 0; c < 7; c++)
+			{
+				int16_t value = (channels & (1 << c)) ? values[c][i] : 0;
+				record[7 + 2 * c] = value;
+				record[8 + 2 * c] = value >> 8;
+			}
+			fwrite(record, 1, RECORD_SIZE, out);
+			continue;
+		}
+		fprintf(out, "%u,%lu", seq, (unsigned long)time);
+		for (uint8_t c = 0; c < 7; c++)
+		{
+			if (channels & (1 << c))
+				fprintf(out, ",%d", values[c][i]);
+			else
+				fputc(',', out);
+		}
+		fputc('\n', out);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bool binary = false;
+	long baud = 115200;
+	const char *paths[2] = {NULL, NULL};
+	int pathCount = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--binary") == 0)
+			binary = true;
+		else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+			baud = strtol(argv[++i], NULL, 10);
+		else if (pathCount < 2)
+			paths[pathCount++] = argv[i];
+	}
+	if (pathCount == 0)
+	{
+		fprintf(stderr, "usage: %s [--binary] [--baud rate] input [output]\n", argv[0]);
+		return 2;
+	}
+
+	int input = openInput(paths[0], baud);
+	if (input < 0)
+	{
+		fprintf(stderr, "Could not open %s\n", paths[0]);
+		return 2;
+	}
+	FILE *out = paths[1] == NULL ? stdout : fopen(paths[1], binary ? "wb" : "w");
+	if (out == NULL)
+	{
+		fprintf(stderr, "Could not open %s\n", paths[1]);
+		return 2;
+	}
+	bool live = isatty(input);
+	if (!binary)
+		fprintf(out, "sequence,time_us,accel_x,accel_y,accel_z,temp,gyro_x,gyro_y,gyro_z\n");
+
+	SimpleIMU_TelemetryDecoder decoder;
+	int16_t data[7][IMU_TELEMETRY_MAX_SAMPLES];
+	IMURawBlock block = {{data[0], data[1], data[2]}, {data[4], data[5], data[6]}, data[3], IMU_TELEMETRY_MAX_SAMPLES, 0};
+	uint8_t buffer[4096];
+	ssize_t length;
+	while ((length = read(input, buffer, sizeof(buffer))) > 0)
+	{
+		for (ssize_t i = 0; i < length; i++)
+		{
+			if (!decoder.push(buffer[i]))
+				continue;
+			uint16_t sequence = decoder.getSequence();
+			uint8_t channels = decoder.getChannels();
+			if (decoder.read(&block))
+				writeFrame(out, binary, sequence, channels, &block);
+		}
+		if (live)
+			fflush(out);
+	}
+
+	IMUTelemetryStats stats;
+	decoder.getStats(&stats);
+	fprintf(stderr, "%lu frames, %lu samples, %lu lost samples, %lu CRC errors, %lu bytes skipped\n",
+			(unsigned long)stats.frames, (unsigned long)stats.samples, (unsigned long)stats.lost,
+			(unsigned long)stats.crcErrors, (unsigned long)stats.skipped);
+	if (out != stdout && fclose(out) != 0)
+		return 2;
+	return stats.frames == 0 ? 1 : 0;
+}
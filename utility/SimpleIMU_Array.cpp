@@ -0,0 +1,130 @@
+/*
+ *  Reading several IMUs together for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <Arduino.h>
+#include "../SimpleIMU_Array.h"
+
+// Constructor
+SimpleIMU_Array::SimpleIMU_Array()
+{
+	SimpleIMU_Array::ARR_Count = 0;
+	SimpleIMU_Array::ARR_Reverse = false;
+	SimpleIMU_Array::ARR_Period = 0;
+	SimpleIMU_Array::ARR_NextRead = 0;
+}
+
+// Add an IMU, keeping IMUs on the same transport next to each other
+bool SimpleIMU_Array::add(SimpleIMU *imu)
+{
+	uint8_t count = SimpleIMU_Array::ARR_Count;
+	if (count >= IMU_ARRAY_MAX_SENSORS)
+		return false;
+	SimpleIMU_Array::ARR_Sensors[count] = imu;
+
+	/* Insert after the last IMU on the same transport */
+	uint8_t position = count;
+	for (uint8_t i = 0; i < count; i++)
+		if (SimpleIMU_Array::ARR_Sensors[SimpleIMU_Array::ARR_Order[i]]->IMU_Transport == imu->IMU_Transport)
+			position = i + 1;
+	for (uint8_t i = count; i > position; i--)
+		SimpleIMU_Array::ARR_Order[i] = SimpleIMU_Array::ARR_Order[i - 1];
+	SimpleIMU_Array::ARR_Order[position] = count;
+	SimpleIMU_Array::ARR_Count = count + 1;
+	return true;
+}
+
+uint8_t SimpleIMU_Array::getSensorCount()
+{
+	return SimpleIMU_Array::ARR_Count;
+}
+
+// Initialize all IMUs with the same rate
+bool SimpleIMU_Array::begin(uint8_t divider, uint8_t dlpfMode)
+{
+	bool ok = true;
+	for (uint8_t i = 0; i < SimpleIMU_Array::ARR_Count; i++)
+	{
+		SimpleIMU *imu = SimpleIMU_Array::ARR_Sensors[SimpleIMU_Array::ARR_Order[i]];
+		if (!imu->init())
+		{
+			ok = false;
+			continue;
+		}
+		imu->beginConfig();
+		imu->setSampleRateDivider(divider);
+		imu->setDLPFMode(dlpfMode);
+		imu->commitConfig();
+	}
+	SimpleIMU_Array::ARR_NextRead = micros();
+	return ok;
+}
+
+void SimpleIMU_Array::setPeriod(uint32_t period)
+{
+	SimpleIMU_Array::ARR_Period = period;
+}
+
+// Read one sample of every IMU
+uint8_t SimpleIMU_Array::read(IMUSampleSet *set)
+{
+	uint8_t count = SimpleIMU_Array::ARR_Count;
+	bool reverse = SimpleIMU_Array::ARR_Reverse;
+	SimpleIMU_Array::ARR_Reverse = !reverse;
+
+	uint32_t first = 0, sum = 0;
+	uint8_t read = 0;
+	uint8_t result = IMU_OK;
+	set->count = count;
+	set->spread = 0;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		uint8_t index = SimpleIMU_Array::ARR_Order[reverse ? count - 1 - i : i];
+		IMUSample *sample = &set->sample[index];
+		uint32_t start = micros();
+		uint8_t status = SimpleIMU_Array::ARR_Sensors[index]->readMotion(&sample->accel, &sample->gyro, &sample->temp);
+		if (status != IMU_OK)
+		{
+			/* The stale sample keeps its time and stays out of the timestamp */
+			if (result == IMU_OK)
+				result = status;
+			continue;
+		}
+		uint32_t time = start + (micros() - start) / 2;
+		set->sampleTime[index] = time;
+		sample->time = time;
+
+		/* Sum the offsets from the first sample, the sum of the times would overflow */
+		if (read == 0)
+			first = time;
+		sum += time - first;
+		set->spread = time - first;
+		read++;
+	}
+	set->timestamp = read > 0 ? first + sum / read : micros();
+	return result;
+}
+
+// Read a sample set when the period has passed
+bool SimpleIMU_Array::poll(IMUSampleSet *set)
+{
+	uint32_t now = micros();
+	if ((int32_t)(now - SimpleIMU_Array::ARR_NextRead) < 0)
+		return false;
+
+	uint32_t period = SimpleIMU_Array::ARR_Period;
+	if (period == 0 && SimpleIMU_Array::ARR_Count > 0)
+		period = 1000000.0f / SimpleIMU_Array::ARR_Sensors[0]->getOutputDataRate();
+
+	/* Keep the schedule, unless more than a period behind */
+	SimpleIMU_Array::ARR_NextRead += period;
+	if ((int32_t)(now - SimpleIMU_Array::ARR_NextRead) >= (int32_t)period)
+		SimpleIMU_Array::ARR_NextRead = now + period;
+	SimpleIMU_Array::read(set);
+	return true;
+}
@@ -0,0 +1,223 @@
+/*
+ *  Auxiliary I2C master of the MPU6050 for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "SimpleIMU_MPU6050.h"
+
+// Start the auxiliary I2C master
+uint8_t SimpleIMU::beginAuxMaster(uint8_t clock, uint8_t delay)
+{
+	uint8_t value;
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+
+	/* The external sensors are behind the master, not on the host bus */
+	SimpleIMU::IMU_IntConfig[0] &= ~(1 << MPU6050_IMU::MPU6050_INTCFG_I2C_BYPASS_EN_BIT);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_PIN_CFG, SimpleIMU::IMU_IntConfig[0]);
+
+	SimpleIMU::IMU_AuxMasterCtrl = (1 << MPU6050_IMU::MPU6050_WAIT_FOR_ES_BIT) | (clock & 0x0F);
+	SimpleIMU::IMU_AuxDelay = delay & 0x1F;
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_CTRL, SimpleIMU::IMU_AuxMasterCtrl);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV4_CTRL, SimpleIMU::IMU_AuxDelay);
+
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_USER_CTRL, &value, 1) == IMU_OK)
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, value | (1 << MPU6050_IMU::MPU6050_USERCTRL_I2C_MST_EN_BIT));
+	return SimpleIMU::statusSince(errors);
+}
+
+// Stop the auxiliary I2C master
+uint8_t SimpleIMU::endAuxMaster()
+{
+	uint8_t value;
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	for (uint8_t i = 0; i < IMU_AUX_SLAVES; i++)
+		SimpleIMU::removeAuxSlave(i);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_DELAY_CTRL, 0x00);
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_USER_CTRL, &value, 1) == IMU_OK)
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, value & ~(1 << MPU6050_IMU::MPU6050_USERCTRL_I2C_MST_EN_BIT));
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_CTRL, 0x00);
+	SimpleIMU::IMU_AuxMasterCtrl = 0;
+	return SimpleIMU::statusSince(errors);
+}
+
+// Write the address, register and control of a slave in one transaction
+uint8_t SimpleIMU::setAuxSlave(uint8_t slave, uint8_t address, uint8_t reg, uint8_t ctrl, bool delayed)
+{
+	uint8_t buffer[3] = {address, reg, ctrl};
+	uint8_t status = SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_I2C_SLV0_ADDR + 3 * slave, buffer, 3);
+	if (status != IMU_OK)
+		return status;
+	memcpy(SimpleIMU::IMU_AuxSlaveConfig[slave], buffer, 3);
+
+	if (delayed)
+		SimpleIMU::IMU_AuxDelayed |= 1 << slave;
+	else
+		SimpleIMU::IMU_AuxDelayed &= ~(1 << slave);
+	uint8_t delayCtrl = SimpleIMU::IMU_AuxDelayed;
+	if (delayCtrl != 0)
+		delayCtrl |= 0x80; /* DELAY_ES_SHADOW, keep the data of delayed slaves consistent */
+	return SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_DELAY_CTRL, delayCtrl);
+}
+
+// Read registers of an external sensor on every sample
+bool SimpleIMU::addAuxRead(uint8_t slave, uint8_t address, uint8_t reg, uint8_t length, bool swapBytes, bool delayed)
+{
+	if (slave >= IMU_AUX_SLAVES || length == 0 || length > 15)
+		return false;
+	uint8_t total = SimpleIMU::getAuxLength() - SimpleIMU::IMU_AuxLength[slave] + length;
+	if (total > IMU_AUX_DATA_SIZE)
+		return false;
+
+	uint8_t ctrl = (1 << MPU6050_IMU::MPU6050_I2C_SLV_EN_BIT) | length;
+	if (swapBytes)
+		ctrl |= 1 << MPU6050_IMU::MPU6050_I2C_SLV_BYTE_SW_BIT;
+	if (SimpleIMU::setAuxSlave(slave, 0x80 | address, reg, ctrl, delayed) != IMU_OK)
+		return false;
+	SimpleIMU::IMU_AuxSlaves |= 1 << slave;
+	SimpleIMU::IMU_AuxReadSlaves |= 1 << slave;
+	SimpleIMU::IMU_AuxLength[slave] = length;
+	return true;
+}
+
+// Write a register of an external sensor on every sample
+bool SimpleIMU::addAuxWrite(uint8_t slave, uint8_t address, uint8_t reg, uint8_t value, bool delayed)
+{
+	if (slave >= IMU_AUX_SLAVES)
+		return false;
+	if (SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV0_DO + slave, value) != IMU_OK)
+		return false;
+	if (SimpleIMU::setAuxSlave(slave, address & 0x7F, reg, (1 << MPU6050_IMU::MPU6050_I2C_SLV_EN_BIT) | 1, delayed) != IMU_OK)
+		return false;
+	SimpleIMU::IMU_AuxSlaves |= 1 << slave;
+	SimpleIMU::IMU_AuxReadSlaves &= ~(1 << slave);
+	SimpleIMU::IMU_AuxLength[slave] = 0;
+	SimpleIMU::IMU_AuxSlaveOut[slave] = value;
+	return true;
+}
+
+// Disable a slave
+uint8_t SimpleIMU::removeAuxSlave(uint8_t slave)
+{
+	if (slave >= IMU_AUX_SLAVES)
+		return IMU_ERROR_ARGUMENT;
+	SimpleIMU::IMU_AuxSlaves &= ~(1 << slave);
+	SimpleIMU::IMU_AuxReadSlaves &= ~(1 << slave);
+	SimpleIMU::IMU_AuxDelayed &= ~(1 << slave);
+	SimpleIMU::IMU_AuxLength[slave] = 0;
+	return SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV0_CTRL + 3 * slave, 0x00);
+}
+
+// Write the cached master and slaves back
+uint8_t SimpleIMU::restoreAux()
+{
+	uint8_t value;
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	if (SimpleIMU::IMU_AuxMasterCtrl == 0)
+		return IMU_OK;
+
+	/* The slave 3 FIFO bit is set again by beginFIFO */
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_CTRL, SimpleIMU::IMU_AuxMasterCtrl);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV4_CTRL, SimpleIMU::IMU_AuxDelay);
+	for (uint8_t i = 0; i < IMU_AUX_SLAVES; i++)
+	{
+		if (!(SimpleIMU::IMU_AuxSlaves & (1 << i)))
+			continue;
+		if (!(SimpleIMU::IMU_AuxReadSlaves & (1 << i)))
+			SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_SLV0_DO + i, SimpleIMU::IMU_AuxSlaveOut[i]);
+		SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_I2C_SLV0_ADDR + 3 * i, SimpleIMU::IMU_AuxSlaveConfig[i], 3);
+	}
+	uint8_t delayCtrl = SimpleIMU::IMU_AuxDelayed;
+	if (delayCtrl != 0)
+		delayCtrl |= 0x80;
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_DELAY_CTRL, delayCtrl);
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_USER_CTRL, &value, 1) == IMU_OK)
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, value | (1 << MPU6050_IMU::MPU6050_USERCTRL_I2C_MST_EN_BIT));
+	return SimpleIMU::statusSince(errors);
+}
+
+// Single transfer through slave 4, address, register, data out and control in one transaction
+bool SimpleIMU::auxTransfer(uint8_t address, uint8_t reg, uint8_t *value, bool read)
+{
+	uint8_t buffer[4] = {(uint8_t)((read ? 0x80 : 0x00) | address), reg, read ? (uint8_t)0 : *value,
+						 (uint8_t)((1 << MPU6050_IMU::MPU6050_I2C_SLV4_EN_BIT) | SimpleIMU::IMU_AuxDelay)};
+	if (SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_I2C_SLV4_ADDR, buffer, 4) != IMU_OK)
+		return false;
+
+	/* The transfer runs with the next sample, I2C_MST_STATUS clears when read */
+	uint32_t start = millis();
+	uint8_t status = 0;
+	while (!(status & ((1 << MPU6050_IMU::MPU6050_MST_I2C_SLV4_DONE_BIT) | (1 << MPU6050_IMU::MPU6050_MST_I2C_SLV4_NACK_BIT))))
+	{
+		if (millis() - start > IMU_AUX_TIMEOUT)
+			return false;
+		if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_I2C_MST_STATUS, &status, 1) != IMU_OK)
+			return false;
+	}
+	if (status & (1 << MPU6050_IMU::MPU6050_MST_I2C_SLV4_NACK_BIT))
+		return false;
+	if (read)
+		return SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_I2C_SLV4_DI, value, 1) == IMU_OK;
+	return true;
+}
+
+// Write a register of an external sensor once
+bool SimpleIMU::writeAux(uint8_t address, uint8_t reg, uint8_t value)
+{
+	return SimpleIMU::auxTransfer(address, reg, &value, false);
+}
+
+// Read a register of an external sensor once
+bool SimpleIMU::readAux(uint8_t address, uint8_t reg, uint8_t *value)
+{
+	return SimpleIMU::auxTransfer(address, reg, value, true);
+}
+
+// Get number of bytes of external sensor data
+uint8_t SimpleIMU::getAuxLength()
+{
+	uint8_t length = 0;
+	for (uint8_t i = 0; i < IMU_AUX_SLAVES; i++)
+		length += SimpleIMU::IMU_AuxLength[i];
+	return length;
+}
+
+// Get where the data of a slave starts, slaves fill EXT_SENS_DATA in order
+uint8_t SimpleIMU::getAuxOffset(uint8_t slave)
+{
+	uint8_t offset = 0;
+	for (uint8_t i = 0; i < slave && i < IMU_AUX_SLAVES; i++)
+		offset += SimpleIMU::IMU_AuxLength[i];
+	return offset;
+}
+
+// Read motion and external sensor data, EXT_SENS_DATA follows GYRO_ZOUT_L
+uint8_t SimpleIMU::readMotionAux(AccelData *accel, GyroData *gyro, float *temp, uint8_t *aux)
+{
+	uint8_t buffer[14 + IMU_AUX_DATA_SIZE];
+	uint8_t auxLength = SimpleIMU::getAuxLength();
+	uint8_t status = SimpleIMU::readRegisterBlock(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 14 + auxLength);
+	if (status != IMU_OK)
+		return status;
+
+	int16_t ax = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_AccelOffsetX;
+	int16_t ay = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_AccelOffsetY;
+	int16_t az = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_AccelOffsetZ;
+	int16_t t = (int16_t)(buffer[6] << 8 | buffer[7]);
+	int16_t gx = (int16_t)(buffer[8] << 8 | buffer[9]) - SimpleIMU::IMU_GyroOffsetX;
+	int16_t gy = (int16_t)(buffer[10] << 8 | buffer[11]) - SimpleIMU::IMU_GyroOffsetY;
+	int16_t gz = (int16_t)(buffer[12] << 8 | buffer[13]) - SimpleIMU::IMU_GyroOffsetZ;
+
+	SimpleIMU::scaleAccel(ax, ay, az, accel);
+	SimpleIMU::scaleGyro(gx, gy, gz, gyro);
+	if (temp != NULL)
+		*temp = SimpleIMU::scaleTemp(t);
+	if (aux != NULL)
+		memcpy(aux, buffer + 14, auxLength);
+	return IMU_OK;
+}
@@ -0,0 +1,208 @@
+/*
+ *  Block reads into per axis arrays for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "../SimpleIMU_Convert.h"
+#include "SimpleIMU_MPU6050.h"
+
+// Gather one big endian axis out of a run of frames
+static void unpackAxis(const uint8_t *p, uint8_t stride, uint8_t frames, int16_t *out)
+{
+	if (out == NULL)
+		return;
+	for (uint8_t i = 0; i < frames; i++, p += stride)
+		out[i] = (int16_t)(p[0] << 8 | p[1]);
+}
+
+// Offset and scale one axis
+static void scaleAxis(const int16_t *raw, float *out, uint16_t count, int16_t offset, float scale)
+{
+	if (raw == NULL || out == NULL)
+		return;
+	for (uint16_t i = 0; i < count; i++)
+		out[i] = (int16_t)(raw[i] - offset) * scale;
+}
+
+// Read frames from the FIFO into a block
+int SimpleIMU::readFIFOBlock(IMURawBlock *block, uint8_t *aux)
+{
+	uint8_t frameSize = SimpleIMU::IMU_FIFOFrameSize;
+	if (frameSize == 0 || block->count >= block->size)
+		return 0;
+	int frames = SimpleIMU::getFIFOFrames(block->size - block->count);
+	if (frames < 0)
+		return -1;
+	float period = SimpleIMU::getSamplePeriod();
+	uint32_t first = SimpleIMU::advanceTiming(frames);
+	if (block->count == 0)
+	{
+		block->time = first;
+		block->period = period;
+	}
+
+	uint8_t framesPerRead = SimpleIMU::getMaxTransfer() / frameSize;
+	if (framesPerRead == 0)
+		framesPerRead = 1;
+	uint8_t buffer[IMU_TRANSFER_BUFFER_LENGTH > IMU_FIFO_MAX_FRAME ? IMU_TRANSFER_BUFFER_LENGTH : IMU_FIFO_MAX_FRAME];
+	uint8_t sensors = SimpleIMU::IMU_FIFOSensors;
+	uint8_t auxLength = SimpleIMU::getAuxLength();
+	int count = 0;
+	while (count < frames)
+	{
+		uint8_t chunk = framesPerRead;
+		if (frames - count < chunk)
+			chunk = frames - count;
+		if (SimpleIMU::readRegisterBlock(MPU6050_IMU::MPU6050_RA_FIFO_R_W, buffer, chunk * frameSize) != IMU_OK)
+		{
+			/* The frames that follow are no longer aligned, keep what was read */
+			SimpleIMU::resetFIFO();
+			block->count += count;
+			return -1;
+		}
+
+		/* One pass per axis over the chunk, frames are in register order */
+		uint16_t index = block->count + count;
+		uint8_t position = 0;
+		if (sensors & IMU_FIFO_ACCEL)
+		{
+			for (uint8_t a = 0; a < 3; a++, position += 2)
+				unpackAxis(buffer + position, frameSize, chunk, block->accel[a] == NULL ? NULL : block->accel[a] + index);
+		}
+		if (sensors & IMU_FIFO_TEMP)
+		{
+			unpackAxis(buffer + position, frameSize, chunk, block->temp == NULL ? NULL : block->temp + index);
+			position += 2;
+		}
+		for (uint8_t a = 0; a < 3; a++)
+		{
+			if (!(sensors & (IMU_FIFO_GYRO_X >> a)))
+				continue;
+			unpackAxis(buffer + position, frameSize, chunk, block->gyro[a] == NULL ? NULL : block->gyro[a] + index);
+			position += 2;
+		}
+		if ((sensors & IMU_FIFO_AUX) && aux != NULL)
+		{
+			for (uint8_t i = 0; i < chunk; i++)
+				memcpy(aux + (index + i) * auxLength, buffer + i * frameSize + position, auxLength);
+		}
+		count += chunk;
+	}
+	block->count += count;
+	return count;
+}
+
+// Read samples into a block with one burst each
+uint8_t SimpleIMU::readMotionBlock(IMURawBlock *block, uint16_t count)
+{
+	if (block->count >= block->size)
+		return IMU_OK;
+	if (count > block->size - block->count)
+		count = block->size - block->count;
+	uint32_t period = lroundf(SimpleIMU::getSamplePeriod());
+	uint32_t next = micros();
+	if (block->count == 0)
+	{
+		block->time = next;
+		block->period = period;
+	}
+	for (uint16_t i = 0; i < count; i++)
+	{
+		while ((int32_t)(micros() - next) < 0)
+			;
+		next += period;
+
+		uint8_t buffer[14];
+		uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 14);
+		if (status != IMU_OK)
+			return status;
+		uint16_t index = block->count;
+		for (uint8_t a = 0; a < 3; a++)
+		{
+			unpackAxis(buffer + 2 * a, 14, 1, block->accel[a] == NULL ? NULL : block->accel[a] + index);
+			unpackAxis(buffer + 8 + 2 * a, 14, 1, block->gyro[a] == NULL ? NULL : block->gyro[a] + index);
+		}
+		unpackAxis(buffer + 6, 14, 1, block->temp == NULL ? NULL : block->temp + index);
+		block->count = index + 1;
+	}
+	return IMU_OK;
+}
+
+// Offset and scale a block
+void SimpleIMU::scaleBlock(const IMURawBlock *raw, IMUSampleBlock *block)
+{
+	uint16_t count = raw->count < block->size ? raw->count : block->size;
+	int16_t accelOffset[3] = {SimpleIMU::IMU_AccelOffsetX, SimpleIMU::IMU_AccelOffsetY, SimpleIMU::IMU_AccelOffsetZ};
+	int16_t gyroOffset[3] = {SimpleIMU::IMU_GyroOffsetX, SimpleIMU::IMU_GyroOffsetY, SimpleIMU::IMU_GyroOffsetZ};
+	for (uint8_t a = 0; a < 3; a++)
+	{
+		scaleAxis(raw->accel[a], block->accel[a], count, accelOffset[a], SimpleIMU::IMU_AccelScale);
+		scaleAxis(raw->gyro[a], block->gyro[a], count, gyroOffset[a], SimpleIMU::IMU_GyroScale);
+	}
+	if (raw->temp != NULL && block->temp != NULL)
+	{
+		for (uint16_t i = 0; i < count; i++)
+			block->temp[i] = SimpleIMU::scaleTemp(raw->temp[i]);
+	}
+	block->count = count;
+	block->time = raw->time;
+	block->period = raw->period;
+}
+
+// Convert raw frames into a block
+uint16_t SimpleIMU::convertFrames(const uint8_t *frames, uint16_t count, IMUSampleBlock *block)
+{
+	if (block->count >= block->size)
+		return 0;
+	if (count > block->size - block->count)
+		count = block->size - block->count;
+	uint8_t sensors = SimpleIMU::IMU_FIFOSensors;
+	uint8_t frameSize = SimpleIMU::IMU_FIFOFrameSize;
+	if (frameSize == 0)
+	{
+		sensors = IMU_FIFO_ACCEL | IMU_FIFO_TEMP | IMU_FIFO_GYRO;
+		frameSize = 14;
+	}
+
+	/* One channel per axis in register order, as readFIFOBlock unpacks them */
+	int16_t accelOffset[3] = {SimpleIMU::IMU_AccelOffsetX, SimpleIMU::IMU_AccelOffsetY, SimpleIMU::IMU_AccelOffsetZ};
+	int16_t gyroOffset[3] = {SimpleIMU::IMU_GyroOffsetX, SimpleIMU::IMU_GyroOffsetY, SimpleIMU::IMU_GyroOffsetZ};
+	float bias[7], scale[7];
+	float *out[7];
+	uint8_t channels = 0;
+	uint16_t index = block->count;
+	if (sensors & IMU_FIFO_ACCEL)
+	{
+		for (uint8_t a = 0; a < 3; a++, channels++)
+		{
+			bias[channels] = accelOffset[a];
+			scale[channels] = SimpleIMU::IMU_AccelScale;
+			out[channels] = block->accel[a] == NULL ? NULL : block->accel[a] + index;
+		}
+	}
+	if (sensors & IMU_FIFO_TEMP)
+	{
+		/* t / 340 + 36.53 as (t - bias) * scale */
+		bias[channels] = -36.53f * 340.0f;
+		scale[channels] = 1.0f / 340.0f;
+		out[channels++] = block->temp == NULL ? NULL : block->temp + index;
+	}
+	for (uint8_t a = 0; a < 3; a++)
+	{
+		if (!(sensors & (IMU_FIFO_GYRO_X >> a)))
+			continue;
+		bias[channels] = gyroOffset[a];
+		scale[channels] = SimpleIMU::IMU_GyroScale;
+		out[channels++] = block->gyro[a] == NULL ? NULL : block->gyro[a] + index;
+	}
+	SimpleIMU_ConvertFrames(frames, frameSize, count, channels, bias, scale, out);
+	block->count = index + count;
+	return count;
+}
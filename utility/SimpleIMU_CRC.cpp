@@ -0,0 +1,22 @@
+/*
+ *  CRC helper for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "SimpleIMU_CRC.h"
+
+// Compute CRC-16/CCITT-FALSE, polynomial 0x1021
+uint16_t SimpleIMU_CRC16(const uint8_t *data, uint16_t length, uint16_t crc)
+{
+	for (uint16_t i = 0; i < length; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+		for (uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
@@ -0,0 +1,25 @@
+/*
+ *  CRC helper for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#ifndef SIMPLEIMU_CRC_H
+#define SIMPLEIMU_CRC_H
+
+#include <Arduino.h>
+
+/*
+ * Function to compute the CRC-16/CCITT-FALSE of a block of bytes.
+ *
+ * params: data, pointer to the bytes
+ * 		   length, number of bytes
+ * 		   crc, the CRC of the previous block, to continue over several blocks
+ * returns: uint16_t, the CRC of the bytes
+ */
+uint16_t SimpleIMU_CRC16(const uint8_t *data, uint16_t length, uint16_t crc = 0xFFFF);
+
+#endif /* SIMPLEIMU_CRC_H */
@@ -0,0 +1,87 @@
+/*
+ *  Calibration storage for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "SimpleIMU_MPU6050.h"
+#include "SimpleIMU_CRC.h"
+
+/* Number of bytes of IMUCalibration covered by the CRC */
+#define IMU_CALIBRATION_CRC_LENGTH (sizeof(IMUCalibration) - sizeof(uint16_t))
+
+// Export calibration
+uint8_t SimpleIMU::getCalibration(IMUCalibration *cal)
+{
+	/* Offsets set by hand carry no temperature, take the current one */
+	if (!SimpleIMU::IMU_HasCalibTemp)
+	{
+		uint16_t errors = SimpleIMU::IMU_ErrorCount;
+		SimpleIMU::sampleCalibTemp();
+		if (!SimpleIMU::IMU_HasCalibTemp)
+			return SimpleIMU::statusSince(errors);
+	}
+	cal->version = IMU_CALIBRATION_VERSION;
+	cal->gyroRange = SimpleIMU::IMU_GyroFullScale;
+	cal->accelRange = SimpleIMU::IMU_AccelFullScale;
+	cal->reserved = 0;
+	cal->gyroOffset[0] = SimpleIMU::IMU_GyroOffsetX;
+	cal->gyroOffset[1] = SimpleIMU::IMU_GyroOffsetY;
+	cal->gyroOffset[2] = SimpleIMU::IMU_GyroOffsetZ;
+	cal->accelOffset[0] = SimpleIMU::IMU_AccelOffsetX;
+	cal->accelOffset[1] = SimpleIMU::IMU_AccelOffsetY;
+	cal->accelOffset[2] = SimpleIMU::IMU_AccelOffsetZ;
+	cal->temperature = SimpleIMU::IMU_CalibTemp;
+	cal->crc = SimpleIMU_CRC16((const uint8_t *)cal, IMU_CALIBRATION_CRC_LENGTH);
+	return IMU_OK;
+}
+
+// Load calibration
+bool SimpleIMU::setCalibration(const IMUCalibration *cal, int16_t maxTempDelta)
+{
+	if (cal->version != IMU_CALIBRATION_VERSION)
+		return false;
+	if (cal->crc != SimpleIMU_CRC16((const uint8_t *)cal, IMU_CALIBRATION_CRC_LENGTH))
+		return false;
+	if (cal->gyroRange > MPU6050_IMU::MPU6050_GYRO_FS_2000 || cal->accelRange > MPU6050_IMU::MPU6050_ACCEL_FS_16)
+		return false;
+
+	/* The bias drifts with temperature, so an old record may no longer fit */
+	if (maxTempDelta > 0)
+	{
+		uint8_t buffer[2];
+		if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_TEMP_OUT_H, buffer, 2) != IMU_OK)
+			return false;
+		int16_t t = SimpleIMU::scaleTempFixed((int16_t)(buffer[0] << 8 | buffer[1]));
+		if (abs(t - cal->temperature) > maxTempDelta)
+			return false;
+	}
+
+	uint8_t gyroRange = SimpleIMU::IMU_GyroFullScale;
+	uint8_t accelRange = SimpleIMU::IMU_AccelFullScale;
+	SimpleIMU::IMU_GyroOffsetX = SimpleIMU::rescaleOffset(cal->gyroOffset[0], cal->gyroRange, gyroRange);
+	SimpleIMU::IMU_GyroOffsetY = SimpleIMU::rescaleOffset(cal->gyroOffset[1], cal->gyroRange, gyroRange);
+	SimpleIMU::IMU_GyroOffsetZ = SimpleIMU::rescaleOffset(cal->gyroOffset[2], cal->gyroRange, gyroRange);
+	SimpleIMU::IMU_AccelOffsetX = SimpleIMU::rescaleOffset(cal->accelOffset[0], cal->accelRange, accelRange);
+	SimpleIMU::IMU_AccelOffsetY = SimpleIMU::rescaleOffset(cal->accelOffset[1], cal->accelRange, accelRange);
+	SimpleIMU::IMU_AccelOffsetZ = SimpleIMU::rescaleOffset(cal->accelOffset[2], cal->accelRange, accelRange);
+	SimpleIMU::IMU_CalibTemp = cal->temperature;
+	SimpleIMU::IMU_HasCalibTemp = true;
+	return true;
+}
+
+// Keep the temperature of the calibration
+void SimpleIMU::sampleCalibTemp()
+{
+	uint8_t buffer[2];
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_TEMP_OUT_H, buffer, 2) != IMU_OK)
+		return;
+	SimpleIMU::IMU_CalibTemp = SimpleIMU::scaleTempFixed((int16_t)(buffer[0] << 8 | buffer[1]));
+	SimpleIMU::IMU_HasCalibTemp = true;
+}
@@ -0,0 +1,193 @@
+/*
+ *  Non-blocking calibration for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU_Calibrator.h"
+#include "SimpleIMU_MPU6050.h"
+
+// Constructor
+SimpleIMU_Calibrator::SimpleIMU_Calibrator(SimpleIMU *imu)
+{
+	SimpleIMU_Calibrator::CAL_IMU = imu;
+	SimpleIMU_Calibrator::CAL_State = IMU_CALIB_IDLE;
+	SimpleIMU_Calibrator::CAL_Sensors = 0;
+	SimpleIMU_Calibrator::CAL_Count = 0;
+	SimpleIMU_Calibrator::CAL_Temp = 0;
+	SimpleIMU_Calibrator::CAL_Rejected = 0;
+	for (uint8_t i = 0; i < 6; i++)
+		SimpleIMU_Calibrator::CAL_M2[i] = 0;
+}
+
+// Start calibration
+void SimpleIMU_Calibrator::begin(uint8_t sensors, uint16_t samples, uint8_t window, float maxGyroNoise, float maxAccelNoise)
+{
+	SimpleIMU_Calibrator::CAL_Sensors = sensors & (IMU_CALIB_GYRO | IMU_CALIB_ACCEL);
+	SimpleIMU_Calibrator::CAL_Samples = samples;
+	SimpleIMU_Calibrator::CAL_WindowSize = window < 2 ? 2 : window;
+	SimpleIMU_Calibrator::CAL_WindowCount = 0;
+	SimpleIMU_Calibrator::CAL_Count = 0;
+	SimpleIMU_Calibrator::CAL_Rejected = 0;
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		SimpleIMU_Calibrator::CAL_WindowMean[i] = 0;
+		SimpleIMU_Calibrator::CAL_WindowM2[i] = 0;
+		SimpleIMU_Calibrator::CAL_Mean[i] = 0;
+		SimpleIMU_Calibrator::CAL_M2[i] = 0;
+	}
+
+	/* Thresholds in counts^2 of the current ranges */
+	float gyroCounts = maxGyroNoise / SimpleIMU_Calibrator::CAL_IMU->IMU_GyroScale;
+	float accelCounts = maxAccelNoise / SimpleIMU_Calibrator::CAL_IMU->IMU_AccelScale;
+	SimpleIMU_Calibrator::CAL_MaxVariance[0] = gyroCounts * gyroCounts;
+	SimpleIMU_Calibrator::CAL_MaxVariance[1] = accelCounts * accelCounts;
+
+	/* One sample per output sample of the IMU, the accelerometer updates at 1 kHz at most */
+	SimpleIMU_Calibrator::CAL_Period = 1000000.0 / SimpleIMU_Calibrator::CAL_IMU->getOutputDataRate();
+	if (SimpleIMU_Calibrator::CAL_Period < 1000 && (SimpleIMU_Calibrator::CAL_Sensors & IMU_CALIB_ACCEL))
+		SimpleIMU_Calibrator::CAL_Period = 1000;
+	SimpleIMU_Calibrator::CAL_LastSample = micros() - SimpleIMU_Calibrator::CAL_Period;
+	SimpleIMU_Calibrator::CAL_State = SimpleIMU_Calibrator::CAL_Sensors ? IMU_CALIB_RUNNING : IMU_CALIB_IDLE;
+}
+
+// Advance calibration
+uint8_t SimpleIMU_Calibrator::poll()
+{
+	if (SimpleIMU_Calibrator::CAL_State != IMU_CALIB_RUNNING)
+		return SimpleIMU_Calibrator::CAL_State;
+
+	/* The clock of the IMU is off by a few percent, the period only keeps INT_STATUS from being polled early */
+	uint32_t now = micros();
+	if (now - SimpleIMU_Calibrator::CAL_LastSample < SimpleIMU_Calibrator::CAL_Period - SimpleIMU_Calibrator::CAL_Period / 8)
+		return IMU_CALIB_RUNNING;
+
+	/* One sample per data ready, a failed read leaves the window untouched */
+	SimpleIMU *imu = SimpleIMU_Calibrator::CAL_IMU;
+	uint8_t int_status;
+	if (imu->readRegisters(MPU6050_IMU::MPU6050_RA_INT_STATUS, &int_status, 1) != IMU_OK)
+		return IMU_CALIB_RUNNING;
+	imu->IMU_PendingEvents |= int_status & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	if (!(int_status & (1 << MPU6050_IMU::MPU6050_INTERRUPT_DATA_RDY_BIT)))
+		return IMU_CALIB_RUNNING;
+	IMURawSample raw;
+	if (imu->readMotionRaw(&raw) != IMU_OK)
+		return IMU_CALIB_RUNNING;
+	SimpleIMU_Calibrator::CAL_LastSample = now;
+	SimpleIMU_Calibrator::CAL_Temp = raw.temp;
+
+	/* Welford update of the window mean and sum of squared differences */
+	float value[6] = {(float)raw.accel[0], (float)raw.accel[1], (float)raw.accel[2],
+					  (float)raw.gyro[0], (float)raw.gyro[1], (float)raw.gyro[2]};
+	uint8_t n = ++SimpleIMU_Calibrator::CAL_WindowCount;
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		float delta = value[i] - SimpleIMU_Calibrator::CAL_WindowMean[i];
+		SimpleIMU_Calibrator::CAL_WindowMean[i] += delta / n;
+		SimpleIMU_Calibrator::CAL_WindowM2[i] += delta * (value[i] - SimpleIMU_Calibrator::CAL_WindowMean[i]);
+	}
+
+	if (n >= SimpleIMU_Calibrator::CAL_WindowSize)
+		SimpleIMU_Calibrator::closeWindow();
+	return SimpleIMU_Calibrator::CAL_State;
+}
+
+// Accept or reject the current window
+void SimpleIMU_Calibrator::closeWindow()
+{
+	uint8_t n = SimpleIMU_Calibrator::CAL_WindowCount;
+	bool moving = false;
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		bool gyro = i >= 3;
+		if (!(SimpleIMU_Calibrator::CAL_Sensors & (gyro ? IMU_CALIB_GYRO : IMU_CALIB_ACCEL)))
+			continue;
+		if (SimpleIMU_Calibrator::CAL_WindowM2[i] / (n - 1) > SimpleIMU_Calibrator::CAL_MaxVariance[gyro ? 0 : 1])
+			moving = true;
+	}
+
+	if (moving)
+	{
+		SimpleIMU_Calibrator::CAL_Rejected++;
+		if (SimpleIMU_Calibrator::CAL_Rejected > IMU_CALIB_MAX_REJECTED)
+			SimpleIMU_Calibrator::CAL_State = IMU_CALIB_FAILED;
+	}
+	else
+	{
+		/* Merge the window into the accepted samples */
+		float total = SimpleIMU_Calibrator::CAL_Count + n;
+		for (uint8_t i = 0; i < 6; i++)
+		{
+			float delta = SimpleIMU_Calibrator::CAL_WindowMean[i] - SimpleIMU_Calibrator::CAL_Mean[i];
+			SimpleIMU_Calibrator::CAL_Mean[i] += delta * n / total;
+			SimpleIMU_Calibrator::CAL_M2[i] += SimpleIMU_Calibrator::CAL_WindowM2[i] + delta * delta * SimpleIMU_Calibrator::CAL_Count * n / total;
+		}
+		SimpleIMU_Calibrator::CAL_Count += n;
+		if (SimpleIMU_Calibrator::CAL_Count >= SimpleIMU_Calibrator::CAL_Samples)
+			SimpleIMU_Calibrator::finish();
+	}
+
+	SimpleIMU_Calibrator::CAL_WindowCount = 0;
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		SimpleIMU_Calibrator::CAL_WindowMean[i] = 0;
+		SimpleIMU_Calibrator::CAL_WindowM2[i] = 0;
+	}
+}
+
+// Write offsets into the IMU
+void SimpleIMU_Calibrator::finish()
+{
+	SimpleIMU *imu = SimpleIMU_Calibrator::CAL_IMU;
+	if (SimpleIMU_Calibrator::CAL_Sensors & IMU_CALIB_ACCEL)
+	{
+		imu->IMU_AccelOffsetX = lround(SimpleIMU_Calibrator::CAL_Mean[0]);
+		imu->IMU_AccelOffsetY = lround(SimpleIMU_Calibrator::CAL_Mean[1]);
+		imu->IMU_AccelOffsetZ = lround(SimpleIMU_Calibrator::CAL_Mean[2]);
+	}
+	if (SimpleIMU_Calibrator::CAL_Sensors & IMU_CALIB_GYRO)
+	{
+		imu->IMU_GyroOffsetX = lround(SimpleIMU_Calibrator::CAL_Mean[3]);
+		imu->IMU_GyroOffsetY = lround(SimpleIMU_Calibrator::CAL_Mean[4]);
+		imu->IMU_GyroOffsetZ = lround(SimpleIMU_Calibrator::CAL_Mean[5]);
+	}
+	imu->IMU_CalibTemp = imu->scaleTempFixed(SimpleIMU_Calibrator::CAL_Temp);
+	imu->IMU_HasCalibTemp = true;
+	SimpleIMU_Calibrator::CAL_State = IMU_CALIB_DONE;
+}
+
+// Get calibration state
+uint8_t SimpleIMU_Calibrator::getState()
+{
+	return SimpleIMU_Calibrator::CAL_State;
+}
+
+// Get gyroscope noise of the accepted samples
+float SimpleIMU_Calibrator::getQuality()
+{
+	if (SimpleIMU_Calibrator::CAL_Count < 2)
+		return 0;
+	float variance = 0;
+	for (uint8_t i = 3; i < 6; i++)
+		if (SimpleIMU_Calibrator::CAL_M2[i] > variance)
+			variance = SimpleIMU_Calibrator::CAL_M2[i];
+	variance /= SimpleIMU_Calibrator::CAL_Count - 1;
+	return sqrt(variance) * SimpleIMU_Calibrator::CAL_IMU->IMU_GyroScale;
+}
+
+// Get number of rejected windows
+uint16_t SimpleIMU_Calibrator::getRejectedWindows()
+{
+	return SimpleIMU_Calibrator::CAL_Rejected;
+}
+
+// Get number of accepted samples
+uint16_t SimpleIMU_Calibrator::getSampleCount()
+{
+	return SimpleIMU_Calibrator::CAL_Count;
+}
@@ -0,0 +1,228 @@
+/*
+ *  Conversion of raw frame blocks for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include <string.h>
+#include "../SimpleIMU_Convert.h"
+
+#if defined(__SSE2__)
+#define IMU_CONVERT_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+/* AVX2 is built with a target attribute and picked at run time */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(ARDUINO)
+#define IMU_CONVERT_HAS_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define IMU_CONVERT_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+ * Every kernel converts one channel of count frames and returns how many
+ * it converted, a multiple of its width. p points at the channel in the
+ * first frame.
+ */
+typedef uint32_t (*IMUConvertChannel)(const uint8_t *p, uint8_t stride, uint32_t count, float bias, float scale,
+									  float *out);
+
+/* The kernel in use, 0xFF until the first conversion picks one */
+static uint8_t convertKernel = 0xFF;
+
+// Convert one channel a value at a time
+static uint32_t convertScalar(const uint8_t *p, uint8_t stride, uint32_t count, float bias, float scale, float *out)
+{
+	for (uint32_t i = 0; i < count; i++, p += stride)
+		out[i] = ((float)(int16_t)(p[0] << 8 | p[1]) - bias) * scale;
+	return count;
+}
+
+#if defined(IMU_CONVERT_HAS_SSE2) || defined(IMU_CONVERT_HAS_NEON)
+// Load one unaligned channel in the byte order of the host
+static inline uint16_t loadWord(const uint8_t *p)
+{
+	uint16_t w;
+	memcpy(&w, p, 2);
+	return w;
+}
+#endif
+
+#if defined(IMU_CONVERT_HAS_SSE2)
+// Convert one channel eight frames at a time with SSE2
+static uint32_t convertSSE2(const uint8_t *p, uint8_t stride, uint32_t count, float bias, float scale, float *out)
+{
+	__m128 b = _mm_set1_ps(bias);
+	__m128 s = _mm_set1_ps(scale);
+	uint32_t i = 0;
+	for (; i + 8 <= count; i += 8, p += 8 * stride)
+	{
+		__m128i w = _mm_cvtsi32_si128(loadWord(p));
+		w = _mm_insert_epi16(w, loadWord(p + stride), 1);
+		w = _mm_insert_epi16(w, loadWord(p + 2 * stride), 2);
+		w = _mm_insert_epi16(w, loadWord(p + 3 * stride), 3);
+		w = _mm_insert_epi16(w, loadWord(p + 4 * stride), 4);
+		w = _mm_insert_epi16(w, loadWord(p + 5 * stride), 5);
+		w = _mm_insert_epi16(w, loadWord(p + 6 * stride), 6);
+		w = _mm_insert_epi16(w, loadWord(p + 7 * stride), 7);
+		w = _mm_or_si128(_mm_slli_epi16(w, 8), _mm_srli_epi16(w, 8));
+
+		/* Each word doubled into a dword and shifted back down extends its sign */
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16);
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(lo), b), s));
+		_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(hi), b), s));
+	}
+	return i;
+}
+#endif
+
+#if defined(IMU_CONVERT_HAS_AVX2)
+// Convert one channel eight frames at a time with AVX2 gathers
+__attribute__((target("avx2"))) static uint32_t convertAVX2(const uint8_t *p, uint8_t stride, uint32_t count, float bias,
+															float scale, float *out)
+{
+	/*
+	 * Each lane gathers the four bytes starting at the channel, the shuffle
+	 * moves its two bytes swapped to the top and the arithmetic shift brings
+	 * them down with their sign. The last frame is left to the scalar
+	 * kernel, so the two extra bytes never lie past the block.
+	 */
+	__m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+	__m256i swap = _mm256_setr_epi8(-128, -128, 1, 0, -128, -128, 5, 4, -128, -128, 9, 8, -128, -128, 13, 12,
+									-128, -128, 1, 0, -128, -128, 5, 4, -128, -128, 9, 8, -128, -128, 13, 12);
+	__m256 b = _mm256_set1_ps(bias);
+	__m256 s = _mm256_set1_ps(scale);
+	uint32_t i = 0;
+	for (; i + 8 < count; i += 8, p += 8 * stride)
+	{
+		__m256i w = _mm256_i32gather_epi32((const int *)p, index, 1);
+		w = _mm256_srai_epi32(_mm256_shuffle_epi8(w, swap), 16);
+		_mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(w), b), s));
+	}
+	return i;
+}
+
+// Check the processor for AVX2
+static bool hasAVX2()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+#endif
+
+#if defined(IMU_CONVERT_HAS_NEON)
+// Convert one channel eight frames at a time with NEON
+static uint32_t convertNEON(const uint8_t *p, uint8_t stride, uint32_t count, float bias, float scale, float *out)
+{
+	float32x4_t b = vdupq_n_f32(bias);
+	float32x4_t s = vdupq_n_f32(scale);
+	uint32_t i = 0;
+	for (; i + 8 <= count; i += 8, p += 8 * stride)
+	{
+		uint16x8_t w = vdupq_n_u16(loadWord(p));
+		w = vsetq_lane_u16(loadWord(p + stride), w, 1);
+		w = vsetq_lane_u16(loadWord(p + 2 * stride), w, 2);
+		w = vsetq_lane_u16(loadWord(p + 3 * stride), w, 3);
+		w = vsetq_lane_u16(loadWord(p + 4 * stride), w, 4);
+		w = vsetq_lane_u16(loadWord(p + 5 * stride), w, 5);
+		w = vsetq_lane_u16(loadWord(p + 6 * stride), w, 6);
+		w = vsetq_lane_u16(loadWord(p + 7 * stride), w, 7);
+		int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_u16(w)));
+		float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+		float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+		vst1q_f32(out + i, vmulq_f32(vsubq_f32(lo, b), s));
+		vst1q_f32(out + i + 4, vmulq_f32(vsubq_f32(hi, b), s));
+	}
+	return i;
+}
+#endif
+
+// Get the channel kernel
+static IMUConvertChannel channelKernel(uint8_t kernel)
+{
+	switch (kernel)
+	{
+#if defined(IMU_CONVERT_HAS_SSE2)
+	case IMU_CONVERT_SSE2:
+		return convertSSE2;
+#endif
+#if defined(IMU_CONVERT_HAS_AVX2)
+	case IMU_CONVERT_AVX2:
+		return hasAVX2() ? convertAVX2 : NULL;
+#endif
+#if defined(IMU_CONVERT_HAS_NEON)
+	case IMU_CONVERT_NEON:
+		return convertNEON;
+#endif
+	case IMU_CONVERT_SCALAR:
+		return convertScalar;
+	default:
+		return NULL;
+	}
+}
+
+// Convert a block of frames
+static void convertFrames(IMUConvertChannel kernel, const uint8_t *frames, uint8_t frameSize, uint32_t count,
+						  uint8_t channels, const float *bias, const float *scale, float *const *out)
+{
+	if (channels > frameSize / 2)
+		channels = frameSize / 2;
+	for (uint32_t done = 0; done < count; done += IMU_CONVERT_CHUNK)
+	{
+		uint32_t chunk = count - done < IMU_CONVERT_CHUNK ? count - done : IMU_CONVERT_CHUNK;
+		const uint8_t *p = frames + done * frameSize;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			if (out[c] == NULL)
+				continue;
+			uint32_t n = kernel(p + 2 * c, frameSize, chunk, bias[c], scale[c], out[c] + done);
+			convertScalar(p + 2 * c + n * frameSize, frameSize, chunk - n, bias[c], scale[c], out[c] + done + n);
+		}
+	}
+}
+
+// Convert with the fastest kernel
+void SimpleIMU_ConvertFrames(const uint8_t *frames, uint8_t frameSize, uint32_t count, uint8_t channels,
+							 const float *bias, const float *scale, float *const *out)
+{
+	convertFrames(channelKernel(SimpleIMU_GetConvertKernel()), frames, frameSize, count, channels, bias, scale, out);
+}
+
+// Convert with the scalar reference
+void SimpleIMU_ConvertFramesScalar(const uint8_t *frames, uint8_t frameSize, uint32_t count, uint8_t channels,
+								   const float *bias, const float *scale, float *const *out)
+{
+	convertFrames(convertScalar, frames, frameSize, count, channels, bias, scale, out);
+}
+
+// Get the kernel in use
+uint8_t SimpleIMU_GetConvertKernel()
+{
+	if (convertKernel == 0xFF)
+	{
+		const uint8_t fastest[] = {IMU_CONVERT_AVX2, IMU_CONVERT_NEON, IMU_CONVERT_SSE2, IMU_CONVERT_SCALAR};
+		for (uint8_t i = 0; convertKernel == 0xFF; i++)
+			if (channelKernel(fastest[i]) != NULL)
+				convertKernel = fastest[i];
+	}
+	return convertKernel;
+}
+
+// Choose the kernel
+bool SimpleIMU_SetConvertKernel(uint8_t kernel)
+{
+	if (channelKernel(kernel) == NULL)
+		return false;
+	convertKernel = kernel;
+	return true;
+}
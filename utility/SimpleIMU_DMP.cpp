@@ -0,0 +1,235 @@
+/*
+ *  Digital Motion Processor support for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "SimpleIMU_MPU6050.h"
+
+// Write a block into DMP memory
+bool SimpleIMU::writeMemoryBlock(const uint8_t *data, uint16_t size, uint16_t address, bool progmem)
+{
+	uint8_t chunk[MPU6050_IMU::MPU6050_DMP_MEMORY_CHUNK_SIZE];
+	uint8_t verify[MPU6050_IMU::MPU6050_DMP_MEMORY_CHUNK_SIZE];
+	uint16_t i = 0;
+	while (i < size)
+	{
+		uint8_t bank = address >> 8;
+		uint8_t offset = address & 0xFF;
+		if (bank >= MPU6050_IMU::MPU6050_DMP_MEMORY_BANKS)
+			return false;
+
+		/* A chunk must not cross into the next bank */
+		uint16_t length = MPU6050_IMU::MPU6050_DMP_MEMORY_CHUNK_SIZE;
+		if (size - i < length)
+			length = size - i;
+		if (256 - offset < length)
+			length = 256 - offset;
+		for (uint8_t j = 0; j < length; j++)
+			chunk[j] = progmem ? pgm_read_byte(data + i + j) : data[i + j];
+
+		uint16_t errors = SimpleIMU::IMU_ErrorCount;
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_BANK_SEL, bank);
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_MEM_START_ADDR, offset);
+		SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_MEM_R_W, chunk, length);
+		if (SimpleIMU::statusSince(errors) != IMU_OK)
+			return false;
+
+		/* Read the chunk back to verify it */
+		if (SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_MEM_START_ADDR, offset) != IMU_OK ||
+			SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_MEM_R_W, verify, length) != IMU_OK)
+			return false;
+		if (memcmp(chunk, verify, length) != 0)
+			return false;
+
+		i += length;
+		address += length;
+	}
+	return true;
+}
+
+// Apply a DMP configuration table
+bool SimpleIMU::writeDMPConfig(const uint8_t *config, uint16_t size, bool progmem)
+{
+	uint16_t i = 0;
+	while (i + 3 < size)
+	{
+		uint8_t entry[3];
+		for (uint8_t j = 0; j < 3; j++)
+			entry[j] = progmem ? pgm_read_byte(config + i + j) : config[i + j];
+		i += 3;
+		if (entry[2] > 0)
+		{
+			if (i + entry[2] > size || !SimpleIMU::writeMemoryBlock(config + i, entry[2], (uint16_t)entry[0] << 8 | entry[1], progmem))
+				return false;
+			i += entry[2];
+			continue;
+		}
+
+		/* The only special entry of MotionApps 2.0 enables the zero motion, FIFO overflow and DMP interrupts */
+		uint8_t special = progmem ? pgm_read_byte(config + i) : config[i];
+		if (special != IMU_DMP_CONFIG_INTERRUPTS)
+			return false;
+		SimpleIMU::IMU_IntConfig[1] = (1 << MPU6050_IMU::MPU6050_INTERRUPT_ZMOT_BIT) | (1 << MPU6050_IMU::MPU6050_INTERRUPT_FIFO_OFLOW_BIT) |
+									  (1 << MPU6050_IMU::MPU6050_INTERRUPT_DMP_INT_BIT);
+		if (SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE, SimpleIMU::IMU_IntConfig[1]) != IMU_OK)
+			return false;
+		i++;
+	}
+	return i == size;
+}
+
+// Load firmware and start the DMP
+bool SimpleIMU::beginDMP(const uint8_t *firmware, uint16_t size, const uint8_t *config, uint16_t configSize, uint8_t packetSize, bool progmem)
+{
+	/* A packet has to hold at least the quaternion */
+	if (packetSize < 16)
+		return false;
+
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	SimpleIMU::IMU_DMPPacketSize = 0;
+	SimpleIMU::IMU_FIFOSensors = 0;
+	SimpleIMU::IMU_FIFOFrameSize = 0;
+
+	/* Reset, then wake up with the z gyroscope as clock as MotionApps does */
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, 1 << MPU6050_IMU::MPU6050_PWR1_DEVICE_RESET_BIT);
+	delay(100);
+
+	/* The reset cleared the offset registers and the auxiliary master, recover must not bring them back */
+	SimpleIMU::IMU_HasOffsetRegs = false;
+	SimpleIMU::IMU_AuxSlaves = 0;
+	SimpleIMU::IMU_AuxReadSlaves = 0;
+	for (uint8_t i = 0; i < IMU_AUX_SLAVES; i++)
+		SimpleIMU::IMU_AuxLength[i] = 0;
+	SimpleIMU::IMU_AuxMasterCtrl = 0;
+	SimpleIMU::IMU_AuxDelayed = 0;
+	SimpleIMU::IMU_PowerConfig[0] = MPU6050_IMU::MPU6050_CLOCK_PLL_ZGYRO;
+	SimpleIMU::IMU_PowerConfig[1] = 0x00;
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, MPU6050_IMU::MPU6050_CLOCK_PLL_ZGYRO);
+	SimpleIMU::IMU_IntConfig[0] = 0x00;
+	SimpleIMU::IMU_IntConfig[1] = 0x00;
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE, 0x00);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_FIFO_EN, 0x00);
+
+	/* 200 Hz, frame sync on the temperature, 42 Hz filter, 2000 deg/s, 2 g, as the DMP image expects */
+	SimpleIMU::beginConfig();
+	SimpleIMU::setSampleRateDivider(4);
+	SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_CONFIG, 0x38, MPU6050_IMU::MPU6050_EXT_SYNC_TEMP_OUT_L << 3);
+	SimpleIMU::setDLPFMode(MPU6050_IMU::MPU6050_DLPF_BW_42);
+	SimpleIMU::setGyroRange(MPU6050_IMU::MPU6050_GYRO_FS_2000);
+	SimpleIMU::setAccelRange(MPU6050_IMU::MPU6050_ACCEL_FS_2);
+
+	/* The reset cleared the registers, so write all of them */
+	SimpleIMU::IMU_ConfigDirty = (1 << IMU_CONFIG_SHADOW_LENGTH) - 1;
+	SimpleIMU::commitConfig();
+
+	if (!SimpleIMU::writeMemoryBlock(firmware, size, 0, progmem))
+		return false;
+	if (!SimpleIMU::writeDMPConfig(config, configSize, progmem))
+		return false;
+
+	/* Program start address, and the OTP bank of the gyroscope offsets marked invalid */
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_DMP_CFG_1, IMU_DMP_START_ADDRESS >> 8);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_DMP_CFG_2, IMU_DMP_START_ADDRESS & 0xFF);
+	uint8_t offs_tc;
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_XG_OFFS_TC, &offs_tc, 1) == IMU_OK)
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_XG_OFFS_TC, offs_tc & ~(1 << MPU6050_IMU::MPU6050_TC_OTP_BNK_VLD_BIT));
+
+	/* Enable and reset FIFO and DMP, interrupt on every packet and on an overflow */
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL,
+							 (1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_EN_BIT) | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT) |
+								 (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_RESET_BIT) | (1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_RESET_BIT));
+	SimpleIMU::IMU_IntConfig[1] = (1 << MPU6050_IMU::MPU6050_INTERRUPT_FIFO_OFLOW_BIT) | (1 << MPU6050_IMU::MPU6050_INTERRUPT_DMP_INT_BIT);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE, SimpleIMU::IMU_IntConfig[1]);
+	if (SimpleIMU::statusSince(errors) != IMU_OK)
+		return false;
+	SimpleIMU::IMU_DMPPacketSize = packetSize;
+	return true;
+}
+
+// Stop the DMP
+uint8_t SimpleIMU::endDMP()
+{
+	uint8_t user_ctrl;
+	SimpleIMU::IMU_DMPPacketSize = 0;
+	SimpleIMU::IMU_IntConfig[1] = 0x00;
+	uint8_t status = SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE, 0x00);
+	if (status == IMU_OK)
+		status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_USER_CTRL, &user_ctrl, 1);
+	if (status != IMU_OK)
+		return status;
+	user_ctrl &= ~((1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_EN_BIT) | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT));
+	return SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, user_ctrl | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_RESET_BIT));
+}
+
+// Set DMP packet rate
+bool SimpleIMU::setDMPOutputRate(uint8_t divider)
+{
+	uint8_t rate[2] = {0x00, divider};
+	return SimpleIMU::writeMemoryBlock(rate, 2, IMU_DMP_FIFO_RATE_ADDRESS, false);
+}
+
+// Read a quaternion packet from the FIFO
+int SimpleIMU::readDMPQuaternion(float *q)
+{
+	uint8_t packetSize = SimpleIMU::IMU_DMPPacketSize;
+	if (packetSize == 0)
+		return 0;
+
+	/* Overflow flag and FIFO count in one transfer, a count read after an earlier packet may be below the size */
+	uint8_t int_status, fifo_count[2];
+	IMURegisterRead reads[2] = {
+		{MPU6050_IMU::MPU6050_RA_INT_STATUS, &int_status, 1},
+		{MPU6050_IMU::MPU6050_RA_FIFO_COUNTH, fifo_count, 2}};
+	if (SimpleIMU::readRegisters(reads, 2) != IMU_OK)
+		return 0;
+	SimpleIMU::IMU_PendingEvents |= int_status & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	uint16_t count = (uint16_t)fifo_count[0] << 8 | fifo_count[1];
+	if ((int_status & (1 << MPU6050_IMU::MPU6050_INTERRUPT_FIFO_OFLOW_BIT)) || count >= IMU_FIFO_SIZE)
+	{
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL,
+								 (1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_EN_BIT) | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT) |
+									 (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_RESET_BIT));
+		return -1;
+	}
+	if (count < packetSize)
+		return 0;
+
+	/* The quaternion is at the start of the packet, the rest is read and dropped */
+	uint8_t buffer[IMU_TRANSFER_BUFFER_LENGTH];
+	uint8_t quat[16];
+	uint8_t read = 0;
+	uint16_t maxLength = SimpleIMU::getMaxTransfer();
+	while (read < packetSize)
+	{
+		uint8_t length = packetSize - read;
+		if (length > maxLength)
+			length = maxLength;
+		if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_FIFO_R_W, buffer, length) != IMU_OK)
+		{
+			/* The rest of the packet is left in the FIFO, which is out of step as after an overflow */
+			SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL,
+									 (1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_EN_BIT) | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT) |
+										 (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_RESET_BIT));
+			return -1;
+		}
+		for (uint8_t i = 0; i < length && read + i < 16; i++)
+			quat[read + i] = buffer[i];
+		read += length;
+	}
+
+	/* Four big endian 32 bit values in Q30 */
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		int32_t value = (int32_t)((uint32_t)quat[4 * i] << 24 | (uint32_t)quat[4 * i + 1] << 16 |
+								  (uint32_t)quat[4 * i + 2] << 8 | quat[4 * i + 3]);
+		q[i] = value * (1.0f / 1073741824.0f);
+	}
+	return 1;
+}
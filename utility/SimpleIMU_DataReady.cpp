@@ -0,0 +1,165 @@
+/*
+ *  Interrupt driven acquisition for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "SimpleIMU_MPU6050.h"
+
+/* Orders the ring buffer accesses between producer and consumer */
+#if defined(__AVR__)
+#define IMU_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define IMU_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+SimpleIMU *SimpleIMU::IMU_DataReadyInstance = NULL;
+
+// Data ready interrupt service routine
+void IMU_ISR_ATTR SimpleIMU::dataReadyISR()
+{
+	if (SimpleIMU::IMU_DataReadyInstance != NULL)
+		SimpleIMU::IMU_DataReadyInstance->handleDataReady();
+}
+
+// Start interrupt driven acquisition
+bool SimpleIMU::beginDataReady(uint8_t pin, IMUSample *buffer, uint8_t size)
+{
+	if (buffer == NULL || size == 0 || size > 128 || (size & (size - 1)) != 0)
+		return false;
+
+	SimpleIMU::IMU_RingBuffer = buffer;
+	SimpleIMU::IMU_RingMask = size - 1;
+	SimpleIMU::IMU_TimingLocked = false;
+	SimpleIMU::IMU_RingHead = 0;
+	SimpleIMU::IMU_RingTail = 0;
+	SimpleIMU::IMU_RingOverruns = 0;
+	SimpleIMU::IMU_MissedSamples = 0;
+	SimpleIMU::IMU_DataReadyServiced = SimpleIMU::IMU_DataReadyCount;
+
+	/* Active high push-pull 50us pulse, cleared by any read */
+	SimpleIMU::IMU_IntConfig[0] = 1 << MPU6050_IMU::MPU6050_INTCFG_INT_RD_CLEAR_BIT;
+	SimpleIMU::IMU_IntConfig[1] = 1 << MPU6050_IMU::MPU6050_INTERRUPT_DATA_RDY_BIT;
+	if (SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_INT_PIN_CFG, SimpleIMU::IMU_IntConfig, 2) != IMU_OK)
+	{
+		SimpleIMU::IMU_RingBuffer = NULL;
+		return false;
+	}
+
+	SimpleIMU::IMU_IntPin = pin;
+	if (pin != IMU_NO_PIN)
+	{
+		SimpleIMU::IMU_DataReadyInstance = this;
+		pinMode(pin, INPUT);
+		attachInterrupt(digitalPinToInterrupt(pin), SimpleIMU::dataReadyISR, RISING);
+	}
+	return true;
+}
+
+// Stop interrupt driven acquisition
+uint8_t SimpleIMU::endDataReady()
+{
+	SimpleIMU::IMU_IntConfig[1] = 0x00;
+	uint8_t status = SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE, 0x00);
+	if (SimpleIMU::IMU_IntPin != IMU_NO_PIN)
+	{
+		detachInterrupt(digitalPinToInterrupt(SimpleIMU::IMU_IntPin));
+		if (SimpleIMU::IMU_DataReadyInstance == this)
+			SimpleIMU::IMU_DataReadyInstance = NULL;
+	}
+	SimpleIMU::IMU_IntPin = IMU_NO_PIN;
+	SimpleIMU::IMU_RingBuffer = NULL;
+	return status;
+}
+
+// Record a data ready event
+void IMU_ISR_ATTR SimpleIMU::handleDataReady()
+{
+	/* The time first, it is valid once the count has moved */
+	SimpleIMU::IMU_DataReadyTime = micros();
+	SimpleIMU::IMU_DataReadyCount++;
+}
+
+// Read the pending sample into the ring buffer
+bool SimpleIMU::updateDataReady()
+{
+	if (SimpleIMU::IMU_RingBuffer == NULL)
+		return false;
+
+	/* Single byte counter, read atomically without disabling interrupts */
+	uint8_t count = SimpleIMU::IMU_DataReadyCount;
+	uint8_t pending = count - SimpleIMU::IMU_DataReadyServiced;
+	if (pending == 0)
+		return false;
+	SimpleIMU::IMU_DataReadyServiced = count;
+	SimpleIMU::IMU_MissedSamples += pending - 1;
+
+	/* Read twice until equal, the four bytes are not read atomically on 8 bit boards */
+	uint32_t time;
+	do
+		time = SimpleIMU::IMU_DataReadyTime;
+	while (time != SimpleIMU::IMU_DataReadyTime);
+	SimpleIMU::trackDataReady(pending, time);
+
+	uint8_t head = SimpleIMU::IMU_RingHead;
+	uint8_t next = (head + 1) & SimpleIMU::IMU_RingMask;
+	if (next == SimpleIMU::IMU_RingTail)
+	{
+		/* Read anyway to clear the interrupt status of the IMU */
+		IMUSample dropped;
+		if (SimpleIMU::readMotion(&dropped.accel, &dropped.gyro, &dropped.temp) != IMU_OK)
+			SimpleIMU::IMU_MissedSamples++;
+		else
+			SimpleIMU::IMU_RingOverruns++;
+		return false;
+	}
+
+	/* The event is consumed, a sample that could not be read is missed */
+	IMUSample *sample = &SimpleIMU::IMU_RingBuffer[head];
+	if (SimpleIMU::readMotion(&sample->accel, &sample->gyro, &sample->temp) != IMU_OK)
+	{
+		SimpleIMU::IMU_MissedSamples++;
+		return false;
+	}
+	sample->time = time;
+	IMU_MEMORY_BARRIER();
+	SimpleIMU::IMU_RingHead = next;
+	return true;
+}
+
+// Get number of samples in the ring buffer
+uint8_t SimpleIMU::availableSamples()
+{
+	return (SimpleIMU::IMU_RingHead - SimpleIMU::IMU_RingTail) & SimpleIMU::IMU_RingMask;
+}
+
+// Take the oldest sample from the ring buffer
+bool SimpleIMU::readSample(IMUSample *sample)
+{
+	uint8_t tail = SimpleIMU::IMU_RingTail;
+	if (SimpleIMU::IMU_RingBuffer == NULL || tail == SimpleIMU::IMU_RingHead)
+		return false;
+	IMU_MEMORY_BARRIER();
+	*sample = SimpleIMU::IMU_RingBuffer[tail];
+	IMU_MEMORY_BARRIER();
+	SimpleIMU::IMU_RingTail = (tail + 1) & SimpleIMU::IMU_RingMask;
+	return true;
+}
+
+// Get number of samples dropped on a full ring buffer
+uint16_t SimpleIMU::getOverrunCount()
+{
+	return SimpleIMU::IMU_RingOverruns;
+}
+
+// Get number of samples overwritten in the IMU
+uint16_t SimpleIMU::getMissedCount()
+{
+	return SimpleIMU::IMU_MissedSamples;
+}
@@ -0,0 +1,508 @@
+/*
+ *  Filter and decimation stages for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include <string.h>
+#include "../SimpleIMU_Filter.h"
+
+#define IMU_FILTER_PI 3.14159265f
+
+/* Largest gain of a Q15 decimator, so the sums keep 16 bits for the data */
+#define IMU_FILTER_MAX_GAIN 65536UL
+
+// Saturate a sum to 16 bits
+static int16_t saturate(int32_t value)
+{
+	if (value > 32767)
+		return 32767;
+	if (value < -32768)
+		return -32768;
+	return (int16_t)value;
+}
+
+// Divide a sum by the gain, rounded to nearest
+static int32_t divide(int32_t sum, uint32_t gain, uint8_t shift)
+{
+	if (shift == 0)
+		return sum;
+	if (shift != 0xFF)
+		return (sum + ((int32_t)1 << (shift - 1))) >> shift;
+	return (sum >= 0 ? sum + (int32_t)(gain / 2) : sum - (int32_t)(gain / 2)) / (int32_t)gain;
+}
+
+// Constructor
+SimpleIMU_Filter::SimpleIMU_Filter(uint8_t channels, uint8_t format)
+{
+	SimpleIMU_Filter::FLT_Channels = channels > IMU_FILTER_MAX_CHANNELS ? IMU_FILTER_MAX_CHANNELS : channels;
+	SimpleIMU_Filter::FLT_Format = format;
+	SimpleIMU_Filter::FLT_Next = NULL;
+	SimpleIMU_Filter::FLT_Taps = NULL;
+	SimpleIMU_Filter::FLT_History = NULL;
+	SimpleIMU_Filter::FLT_Order = 1;
+	SimpleIMU_Filter::setGain(1);
+	SimpleIMU_Filter::configure(IMU_FILTER_NONE, 1);
+}
+
+// Set the type and clear the state
+void SimpleIMU_Filter::configure(uint8_t type, uint8_t length)
+{
+	SimpleIMU_Filter::FLT_Type = type;
+	SimpleIMU_Filter::FLT_Length = length;
+	SimpleIMU_Filter::FLT_Position = 0;
+	memset(&(SimpleIMU_Filter::FLT_State), 0, sizeof(SimpleIMU_Filter::FLT_State));
+	if (SimpleIMU_Filter::FLT_History != NULL && (type == IMU_FILTER_FIR || type == IMU_FILTER_MOVING_AVERAGE))
+	{
+		size_t size = SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 ? sizeof(int16_t) : sizeof(float);
+		memset(SimpleIMU_Filter::FLT_History, 0, size * length * SimpleIMU_Filter::FLT_Channels);
+	}
+}
+
+// Set the gain
+void SimpleIMU_Filter::setGain(uint32_t gain)
+{
+	SimpleIMU_Filter::FLT_Gain = gain;
+	SimpleIMU_Filter::FLT_InverseGain = 1.0f / gain;
+	SimpleIMU_Filter::FLT_Shift = 0xFF;
+	for (uint8_t shift = 0; shift < 32; shift++)
+		if (gain == (uint32_t)1 << shift)
+			SimpleIMU_Filter::FLT_Shift = shift;
+}
+
+// Set the next stage
+bool SimpleIMU_Filter::setNext(SimpleIMU_Filter *next)
+{
+	if (next != NULL && (next->FLT_Channels != SimpleIMU_Filter::FLT_Channels || next->FLT_Format != SimpleIMU_Filter::FLT_Format))
+		return false;
+	SimpleIMU_Filter::FLT_Next = next;
+	return true;
+}
+
+// Make the stage a biquad
+bool SimpleIMU_Filter::setBiquad(const float *coeffs)
+{
+	int16_t q[5];
+	for (uint8_t i = 0; i < 5; i++)
+	{
+		if (SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 && !(coeffs[i] >= -2.0f && coeffs[i] < 2.0f))
+			return false;
+		long value = lround(coeffs[i] * 16384.0f);
+		q[i] = value > 32767 ? 32767 : value;
+	}
+
+	/* The poles have to stay inside the unit circle, for Q15 after rounding the coefficients */
+	float a1 = SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 ? q[3] / 16384.0f : coeffs[3];
+	float a2 = SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 ? q[4] / 16384.0f : coeffs[4];
+	if (!(a2 < 1.0f && fabs(a1) < 1.0f + a2))
+		return false;
+	for (uint8_t i = 0; i < 5; i++)
+	{
+		SimpleIMU_Filter::FLT_BiquadFloat[i] = coeffs[i];
+		SimpleIMU_Filter::FLT_Biquad[i] = q[i];
+	}
+	SimpleIMU_Filter::configure(IMU_FILTER_BIQUAD, 1);
+	return true;
+}
+
+// Make the stage a Butterworth low pass
+bool SimpleIMU_Filter::setLowPass(float cutoff, float rate)
+{
+	if (!(cutoff > 0.0f && cutoff < rate / 2))
+		return false;
+	if (SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 && cutoff < rate * IMU_FILTER_MIN_CUTOFF)
+		return false;
+	float w = 2.0f * IMU_FILTER_PI * cutoff / rate;
+	float c = cos(w);
+	float alpha = sin(w) * 0.70710678f; /* sin(w) / (2 * Q) with Q = 1 / sqrt(2) */
+	float a0 = 1.0f + alpha;
+	float coeffs[5] = {(1.0f - c) / 2 / a0, 0.0f, 0.0f, -2.0f * c / a0, (1.0f - alpha) / a0};
+
+	/*
+	 * In Q15 a2 is nudged by at most 2 LSB so 1 + a1 + a2 is a multiple of
+	 * 4 LSB, then b0 is a quarter of it, so the gain at 0 Hz stays exactly 1
+	 */
+	if (SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15)
+	{
+		long a1 = lround(coeffs[3] * 16384.0f);
+		long a2 = lround(coeffs[4] * 16384.0f);
+		long rest = (16384 + a1 + a2) % 4;
+		a2 += rest == 3 ? 1 : -rest;
+		coeffs[0] = (16384 + a1 + a2) / 4 / 16384.0f;
+		coeffs[3] = a1 / 16384.0f;
+		coeffs[4] = a2 / 16384.0f;
+	}
+	coeffs[1] = 2.0f * coeffs[0];
+	coeffs[2] = coeffs[0];
+	return SimpleIMU_Filter::setBiquad(coeffs);
+}
+
+// Make the stage a Butterworth high pass
+bool SimpleIMU_Filter::setHighPass(float cutoff, float rate)
+{
+	if (!(cutoff > 0.0f && cutoff < rate / 2))
+		return false;
+	if (SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 && cutoff < rate * IMU_FILTER_MIN_CUTOFF)
+		return false;
+	float w = 2.0f * IMU_FILTER_PI * cutoff / rate;
+	float c = cos(w);
+	float alpha = sin(w) * 0.70710678f;
+	float a0 = 1.0f + alpha;
+	float coeffs[5] = {(1.0f + c) / 2 / a0, 0.0f, 0.0f, -2.0f * c / a0, (1.0f - alpha) / a0};
+
+	/* In Q15 b1 is exactly -2 b0, so the gain at 0 Hz stays 0 */
+	if (SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15)
+		coeffs[0] = lround(coeffs[0] * 16384.0f) / 16384.0f;
+	coeffs[1] = -2.0f * coeffs[0];
+	coeffs[2] = coeffs[0];
+	return SimpleIMU_Filter::setBiquad(coeffs);
+}
+
+// Make the stage a Q15 FIR filter
+bool SimpleIMU_Filter::setFIR(const int16_t *taps, uint8_t length, int16_t *history)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_Q15 || length == 0)
+		return false;
+	SimpleIMU_Filter::FLT_Taps = taps;
+	SimpleIMU_Filter::FLT_History = history;
+	SimpleIMU_Filter::configure(IMU_FILTER_FIR, length);
+	return true;
+}
+
+// Make the stage a float FIR filter
+bool SimpleIMU_Filter::setFIR(const float *taps, uint8_t length, float *history)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_FLOAT || length == 0)
+		return false;
+	SimpleIMU_Filter::FLT_Taps = taps;
+	SimpleIMU_Filter::FLT_History = history;
+	SimpleIMU_Filter::configure(IMU_FILTER_FIR, length);
+	return true;
+}
+
+// Make the stage a Q15 moving average
+bool SimpleIMU_Filter::setMovingAverage(uint8_t length, int16_t *history)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_Q15 || length == 0)
+		return false;
+	SimpleIMU_Filter::FLT_History = history;
+	SimpleIMU_Filter::setGain(length);
+	SimpleIMU_Filter::configure(IMU_FILTER_MOVING_AVERAGE, length);
+	return true;
+}
+
+// Make the stage a float moving average
+bool SimpleIMU_Filter::setMovingAverage(uint8_t length, float *history)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_FLOAT || length == 0)
+		return false;
+	SimpleIMU_Filter::FLT_History = history;
+	SimpleIMU_Filter::setGain(length);
+	SimpleIMU_Filter::configure(IMU_FILTER_MOVING_AVERAGE, length);
+	return true;
+}
+
+// Make the stage a CIC decimator
+bool SimpleIMU_Filter::setDecimator(uint8_t factor, uint8_t order)
+{
+	uint8_t maxOrder = SimpleIMU_Filter::FLT_Format == IMU_FILTER_Q15 ? IMU_FILTER_MAX_ORDER : 1;
+	if (factor == 0 || order == 0 || order > maxOrder)
+		return false;
+	uint32_t gain = 1;
+	for (uint8_t i = 0; i < order; i++)
+		gain *= factor;
+	if (gain > IMU_FILTER_MAX_GAIN)
+		return false;
+	SimpleIMU_Filter::FLT_Order = order;
+	SimpleIMU_Filter::setGain(gain);
+	SimpleIMU_Filter::configure(IMU_FILTER_DECIMATOR, factor);
+	return true;
+}
+
+// Clear the state of the pipeline
+void SimpleIMU_Filter::reset()
+{
+	SimpleIMU_Filter::configure(SimpleIMU_Filter::FLT_Type, SimpleIMU_Filter::FLT_Length);
+	if (SimpleIMU_Filter::FLT_Next != NULL)
+		SimpleIMU_Filter::FLT_Next->reset();
+}
+
+// Get the decimation of the pipeline
+uint16_t SimpleIMU_Filter::getDecimation()
+{
+	uint16_t decimation = SimpleIMU_Filter::FLT_Type == IMU_FILTER_DECIMATOR ? SimpleIMU_Filter::FLT_Length : 1;
+	if (SimpleIMU_Filter::FLT_Next != NULL)
+		decimation *= SimpleIMU_Filter::FLT_Next->getDecimation();
+	return decimation;
+}
+
+// Run the stage on one Q15 sample
+bool SimpleIMU_Filter::process(int16_t *values)
+{
+	uint8_t channels = SimpleIMU_Filter::FLT_Channels;
+	uint8_t length = SimpleIMU_Filter::FLT_Length;
+	uint8_t position = SimpleIMU_Filter::FLT_Position;
+	switch (SimpleIMU_Filter::FLT_Type)
+	{
+	case IMU_FILTER_BIQUAD:
+	{
+		/*
+		 * Direct form 1 on the saturated outputs, the sum in Q14 wraps on the
+		 * way. The bits shifted out are carried into the next sum, so the
+		 * rounding averages out instead of being amplified by poles close
+		 * to 1 into an offset.
+		 */
+		const int16_t *b = SimpleIMU_Filter::FLT_Biquad;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			int32_t *s = SimpleIMU_Filter::FLT_State.q[c];
+			int16_t x = values[c];
+			uint32_t sum = (uint32_t)((int32_t)b[0] * x) + (uint32_t)((int32_t)b[1] * s[0]) + (uint32_t)((int32_t)b[2] * s[1]) -
+						   (uint32_t)((int32_t)b[3] * s[2]) - (uint32_t)((int32_t)b[4] * s[3]) + (uint32_t)s[4];
+			s[4] = sum & 0x3FFF;
+			int16_t y = saturate((int32_t)sum >> 14);
+			s[1] = s[0];
+			s[0] = x;
+			s[3] = s[2];
+			s[2] = y;
+			values[c] = y;
+		}
+		return true;
+	}
+	case IMU_FILTER_FIR:
+	{
+		const int16_t *taps = (const int16_t *)SimpleIMU_Filter::FLT_Taps;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			int16_t *history = (int16_t *)SimpleIMU_Filter::FLT_History + c * length;
+			history[position] = values[c];
+			uint32_t sum = 1UL << 14;
+			uint8_t index = position;
+			for (uint8_t k = 0; k < length; k++)
+			{
+				sum += (uint32_t)((int32_t)taps[k] * history[index]);
+				index = index == 0 ? length - 1 : index - 1;
+			}
+			values[c] = saturate((int32_t)sum >> 15);
+		}
+		SimpleIMU_Filter::FLT_Position = position + 1 == length ? 0 : position + 1;
+		return true;
+	}
+	case IMU_FILTER_MOVING_AVERAGE:
+	{
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			int16_t *history = (int16_t *)SimpleIMU_Filter::FLT_History + c * length;
+			int32_t *sum = &(SimpleIMU_Filter::FLT_State.q[c][0]);
+			*sum += values[c] - history[position];
+			history[position] = values[c];
+			values[c] = saturate(divide(*sum, SimpleIMU_Filter::FLT_Gain, SimpleIMU_Filter::FLT_Shift));
+		}
+		SimpleIMU_Filter::FLT_Position = position + 1 == length ? 0 : position + 1;
+		return true;
+	}
+	case IMU_FILTER_DECIMATOR:
+	{
+		/* Integrators at the input rate, combs at the output rate, all wrapping */
+		uint8_t order = SimpleIMU_Filter::FLT_Order;
+		bool output = position + 1 == length;
+		SimpleIMU_Filter::FLT_Position = output ? 0 : position + 1;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			uint32_t *s = (uint32_t *)SimpleIMU_Filter::FLT_State.q[c];
+			s[0] += (uint32_t)(int32_t)values[c];
+			for (uint8_t i = 1; i < order; i++)
+				s[i] += s[i - 1];
+			if (!output)
+				continue;
+			uint32_t v = s[order - 1];
+			for (uint8_t i = 0; i < order; i++)
+			{
+				uint32_t delayed = s[order + i];
+				s[order + i] = v;
+				v -= delayed;
+			}
+			values[c] = saturate(divide((int32_t)v, SimpleIMU_Filter::FLT_Gain, SimpleIMU_Filter::FLT_Shift));
+		}
+		return output;
+	}
+	default:
+		return true;
+	}
+}
+
+// Run the stage on one float sample
+bool SimpleIMU_Filter::process(float *values)
+{
+	uint8_t channels = SimpleIMU_Filter::FLT_Channels;
+	uint8_t length = SimpleIMU_Filter::FLT_Length;
+	uint8_t position = SimpleIMU_Filter::FLT_Position;
+	switch (SimpleIMU_Filter::FLT_Type)
+	{
+	case IMU_FILTER_BIQUAD:
+	{
+		/* Transposed direct form 2 */
+		const float *b = SimpleIMU_Filter::FLT_BiquadFloat;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			float *s = SimpleIMU_Filter::FLT_State.f[c];
+			float x = values[c];
+			float y = b[0] * x + s[0];
+			s[0] = b[1] * x - b[3] * y + s[1];
+			s[1] = b[2] * x - b[4] * y;
+			values[c] = y;
+		}
+		return true;
+	}
+	case IMU_FILTER_FIR:
+	{
+		const float *taps = (const float *)SimpleIMU_Filter::FLT_Taps;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			float *history = (float *)SimpleIMU_Filter::FLT_History + c * length;
+			history[position] = values[c];
+			float sum = 0.0f;
+			uint8_t index = position;
+			for (uint8_t k = 0; k < length; k++)
+			{
+				sum += taps[k] * history[index];
+				index = index == 0 ? length - 1 : index - 1;
+			}
+			values[c] = sum;
+		}
+		SimpleIMU_Filter::FLT_Position = position + 1 == length ? 0 : position + 1;
+		return true;
+	}
+	case IMU_FILTER_MOVING_AVERAGE:
+	{
+		bool wrap = position + 1 == length;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			float *history = (float *)SimpleIMU_Filter::FLT_History + c * length;
+			float *sum = &(SimpleIMU_Filter::FLT_State.f[c][0]);
+			*sum += values[c] - history[position];
+			history[position] = values[c];
+			values[c] = *sum * SimpleIMU_Filter::FLT_InverseGain;
+
+			/* Summed afresh once per round, so the rounding of the running sum does not add up */
+			if (wrap)
+			{
+				*sum = 0.0f;
+				for (uint8_t k = 0; k < length; k++)
+					*sum += history[k];
+			}
+		}
+		SimpleIMU_Filter::FLT_Position = wrap ? 0 : position + 1;
+		return true;
+	}
+	case IMU_FILTER_DECIMATOR:
+	{
+		/* Order 1 only, integrate and dump, so the sum never grows */
+		bool output = position + 1 == length;
+		SimpleIMU_Filter::FLT_Position = output ? 0 : position + 1;
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			float *sum = &(SimpleIMU_Filter::FLT_State.f[c][0]);
+			*sum += values[c];
+			if (!output)
+				continue;
+			values[c] = *sum * SimpleIMU_Filter::FLT_InverseGain;
+			*sum = 0.0f;
+		}
+		return output;
+	}
+	default:
+		return true;
+	}
+}
+
+// Run one Q15 sample through the pipeline
+bool SimpleIMU_Filter::update(int16_t *values)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_Q15 || !SimpleIMU_Filter::process(values))
+		return false;
+	return SimpleIMU_Filter::FLT_Next == NULL || SimpleIMU_Filter::FLT_Next->update(values);
+}
+
+// Run one float sample through the pipeline
+bool SimpleIMU_Filter::update(float *values)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_FLOAT || !SimpleIMU_Filter::process(values))
+		return false;
+	return SimpleIMU_Filter::FLT_Next == NULL || SimpleIMU_Filter::FLT_Next->update(values);
+}
+
+// Run one accelerometer sample through the pipeline
+bool SimpleIMU_Filter::update(AccelData *accel)
+{
+	float values[IMU_FILTER_MAX_CHANNELS > 3 ? IMU_FILTER_MAX_CHANNELS : 3] = {accel->x, accel->y, accel->z};
+	if (SimpleIMU_Filter::FLT_Channels != 3 || !SimpleIMU_Filter::update(values))
+		return false;
+	accel->x = values[0];
+	accel->y = values[1];
+	accel->z = values[2];
+	return true;
+}
+
+// Run one gyroscope sample through the pipeline
+bool SimpleIMU_Filter::update(GyroData *gyro)
+{
+	float values[IMU_FILTER_MAX_CHANNELS > 3 ? IMU_FILTER_MAX_CHANNELS : 3] = {gyro->x, gyro->y, gyro->z};
+	if (SimpleIMU_Filter::FLT_Channels != 3 || !SimpleIMU_Filter::update(values))
+		return false;
+	gyro->x = values[0];
+	gyro->y = values[1];
+	gyro->z = values[2];
+	return true;
+}
+
+// Run a Q15 block through the pipeline
+uint16_t SimpleIMU_Filter::updateBlock(int16_t *const *data, uint16_t count)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_Q15)
+		return 0;
+	uint8_t channels = SimpleIMU_Filter::FLT_Channels;
+	int16_t values[IMU_FILTER_MAX_CHANNELS];
+	uint16_t out = 0;
+	for (uint16_t i = 0; i < count; i++)
+	{
+		for (uint8_t c = 0; c < channels; c++)
+			values[c] = data[c][i];
+		if (!SimpleIMU_Filter::process(values))
+			continue;
+		for (uint8_t c = 0; c < channels; c++)
+			data[c][out] = values[c];
+		out++;
+	}
+	if (SimpleIMU_Filter::FLT_Next == NULL)
+		return out;
+	return SimpleIMU_Filter::FLT_Next->updateBlock(data, out);
+}
+
+// Run a float block through the pipeline
+uint16_t SimpleIMU_Filter::updateBlock(float *const *data, uint16_t count)
+{
+	if (SimpleIMU_Filter::FLT_Format != IMU_FILTER_FLOAT)
+		return 0;
+	uint8_t channels = SimpleIMU_Filter::FLT_Channels;
+	float values[IMU_FILTER_MAX_CHANNELS];
+	uint16_t out = 0;
+	for (uint16_t i = 0; i < count; i++)
+	{
+		for (uint8_t c = 0; c < channels; c++)
+			values[c] = data[c][i];
+		if (!SimpleIMU_Filter::process(values))
+			continue;
+		for (uint8_t c = 0; c < channels; c++)
+			data[c][out] = values[c];
+		out++;
+	}
+	if (SimpleIMU_Filter::FLT_Next == NULL)
+		return out;
+	return SimpleIMU_Filter::FLT_Next->updateBlock(data, out);
+}
@@ -0,0 +1,298 @@
+/*
+ *  Orientation estimation for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU_Fusion.h"
+
+#define IMU_DEG_TO_RAD 0.0174532925f
+#define IMU_RAD_TO_DEG 57.2957795f
+
+// Constructor
+SimpleIMU_Fusion::SimpleIMU_Fusion(uint8_t algorithm)
+{
+	SimpleIMU_Fusion::FUS_Algorithm = algorithm;
+	SimpleIMU_Fusion::FUS_Alpha = 0.98f;
+	SimpleIMU_Fusion::FUS_Kp = 1.0f;
+	SimpleIMU_Fusion::FUS_Ki = 0.0f;
+	SimpleIMU_Fusion::FUS_Beta = 0.1f;
+	SimpleIMU_Fusion::FUS_LastTime = 0;
+	SimpleIMU_Fusion::reset();
+}
+
+// Select algorithm
+void SimpleIMU_Fusion::setAlgorithm(uint8_t algorithm)
+{
+	SimpleIMU_Fusion::FUS_Algorithm = algorithm;
+	for (uint8_t i = 0; i < 3; i++)
+		SimpleIMU_Fusion::FUS_Integral[i] = 0.0f;
+}
+
+// Set complementary filter weight
+void SimpleIMU_Fusion::setComplementaryAlpha(float alpha)
+{
+	SimpleIMU_Fusion::FUS_Alpha = alpha;
+}
+
+// Set Mahony filter gains
+void SimpleIMU_Fusion::setMahonyGains(float kp, float ki)
+{
+	SimpleIMU_Fusion::FUS_Kp = kp;
+	SimpleIMU_Fusion::FUS_Ki = ki;
+}
+
+// Set Madgwick filter gain
+void SimpleIMU_Fusion::setMadgwickBeta(float beta)
+{
+	SimpleIMU_Fusion::FUS_Beta = beta;
+}
+
+// Reset orientation
+void SimpleIMU_Fusion::reset()
+{
+	SimpleIMU_Fusion::FUS_Q[0] = 1.0f;
+	SimpleIMU_Fusion::FUS_Q[1] = 0.0f;
+	SimpleIMU_Fusion::FUS_Q[2] = 0.0f;
+	SimpleIMU_Fusion::FUS_Q[3] = 0.0f;
+	for (uint8_t i = 0; i < 3; i++)
+		SimpleIMU_Fusion::FUS_Integral[i] = 0.0f;
+	SimpleIMU_Fusion::FUS_HasTime = false;
+}
+
+// Set orientation from gravity
+void SimpleIMU_Fusion::initFromAccel(const AccelData *accel)
+{
+	float roll = atan2(accel->y, accel->z);
+	float pitch = atan2(-accel->x, sqrt(accel->y * accel->y + accel->z * accel->z));
+	float cr = cos(roll * 0.5f), sr = sin(roll * 0.5f);
+	float cp = cos(pitch * 0.5f), sp = sin(pitch * 0.5f);
+	SimpleIMU_Fusion::FUS_Q[0] = cr * cp;
+	SimpleIMU_Fusion::FUS_Q[1] = sr * cp;
+	SimpleIMU_Fusion::FUS_Q[2] = cr * sp;
+	SimpleIMU_Fusion::FUS_Q[3] = -sr * sp;
+	for (uint8_t i = 0; i < 3; i++)
+		SimpleIMU_Fusion::FUS_Integral[i] = 0.0f;
+}
+
+// Inverse square root
+float SimpleIMU_Fusion::invSqrt(float x)
+{
+#if IMU_FUSION_FAST_INVSQRT
+	/* Bit level approximation refined by two Newton steps, relative error below 5e-6 */
+	union
+	{
+		float f;
+		int32_t i;
+	} u;
+	float half = 0.5f * x;
+	u.f = x;
+	u.i = 0x5F3759DF - (u.i >> 1);
+	u.f = u.f * (1.5f - half * u.f * u.f);
+	u.f = u.f * (1.5f - half * u.f * u.f);
+	return u.f;
+#else
+	return 1.0f / sqrt(x);
+#endif
+}
+
+// Update orientation
+void SimpleIMU_Fusion::update(const AccelData *accel, const GyroData *gyro, float dt)
+{
+	float gx = gyro->x * IMU_DEG_TO_RAD;
+	float gy = gyro->y * IMU_DEG_TO_RAD;
+	float gz = gyro->z * IMU_DEG_TO_RAD;
+	if (SimpleIMU_Fusion::FUS_Algorithm == IMU_FUSION_MADGWICK)
+		SimpleIMU_Fusion::updateMadgwick(gx, gy, gz, accel->x, accel->y, accel->z, dt);
+	else
+		SimpleIMU_Fusion::updateMahony(gx, gy, gz, accel->x, accel->y, accel->z, dt);
+}
+
+// Update orientation from fixed point data
+void SimpleIMU_Fusion::update(const AccelDataFixed *accel, const GyroDataFixed *gyro, float dt)
+{
+	/* Milli degrees per second to rad/s, the accelerometer scale cancels out */
+	const float scale = IMU_DEG_TO_RAD * 0.001f;
+	float gx = gyro->x * scale;
+	float gy = gyro->y * scale;
+	float gz = gyro->z * scale;
+	if (SimpleIMU_Fusion::FUS_Algorithm == IMU_FUSION_MADGWICK)
+		SimpleIMU_Fusion::updateMadgwick(gx, gy, gz, accel->x, accel->y, accel->z, dt);
+	else
+		SimpleIMU_Fusion::updateMahony(gx, gy, gz, accel->x, accel->y, accel->z, dt);
+}
+
+// Update orientation from a sample
+void SimpleIMU_Fusion::update(const IMUSample *sample, float dt)
+{
+	SimpleIMU_Fusion::update(&sample->accel, &sample->gyro, dt);
+}
+
+// Update with the time between the samples
+bool SimpleIMU_Fusion::update(const IMUSample *sample)
+{
+	uint32_t last = SimpleIMU_Fusion::FUS_LastTime;
+	bool hasTime = SimpleIMU_Fusion::FUS_HasTime;
+	SimpleIMU_Fusion::FUS_LastTime = sample->time;
+	SimpleIMU_Fusion::FUS_HasTime = true;
+	if (!hasTime)
+		return false;
+	SimpleIMU_Fusion::update(&sample->accel, &sample->gyro, (uint32_t)(sample->time - last) * 1e-6f);
+	return true;
+}
+
+// Complementary and Mahony filter
+void SimpleIMU_Fusion::updateMahony(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+{
+	float *q = SimpleIMU_Fusion::FUS_Q;
+	float halfDt = 0.5f * dt;
+
+	/* Rotation increment from the gyroscope, as half angles */
+	float hx = gx * halfDt, hy = gy * halfDt, hz = gz * halfDt;
+
+	/* Skip the correction in free fall, when the direction of gravity is unknown */
+	if (ax != 0.0f || ay != 0.0f || az != 0.0f)
+	{
+		float norm = SimpleIMU_Fusion::invSqrt(ax * ax + ay * ay + az * az);
+		ax *= norm;
+		ay *= norm;
+		az *= norm;
+
+		/* Half of the estimated gravity direction */
+		float vx = q[1] * q[3] - q[0] * q[2];
+		float vy = q[0] * q[1] + q[2] * q[3];
+		float vz = q[0] * q[0] - 0.5f + q[3] * q[3];
+
+		/* Half of the error between measured and estimated gravity */
+		float ex = ay * vz - az * vy;
+		float ey = az * vx - ax * vz;
+		float ez = ax * vy - ay * vx;
+
+		if (SimpleIMU_Fusion::FUS_Algorithm == IMU_FUSION_COMPLEMENTARY)
+		{
+			/* Rotate by (1 - alpha) of the error, independent of dt */
+			float k = 1.0f - SimpleIMU_Fusion::FUS_Alpha;
+			hx += ex * k;
+			hy += ey * k;
+			hz += ez * k;
+		}
+		else
+		{
+			if (SimpleIMU_Fusion::FUS_Ki > 0.0f)
+			{
+				float ki = 2.0f * SimpleIMU_Fusion::FUS_Ki * dt;
+				SimpleIMU_Fusion::FUS_Integral[0] += ki * ex;
+				SimpleIMU_Fusion::FUS_Integral[1] += ki * ey;
+				SimpleIMU_Fusion::FUS_Integral[2] += ki * ez;
+				hx += SimpleIMU_Fusion::FUS_Integral[0] * halfDt;
+				hy += SimpleIMU_Fusion::FUS_Integral[1] * halfDt;
+				hz += SimpleIMU_Fusion::FUS_Integral[2] * halfDt;
+			}
+			float kp = 2.0f * SimpleIMU_Fusion::FUS_Kp * halfDt;
+			hx += ex * kp;
+			hy += ey * kp;
+			hz += ez * kp;
+		}
+	}
+
+	/* q += q * (0, h) */
+	float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+	q[0] = q0 - q1 * hx - q2 * hy - q3 * hz;
+	q[1] = q1 + q0 * hx + q2 * hz - q3 * hy;
+	q[2] = q2 + q0 * hy - q1 * hz + q3 * hx;
+	q[3] = q3 + q0 * hz + q1 * hy - q2 * hx;
+
+	float norm = SimpleIMU_Fusion::invSqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+	q[0] *= norm;
+	q[1] *= norm;
+	q[2] *= norm;
+	q[3] *= norm;
+}
+
+// Madgwick filter
+void SimpleIMU_Fusion::updateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+{
+	float *q = SimpleIMU_Fusion::FUS_Q;
+	float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+
+	/* Rate of change of the quaternion from the gyroscope */
+	float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+	float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+	float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+	float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+	/* Skip the correction in free fall, when the direction of gravity is unknown */
+	if (ax != 0.0f || ay != 0.0f || az != 0.0f)
+	{
+		float norm = SimpleIMU_Fusion::invSqrt(ax * ax + ay * ay + az * az);
+		ax *= norm;
+		ay *= norm;
+		az *= norm;
+
+		float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+		float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+		float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+		float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+		/* Gradient of the error between measured and estimated gravity */
+		float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+		float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+		float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+		float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+		float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+		if (sNorm > 0.0f)
+		{
+			sNorm = SimpleIMU_Fusion::FUS_Beta * SimpleIMU_Fusion::invSqrt(sNorm);
+			qDot0 -= sNorm * s0;
+			qDot1 -= sNorm * s1;
+			qDot2 -= sNorm * s2;
+			qDot3 -= sNorm * s3;
+		}
+	}
+
+	q0 += qDot0 * dt;
+	q1 += qDot1 * dt;
+	q2 += qDot2 * dt;
+	q3 += qDot3 * dt;
+
+	float norm = SimpleIMU_Fusion::invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+	q[0] = q0 * norm;
+	q[1] = q1 * norm;
+	q[2] = q2 * norm;
+	q[3] = q3 * norm;
+}
+
+// Get orientation quaternion
+void SimpleIMU_Fusion::getQuaternion(float *q)
+{
+	for (uint8_t i = 0; i < 4; i++)
+		q[i] = SimpleIMU_Fusion::FUS_Q[i];
+}
+
+// Get gravity direction
+void SimpleIMU_Fusion::getGravity(float *gravity)
+{
+	float *q = SimpleIMU_Fusion::FUS_Q;
+	gravity[0] = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+	gravity[1] = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+	gravity[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+// Get Euler angles
+void SimpleIMU_Fusion::getEuler(float *roll, float *pitch, float *yaw)
+{
+	float *q = SimpleIMU_Fusion::FUS_Q;
+	float sinPitch = 2.0f * (q[0] * q[2] - q[3] * q[1]);
+	if (sinPitch > 1.0f)
+		sinPitch = 1.0f;
+	else if (sinPitch < -1.0f)
+		sinPitch = -1.0f;
+	*roll = atan2(2.0f * (q[0] * q[1] + q[2] * q[3]), 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2])) * IMU_RAD_TO_DEG;
+	*pitch = asin(sinPitch) * IMU_RAD_TO_DEG;
+	*yaw = atan2(2.0f * (q[0] * q[3] + q[1] * q[2]), 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3])) * IMU_RAD_TO_DEG;
+}
@@ -0,0 +1,180 @@
+/*
+ *  Linux i2c-dev bus access for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "../SimpleIMU_LinuxI2C.h"
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+
+// Constructor
+SimpleIMU_LinuxI2C::SimpleIMU_LinuxI2C(const char *device)
+{
+	SimpleIMU_LinuxI2C::I2C_Device = device;
+	SimpleIMU_LinuxI2C::I2C_Fd = -1;
+	SimpleIMU_LinuxI2C::I2C_OwnsFd = true;
+	SimpleIMU_LinuxI2C::I2C_Transfers = 0;
+	SimpleIMU_LinuxI2C::I2C_Timeout = IMU_BUS_TIMEOUT;
+}
+
+// Constructor on an open bus
+SimpleIMU_LinuxI2C::SimpleIMU_LinuxI2C(int fd)
+{
+	SimpleIMU_LinuxI2C::I2C_Device = NULL;
+	SimpleIMU_LinuxI2C::I2C_Fd = fd;
+	SimpleIMU_LinuxI2C::I2C_OwnsFd = false;
+	SimpleIMU_LinuxI2C::I2C_Transfers = 0;
+	SimpleIMU_LinuxI2C::I2C_Timeout = IMU_BUS_TIMEOUT;
+}
+
+// Destructor
+SimpleIMU_LinuxI2C::~SimpleIMU_LinuxI2C()
+{
+	if (SimpleIMU_LinuxI2C::I2C_OwnsFd && SimpleIMU_LinuxI2C::I2C_Fd >= 0)
+		close(SimpleIMU_LinuxI2C::I2C_Fd);
+}
+
+// Open the bus
+bool SimpleIMU_LinuxI2C::begin()
+{
+	if (SimpleIMU_LinuxI2C::I2C_Fd < 0)
+	{
+		if (SimpleIMU_LinuxI2C::I2C_Device == NULL)
+			return false;
+		SimpleIMU_LinuxI2C::I2C_Fd = open(SimpleIMU_LinuxI2C::I2C_Device, O_RDWR);
+		if (SimpleIMU_LinuxI2C::I2C_Fd < 0)
+			return false;
+	}
+	SimpleIMU_LinuxI2C::applyTimeout();
+	return true;
+}
+
+// Set the transaction timeout
+void SimpleIMU_LinuxI2C::setTimeout(uint32_t timeout)
+{
+	SimpleIMU_LinuxI2C::I2C_Timeout = timeout;
+	if (SimpleIMU_LinuxI2C::I2C_Fd >= 0)
+		SimpleIMU_LinuxI2C::applyTimeout();
+}
+
+// Pass the timeout to the bus driver in units of 10 ms
+void SimpleIMU_LinuxI2C::applyTimeout()
+{
+	uint32_t timeout = SimpleIMU_LinuxI2C::I2C_Timeout;
+	if (timeout != 0)
+		ioctl(SimpleIMU_LinuxI2C::I2C_Fd, I2C_TIMEOUT, (unsigned long)((timeout + 9999) / 10000));
+}
+
+// Run messages as one combined transaction
+uint8_t SimpleIMU_LinuxI2C::transfer(struct i2c_msg *messages, uint8_t count)
+{
+	struct i2c_rdwr_ioctl_data data;
+	data.msgs = messages;
+	data.nmsgs = count;
+	int result = ioctl(SimpleIMU_LinuxI2C::I2C_Fd, I2C_RDWR, &data);
+	if (result == count)
+		return IMU_OK;
+	if (result >= 0)
+		return IMU_ERROR_SHORT_READ;
+
+	/* Drivers report a missing acknowledge as ENXIO or EREMOTEIO */
+	switch (errno)
+	{
+	case ENXIO:
+	case EREMOTEIO:
+		return IMU_ERROR_NACK;
+	case ETIMEDOUT:
+		return IMU_ERROR_TIMEOUT;
+	default:
+		return IMU_ERROR_BUS;
+	}
+}
+
+// Write consecutive registers in one message
+uint8_t SimpleIMU_LinuxI2C::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length)
+{
+	/* The register address goes first, so the message is one byte longer than the data */
+	uint8_t buffer[IMU_LINUX_I2C_MAX_TRANSFER + 1];
+	if (length > IMU_LINUX_I2C_MAX_TRANSFER)
+		return IMU_ERROR_ARGUMENT;
+	buffer[0] = reg;
+	if (length > 0)
+		memcpy(buffer + 1, data, length);
+
+	struct i2c_msg message;
+	message.addr = address;
+	message.flags = 0;
+	message.len = length + 1;
+	message.buf = buffer;
+	SimpleIMU_LinuxI2C::I2C_Transfers++;
+	return this->transfer(&message, 1);
+}
+
+// Read consecutive registers, address write and read joined by a repeated start
+uint8_t SimpleIMU_LinuxI2C::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length)
+{
+	IMURegisterRead read = {reg, data, length};
+	return SimpleIMU_LinuxI2C::readRegisters(address, &read, 1);
+}
+
+// Read several blocks of registers in as few ioctl calls as possible
+uint8_t SimpleIMU_LinuxI2C::readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count)
+{
+	struct i2c_msg messages[2 * IMU_LINUX_I2C_MAX_READS];
+	uint8_t regs[IMU_LINUX_I2C_MAX_READS];
+	uint8_t status = IMU_OK;
+	for (uint8_t i = 0; i < count; i++)
+		if (reads[i].length > IMU_LINUX_I2C_MAX_TRANSFER)
+			return IMU_ERROR_ARGUMENT;
+	while (count > 0)
+	{
+		uint8_t batch = count < IMU_LINUX_I2C_MAX_READS ? count : IMU_LINUX_I2C_MAX_READS;
+		for (uint8_t i = 0; i < batch; i++)
+		{
+			regs[i] = reads[i].reg;
+			messages[2 * i].addr = address;
+			messages[2 * i].flags = 0;
+			messages[2 * i].len = 1;
+			messages[2 * i].buf = &regs[i];
+			messages[2 * i + 1].addr = address;
+			messages[2 * i + 1].flags = I2C_M_RD;
+			messages[2 * i + 1].len = reads[i].length;
+			messages[2 * i + 1].buf = reads[i].buffer;
+		}
+		SimpleIMU_LinuxI2C::I2C_Transfers++;
+		uint8_t result = this->transfer(messages, 2 * batch);
+		if (status == IMU_OK)
+			status = result;
+		reads += batch;
+		count -= batch;
+	}
+	return status;
+}
+
+// Largest transfer
+uint16_t SimpleIMU_LinuxI2C::getMaxTransfer()
+{
+	return IMU_LINUX_I2C_MAX_TRANSFER;
+}
+
+uint32_t SimpleIMU_LinuxI2C::getTransferCount()
+{
+	return SimpleIMU_LinuxI2C::I2C_Transfers;
+}
+
+void SimpleIMU_LinuxI2C::resetTransferCount()
+{
+	SimpleIMU_LinuxI2C::I2C_Transfers = 0;
+}
+
+#endif
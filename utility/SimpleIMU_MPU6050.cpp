@@ -12,240 +12,758 @@
 #include "../SimpleIMU.h"
 #include "SimpleIMU_MPU6050.h"
 
+// Write a register
+uint8_t SimpleIMU::writeRegister(uint8_t reg, uint8_t value)
+{
+	return SimpleIMU::writeRegisters(reg, &value, 1);
+}
+
+// Write consecutive registers
+uint8_t SimpleIMU::writeRegisters(uint8_t reg, const uint8_t *buffer, uint8_t length)
+{
+	uint8_t status, attempts = 0;
+	do
+		status = SimpleIMU::IMU_Transport->writeRegisters(SimpleIMU::IMU_Addr, reg, buffer, length);
+	while (status != IMU_OK && SimpleIMU::retryTransaction(status, &attempts));
+	return status;
+}
+
+// Read consecutive registers
+uint8_t SimpleIMU::readRegisters(uint8_t reg, uint8_t *buffer, uint8_t length)
+{
+	/* A failed FIFO read has taken bytes out of the FIFO already, it is reset by the caller instead */
+	uint8_t status, attempts = reg == MPU6050_IMU::MPU6050_RA_FIFO_R_W ? 0xFF : 0;
+	do
+		status = SimpleIMU::IMU_Transport->readRegisters(SimpleIMU::IMU_Addr, reg, buffer, length);
+	while (status != IMU_OK && SimpleIMU::retryTransaction(status, &attempts));
+	return status;
+}
+
+// Read several blocks of registers
+uint8_t SimpleIMU::readRegisters(const IMURegisterRead *reads, uint8_t count)
+{
+	uint8_t status, attempts = 0;
+	do
+		status = SimpleIMU::IMU_Transport->readRegisters(SimpleIMU::IMU_Addr, reads, count);
+	while (status != IMU_OK && SimpleIMU::retryTransaction(status, &attempts));
+	return status;
+}
+
+// Largest read in one transaction, the length of a read is a uint8_t
+uint16_t SimpleIMU::getMaxTransfer()
+{
+	uint16_t length = SimpleIMU::IMU_Transport->getMaxTransfer();
+	if (length > IMU_TRANSFER_BUFFER_LENGTH)
+		length = IMU_TRANSFER_BUFFER_LENGTH;
+	return length < 255 ? length : 255;
+}
+
+// Read a block of registers in pieces the transport can carry
+uint8_t SimpleIMU::readRegisterBlock(uint8_t reg, uint8_t *buffer, uint16_t length)
+{
+	uint16_t maxLength = SimpleIMU::getMaxTransfer();
+	if (maxLength == 0)
+		return IMU_ERROR_ARGUMENT;
+	while (length > 0)
+	{
+		uint16_t part = length < maxLength ? length : maxLength;
+		uint8_t status = SimpleIMU::readRegisters(reg, buffer, part);
+		if (status != IMU_OK)
+			return status;
+		if (reg != MPU6050_IMU::MPU6050_RA_FIFO_R_W)
+			reg += part;
+		buffer += part;
+		length -= part;
+	}
+	return IMU_OK;
+}
+
 bool SimpleIMU::init()
 {
+	/* Start the bus as master, the IMU is a slave */
+	if (!SimpleIMU::IMU_Transport->begin())
+		return false;
+
 	/* Disable sleep mode */
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1);
-	Wire.write(0x00);
-	Wire.endTransmission(false);
+	SimpleIMU::IMU_PowerConfig[0] = 0x00;
+	SimpleIMU::IMU_PowerConfig[1] = 0x00;
+	if (SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, 0x00) != IMU_OK)
+		return false;
 
 	/* Check whether device is connected */
-	Wire.write(MPU6050_IMU::MPU6050_RA_WHO_AM_I);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 1, true);
-	uint8_t response = Wire.read();
-	if (response == 255)
+	if (SimpleIMU::checkDevice() != IMU_OK)
 		return false;
 
-	/* Enable DMP */
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_USER_CTRL);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 1, false);
-	uint8_t user_ctrl = Wire.read();
-	user_ctrl |= (1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_EN_BIT);
-	Wire.write(MPU6050_IMU::MPU6050_RA_USER_CTRL);
-	Wire.write(user_ctrl);
-	Wire.endTransmission(true);
+	/* Load the configuration shadow, SMPLRT_DIV to ACCEL_CONFIG in one read */
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_SMPLRT_DIV, SimpleIMU::IMU_ConfigShadow, IMU_CONFIG_SHADOW_LENGTH) != IMU_OK)
+		return false;
+	SimpleIMU::IMU_ConfigDirty = 0;
+	SimpleIMU::IMU_GyroFullScale = SimpleIMU::getGyroRange();
+	SimpleIMU::IMU_AccelFullScale = SimpleIMU::getAccelRange();
+	SimpleIMU::updateGyroScale();
+	SimpleIMU::updateAccelScale();
 	return true;
 }
 
 // Read gyroscope values
-void SimpleIMU::readGyro(GyroData *gyro)
-{
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_GYRO_XOUT_H);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 6, true);
-	int16_t x = (Wire.read() << 8 | Wire.read()) - SimpleIMU::IMU_GyroOffsetX;
-	int16_t y = (Wire.read() << 8 | Wire.read()) - SimpleIMU::IMU_GyroOffsetY;
-	int16_t z = (Wire.read() << 8 | Wire.read()) - SimpleIMU::IMU_GyroOffsetZ;
-	if (SimpleIMU::IMU_GyroFullScale == MPU6050_IMU::MPU6050_GYRO_FS_250)
-	{
-		gyro->x = x / 131.0;
-		gyro->y = y / 131.0;
-		gyro->z = z / 131.0;
-	}
-	else if (SimpleIMU::IMU_GyroFullScale == MPU6050_IMU::MPU6050_GYRO_FS_500)
-	{
-		gyro->x = x / 65.5;
-		gyro->y = y / 65.5;
-		gyro->z = z / 65.5;
-	}
-	else if (SimpleIMU::IMU_GyroFullScale == MPU6050_IMU::MPU6050_GYRO_FS_1000)
-	{
-		gyro->x = x / 32.8;
-		gyro->y = y / 32.8;
-		gyro->z = z / 32.8;
-	}
-	else if (SimpleIMU::IMU_GyroFullScale == MPU6050_IMU::MPU6050_GYRO_FS_2000)
-	{
-		gyro->x = x / 16.4;
-		gyro->y = y / 16.4;
-		gyro->z = z / 16.4;
-	}
+uint8_t SimpleIMU::readGyro(GyroData *gyro)
+{
+	uint8_t buffer[6];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_GYRO_XOUT_H, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	int16_t x = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_GyroOffsetX;
+	int16_t y = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_GyroOffsetY;
+	int16_t z = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_GyroOffsetZ;
+	SimpleIMU::scaleGyro(x, y, z, gyro);
+	return IMU_OK;
+}
+
+// Scale gyroscope values
+void SimpleIMU::scaleGyro(int16_t x, int16_t y, int16_t z, GyroData *gyro)
+{
+	gyro->x = x * SimpleIMU::IMU_GyroScale;
+	gyro->y = y * SimpleIMU::IMU_GyroScale;
+	gyro->z = z * SimpleIMU::IMU_GyroScale;
+}
+
+// Scale gyroscope values to fixed point
+void SimpleIMU::scaleGyroFixed(int16_t x, int16_t y, int16_t z, GyroDataFixed *gyro)
+{
+	int32_t mult = SimpleIMU::IMU_GyroFixedMult;
+	uint8_t shift = SimpleIMU::IMU_GyroFixedShift;
+	int32_t round = (int32_t)1 << (shift - 1);
+	gyro->x = ((int32_t)x * mult + round) >> shift;
+	gyro->y = ((int32_t)y * mult + round) >> shift;
+	gyro->z = ((int32_t)z * mult + round) >> shift;
 }
 
 // Calibrate gyroscope
-void SimpleIMU::calibGyro(int samples)
+uint8_t SimpleIMU::calibGyro(int samples)
 {
-	GyroData gyro;
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	uint8_t buffer[6];
 	int16_t x, y, z;
 	long int sumx = 0, sumy = 0, sumz = 0;
+	int count = 0;
 	for (int i = 0; i < samples; i++)
 	{
-		Wire.beginTransmission(SimpleIMU::IMU_Addr);
-		Wire.write(MPU6050_IMU::MPU6050_RA_GYRO_XOUT_H);
-		Wire.endTransmission(false);
-		Wire.requestFrom(SimpleIMU::IMU_Addr, 6, true);
-		x = (Wire.read() << 8 | Wire.read());
-		y = (Wire.read() << 8 | Wire.read());
-		z = (Wire.read() << 8 | Wire.read());
+		/* Samples that could not be read are left out of the mean */
+		if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_GYRO_XOUT_H, buffer, 6) != IMU_OK)
+			continue;
+		count++;
+		x = (int16_t)(buffer[0] << 8 | buffer[1]);
+		y = (int16_t)(buffer[2] << 8 | buffer[3]);
+		z = (int16_t)(buffer[4] << 8 | buffer[5]);
 		sumx += x;
 		sumy += y;
 		sumz += z;
 	}
-	SimpleIMU::IMU_GyroOffsetX = sumx / samples;
-	SimpleIMU::IMU_GyroOffsetY = sumy / samples;
-	SimpleIMU::IMU_GyroOffsetZ = sumz / samples;
+	if (count == 0)
+		return SimpleIMU::statusSince(errors);
+	SimpleIMU::IMU_GyroOffsetX = sumx / count;
+	SimpleIMU::IMU_GyroOffsetY = sumy / count;
+	SimpleIMU::IMU_GyroOffsetZ = sumz / count;
+	SimpleIMU::sampleCalibTemp();
+	return SimpleIMU::statusSince(errors);
 }
 
 // Set range of gyroscope
-void SimpleIMU::setGyroRange(uint8_t scale)
-{
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_GYRO_CONFIG);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 1, true);
-	uint8_t gyro_config = Wire.read();
-	if (scale == MPU6050_IMU::MPU6050_GYRO_FS_250)
-		gyro_config &= ~((1 << 3) | (1 << 4));
-	else if (scale == MPU6050_IMU::MPU6050_GYRO_FS_500)
-	{
-		gyro_config |= (1 << 3);
-		gyro_config &= ~(1 << 4);
-	}
-	else if (scale == MPU6050_IMU::MPU6050_GYRO_FS_1000)
-	{
-		gyro_config &= ~(1 << 3);
-		gyro_config |= (1 << 4);
-	}
-	else if (scale == MPU6050_IMU::MPU6050_GYRO_FS_2000)
-		gyro_config |= (1 << 3) | (1 << 4);
-	else
-		return;
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_GYRO_CONFIG);
-	Wire.write(gyro_config);
-	Wire.endTransmission(true);
+uint8_t SimpleIMU::setGyroRange(uint8_t scale)
+{
+	if (scale > MPU6050_IMU::MPU6050_GYRO_FS_2000)
+		return IMU_ERROR_ARGUMENT;
+
+	/* The shadow holds the range even if the write failed, recover writes it again */
+	uint8_t status = SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_GYRO_CONFIG, 0x18, scale << 3);
+	SimpleIMU::IMU_GyroOffsetX = SimpleIMU::rescaleOffset(SimpleIMU::IMU_GyroOffsetX, SimpleIMU::IMU_GyroFullScale, scale);
+	SimpleIMU::IMU_GyroOffsetY = SimpleIMU::rescaleOffset(SimpleIMU::IMU_GyroOffsetY, SimpleIMU::IMU_GyroFullScale, scale);
+	SimpleIMU::IMU_GyroOffsetZ = SimpleIMU::rescaleOffset(SimpleIMU::IMU_GyroOffsetZ, SimpleIMU::IMU_GyroFullScale, scale);
 	SimpleIMU::IMU_GyroFullScale = scale;
+	SimpleIMU::updateGyroScale();
+	return status;
+}
+
+// Compute gyroscope scale factors for the current range
+void SimpleIMU::updateGyroScale()
+{
+	/* Counts per deg/s are 131, 65.5, 32.8, 16.4 */
+	static const float gyroScale[4] = {1.0f / 131.0f, 1.0f / 65.5f, 1.0f / 32.8f, 1.0f / 16.4f};
+
+	/* 1000 * 2^(12 - range) / counts per deg/s, about 2^15 so a product with a count fits in 32 bits */
+	static const int16_t gyroFixedMult[4] = {31267, 31267, 31220, 31220};
+	uint8_t range = SimpleIMU::IMU_GyroFullScale & 0x03;
+	SimpleIMU::IMU_GyroScale = gyroScale[range];
+	SimpleIMU::IMU_GyroFixedMult = gyroFixedMult[range];
+	SimpleIMU::IMU_GyroFixedShift = 12 - range;
 }
 
 // Get range of gyroscope
 uint8_t SimpleIMU::getGyroRange()
 {
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_GYRO_CONFIG);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 1, true);
-	uint8_t gyro_config = Wire.read() & 0x18;
-	gyro_config >>= 3;
-	return gyro_config;
+	return (SimpleIMU::IMU_ConfigShadow[MPU6050_IMU::MPU6050_RA_GYRO_CONFIG - MPU6050_IMU::MPU6050_RA_SMPLRT_DIV] & 0x18) >> 3;
 }
 
 // Set range of accelerometer
-void SimpleIMU::setAccelRange(uint8_t scale)
-{
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 1, true);
-	uint8_t accel_config = Wire.read();
-	if (scale == MPU6050_IMU::MPU6050_ACCEL_FS_2)
-		accel_config &= ~((1 << 3) | (1 << 4));
-	else if (scale == MPU6050_IMU::MPU6050_ACCEL_FS_4)
-	{
-		accel_config |= (1 << 3);
-		accel_config &= ~(1 << 4);
-	}
-	else if (scale == MPU6050_IMU::MPU6050_ACCEL_FS_8)
-	{
-		accel_config &= ~(1 << 3);
-		accel_config |= (1 << 4);
-	}
-	else if (scale == MPU6050_IMU::MPU6050_ACCEL_FS_16)
-		accel_config |= (1 << 3) | (1 << 4);
-	else
-		return;
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG);
-	Wire.write(accel_config);
-	Wire.endTransmission(true);
+uint8_t SimpleIMU::setAccelRange(uint8_t scale)
+{
+	if (scale > MPU6050_IMU::MPU6050_ACCEL_FS_16)
+		return IMU_ERROR_ARGUMENT;
+	uint8_t status = SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG, 0x18, scale << 3);
+	SimpleIMU::IMU_AccelOffsetX = SimpleIMU::rescaleOffset(SimpleIMU::IMU_AccelOffsetX, SimpleIMU::IMU_AccelFullScale, scale);
+	SimpleIMU::IMU_AccelOffsetY = SimpleIMU::rescaleOffset(SimpleIMU::IMU_AccelOffsetY, SimpleIMU::IMU_AccelFullScale, scale);
+	SimpleIMU::IMU_AccelOffsetZ = SimpleIMU::rescaleOffset(SimpleIMU::IMU_AccelOffsetZ, SimpleIMU::IMU_AccelFullScale, scale);
 	SimpleIMU::IMU_AccelFullScale = scale;
+	SimpleIMU::updateAccelScale();
+	return status;
+}
+
+// Compute accelerometer scale factors for the current range
+void SimpleIMU::updateAccelScale()
+{
+	/* Counts per g are 16384, 8192, 4096, 2048 */
+	uint8_t range = SimpleIMU::IMU_AccelFullScale & 0x03;
+	SimpleIMU::IMU_AccelScale = 9.81f / (16384 >> range);
+	SimpleIMU::IMU_AccelFixedShift = 14 - range;
 }
 
 // Get range of accelerometer
 uint8_t SimpleIMU::getAccelRange()
 {
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 1, true);
-	uint8_t accel_config = Wire.read() & 0x18;
-	accel_config >>= 3;
-	return accel_config;
+	return (SimpleIMU::IMU_ConfigShadow[MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG - MPU6050_IMU::MPU6050_RA_SMPLRT_DIV] & 0x18) >> 3;
 }
 
-// Calibrate gyroscope
-void SimpleIMU::calibAccel(int samples)
+// Calibrate accelerometer
+uint8_t SimpleIMU::calibAccel(int samples)
 {
-	AccelData accel;
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	uint8_t buffer[6];
 	int16_t x, y, z;
 	long int sumx = 0, sumy = 0, sumz = 0;
+	int count = 0;
 	for (int i = 0; i < samples; i++)
 	{
-		Wire.beginTransmission(SimpleIMU::IMU_Addr);
-		Wire.write(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H);
-		Wire.endTransmission(false);
-		Wire.requestFrom(SimpleIMU::IMU_Addr, 6, true);
-		x = (Wire.read() << 8 | Wire.read());
-		y = (Wire.read() << 8 | Wire.read());
-		z = (Wire.read() << 8 | Wire.read());
+		if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 6) != IMU_OK)
+			continue;
+		count++;
+		x = (int16_t)(buffer[0] << 8 | buffer[1]);
+		y = (int16_t)(buffer[2] << 8 | buffer[3]);
+		z = (int16_t)(buffer[4] << 8 | buffer[5]);
 		sumx += x;
 		sumy += y;
 		sumz += z;
 	}
-	SimpleIMU::IMU_AccelOffsetX = sumx / samples;
-	SimpleIMU::IMU_AccelOffsetY = sumy / samples;
-	SimpleIMU::IMU_AccelOffsetZ = sumz / samples;
+	if (count == 0)
+		return SimpleIMU::statusSince(errors);
+	SimpleIMU::IMU_AccelOffsetX = sumx / count;
+	SimpleIMU::IMU_AccelOffsetY = sumy / count;
+	SimpleIMU::IMU_AccelOffsetZ = sumz / count;
+	SimpleIMU::sampleCalibTemp();
+	return SimpleIMU::statusSince(errors);
+}
+
+// Convert an offset to another range
+int16_t SimpleIMU::rescaleOffset(int16_t offset, uint8_t from, uint8_t to)
+{
+	/* Every step up in range halves the counts per unit */
+	if (to > from)
+		return offset / (1 << (to - from));
+	return offset * (1 << (from - to));
+}
+
+// Move the offsets into the offset registers of the IMU
+uint8_t SimpleIMU::applyHardwareOffsets()
+{
+	uint8_t buffer[6];
+	uint8_t status;
+	int16_t offset[3];
+	int32_t bias[3];
+
+	/* Gyroscope offset registers count in the 1000 deg/s range, 4 counts at 250 deg/s are 1 */
+	uint8_t range = SimpleIMU::IMU_GyroFullScale;
+	bias[0] = SimpleIMU::IMU_GyroOffsetX;
+	bias[1] = SimpleIMU::IMU_GyroOffsetY;
+	bias[2] = SimpleIMU::IMU_GyroOffsetZ;
+	status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_XG_OFFS_USRH, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		int32_t counts = bias[i] * (1 << range);
+		counts = (counts >= 0 ? counts + 2 : counts - 2) / 4;
+		offset[i] = (int16_t)(buffer[2 * i] << 8 | buffer[2 * i + 1]) - counts;
+		buffer[2 * i] = offset[i] >> 8;
+		buffer[2 * i + 1] = offset[i] & 0xFF;
+	}
+	status = SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_XG_OFFS_USRH, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	memcpy(SimpleIMU::IMU_OffsetRegs, buffer, 6);
+
+	/*
+	 * Accelerometer offset registers hold the factory trim in the 16 g range,
+	 * 8 counts at 2 g are 1. The axis along gravity keeps 1 g, so the FIFO
+	 * and the DMP still see the gravity vector.
+	 */
+	range = SimpleIMU::IMU_AccelFullScale;
+	bias[0] = SimpleIMU::IMU_AccelOffsetX;
+	bias[1] = SimpleIMU::IMU_AccelOffsetY;
+	bias[2] = SimpleIMU::IMU_AccelOffsetZ;
+	int32_t oneG = 16384 >> range;
+	uint8_t up = 0;
+	for (uint8_t i = 1; i < 3; i++)
+		if (abs(bias[i]) > abs(bias[up]))
+			up = i;
+	if (abs(bias[up]) > oneG / 2)
+		bias[up] -= bias[up] > 0 ? oneG : -oneG;
+	status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_XA_OFFS_H, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		int32_t counts = bias[i] * (1 << range);
+		counts = (counts >= 0 ? counts + 4 : counts - 4) / 8;
+
+		/* Bit 0 is reserved and must be preserved */
+		uint8_t reserved = buffer[2 * i + 1] & 0x01;
+		offset[i] = (int16_t)(buffer[2 * i] << 8 | buffer[2 * i + 1]) - counts;
+		buffer[2 * i] = offset[i] >> 8;
+		buffer[2 * i + 1] = (offset[i] & 0xFE) | reserved;
+	}
+	status = SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_XA_OFFS_H, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	memcpy(SimpleIMU::IMU_OffsetRegs + 6, buffer, 6);
+	SimpleIMU::IMU_HasOffsetRegs = true;
+
+	/* The IMU outputs corrected data from now on, recover writes the registers again */
+	SimpleIMU::IMU_GyroOffsetX = 0;
+	SimpleIMU::IMU_GyroOffsetY = 0;
+	SimpleIMU::IMU_GyroOffsetZ = 0;
+	SimpleIMU::IMU_AccelOffsetX = 0;
+	SimpleIMU::IMU_AccelOffsetY = 0;
+	SimpleIMU::IMU_AccelOffsetZ = 0;
+	return IMU_OK;
 }
 
 // Read accelerometer values
-void SimpleIMU::readAccel(AccelData *accel)
-{
-	Wire.beginTransmission(SimpleIMU::IMU_Addr);
-	Wire.write(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H);
-	Wire.endTransmission(false);
-	Wire.requestFrom(SimpleIMU::IMU_Addr, 6, true);
-	int16_t x = (Wire.read() << 8 | Wire.read()) - SimpleIMU::IMU_AccelOffsetX;
-	int16_t y = (Wire.read() << 8 | Wire.read()) - SimpleIMU::IMU_AccelOffsetY;
-	int16_t z = (Wire.read() << 8 | Wire.read()) - SimpleIMU::IMU_AccelOffsetZ;
-	if (SimpleIMU::IMU_AccelFullScale == MPU6050_IMU::MPU6050_ACCEL_FS_2)
+uint8_t SimpleIMU::readAccel(AccelData *accel)
+{
+	uint8_t buffer[6];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	int16_t x = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_AccelOffsetX;
+	int16_t y = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_AccelOffsetY;
+	int16_t z = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_AccelOffsetZ;
+	SimpleIMU::scaleAccel(x, y, z, accel);
+	return IMU_OK;
+}
+
+// Scale accelerometer values
+void SimpleIMU::scaleAccel(int16_t x, int16_t y, int16_t z, AccelData *accel)
+{
+	accel->x = x * SimpleIMU::IMU_AccelScale;
+	accel->y = y * SimpleIMU::IMU_AccelScale;
+	accel->z = z * SimpleIMU::IMU_AccelScale;
+}
+
+// Scale accelerometer values to fixed point
+void SimpleIMU::scaleAccelFixed(int16_t x, int16_t y, int16_t z, AccelDataFixed *accel)
+{
+	/* 1000 mg are 2^(14 - range) counts */
+	uint8_t shift = SimpleIMU::IMU_AccelFixedShift;
+	int32_t round = (int32_t)1 << (shift - 1);
+	accel->x = ((int32_t)x * 1000 + round) >> shift;
+	accel->y = ((int32_t)y * 1000 + round) >> shift;
+	accel->z = ((int32_t)z * 1000 + round) >> shift;
+}
+
+// Scale temperature value
+float SimpleIMU::scaleTemp(int16_t t)
+{
+	return t * (1.0f / 340.0f) + 36.53f;
+}
+
+// Scale temperature value to fixed point
+int16_t SimpleIMU::scaleTempFixed(int16_t t)
+{
+	/* Hundredths of a degree, t / 3.4 + 3653 */
+	return (int16_t)((int32_t)t * 5 / 17 + 3653);
+}
+
+// Set sample rate divider
+uint8_t SimpleIMU::setSampleRateDivider(uint8_t divider)
+{
+	return SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_SMPLRT_DIV, 0xFF, divider);
+}
+
+// Get sample rate divider
+uint8_t SimpleIMU::getSampleRateDivider()
+{
+	return SimpleIMU::IMU_ConfigShadow[0];
+}
+
+// Set bandwidth of digital low pass filter
+uint8_t SimpleIMU::setDLPFMode(uint8_t mode)
+{
+	if (mode > MPU6050_IMU::MPU6050_DLPF_BW_5)
+		return IMU_ERROR_ARGUMENT;
+	return SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_CONFIG, 0x07, mode);
+}
+
+// Get bandwidth of digital low pass filter
+uint8_t SimpleIMU::getDLPFMode()
+{
+	return SimpleIMU::IMU_ConfigShadow[MPU6050_IMU::MPU6050_RA_CONFIG - MPU6050_IMU::MPU6050_RA_SMPLRT_DIV] & 0x07;
+}
+
+// Get output data rate
+float SimpleIMU::getOutputDataRate()
+{
+	uint8_t dlpf = SimpleIMU::IMU_ConfigShadow[MPU6050_IMU::MPU6050_RA_CONFIG - MPU6050_IMU::MPU6050_RA_SMPLRT_DIV] & 0x07;
+	float gyroRate = (dlpf == MPU6050_IMU::MPU6050_DLPF_BW_256 || dlpf == 0x07) ? 8000.0 : 1000.0;
+	return gyroRate / (1 + SimpleIMU::IMU_ConfigShadow[0]);
+}
+
+// Start deferring configuration writes
+void SimpleIMU::beginConfig()
+{
+	SimpleIMU::IMU_ConfigDeferred = true;
+}
+
+// Write deferred configuration changes
+uint8_t SimpleIMU::commitConfig()
+{
+	SimpleIMU::IMU_ConfigDeferred = false;
+	return SimpleIMU::flushConfig();
+}
+
+// Change bits of a shadowed configuration register
+uint8_t SimpleIMU::setConfigBits(uint8_t reg, uint8_t mask, uint8_t value)
+{
+	uint8_t index = reg - MPU6050_IMU::MPU6050_RA_SMPLRT_DIV;
+	uint8_t config = (SimpleIMU::IMU_ConfigShadow[index] & ~mask) | (value & mask);
+	if (config != SimpleIMU::IMU_ConfigShadow[index])
 	{
-		accel->x = x / 16384.0;
-		accel->y = y / 16384.0;
-		accel->z = z / 16384.0;
+		SimpleIMU::IMU_ConfigShadow[index] = config;
+		SimpleIMU::IMU_ConfigDirty |= 1 << index;
 	}
-	else if (SimpleIMU::IMU_AccelFullScale ==MPU6050_IMU::MPU6050_ACCEL_FS_4)
+
+	/* Registers left dirty by a failed write go out with the next change */
+	if (SimpleIMU::IMU_ConfigDeferred)
+		return IMU_OK;
+	return SimpleIMU::flushConfig();
+}
+
+// Write dirty configuration registers
+uint8_t SimpleIMU::flushConfig()
+{
+	uint8_t dirty = SimpleIMU::IMU_ConfigDirty;
+	if (dirty == 0)
+		return IMU_OK;
+
+	/* One burst from the first to the last dirty register, the IMU increments the address */
+	uint8_t first = 0, last = IMU_CONFIG_SHADOW_LENGTH - 1;
+	while (!(dirty & (1 << first)))
+		first++;
+	while (!(dirty & (1 << last)))
+		last--;
+	uint8_t status = SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_SMPLRT_DIV + first, &SimpleIMU::IMU_ConfigShadow[first], last - first + 1);
+	if (status == IMU_OK)
+		SimpleIMU::IMU_ConfigDirty = 0;
+	return status;
+}
+
+// Read accelerometer, temperature and gyroscope values in one burst
+uint8_t SimpleIMU::readMotion(AccelData *accel, GyroData *gyro, float *temp)
+{
+	uint8_t buffer[14];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 14);
+	if (status != IMU_OK)
+		return status;
+
+	/* ACCEL_XOUT_H .. ACCEL_ZOUT_L, TEMP_OUT_H/L, GYRO_XOUT_H .. GYRO_ZOUT_L */
+	int16_t ax = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_AccelOffsetX;
+	int16_t ay = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_AccelOffsetY;
+	int16_t az = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_AccelOffsetZ;
+	int16_t t = (int16_t)(buffer[6] << 8 | buffer[7]);
+	int16_t gx = (int16_t)(buffer[8] << 8 | buffer[9]) - SimpleIMU::IMU_GyroOffsetX;
+	int16_t gy = (int16_t)(buffer[10] << 8 | buffer[11]) - SimpleIMU::IMU_GyroOffsetY;
+	int16_t gz = (int16_t)(buffer[12] << 8 | buffer[13]) - SimpleIMU::IMU_GyroOffsetZ;
+
+	SimpleIMU::scaleAccel(ax, ay, az, accel);
+	SimpleIMU::scaleGyro(gx, gy, gz, gyro);
+	if (temp != NULL)
+		*temp = SimpleIMU::scaleTemp(t);
+	return IMU_OK;
+}
+
+
+// Read gyroscope values in fixed point
+uint8_t SimpleIMU::readGyroFixed(GyroDataFixed *gyro)
+{
+	uint8_t buffer[6];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_GYRO_XOUT_H, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	int16_t x = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_GyroOffsetX;
+	int16_t y = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_GyroOffsetY;
+	int16_t z = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_GyroOffsetZ;
+	SimpleIMU::scaleGyroFixed(x, y, z, gyro);
+	return IMU_OK;
+}
+
+// Read accelerometer values in fixed point
+uint8_t SimpleIMU::readAccelFixed(AccelDataFixed *accel)
+{
+	uint8_t buffer[6];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 6);
+	if (status != IMU_OK)
+		return status;
+	int16_t x = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_AccelOffsetX;
+	int16_t y = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_AccelOffsetY;
+	int16_t z = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_AccelOffsetZ;
+	SimpleIMU::scaleAccelFixed(x, y, z, accel);
+	return IMU_OK;
+}
+
+// Read accelerometer, temperature and gyroscope values in fixed point
+uint8_t SimpleIMU::readMotionFixed(AccelDataFixed *accel, GyroDataFixed *gyro, int16_t *temp)
+{
+	uint8_t buffer[14];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 14);
+	if (status != IMU_OK)
+		return status;
+	int16_t ax = (int16_t)(buffer[0] << 8 | buffer[1]) - SimpleIMU::IMU_AccelOffsetX;
+	int16_t ay = (int16_t)(buffer[2] << 8 | buffer[3]) - SimpleIMU::IMU_AccelOffsetY;
+	int16_t az = (int16_t)(buffer[4] << 8 | buffer[5]) - SimpleIMU::IMU_AccelOffsetZ;
+	int16_t t = (int16_t)(buffer[6] << 8 | buffer[7]);
+	int16_t gx = (int16_t)(buffer[8] << 8 | buffer[9]) - SimpleIMU::IMU_GyroOffsetX;
+	int16_t gy = (int16_t)(buffer[10] << 8 | buffer[11]) - SimpleIMU::IMU_GyroOffsetY;
+	int16_t gz = (int16_t)(buffer[12] << 8 | buffer[13]) - SimpleIMU::IMU_GyroOffsetZ;
+
+	SimpleIMU::scaleAccelFixed(ax, ay, az, accel);
+	SimpleIMU::scaleGyroFixed(gx, gy, gz, gyro);
+	if (temp != NULL)
+		*temp = SimpleIMU::scaleTempFixed(t);
+	return IMU_OK;
+}
+
+// Read raw accelerometer, temperature and gyroscope counts
+uint8_t SimpleIMU::readMotionRaw(IMURawSample *raw)
+{
+	uint8_t buffer[14];
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_ACCEL_XOUT_H, buffer, 14);
+	if (status != IMU_OK)
+		return status;
+	raw->accel[0] = (int16_t)(buffer[0] << 8 | buffer[1]);
+	raw->accel[1] = (int16_t)(buffer[2] << 8 | buffer[3]);
+	raw->accel[2] = (int16_t)(buffer[4] << 8 | buffer[5]);
+	raw->temp = (int16_t)(buffer[6] << 8 | buffer[7]);
+	raw->gyro[0] = (int16_t)(buffer[8] << 8 | buffer[9]);
+	raw->gyro[1] = (int16_t)(buffer[10] << 8 | buffer[11]);
+	raw->gyro[2] = (int16_t)(buffer[12] << 8 | buffer[13]);
+	return IMU_OK;
+}
+
+// Start streaming into the FIFO
+uint8_t SimpleIMU::beginFIFO(uint8_t sensors)
+{
+	uint8_t user_ctrl;
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	sensors &= IMU_FIFO_TEMP | IMU_FIFO_GYRO | IMU_FIFO_ACCEL | IMU_FIFO_AUX;
+	if (SimpleIMU::IMU_AuxReadSlaves == 0)
+		sensors &= ~IMU_FIFO_AUX;
+	SimpleIMU::IMU_FIFOSensors = sensors;
+	SimpleIMU::IMU_TimingLocked = false;
+	SimpleIMU::IMU_FIFOFrameSize = 0;
+	if (sensors & IMU_FIFO_ACCEL)
+		SimpleIMU::IMU_FIFOFrameSize += 6;
+	if (sensors & IMU_FIFO_TEMP)
+		SimpleIMU::IMU_FIFOFrameSize += 2;
+	if (sensors & IMU_FIFO_GYRO_X)
+		SimpleIMU::IMU_FIFOFrameSize += 2;
+	if (sensors & IMU_FIFO_GYRO_Y)
+		SimpleIMU::IMU_FIFOFrameSize += 2;
+	if (sensors & IMU_FIFO_GYRO_Z)
+		SimpleIMU::IMU_FIFOFrameSize += 2;
+
+	/* Slaves 0 to 2 are enabled in FIFO_EN, slave 3 in I2C_MST_CTRL */
+	uint8_t fifo_en = sensors & (IMU_FIFO_TEMP | IMU_FIFO_GYRO | IMU_FIFO_ACCEL);
+	if (sensors & IMU_FIFO_AUX)
 	{
-		accel->x = x / 8192.0;
-		accel->y = y / 8192.0;
-		accel->z = z / 8192.0;
+		SimpleIMU::IMU_FIFOFrameSize += SimpleIMU::getAuxLength();
+		fifo_en |= SimpleIMU::IMU_AuxReadSlaves & 0x07;
 	}
-	else if (SimpleIMU::IMU_AccelFullScale == MPU6050_IMU::MPU6050_ACCEL_FS_8)
+
+	/* Stop writing into the FIFO while it is being reset */
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_FIFO_EN, 0x00);
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_USER_CTRL, &user_ctrl, 1);
+	if (status != IMU_OK)
+		return status;
+	user_ctrl &= ~((1 << MPU6050_IMU::MPU6050_USERCTRL_DMP_EN_BIT) | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT));
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, user_ctrl | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_RESET_BIT));
+
+	/* An overflow flagged before the reset would throw away the new FIFO on the first read, reading INT_STATUS clears it */
+	uint8_t int_status;
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_INT_STATUS, &int_status, 1) == IMU_OK)
+		SimpleIMU::IMU_PendingEvents |= int_status & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, user_ctrl | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT));
+	if (SimpleIMU::IMU_AuxSlaves != 0)
 	{
-		accel->x = x / 4096.0;
-		accel->y = y / 4096.0;
-		accel->z = z / 4096.0;
+		bool slave3 = (sensors & IMU_FIFO_AUX) && (SimpleIMU::IMU_AuxReadSlaves & 0x08);
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_I2C_MST_CTRL,
+								 SimpleIMU::IMU_AuxMasterCtrl | (slave3 << MPU6050_IMU::MPU6050_SLV_3_FIFO_EN_BIT));
 	}
-	else if (SimpleIMU::IMU_AccelFullScale == MPU6050_IMU::MPU6050_ACCEL_FS_16)
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_FIFO_EN, fifo_en);
+	return SimpleIMU::statusSince(errors);
+}
+
+// Stop streaming into the FIFO
+uint8_t SimpleIMU::endFIFO()
+{
+	uint8_t user_ctrl;
+	SimpleIMU::IMU_FIFOSensors = 0;
+	SimpleIMU::IMU_FIFOFrameSize = 0;
+	uint8_t status = SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_FIFO_EN, 0x00);
+	if (status == IMU_OK)
+		status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_USER_CTRL, &user_ctrl, 1);
+	if (status != IMU_OK)
+		return status;
+	user_ctrl &= ~(1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_EN_BIT);
+	return SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_USER_CTRL, user_ctrl | (1 << MPU6050_IMU::MPU6050_USERCTRL_FIFO_RESET_BIT));
+}
+
+// Clear the FIFO
+uint8_t SimpleIMU::resetFIFO()
+{
+	return SimpleIMU::beginFIFO(SimpleIMU::IMU_FIFOSensors);
+}
+
+// Get number of bytes in the FIFO
+uint16_t SimpleIMU::getFIFOCount()
+{
+	uint8_t buffer[2];
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_FIFO_COUNTH, buffer, 2) != IMU_OK)
+		return 0;
+	return (uint16_t)buffer[0] << 8 | buffer[1];
+}
+
+// Get size of a FIFO frame
+uint8_t SimpleIMU::getFIFOFrameSize()
+{
+	return SimpleIMU::IMU_FIFOFrameSize;
+}
+
+// Check for FIFO overflow
+bool SimpleIMU::fifoOverflow()
+{
+	uint8_t int_status;
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_INT_STATUS, &int_status, 1) != IMU_OK)
+		return false;
+	SimpleIMU::IMU_PendingEvents |= int_status & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	return int_status & (1 << MPU6050_IMU::MPU6050_INTERRUPT_FIFO_OFLOW_BIT);
+}
+
+// Get number of whole frames in the FIFO
+int SimpleIMU::getFIFOFrames(int maxFrames)
+{
+	/* Overflow flag and FIFO count in one transfer where the transport can queue reads */
+	uint8_t int_status, fifo_count[2];
+	IMURegisterRead reads[2] = {
+		{MPU6050_IMU::MPU6050_RA_INT_STATUS, &int_status, 1},
+		{MPU6050_IMU::MPU6050_RA_FIFO_COUNTH, fifo_count, 2}};
+	if (SimpleIMU::readRegisters(reads, 2) != IMU_OK)
+		return -1;
+	SimpleIMU::IMU_PendingEvents |= int_status & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	if (int_status & (1 << MPU6050_IMU::MPU6050_INTERRUPT_FIFO_OFLOW_BIT))
+	{
+		SimpleIMU::resetFIFO();
+		return -1;
+	}
+
+	/* The count is the last byte of the transfer */
+	int frames = ((uint16_t)fifo_count[0] << 8 | fifo_count[1]) / SimpleIMU::IMU_FIFOFrameSize;
+	SimpleIMU::trackFIFO(frames, SimpleIMU::IMU_Transport->getTime());
+	return frames > maxFrames ? maxFrames : frames;
+}
+
+// Read frames from the FIFO
+int SimpleIMU::readFIFO(IMUSample *samples, int maxSamples, uint8_t *aux)
+{
+	uint8_t frameSize = SimpleIMU::IMU_FIFOFrameSize;
+	if (frameSize == 0 || maxSamples <= 0)
+		return 0;
+	int frames = SimpleIMU::getFIFOFrames(maxSamples);
+	if (frames < 0)
+		return -1;
+
+	/* Read as many whole frames per transaction as the transport allows, frames larger than that in pieces */
+	uint8_t framesPerRead = SimpleIMU::getMaxTransfer() / frameSize;
+	if (framesPerRead == 0)
+		framesPerRead = 1;
+	uint8_t buffer[IMU_TRANSFER_BUFFER_LENGTH > IMU_FIFO_MAX_FRAME ? IMU_TRANSFER_BUFFER_LENGTH : IMU_FIFO_MAX_FRAME];
+	uint8_t auxLength = SimpleIMU::getAuxLength();
+	float period = SimpleIMU::getSamplePeriod();
+	uint32_t first = SimpleIMU::advanceTiming(frames);
+	int count = 0;
+	while (count < frames)
 	{
-		accel->x = x / 2048.0;
-		accel->y = y / 2048.0;
-		accel->z = z / 2048.0;
+		uint8_t chunk = framesPerRead;
+		if (frames - count < chunk)
+			chunk = frames - count;
+		if (SimpleIMU::readRegisterBlock(MPU6050_IMU::MPU6050_RA_FIFO_R_W, buffer, chunk * frameSize) != IMU_OK)
+		{
+			/* The frames that follow are no longer aligned */
+			SimpleIMU::resetFIFO();
+			return -1;
+		}
+
+		/* Frames are in register order: accel, temperature, gyro x, y, z, external sensor data */
+		uint8_t *p = buffer;
+		for (uint8_t i = 0; i < chunk; i++, count++)
+		{
+			IMUSample *sample = &samples[count];
+			sample->time = first + (int32_t)lroundf(count * period);
+			if (SimpleIMU::IMU_FIFOSensors & IMU_FIFO_ACCEL)
+			{
+				int16_t ax = (int16_t)(p[0] << 8 | p[1]) - SimpleIMU::IMU_AccelOffsetX;
+				int16_t ay = (int16_t)(p[2] << 8 | p[3]) - SimpleIMU::IMU_AccelOffsetY;
+				int16_t az = (int16_t)(p[4] << 8 | p[5]) - SimpleIMU::IMU_AccelOffsetZ;
+				SimpleIMU::scaleAccel(ax, ay, az, &sample->accel);
+				p += 6;
+			}
+			if (SimpleIMU::IMU_FIFOSensors & IMU_FIFO_TEMP)
+			{
+				sample->temp = SimpleIMU::scaleTemp((int16_t)(p[0] << 8 | p[1]));
+				p += 2;
+			}
+			if (SimpleIMU::IMU_FIFOSensors & IMU_FIFO_GYRO_X)
+			{
+				int16_t gx = (int16_t)(p[0] << 8 | p[1]) - SimpleIMU::IMU_GyroOffsetX;
+				sample->gyro.x = gx * SimpleIMU::IMU_GyroScale;
+				p += 2;
+			}
+			if (SimpleIMU::IMU_FIFOSensors & IMU_FIFO_GYRO_Y)
+			{
+				int16_t gy = (int16_t)(p[0] << 8 | p[1]) - SimpleIMU::IMU_GyroOffsetY;
+				sample->gyro.y = gy * SimpleIMU::IMU_GyroScale;
+				p += 2;
+			}
+			if (SimpleIMU::IMU_FIFOSensors & IMU_FIFO_GYRO_Z)
+			{
+				int16_t gz = (int16_t)(p[0] << 8 | p[1]) - SimpleIMU::IMU_GyroOffsetZ;
+				sample->gyro.z = gz * SimpleIMU::IMU_GyroScale;
+				p += 2;
+			}
+			if (SimpleIMU::IMU_FIFOSensors & IMU_FIFO_AUX)
+			{
+				if (aux != NULL)
+					memcpy(aux + count * auxLength, p, auxLength);
+				p += auxLength;
+			}
+		}
 	}
-	accel->x = accel->x * 9.81;
-	accel->y = accel->y * 9.81;
-	accel->z = accel->z * 9.81;
-}
\ No newline at end of file
+	return count;
+}
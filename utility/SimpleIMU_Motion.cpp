@@ -0,0 +1,163 @@
+/*
+ *  Motion detection and wake on motion for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "SimpleIMU_MPU6050.h"
+
+SimpleIMU *SimpleIMU::IMU_MotionInstance = NULL;
+
+// Motion interrupt service routine
+void IMU_ISR_ATTR SimpleIMU::motionISR()
+{
+	if (SimpleIMU::IMU_MotionInstance != NULL)
+		SimpleIMU::IMU_MotionInstance->handleMotion();
+}
+
+// Set the motion threshold and duration
+uint8_t SimpleIMU::setMotionDetection(uint8_t threshold, uint8_t duration)
+{
+	SimpleIMU::IMU_MotionConfig[2] = threshold;
+	SimpleIMU::IMU_MotionConfig[3] = duration;
+	return SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_MOT_THR, &SimpleIMU::IMU_MotionConfig[2], 2);
+}
+
+// Set the zero motion threshold and duration
+uint8_t SimpleIMU::setZeroMotionDetection(uint8_t threshold, uint8_t duration)
+{
+	SimpleIMU::IMU_MotionConfig[4] = threshold;
+	SimpleIMU::IMU_MotionConfig[5] = duration;
+	return SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_ZRMOT_THR, &SimpleIMU::IMU_MotionConfig[4], 2);
+}
+
+// Set the free fall threshold and duration
+uint8_t SimpleIMU::setFreeFallDetection(uint8_t threshold, uint8_t duration)
+{
+	SimpleIMU::IMU_MotionConfig[0] = threshold;
+	SimpleIMU::IMU_MotionConfig[1] = duration;
+	return SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_FF_THR, &SimpleIMU::IMU_MotionConfig[0], 2);
+}
+
+// Start delivering motion events at full power
+uint8_t SimpleIMU::beginMotionEvents(uint8_t pin, uint8_t events)
+{
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+
+	/* FF_THR to ZRMOT_DUR are consecutive */
+	SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_FF_THR, SimpleIMU::IMU_MotionConfig, 6);
+
+	/* 1 ms extra accelerometer on delay, the detection counters decrement by 1 */
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_MOT_DETECT_CTRL, 0x15);
+
+	/* Motion and zero motion look at the high pass filtered acceleration */
+	SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG, 0x07, MPU6050_IMU::MPU6050_DHPF_5);
+
+	/* Active high push-pull 50us pulse, status cleared only by reading INT_STATUS */
+	SimpleIMU::IMU_IntConfig[0] = 0x00;
+	SimpleIMU::IMU_IntConfig[1] = events & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_INT_PIN_CFG, SimpleIMU::IMU_IntConfig, 2);
+
+	SimpleIMU::IMU_MotionServiced = SimpleIMU::IMU_MotionCount;
+	SimpleIMU::IMU_PendingEvents = 0;
+	SimpleIMU::IMU_IntPin = pin;
+	if (pin != IMU_NO_PIN)
+	{
+		SimpleIMU::IMU_MotionInstance = this;
+		pinMode(pin, INPUT);
+		attachInterrupt(digitalPinToInterrupt(pin), SimpleIMU::motionISR, RISING);
+	}
+	return SimpleIMU::statusSince(errors);
+}
+
+// Put the IMU into the accelerometer only cycle mode
+uint8_t SimpleIMU::beginWakeOnMotion(uint8_t pin, uint8_t rate)
+{
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	SimpleIMU::beginMotionEvents(pin, IMU_EVENT_MOTION);
+
+	/* Reset the filter to the current acceleration for a sample, then hold it as the reference */
+	SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG, 0x07, MPU6050_IMU::MPU6050_DHPF_RESET);
+	delay(10);
+	SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG, 0x07, MPU6050_IMU::MPU6050_DHPF_HOLD);
+
+	/* PWR_MGMT_1 and PWR_MGMT_2 in one write: internal oscillator, cycle
+	 * mode, temperature sensor and gyroscopes in standby */
+	if (SimpleIMU::statusSince(errors) != IMU_OK)
+		return SimpleIMU::IMU_LastError;
+	SimpleIMU::IMU_PowerMgmt = SimpleIMU::IMU_PowerConfig[0];
+	SimpleIMU::IMU_PowerConfig[0] = (1 << MPU6050_IMU::MPU6050_PWR1_CYCLE_BIT) | (1 << MPU6050_IMU::MPU6050_PWR1_TEMP_DIS_BIT);
+	SimpleIMU::IMU_PowerConfig[1] = (rate & 0x03) << 6 | (1 << MPU6050_IMU::MPU6050_PWR2_STBY_XG_BIT) |
+									(1 << MPU6050_IMU::MPU6050_PWR2_STBY_YG_BIT) | (1 << MPU6050_IMU::MPU6050_PWR2_STBY_ZG_BIT);
+	SimpleIMU::IMU_CycleMode = true;
+	return SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, SimpleIMU::IMU_PowerConfig, 2);
+}
+
+// Stop the motion events and return to full power
+uint8_t SimpleIMU::endMotionEvents()
+{
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	SimpleIMU::IMU_IntConfig[1] = 0x00;
+	SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_INT_ENABLE, 0x00);
+	if (SimpleIMU::IMU_CycleMode)
+	{
+		SimpleIMU::IMU_PowerConfig[0] = SimpleIMU::IMU_PowerMgmt;
+		SimpleIMU::IMU_PowerConfig[1] = 0x00;
+		SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, SimpleIMU::IMU_PowerConfig, 2);
+		SimpleIMU::IMU_CycleMode = false;
+	}
+	SimpleIMU::setConfigBits(MPU6050_IMU::MPU6050_RA_ACCEL_CONFIG, 0x07, MPU6050_IMU::MPU6050_DHPF_RESET);
+	if (SimpleIMU::IMU_IntPin != IMU_NO_PIN)
+	{
+		detachInterrupt(digitalPinToInterrupt(SimpleIMU::IMU_IntPin));
+		if (SimpleIMU::IMU_MotionInstance == this)
+			SimpleIMU::IMU_MotionInstance = NULL;
+	}
+	SimpleIMU::IMU_IntPin = IMU_NO_PIN;
+	return SimpleIMU::statusSince(errors);
+}
+
+// Record a motion interrupt
+void IMU_ISR_ATTR SimpleIMU::handleMotion()
+{
+	SimpleIMU::IMU_MotionCount++;
+}
+
+// Get the motion events since the last call
+uint8_t SimpleIMU::getMotionEvents()
+{
+	/* No bus traffic until the ISR has seen the pin rise */
+	uint8_t count = SimpleIMU::IMU_MotionCount;
+	if (SimpleIMU::IMU_IntPin != IMU_NO_PIN && count == SimpleIMU::IMU_MotionServiced)
+		return 0;
+
+	/* The interrupts stay unserviced on a failed read, so the next call reads the events again */
+	uint8_t status;
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_INT_STATUS, &status, 1) != IMU_OK)
+		return 0;
+	SimpleIMU::IMU_MotionServiced = count;
+	uint8_t events = (status | SimpleIMU::IMU_PendingEvents) & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION);
+	SimpleIMU::IMU_PendingEvents = 0;
+
+	/* Zero motion is signalled both when the IMU stops and when it moves again */
+	if (events & IMU_EVENT_ZERO_MOTION)
+	{
+		uint8_t detect;
+		if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_MOT_DETECT_STATUS, &detect, 1) == IMU_OK &&
+			detect & (1 << MPU6050_IMU::MPU6050_MOTION_MOT_ZRMOT_BIT))
+			events |= IMU_EVENT_STILL;
+	}
+	return events;
+}
+
+// Check for the cycle mode
+bool SimpleIMU::isCycleMode()
+{
+	return SimpleIMU::IMU_CycleMode;
+}
@@ -0,0 +1,167 @@
+/*
+ *  Error reporting and bus recovery for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+#include "SimpleIMU_MPU6050.h"
+
+// Decide whether a failed transaction is tried again
+bool SimpleIMU::retryTransaction(uint8_t status, uint8_t *attempts)
+{
+	/* Nothing is retried inside recover, a dead IMU costs one timeout per register */
+	if (!SimpleIMU::IMU_Recovering)
+	{
+		if (*attempts < SimpleIMU::IMU_Retries)
+		{
+			(*attempts)++;
+			SimpleIMU::IMU_RetryCount++;
+			return true;
+		}
+		if (*attempts == SimpleIMU::IMU_Retries && SimpleIMU::IMU_AutoRecover &&
+			(status == IMU_ERROR_TIMEOUT || status == IMU_ERROR_BUS))
+		{
+			(*attempts)++;
+			if (SimpleIMU::recover() == IMU_OK)
+				return true;
+		}
+	}
+	SimpleIMU::IMU_ErrorCount++;
+	SimpleIMU::IMU_LastError = status;
+	return false;
+}
+
+// Get the status since an error count
+uint8_t SimpleIMU::statusSince(uint16_t errors)
+{
+	return SimpleIMU::IMU_ErrorCount == errors ? IMU_OK : SimpleIMU::IMU_LastError;
+}
+
+// Check the device answering
+uint8_t SimpleIMU::checkDevice()
+{
+	/* Clones answer with other values, only a floating or shorted bus is refused */
+	uint8_t id;
+	uint8_t status = SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_WHO_AM_I, &id, 1);
+	if (status != IMU_OK)
+		return status;
+	if (id == 0x00 || id == 0xFF)
+	{
+		SimpleIMU::IMU_ErrorCount++;
+		SimpleIMU::IMU_LastError = IMU_ERROR_DEVICE;
+		return IMU_ERROR_DEVICE;
+	}
+	return IMU_OK;
+}
+
+// Write the cached configuration back
+void SimpleIMU::restoreConfig()
+{
+	if (SimpleIMU::checkDevice() != IMU_OK)
+		return;
+
+	/* A reset IMU sleeps and has lost the DMP firmware, which is not cached */
+	uint8_t power;
+	if (SimpleIMU::readRegisters(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, &power, 1) != IMU_OK)
+		return;
+	if ((power & (1 << MPU6050_IMU::MPU6050_PWR1_SLEEP_BIT)) && SimpleIMU::IMU_DMPPacketSize != 0)
+	{
+		SimpleIMU::IMU_DMPPacketSize = 0;
+		SimpleIMU::IMU_IntConfig[1] &= ~((1 << MPU6050_IMU::MPU6050_INTERRUPT_FIFO_OFLOW_BIT) | (1 << MPU6050_IMU::MPU6050_INTERRUPT_DMP_INT_BIT));
+		SimpleIMU::IMU_ErrorCount++;
+		SimpleIMU::IMU_LastError = IMU_ERROR_DEVICE;
+	}
+
+	SimpleIMU::IMU_ConfigDirty = 0;
+	if (SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_SMPLRT_DIV, SimpleIMU::IMU_ConfigShadow, IMU_CONFIG_SHADOW_LENGTH) != IMU_OK)
+	{
+		SimpleIMU::IMU_ConfigDirty = (1 << IMU_CONFIG_SHADOW_LENGTH) - 1;
+		return;
+	}
+
+	if (SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_FF_THR, SimpleIMU::IMU_MotionConfig, 6) != IMU_OK)
+		return;
+	if ((SimpleIMU::IMU_IntConfig[1] & (IMU_EVENT_FREE_FALL | IMU_EVENT_MOTION | IMU_EVENT_ZERO_MOTION)) &&
+		SimpleIMU::writeRegister(MPU6050_IMU::MPU6050_RA_MOT_DETECT_CTRL, 0x15) != IMU_OK)
+		return;
+	if (SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_INT_PIN_CFG, SimpleIMU::IMU_IntConfig, 2) != IMU_OK)
+		return;
+
+	if (SimpleIMU::IMU_HasOffsetRegs &&
+		(SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_XG_OFFS_USRH, SimpleIMU::IMU_OffsetRegs, 6) != IMU_OK ||
+		 SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_XA_OFFS_H, SimpleIMU::IMU_OffsetRegs + 6, 6) != IMU_OK))
+		return;
+
+	/* The external sensors have to be set up before the FIFO takes their data */
+	if (SimpleIMU::restoreAux() != IMU_OK)
+		return;
+	if (SimpleIMU::IMU_FIFOSensors != 0 && SimpleIMU::beginFIFO(SimpleIMU::IMU_FIFOSensors) != IMU_OK)
+		return;
+
+	/* Last, a reset IMU sleeps until PWR_MGMT_1 is written */
+	SimpleIMU::writeRegisters(MPU6050_IMU::MPU6050_RA_PWR_MGMT_1, SimpleIMU::IMU_PowerConfig, 2);
+}
+
+// Recover the bus and the configuration
+uint8_t SimpleIMU::recover()
+{
+	uint16_t errors = SimpleIMU::IMU_ErrorCount;
+	SimpleIMU::IMU_Recovering = true;
+	SimpleIMU::IMU_RecoveryCount++;
+	SimpleIMU::IMU_Transport->recover();
+	SimpleIMU::restoreConfig();
+	SimpleIMU::IMU_Recovering = false;
+	return SimpleIMU::statusSince(errors);
+}
+
+// Set the number of retries
+void SimpleIMU::setRetries(uint8_t retries)
+{
+	/* 0xFF marks a transaction that is never retried */
+	SimpleIMU::IMU_Retries = retries == 0xFF ? 0xFE : retries;
+}
+
+// Turn the automatic bus recovery on or off
+void SimpleIMU::setBusRecovery(bool enable)
+{
+	SimpleIMU::IMU_AutoRecover = enable;
+}
+
+// Get the last error
+uint8_t SimpleIMU::getLastError()
+{
+	return SimpleIMU::IMU_LastError;
+}
+
+// Get number of failed transactions
+uint16_t SimpleIMU::getErrorCount()
+{
+	return SimpleIMU::IMU_ErrorCount;
+}
+
+// Get number of retries
+uint16_t SimpleIMU::getRetryCount()
+{
+	return SimpleIMU::IMU_RetryCount;
+}
+
+// Get number of bus recoveries
+uint16_t SimpleIMU::getRecoveryCount()
+{
+	return SimpleIMU::IMU_RecoveryCount;
+}
+
+// Reset the error counts
+void SimpleIMU::resetErrorCounts()
+{
+	SimpleIMU::IMU_LastError = IMU_OK;
+	SimpleIMU::IMU_ErrorCount = 0;
+	SimpleIMU::IMU_RetryCount = 0;
+	SimpleIMU::IMU_RecoveryCount = 0;
+}
@@ -0,0 +1,333 @@
+/*
+ *  Recording and replaying the bus traffic of SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "../SimpleIMU_Replay.h"
+
+#if !defined(ARDUINO)
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t recordMagic[4] = {'S', 'I', 'M', 'R'};
+
+// Write a varint
+static void putVarint(FILE *file, uint32_t value)
+{
+	do
+	{
+		uint8_t bits = value & 0x7F;
+		value >>= 7;
+		fputc(value != 0 ? bits | 0x80 : bits, file);
+	} while (value != 0);
+}
+
+// Read a varint, returns false if it runs past the end
+static bool getVarint(const uint8_t *data, size_t size, size_t *position, uint32_t *value)
+{
+	*value = 0;
+	for (uint8_t shift = 0; shift < 35; shift += 7)
+	{
+		if (*position >= size)
+			return false;
+		uint8_t bits = data[(*position)++];
+		*value |= (uint32_t)(bits & 0x7F) << shift;
+		if (!(bits & 0x80))
+			return true;
+	}
+	return false;
+}
+
+// Constructor
+SimpleIMU_Recorder::SimpleIMU_Recorder(SimpleIMU_Transport *bus)
+{
+	SimpleIMU_Recorder::REC_Bus = bus;
+	SimpleIMU_Recorder::REC_File = NULL;
+	SimpleIMU_Recorder::REC_Last = 0;
+	SimpleIMU_Recorder::REC_Records = 0;
+}
+
+// Destructor
+SimpleIMU_Recorder::~SimpleIMU_Recorder()
+{
+	SimpleIMU_Recorder::close();
+}
+
+// Start recording into a file
+bool SimpleIMU_Recorder::open(const char *path)
+{
+	SimpleIMU_Recorder::close();
+	FILE *file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+	uint16_t maxTransfer = SimpleIMU_Recorder::REC_Bus->getMaxTransfer();
+	uint8_t header[IMU_RECORD_HEADER] = {recordMagic[0], recordMagic[1], recordMagic[2], recordMagic[3],
+										 IMU_RECORD_VERSION, 0, (uint8_t)maxTransfer, (uint8_t)(maxTransfer >> 8)};
+	fwrite(header, 1, IMU_RECORD_HEADER, file);
+	SimpleIMU_Recorder::REC_File = file;
+	SimpleIMU_Recorder::REC_Last = micros();
+	SimpleIMU_Recorder::REC_Records = 0;
+	return true;
+}
+
+// Stop recording
+bool SimpleIMU_Recorder::close()
+{
+	FILE *file = SimpleIMU_Recorder::REC_File;
+	if (file == NULL)
+		return true;
+	SimpleIMU_Recorder::REC_File = NULL;
+	bool written = !ferror(file);
+	return fclose(file) == 0 && written;
+}
+
+// Get the number of records written
+uint32_t SimpleIMU_Recorder::getRecordCount()
+{
+	return SimpleIMU_Recorder::REC_Records;
+}
+
+// Write one record
+void SimpleIMU_Recorder::record(uint8_t kind, uint8_t status, uint8_t address, uint8_t reg, const uint8_t *data,
+								uint16_t length, uint32_t time)
+{
+	FILE *file = SimpleIMU_Recorder::REC_File;
+	if (file == NULL)
+		return;
+	fputc(kind | status << 4, file);
+	fputc(address, file);
+	fputc(reg, file);
+	putVarint(file, time - SimpleIMU_Recorder::REC_Last);
+	putVarint(file, length);
+	fwrite(data, 1, length, file);
+	SimpleIMU_Recorder::REC_Last = time;
+	SimpleIMU_Recorder::REC_Records++;
+}
+
+// Prepare the bus
+bool SimpleIMU_Recorder::begin()
+{
+	return SimpleIMU_Recorder::REC_Bus->begin();
+}
+
+// Write registers and record them
+uint8_t SimpleIMU_Recorder::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length)
+{
+	uint8_t status = SimpleIMU_Recorder::REC_Bus->writeRegisters(address, reg, data, length);
+	SimpleIMU_Recorder::record(IMU_RECORD_WRITE, status, address, reg, data, length, micros());
+	return status;
+}
+
+// Read registers and record them
+uint8_t SimpleIMU_Recorder::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length)
+{
+	uint8_t status = SimpleIMU_Recorder::REC_Bus->readRegisters(address, reg, data, length);
+	SimpleIMU_Recorder::record(IMU_RECORD_READ, status, address, reg, data, length, micros());
+	return status;
+}
+
+// Read in a batch and record each read
+uint8_t SimpleIMU_Recorder::readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count)
+{
+	/* The batch stays one transaction on the bus, on replay the reads come one after the other */
+	uint8_t status = SimpleIMU_Recorder::REC_Bus->readRegisters(address, reads, count);
+	uint32_t time = micros();
+	for (uint8_t i = 0; i < count; i++)
+		SimpleIMU_Recorder::record(IMU_RECORD_READ, status, address, reads[i].reg, reads[i].buffer, reads[i].length, time);
+	return status;
+}
+
+// Largest transfer of the bus
+uint16_t SimpleIMU_Recorder::getMaxTransfer()
+{
+	return SimpleIMU_Recorder::REC_Bus->getMaxTransfer();
+}
+
+// Set the timeout of the bus
+void SimpleIMU_Recorder::setTimeout(uint32_t timeout)
+{
+	SimpleIMU_Recorder::REC_Bus->setTimeout(timeout);
+}
+
+// Recover the bus and record the result
+bool SimpleIMU_Recorder::recover()
+{
+	bool released = SimpleIMU_Recorder::REC_Bus->recover();
+	SimpleIMU_Recorder::record(IMU_RECORD_RECOVER, released ? IMU_OK : IMU_ERROR_BUS, 0, 0, NULL, 0, micros());
+	return released;
+}
+
+// Read the clock of the bus and record it
+uint32_t SimpleIMU_Recorder::getTime()
+{
+	uint32_t time = SimpleIMU_Recorder::REC_Bus->getTime();
+	uint8_t data[4] = {(uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24)};
+	SimpleIMU_Recorder::record(IMU_RECORD_TIME, IMU_OK, 0, 0, data, 4, time);
+	return time;
+}
+
+// Constructor
+SimpleIMU_Replay::SimpleIMU_Replay()
+{
+	SimpleIMU_Replay::RPL_Data = NULL;
+	SimpleIMU_Replay::RPL_Size = 0;
+	SimpleIMU_Replay::RPL_MaxTransfer = 0;
+	SimpleIMU_Replay::rewind();
+}
+
+// Destructor
+SimpleIMU_Replay::~SimpleIMU_Replay()
+{
+	free(SimpleIMU_Replay::RPL_Data);
+}
+
+// Load a recording
+bool SimpleIMU_Replay::open(const char *path)
+{
+	free(SimpleIMU_Replay::RPL_Data);
+	SimpleIMU_Replay::RPL_Data = NULL;
+	SimpleIMU_Replay::RPL_Size = 0;
+	SimpleIMU_Replay::rewind();
+
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+		return false;
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint8_t *data = size >= IMU_RECORD_HEADER ? (uint8_t *)malloc(size) : NULL;
+	bool loaded = data != NULL && fread(data, 1, size, file) == (size_t)size;
+	fclose(file);
+	if (!loaded || memcmp(data, recordMagic, 4) != 0 || data[4] != IMU_RECORD_VERSION)
+	{
+		free(data);
+		return false;
+	}
+	SimpleIMU_Replay::RPL_Data = data;
+	SimpleIMU_Replay::RPL_Size = size;
+	SimpleIMU_Replay::RPL_MaxTransfer = data[6] | data[7] << 8;
+	return true;
+}
+
+// Start from the first record
+void SimpleIMU_Replay::rewind()
+{
+	SimpleIMU_Replay::RPL_Position = IMU_RECORD_HEADER;
+	SimpleIMU_Replay::RPL_Records = 0;
+	SimpleIMU_Replay::RPL_Mismatches = 0;
+	SimpleIMU_Replay::RPL_Elapsed = 0;
+}
+
+// Check whether all records were replayed
+bool SimpleIMU_Replay::isFinished()
+{
+	return SimpleIMU_Replay::RPL_Position >= SimpleIMU_Replay::RPL_Size;
+}
+
+// Get the number of records replayed
+uint32_t SimpleIMU_Replay::getRecordCount()
+{
+	return SimpleIMU_Replay::RPL_Records;
+}
+
+// Get the number of mismatches
+uint32_t SimpleIMU_Replay::getMismatchCount()
+{
+	return SimpleIMU_Replay::RPL_Mismatches;
+}
+
+// Take the next record if it matches the transaction
+uint8_t SimpleIMU_Replay::next(uint8_t kind, uint8_t address, uint8_t reg, uint16_t length, const uint8_t *written,
+							   const uint8_t **data)
+{
+	const uint8_t *recording = SimpleIMU_Replay::RPL_Data;
+	size_t size = SimpleIMU_Replay::RPL_Size;
+	size_t position = SimpleIMU_Replay::RPL_Position;
+	if (position >= size)
+		return IMU_ERROR_NACK;
+
+	uint32_t delta, recorded;
+	bool complete = position + 3 <= size;
+	uint8_t header = complete ? recording[position] : 0;
+	bool matches = complete && (header & 0x0F) == kind && recording[position + 1] == address &&
+				   recording[position + 2] == reg;
+	position += 3;
+	complete = complete && getVarint(recording, size, &position, &delta) &&
+			   getVarint(recording, size, &position, &recorded) && recorded <= size - position;
+	matches = matches && complete && recorded == length &&
+			  (written == NULL || memcmp(written, recording + position, length) == 0);
+	if (!matches)
+	{
+		SimpleIMU_Replay::RPL_Mismatches++;
+		return IMU_ERROR_DEVICE;
+	}
+
+	/*
+	 * The first record sets the start, the following ones wait for their
+	 * time after it, so the clock moves on as it did while recording
+	 */
+	if (SimpleIMU_Replay::RPL_Records == 0)
+		SimpleIMU_Replay::RPL_Start = micros();
+	else
+		SimpleIMU_Replay::RPL_Elapsed += delta;
+	int32_t wait = SimpleIMU_Replay::RPL_Elapsed - (micros() - SimpleIMU_Replay::RPL_Start);
+	if (wait > 0)
+		delayMicroseconds(wait);
+
+	*data = recording + position;
+	SimpleIMU_Replay::RPL_Position = position + recorded;
+	SimpleIMU_Replay::RPL_Records++;
+	return header >> 4;
+}
+
+// Nothing to prepare once loaded
+bool SimpleIMU_Replay::begin()
+{
+	return SimpleIMU_Replay::RPL_Data != NULL;
+}
+
+// Check a write against the recording
+uint8_t SimpleIMU_Replay::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length)
+{
+	const uint8_t *recorded;
+	return SimpleIMU_Replay::next(IMU_RECORD_WRITE, address, reg, length, data, &recorded);
+}
+
+// Give back the recorded bytes of a read
+uint8_t SimpleIMU_Replay::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length)
+{
+	const uint8_t *recorded;
+	uint8_t status = SimpleIMU_Replay::next(IMU_RECORD_READ, address, reg, length, NULL, &recorded);
+	if (status != IMU_ERROR_DEVICE && status != IMU_ERROR_NACK)
+		memcpy(data, recorded, length);
+	return status;
+}
+
+// Largest transfer of the recorded bus
+uint16_t SimpleIMU_Replay::getMaxTransfer()
+{
+	return SimpleIMU_Replay::RPL_MaxTransfer;
+}
+
+// Give back the recorded result of a recovery
+bool SimpleIMU_Replay::recover()
+{
+	const uint8_t *recorded;
+	return SimpleIMU_Replay::next(IMU_RECORD_RECOVER, 0, 0, 0, NULL, &recorded) == IMU_OK;
+}
+
+// Give back the recorded clock, the clock of the host once the program went another way
+uint32_t SimpleIMU_Replay::getTime()
+{
+	const uint8_t *recorded;
+	if (SimpleIMU_Replay::next(IMU_RECORD_TIME, 0, 0, 4, NULL, &recorded) != IMU_OK)
+		return micros();
+	return (uint32_t)recorded[0] | (uint32_t)recorded[1] << 8 | (uint32_t)recorded[2] << 16 | (uint32_t)recorded[3] << 24;
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ *  TCA9548A I2C switch support for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "../SimpleIMU_TCA9548A.h"
+
+// Constructor
+SimpleIMU_MuxChannel::SimpleIMU_MuxChannel()
+{
+	SimpleIMU_MuxChannel::CHAN_Mux = NULL;
+	SimpleIMU_MuxChannel::CHAN_Channel = 0;
+}
+
+// Start the bus of the switch
+bool SimpleIMU_MuxChannel::begin()
+{
+	return SimpleIMU_MuxChannel::CHAN_Mux->getBus()->begin();
+}
+
+// Connect the channel, or none for the bus of the switch
+uint8_t SimpleIMU_MuxChannel::select()
+{
+	uint8_t channel = SimpleIMU_MuxChannel::CHAN_Channel;
+	return SimpleIMU_MuxChannel::CHAN_Mux->writeControl(channel < IMU_TCA9548A_CHANNELS ? 1 << channel : 0x00);
+}
+
+// Write registers of a device on the channel
+uint8_t SimpleIMU_MuxChannel::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length)
+{
+	uint8_t status = SimpleIMU_MuxChannel::select();
+	if (status != IMU_OK)
+		return status;
+	return SimpleIMU_MuxChannel::CHAN_Mux->getBus()->writeRegisters(address, reg, data, length);
+}
+
+// Read registers of a device on the channel
+uint8_t SimpleIMU_MuxChannel::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length)
+{
+	uint8_t status = SimpleIMU_MuxChannel::select();
+	if (status != IMU_OK)
+		return status;
+	return SimpleIMU_MuxChannel::CHAN_Mux->getBus()->readRegisters(address, reg, data, length);
+}
+
+// Batched reads of a device on the channel, one select for all of them
+uint8_t SimpleIMU_MuxChannel::readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count)
+{
+	uint8_t status = SimpleIMU_MuxChannel::select();
+	if (status != IMU_OK)
+		return status;
+	return SimpleIMU_MuxChannel::CHAN_Mux->getBus()->readRegisters(address, reads, count);
+}
+
+uint16_t SimpleIMU_MuxChannel::getMaxTransfer()
+{
+	return SimpleIMU_MuxChannel::CHAN_Mux->getBus()->getMaxTransfer();
+}
+
+// The timeout is the one of the bus of the switch
+void SimpleIMU_MuxChannel::setTimeout(uint32_t timeout)
+{
+	SimpleIMU_MuxChannel::CHAN_Mux->getBus()->setTimeout(timeout);
+}
+
+// Free the bus of the switch
+bool SimpleIMU_MuxChannel::recover()
+{
+	return SimpleIMU_MuxChannel::CHAN_Mux->recover();
+}
+
+// The clock of the bus of the switch
+uint32_t SimpleIMU_MuxChannel::getTime()
+{
+	return SimpleIMU_MuxChannel::CHAN_Mux->getBus()->getTime();
+}
+
+uint8_t SimpleIMU_MuxChannel::getChannel()
+{
+	return SimpleIMU_MuxChannel::CHAN_Channel;
+}
+
+// Constructor
+SimpleIMU_TCA9548A::SimpleIMU_TCA9548A(uint8_t address, SimpleIMU_Transport *bus)
+{
+	SimpleIMU_TCA9548A::MUX_Bus = bus;
+	SimpleIMU_TCA9548A::MUX_Addr = address;
+	SimpleIMU_TCA9548A::MUX_Selected = 0xFF;
+	SimpleIMU_TCA9548A::MUX_Selects = 0;
+	for (uint8_t i = 0; i <= IMU_TCA9548A_CHANNELS; i++)
+	{
+		SimpleIMU_TCA9548A::MUX_Channels[i].CHAN_Mux = this;
+		SimpleIMU_TCA9548A::MUX_Channels[i].CHAN_Channel = i;
+	}
+}
+
+// Start the bus and turn all channels off
+bool SimpleIMU_TCA9548A::begin()
+{
+	if (!SimpleIMU_TCA9548A::MUX_Bus->begin())
+		return false;
+	return SimpleIMU_TCA9548A::disable();
+}
+
+SimpleIMU_Transport *SimpleIMU_TCA9548A::channel(uint8_t channel)
+{
+	if (channel >= IMU_TCA9548A_CHANNELS)
+		return NULL;
+	return &SimpleIMU_TCA9548A::MUX_Channels[channel];
+}
+
+SimpleIMU_Transport *SimpleIMU_TCA9548A::upstream()
+{
+	return &SimpleIMU_TCA9548A::MUX_Channels[IMU_TCA9548A_CHANNELS];
+}
+
+// Connect a channel
+bool SimpleIMU_TCA9548A::select(uint8_t channel)
+{
+	if (channel >= IMU_TCA9548A_CHANNELS)
+		return false;
+	return SimpleIMU_TCA9548A::writeControl(1 << channel) == IMU_OK;
+}
+
+// Disconnect all channels
+bool SimpleIMU_TCA9548A::disable()
+{
+	return SimpleIMU_TCA9548A::writeControl(0x00) == IMU_OK;
+}
+
+// Write the control register, a single byte without a register address
+uint8_t SimpleIMU_TCA9548A::writeControl(uint8_t control)
+{
+	if (SimpleIMU_TCA9548A::MUX_Selected == control)
+		return IMU_OK;
+	SimpleIMU_TCA9548A::MUX_Selects++;
+	uint8_t status = SimpleIMU_TCA9548A::MUX_Bus->writeRegisters(SimpleIMU_TCA9548A::MUX_Addr, control, NULL, 0);
+	SimpleIMU_TCA9548A::MUX_Selected = status == IMU_OK ? control : 0xFF;
+	return status;
+}
+
+// Free the bus and forget the selected channel
+bool SimpleIMU_TCA9548A::recover()
+{
+	SimpleIMU_TCA9548A::MUX_Selected = 0xFF;
+	return SimpleIMU_TCA9548A::MUX_Bus->recover();
+}
+
+SimpleIMU_Transport *SimpleIMU_TCA9548A::getBus()
+{
+	return SimpleIMU_TCA9548A::MUX_Bus;
+}
+
+uint32_t SimpleIMU_TCA9548A::getSelectCount()
+{
+	return SimpleIMU_TCA9548A::MUX_Selects;
+}
+
+void SimpleIMU_TCA9548A::resetSelectCount()
+{
+	SimpleIMU_TCA9548A::MUX_Selects = 0;
+}
@@ -0,0 +1,331 @@
+/*
+ *  Binary telemetry frames for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include <string.h>
+#include "../SimpleIMU_Telemetry.h"
+#include "SimpleIMU_CRC.h"
+
+/* Number of channels a frame can carry */
+#define TLM_CHANNELS 7
+
+// Store a little endian value
+static void putValue(uint8_t *p, uint32_t value, uint8_t bytes)
+{
+	for (uint8_t i = 0; i < bytes; i++, value >>= 8)
+		p[i] = value;
+}
+
+// Load a little endian value
+static uint32_t getValue(const uint8_t *p, uint8_t bytes)
+{
+	uint32_t value = 0;
+	for (uint8_t i = bytes; i > 0; i--)
+		value = value << 8 | p[i - 1];
+	return value;
+}
+
+// Count the channels of a mask
+static uint8_t countChannels(uint8_t channels)
+{
+	uint8_t n = 0;
+	for (uint8_t c = 0; c < TLM_CHANNELS; c++)
+		n += (channels >> c) & 1;
+	return n;
+}
+
+// Constructor
+SimpleIMU_Telemetry::SimpleIMU_Telemetry(uint8_t encoding, uint8_t channels)
+{
+	SimpleIMU_Telemetry::TLM_Encoding = IMU_TELEMETRY_DELTA;
+	SimpleIMU_Telemetry::TLM_Channels = IMU_TELEMETRY_MOTION;
+	SimpleIMU_Telemetry::TLM_Sequence = 0;
+	SimpleIMU_Telemetry::setEncoding(encoding);
+	SimpleIMU_Telemetry::setChannels(channels);
+}
+
+// Set the payload encoding
+bool SimpleIMU_Telemetry::setEncoding(uint8_t encoding)
+{
+	if (encoding > IMU_TELEMETRY_DELTA)
+		return false;
+	SimpleIMU_Telemetry::TLM_Encoding = encoding;
+	return true;
+}
+
+// Set the channels
+bool SimpleIMU_Telemetry::setChannels(uint8_t channels)
+{
+	if (channels == 0 || (channels & ~IMU_TELEMETRY_ALL))
+		return false;
+	SimpleIMU_Telemetry::TLM_Channels = channels;
+	return true;
+}
+
+// Get the sequence number of the next frame
+uint16_t SimpleIMU_Telemetry::getSequence()
+{
+	return SimpleIMU_Telemetry::TLM_Sequence;
+}
+
+// Encode a frame from one pointer per channel
+uint16_t SimpleIMU_Telemetry::encodeFrame(const int16_t *const *channels, uint8_t stride, uint8_t count, uint32_t time,
+										  float period, uint8_t *frame, uint16_t size)
+{
+	uint8_t used = 0;
+	for (uint8_t c = 0; c < TLM_CHANNELS; c++)
+	{
+		if ((SimpleIMU_Telemetry::TLM_Channels & (1 << c)) && channels[c] != NULL)
+			used |= 1 << c;
+	}
+	if (count == 0 || count > IMU_TELEMETRY_MAX_SAMPLES || used == 0 || size < IMU_TELEMETRY_HEADER + 2)
+		return 0;
+
+	/* The payload may use all but the two bytes of the CRC */
+	uint8_t encoding = SimpleIMU_Telemetry::TLM_Encoding;
+	uint16_t end = size - 2;
+	uint16_t position = IMU_TELEMETRY_HEADER;
+	for (uint8_t c = 0; c < TLM_CHANNELS; c++)
+	{
+		if (!(used & (1 << c)))
+			continue;
+		const int16_t *p = channels[c];
+		int16_t previous = 0;
+		for (uint8_t i = 0; i < count; i++, p += stride)
+		{
+			if (encoding == IMU_TELEMETRY_RAW)
+			{
+				if (position + 2 > end)
+					return 0;
+				putValue(frame + position, (uint16_t)*p, 2);
+				position += 2;
+				continue;
+			}
+
+			/* The difference wraps in 16 bits, the decoder wraps it back */
+			int16_t value = encoding == IMU_TELEMETRY_DELTA ? (int16_t)(*p - previous) : *p;
+			previous = *p;
+			uint16_t zigzag = (uint16_t)((uint16_t)value << 1) ^ (uint16_t)(value >> 15);
+			do
+			{
+				if (position >= end)
+					return 0;
+				uint8_t bits = zigzag & 0x7F;
+				zigzag >>= 7;
+				frame[position++] = zigzag != 0 ? bits | 0x80 : bits;
+			} while (zigzag != 0);
+		}
+	}
+
+	frame[0] = IMU_TELEMETRY_SYNC0;
+	frame[1] = IMU_TELEMETRY_SYNC1;
+	frame[2] = IMU_TELEMETRY_VERSION << 4 | encoding;
+	frame[3] = used;
+	frame[4] = count;
+	putValue(frame + 5, position - IMU_TELEMETRY_HEADER, 2);
+	putValue(frame + 7, SimpleIMU_Telemetry::TLM_Sequence, 2);
+	putValue(frame + 9, time, 4);
+	putValue(frame + 13, lroundf(period * 256.0f), 4);
+	putValue(frame + position, SimpleIMU_CRC16(frame + 2, position - 2), 2);
+	SimpleIMU_Telemetry::TLM_Sequence += count;
+	return position + 2;
+}
+
+// Encode a block
+uint16_t SimpleIMU_Telemetry::encode(const IMURawBlock *block, uint8_t *frame, uint16_t size)
+{
+	if (block->count > IMU_TELEMETRY_MAX_SAMPLES)
+		return 0;
+	const int16_t *channels[TLM_CHANNELS] = {block->accel[0], block->accel[1], block->accel[2], block->temp,
+											 block->gyro[0], block->gyro[1], block->gyro[2]};
+	return SimpleIMU_Telemetry::encodeFrame(channels, 1, block->count, block->time, block->period, frame, size);
+}
+
+// Encode an array of raw samples
+uint16_t SimpleIMU_Telemetry::encode(const IMURawSample *samples, uint8_t count, uint32_t time, float period,
+									 uint8_t *frame, uint16_t size)
+{
+	const int16_t *channels[TLM_CHANNELS] = {&samples->accel[0], &samples->accel[1], &samples->accel[2], &samples->temp,
+											 &samples->gyro[0], &samples->gyro[1], &samples->gyro[2]};
+	return SimpleIMU_Telemetry::encodeFrame(channels, sizeof(IMURawSample) / sizeof(int16_t), count, time, period, frame,
+											size);
+}
+
+// Constructor
+SimpleIMU_TelemetryDecoder::SimpleIMU_TelemetryDecoder()
+{
+	SimpleIMU_TelemetryDecoder::TLM_Length = 0;
+	SimpleIMU_TelemetryDecoder::TLM_Frame = 0;
+	SimpleIMU_TelemetryDecoder::TLM_Expected = 0;
+	SimpleIMU_TelemetryDecoder::TLM_Started = false;
+	SimpleIMU_TelemetryDecoder::resetStats();
+}
+
+// Drop bytes from the start of the buffer
+void SimpleIMU_TelemetryDecoder::drop(uint16_t count)
+{
+	uint8_t *buffer = SimpleIMU_TelemetryDecoder::TLM_Buffer;
+	SimpleIMU_TelemetryDecoder::TLM_Length -= count;
+	memmove(buffer, buffer + count, SimpleIMU_TelemetryDecoder::TLM_Length);
+}
+
+// Look for a frame at the start of the buffer
+bool SimpleIMU_TelemetryDecoder::parse()
+{
+	const uint8_t *buffer = SimpleIMU_TelemetryDecoder::TLM_Buffer;
+	IMUTelemetryStats *stats = &(SimpleIMU_TelemetryDecoder::TLM_Stats);
+	while (SimpleIMU_TelemetryDecoder::TLM_Length > 0)
+	{
+		uint16_t length = SimpleIMU_TelemetryDecoder::TLM_Length;
+		if (buffer[0] != IMU_TELEMETRY_SYNC0 || (length > 1 && buffer[1] != IMU_TELEMETRY_SYNC1))
+		{
+			SimpleIMU_TelemetryDecoder::drop(1);
+			stats->skipped++;
+			continue;
+		}
+		if (length < IMU_TELEMETRY_HEADER)
+			return false;
+
+		/* The header has to describe a frame the encoder can write */
+		uint8_t encoding = buffer[2] & 0x0F;
+		uint8_t channels = buffer[3];
+		uint8_t count = buffer[4];
+		uint16_t payload = getValue(buffer + 5, 2);
+		uint16_t values = count * countChannels(channels);
+		bool valid = buffer[2] >> 4 == IMU_TELEMETRY_VERSION && encoding <= IMU_TELEMETRY_DELTA && channels != 0 &&
+					 !(channels & ~IMU_TELEMETRY_ALL) && count != 0 && count <= IMU_TELEMETRY_MAX_SAMPLES &&
+					 (encoding == IMU_TELEMETRY_RAW ? payload == 2 * values : payload >= values && payload <= 3 * values);
+		if (valid && length < IMU_TELEMETRY_HEADER + payload + 2)
+			return false;
+		if (!valid || getValue(buffer + IMU_TELEMETRY_HEADER + payload, 2) != SimpleIMU_CRC16(buffer + 2, IMU_TELEMETRY_HEADER + payload - 2))
+		{
+			/* Look for the next frame from the byte after this sync */
+			SimpleIMU_TelemetryDecoder::drop(1);
+			stats->crcErrors++;
+			stats->skipped++;
+			continue;
+		}
+
+		uint16_t sequence = getValue(buffer + 7, 2);
+		uint16_t gap = sequence - SimpleIMU_TelemetryDecoder::TLM_Expected;
+		if (SimpleIMU_TelemetryDecoder::TLM_Started && gap < 0x8000)
+			stats->lost += gap;
+		SimpleIMU_TelemetryDecoder::TLM_Expected = sequence + count;
+		SimpleIMU_TelemetryDecoder::TLM_Started = true;
+		SimpleIMU_TelemetryDecoder::TLM_Frame = IMU_TELEMETRY_HEADER + payload + 2;
+		stats->frames++;
+		stats->samples += count;
+		return true;
+	}
+	return false;
+}
+
+// Add one received byte
+bool SimpleIMU_TelemetryDecoder::push(uint8_t byte)
+{
+	if (SimpleIMU_TelemetryDecoder::TLM_Frame != 0)
+	{
+		SimpleIMU_TelemetryDecoder::drop(SimpleIMU_TelemetryDecoder::TLM_Frame);
+		SimpleIMU_TelemetryDecoder::TLM_Frame = 0;
+		if (SimpleIMU_TelemetryDecoder::parse())
+		{
+			/* A frame was already waiting behind the last one, keep the byte for later */
+			SimpleIMU_TelemetryDecoder::TLM_Buffer[SimpleIMU_TelemetryDecoder::TLM_Length++] = byte;
+			return true;
+		}
+	}
+	SimpleIMU_TelemetryDecoder::TLM_Buffer[SimpleIMU_TelemetryDecoder::TLM_Length++] = byte;
+	return SimpleIMU_TelemetryDecoder::parse();
+}
+
+// Get the channels of the completed frame
+uint8_t SimpleIMU_TelemetryDecoder::getChannels()
+{
+	if (SimpleIMU_TelemetryDecoder::TLM_Frame == 0)
+		return 0;
+	return SimpleIMU_TelemetryDecoder::TLM_Buffer[3];
+}
+
+// Get the sequence number of the completed frame
+uint16_t SimpleIMU_TelemetryDecoder::getSequence()
+{
+	return getValue(SimpleIMU_TelemetryDecoder::TLM_Buffer + 7, 2);
+}
+
+// Decode the completed frame into a block
+bool SimpleIMU_TelemetryDecoder::read(IMURawBlock *block)
+{
+	const uint8_t *buffer = SimpleIMU_TelemetryDecoder::TLM_Buffer;
+	uint8_t count = buffer[4];
+	if (SimpleIMU_TelemetryDecoder::TLM_Frame == 0 || block->size < count)
+		return false;
+
+	uint8_t encoding = buffer[2] & 0x0F;
+	uint8_t channels = buffer[3];
+	uint16_t end = IMU_TELEMETRY_HEADER + getValue(buffer + 5, 2);
+	uint16_t position = IMU_TELEMETRY_HEADER;
+	int16_t *out[TLM_CHANNELS] = {block->accel[0], block->accel[1], block->accel[2], block->temp,
+								  block->gyro[0], block->gyro[1], block->gyro[2]};
+	for (uint8_t c = 0; c < TLM_CHANNELS; c++)
+	{
+		if (!(channels & (1 << c)))
+			continue;
+		int16_t previous = 0;
+		for (uint8_t i = 0; i < count; i++)
+		{
+			int16_t value;
+			if (encoding == IMU_TELEMETRY_RAW)
+			{
+				value = getValue(buffer + position, 2);
+				position += 2;
+			}
+			else
+			{
+				uint32_t zigzag = 0;
+				uint8_t shift = 0;
+				uint8_t bits;
+				do
+				{
+					if (position >= end || shift > 14)
+						return false;
+					bits = buffer[position++];
+					zigzag |= (uint32_t)(bits & 0x7F) << shift;
+					shift += 7;
+				} while (bits & 0x80);
+				if (zigzag > 0xFFFF)
+					return false;
+				value = (int16_t)((zigzag >> 1) ^ -(zigzag & 1));
+				if (encoding == IMU_TELEMETRY_DELTA)
+					value = (int16_t)(previous + value);
+				previous = value;
+			}
+			if (out[c] != NULL)
+				out[c][i] = value;
+		}
+	}
+	if (position != end)
+		return false;
+	block->count = count;
+	block->time = getValue(buffer + 9, 4);
+	block->period = getValue(buffer + 13, 4) / 256.0f;
+	return true;
+}
+
+// Get the counters
+void SimpleIMU_TelemetryDecoder::getStats(IMUTelemetryStats *stats)
+{
+	*stats = SimpleIMU_TelemetryDecoder::TLM_Stats;
+}
+
+// Clear the counters
+void SimpleIMU_TelemetryDecoder::resetStats()
+{
+	memset(&(SimpleIMU_TelemetryDecoder::TLM_Stats), 0, sizeof(IMUTelemetryStats));
+}
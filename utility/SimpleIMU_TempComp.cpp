@@ -0,0 +1,213 @@
+/*
+ *  Temperature compensation for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU_TempComp.h"
+#include "SimpleIMU_CRC.h"
+
+/* Number of bytes of IMUTempTable covered by the CRC */
+#define IMU_TEMPCOMP_CRC_LENGTH (sizeof(IMUTempTable) - sizeof(uint16_t))
+
+// Constructor
+SimpleIMU_TempComp::SimpleIMU_TempComp(SimpleIMU *imu)
+{
+	SimpleIMU_TempComp::CMP_IMU = imu;
+	SimpleIMU_TempComp::begin();
+}
+
+// Start with an empty table
+void SimpleIMU_TempComp::begin(int8_t minTemp, uint8_t binWidth, uint8_t window, float maxGyroNoise, float maxAccelNoise,
+							   float maxDrift)
+{
+	memset(&(SimpleIMU_TempComp::CMP_Table), 0, sizeof(IMUTempTable));
+	SimpleIMU_TempComp::CMP_Table.version = IMU_TEMPCOMP_VERSION;
+	SimpleIMU_TempComp::CMP_Table.minTemp = minTemp;
+	SimpleIMU_TempComp::CMP_Table.binWidth = binWidth == 0 ? 1 : binWidth;
+	SimpleIMU_TempComp::CMP_WindowSize = window < 2 ? 2 : window;
+	SimpleIMU_TempComp::CMP_MaxVariance[0] = maxGyroNoise * maxGyroNoise;
+	SimpleIMU_TempComp::CMP_MaxVariance[1] = maxAccelNoise * maxAccelNoise;
+	SimpleIMU_TempComp::CMP_MaxDrift = maxDrift;
+	SimpleIMU_TempComp::CMP_WindowCount = 0;
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		SimpleIMU_TempComp::CMP_WindowMean[i] = 0;
+		if (i < 6)
+			SimpleIMU_TempComp::CMP_WindowM2[i] = 0;
+	}
+	SimpleIMU_TempComp::CMP_Accepted = 0;
+	SimpleIMU_TempComp::CMP_Rejected = 0;
+}
+
+// Feed one sample
+bool SimpleIMU_TempComp::update(const AccelData *accel, const GyroData *gyro, float temp)
+{
+	/* Welford update of the window mean and sum of squared differences */
+	float value[7] = {gyro->x, gyro->y, gyro->z, accel->x, accel->y, accel->z, temp};
+	uint8_t n = ++SimpleIMU_TempComp::CMP_WindowCount;
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		float delta = value[i] - SimpleIMU_TempComp::CMP_WindowMean[i];
+		SimpleIMU_TempComp::CMP_WindowMean[i] += delta / n;
+		if (i < 6)
+			SimpleIMU_TempComp::CMP_WindowM2[i] += delta * (value[i] - SimpleIMU_TempComp::CMP_WindowMean[i]);
+	}
+
+	if (n < SimpleIMU_TempComp::CMP_WindowSize)
+		return false;
+	return SimpleIMU_TempComp::closeWindow();
+}
+
+// Find the nearest bin of a temperature
+int SimpleIMU_TempComp::findBin(float temp)
+{
+	float position = (temp - SimpleIMU_TempComp::CMP_Table.minTemp) / SimpleIMU_TempComp::CMP_Table.binWidth;
+	int bin = (int)floor(position + 0.5f);
+	if (bin < 0 || bin >= IMU_TEMPCOMP_BINS)
+		return -1;
+	return bin;
+}
+
+// Learn the window and move the offsets
+bool SimpleIMU_TempComp::closeWindow()
+{
+	SimpleIMU *imu = SimpleIMU_TempComp::CMP_IMU;
+	uint8_t n = SimpleIMU_TempComp::CMP_WindowCount;
+	float temp = SimpleIMU_TempComp::CMP_WindowMean[6];
+	bool moving = false;
+	for (uint8_t i = 0; i < 6; i++)
+		if (SimpleIMU_TempComp::CMP_WindowM2[i] / (n - 1) > SimpleIMU_TempComp::CMP_MaxVariance[i < 3 ? 0 : 1])
+			moving = true;
+	for (uint8_t i = 0; i < 3; i++)
+		if (fabs(SimpleIMU_TempComp::CMP_WindowMean[i]) > SimpleIMU_TempComp::CMP_MaxDrift)
+			moving = true;
+
+	/* The window was read with the current offsets, the bias is the offset plus what is left */
+	int bin = SimpleIMU_TempComp::findBin(temp);
+	if (moving)
+		SimpleIMU_TempComp::CMP_Rejected++;
+	else if (bin >= 0)
+	{
+		int16_t offset[3] = {imu->IMU_GyroOffsetX, imu->IMU_GyroOffsetY, imu->IMU_GyroOffsetZ};
+		uint8_t weight = SimpleIMU_TempComp::CMP_Table.weight[bin];
+		if (weight < IMU_TEMPCOMP_MAX_WEIGHT)
+			weight++;
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			float bias = offset[i] * imu->IMU_GyroScale + SimpleIMU_TempComp::CMP_WindowMean[i];
+			float learned = SimpleIMU_TempComp::CMP_Table.bias[bin][i] / 1000.0f;
+			learned += (bias - learned) / weight;
+			if (learned > 32.767f)
+				learned = 32.767f;
+			else if (learned < -32.768f)
+				learned = -32.768f;
+			SimpleIMU_TempComp::CMP_Table.bias[bin][i] = lround(learned * 1000.0f);
+		}
+		SimpleIMU_TempComp::CMP_Table.weight[bin] = weight;
+		SimpleIMU_TempComp::CMP_Accepted++;
+	}
+
+	SimpleIMU_TempComp::CMP_WindowCount = 0;
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		SimpleIMU_TempComp::CMP_WindowMean[i] = 0;
+		if (i < 6)
+			SimpleIMU_TempComp::CMP_WindowM2[i] = 0;
+	}
+
+	/* Offsets only change between windows, so every window is read with one set of offsets */
+	GyroData bias;
+	if (!SimpleIMU_TempComp::getBias(temp, &bias))
+		return false;
+	int16_t x = lround(bias.x / imu->IMU_GyroScale);
+	int16_t y = lround(bias.y / imu->IMU_GyroScale);
+	int16_t z = lround(bias.z / imu->IMU_GyroScale);
+	if (x == imu->IMU_GyroOffsetX && y == imu->IMU_GyroOffsetY && z == imu->IMU_GyroOffsetZ)
+		return false;
+	imu->IMU_GyroOffsetX = x;
+	imu->IMU_GyroOffsetY = y;
+	imu->IMU_GyroOffsetZ = z;
+	imu->IMU_CalibTemp = lround(temp * 100.0f);
+	imu->IMU_HasCalibTemp = true;
+	return true;
+}
+
+// Interpolate the bias between the learned bins
+bool SimpleIMU_TempComp::getBias(float temp, GyroData *bias)
+{
+	const IMUTempTable *table = &(SimpleIMU_TempComp::CMP_Table);
+	float position = (temp - table->minTemp) / table->binWidth;
+
+	/* The nearest learned bins at or below and above the temperature */
+	int below = -1, above = -1;
+	for (int i = 0; i < IMU_TEMPCOMP_BINS; i++)
+	{
+		if (table->weight[i] == 0)
+			continue;
+		if (i <= position)
+			below = i;
+		else if (above < 0)
+			above = i;
+	}
+	if (below < 0 && above < 0)
+		return false;
+	if (below < 0)
+		below = above;
+	if (above < 0)
+		above = below;
+
+	float f = above == below ? 0.0f : (position - below) / (above - below);
+	float value[3];
+	for (uint8_t i = 0; i < 3; i++)
+		value[i] = (table->bias[below][i] + f * (table->bias[above][i] - table->bias[below][i])) / 1000.0f;
+	bias->x = value[0];
+	bias->y = value[1];
+	bias->z = value[2];
+	return true;
+}
+
+// Get number of learned bins
+uint8_t SimpleIMU_TempComp::getLearnedBins()
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < IMU_TEMPCOMP_BINS; i++)
+		if (SimpleIMU_TempComp::CMP_Table.weight[i] != 0)
+			count++;
+	return count;
+}
+
+// Get number of accepted windows
+uint16_t SimpleIMU_TempComp::getAcceptedWindows()
+{
+	return SimpleIMU_TempComp::CMP_Accepted;
+}
+
+// Get number of rejected windows
+uint16_t SimpleIMU_TempComp::getRejectedWindows()
+{
+	return SimpleIMU_TempComp::CMP_Rejected;
+}
+
+// Export the table
+void SimpleIMU_TempComp::getTable(IMUTempTable *table)
+{
+	*table = SimpleIMU_TempComp::CMP_Table;
+	table->crc = SimpleIMU_CRC16((const uint8_t *)table, IMU_TEMPCOMP_CRC_LENGTH);
+}
+
+// Load a stored table
+bool SimpleIMU_TempComp::setTable(const IMUTempTable *table)
+{
+	if (table->version != IMU_TEMPCOMP_VERSION || table->binWidth == 0)
+		return false;
+	if (table->crc != SimpleIMU_CRC16((const uint8_t *)table, IMU_TEMPCOMP_CRC_LENGTH))
+		return false;
+	SimpleIMU_TempComp::CMP_Table = *table;
+	return true;
+}
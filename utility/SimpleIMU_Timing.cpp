@@ -0,0 +1,138 @@
+/*
+ *  Sample timing for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+// Importing required libraries
+#include <Arduino.h>
+#include "../SimpleIMU.h"
+
+/* Samples the period is measured over at least, and at most before the anchor moves on */
+#define IMU_TIMING_MIN_SPAN 32
+#define IMU_TIMING_MAX_SPAN 4096
+
+/* Largest error of the IMU clock, the internal oscillator is within a few percent */
+#define IMU_TIMING_MAX_SCALE 1.1f
+#define IMU_TIMING_MIN_SCALE 0.9f
+
+// Get the sample period against the host clock
+float SimpleIMU::getSamplePeriod()
+{
+	return 1000000.0f * SimpleIMU::IMU_ClockScale / SimpleIMU::getOutputDataRate();
+}
+
+// Move the timeline by a timing error
+void SimpleIMU::correctTiming(float error)
+{
+	SimpleIMU::IMU_NextSampleTime += (int32_t)lroundf(error);
+	uint32_t samples = SimpleIMU::IMU_AnchorSamples;
+	if (samples < IMU_TIMING_MIN_SPAN)
+		return;
+
+	/* The period is kept as a scale of the nominal one, so it survives a change of the rate */
+	float nominal = 1000000.0f / SimpleIMU::getOutputDataRate();
+	float scale = (int32_t)(SimpleIMU::IMU_NextSampleTime - SimpleIMU::IMU_AnchorTime) / (samples * nominal);
+	if (scale > IMU_TIMING_MAX_SCALE)
+		scale = IMU_TIMING_MAX_SCALE;
+	else if (scale < IMU_TIMING_MIN_SCALE)
+		scale = IMU_TIMING_MIN_SCALE;
+	SimpleIMU::IMU_ClockScale = scale;
+}
+
+// Place samples on the timeline
+uint32_t SimpleIMU::advanceTiming(uint16_t samples)
+{
+	float period = SimpleIMU::getSamplePeriod();
+	uint32_t first = SimpleIMU::IMU_NextSampleTime;
+	SimpleIMU::IMU_NextSampleTime += (int32_t)lroundf(samples * period);
+	SimpleIMU::IMU_AnchorSamples += samples;
+	if (SimpleIMU::IMU_AnchorSamples >= IMU_TIMING_MAX_SPAN)
+	{
+		/* Half of the span is kept, so the period still follows a slow drift of the clock */
+		SimpleIMU::IMU_AnchorTime += (int32_t)lroundf(IMU_TIMING_MAX_SPAN / 2 * period);
+		SimpleIMU::IMU_AnchorSamples -= IMU_TIMING_MAX_SPAN / 2;
+	}
+	return first;
+}
+
+// Add to the jitter statistics
+void SimpleIMU::recordJitter(uint32_t jitter)
+{
+	if (jitter > SimpleIMU::IMU_JitterMax)
+		SimpleIMU::IMU_JitterMax = jitter;
+	SimpleIMU::IMU_JitterSquares += (float)jitter * jitter;
+	SimpleIMU::IMU_JitterCount++;
+}
+
+// Follow the FIFO count
+void SimpleIMU::trackFIFO(uint16_t frames, uint32_t time)
+{
+	float period = SimpleIMU::getSamplePeriod();
+	if (!SimpleIMU::IMU_TimingLocked)
+	{
+		/* The oldest frame is expected (frames - 0.5) periods before the count */
+		SimpleIMU::IMU_NextSampleTime = time - (int32_t)lroundf((frames - 0.5f) * period);
+		SimpleIMU::IMU_AnchorTime = SimpleIMU::IMU_NextSampleTime;
+		SimpleIMU::IMU_AnchorSamples = 0;
+		SimpleIMU::IMU_TimingLocked = true;
+		return;
+	}
+
+	/*
+	 * The count alone says no more than that the newest frame was taken
+	 * within the period before it. As the reads slide over the samples
+	 * the timeline is pushed from both sides and settles between them.
+	 */
+	uint32_t newest = SimpleIMU::IMU_NextSampleTime + (int32_t)lroundf((frames - 1.0f) * period);
+	float error = (int32_t)(time - newest);
+	if (error > period)
+		error -= period;
+	else if (error > 0)
+		error = 0;
+	SimpleIMU::recordJitter(lroundf(fabsf(error)));
+	if (error != 0)
+		SimpleIMU::correctTiming(error);
+}
+
+// Follow the data ready interrupts
+void SimpleIMU::trackDataReady(uint8_t samples, uint32_t time)
+{
+	if (!SimpleIMU::IMU_TimingLocked)
+	{
+		SimpleIMU::IMU_NextSampleTime = time;
+		SimpleIMU::IMU_AnchorTime = time;
+		SimpleIMU::IMU_AnchorSamples = 0;
+		SimpleIMU::IMU_TimingLocked = true;
+		SimpleIMU::advanceTiming(1);
+		return;
+	}
+
+	/* Interrupts missed in between are on the timeline too, a quarter of the latency is taken */
+	SimpleIMU::advanceTiming(samples - 1);
+	float error = (int32_t)(time - SimpleIMU::IMU_NextSampleTime);
+	SimpleIMU::recordJitter(lroundf(fabsf(error)));
+	SimpleIMU::correctTiming(error / 4);
+	SimpleIMU::advanceTiming(1);
+}
+
+// Get the timing statistics
+void SimpleIMU::getTimingStats(IMUTimingStats *stats)
+{
+	stats->period = SimpleIMU::getSamplePeriod();
+	stats->drift = (SimpleIMU::IMU_ClockScale - 1.0f) * 1000000.0f;
+	stats->jitterMax = SimpleIMU::IMU_JitterMax;
+	stats->samples = SimpleIMU::IMU_JitterCount;
+	stats->jitterRms = SimpleIMU::IMU_JitterCount == 0 ? 0.0f : sqrtf(SimpleIMU::IMU_JitterSquares / SimpleIMU::IMU_JitterCount);
+}
+
+// Clear the jitter statistics
+void SimpleIMU::resetTimingStats()
+{
+	SimpleIMU::IMU_JitterMax = 0;
+	SimpleIMU::IMU_JitterSquares = 0.0f;
+	SimpleIMU::IMU_JitterCount = 0;
+}
@@ -0,0 +1,204 @@
+/*
+ *  Bus access for SimpleIMU library
+ *  Original code by Joel Jojo
+ *
+ *  This is free software. You can redistribute it and/or modify it under
+ *  the terms of MIT Licence.
+ *  To view a copy of this license, visit http://opensource.org/licenses/mit-license.php
+ */
+
+#include "../SimpleIMU_Transport.h"
+
+SimpleIMU_WireTransport SimpleIMU_WireBus(&Wire);
+
+// Nothing to prepare by default
+bool SimpleIMU_Transport::begin()
+{
+	return true;
+}
+
+// Do the reads one after the other
+uint8_t SimpleIMU_Transport::readRegisters(uint8_t address, const IMURegisterRead *reads, uint8_t count)
+{
+	uint8_t status = IMU_OK;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		uint8_t result = this->readRegisters(address, reads[i].reg, reads[i].buffer, reads[i].length);
+		if (status == IMU_OK)
+			status = result;
+	}
+	return status;
+}
+
+// No timeout by default
+void SimpleIMU_Transport::setTimeout(uint32_t timeout)
+{
+	(void)timeout;
+}
+
+// No recovery by default
+bool SimpleIMU_Transport::recover()
+{
+	return false;
+}
+
+// The clock of the host by default
+uint32_t SimpleIMU_Transport::getTime()
+{
+	return micros();
+}
+
+// Status of an endTransmission result
+static uint8_t wireStatus(uint8_t error)
+{
+	/* 1 data too long, 2 address NACK, 3 data NACK, 4 other error, 5 timeout */
+	switch (error)
+	{
+	case 0:
+		return IMU_OK;
+	case 2:
+	case 3:
+		return IMU_ERROR_NACK;
+	case 5:
+		return IMU_ERROR_TIMEOUT;
+	default:
+		return IMU_ERROR_BUS;
+	}
+}
+
+// Constructor
+SimpleIMU_WireTransport::SimpleIMU_WireTransport(TwoWire *wire, uint8_t sda, uint8_t scl)
+{
+	SimpleIMU_WireTransport::TRANSPORT_Wire = wire;
+	SimpleIMU_WireTransport::TRANSPORT_Started = false;
+	SimpleIMU_WireTransport::TRANSPORT_Timeout = IMU_BUS_TIMEOUT;
+	SimpleIMU_WireTransport::TRANSPORT_Clock = 0;
+	SimpleIMU_WireTransport::TRANSPORT_SDA = sda;
+	SimpleIMU_WireTransport::TRANSPORT_SCL = scl;
+}
+
+// Start the bus as master, once
+bool SimpleIMU_WireTransport::begin()
+{
+	if (!SimpleIMU_WireTransport::TRANSPORT_Started)
+	{
+		SimpleIMU_WireTransport::TRANSPORT_Wire->begin();
+		SimpleIMU_WireTransport::applyTimeout();
+		SimpleIMU_WireTransport::TRANSPORT_Started = true;
+	}
+	return true;
+}
+
+// Set the transaction timeout
+void SimpleIMU_WireTransport::setTimeout(uint32_t timeout)
+{
+	SimpleIMU_WireTransport::TRANSPORT_Timeout = timeout;
+	if (SimpleIMU_WireTransport::TRANSPORT_Started)
+		SimpleIMU_WireTransport::applyTimeout();
+}
+
+// Set the bus clock
+void SimpleIMU_WireTransport::setClock(uint32_t clock)
+{
+	SimpleIMU_WireTransport::TRANSPORT_Clock = clock;
+	SimpleIMU_WireTransport::TRANSPORT_Wire->setClock(clock);
+}
+
+// Pass the timeout to the Wire library
+void SimpleIMU_WireTransport::applyTimeout()
+{
+	uint32_t timeout = SimpleIMU_WireTransport::TRANSPORT_Timeout;
+#if defined(WIRE_HAS_TIMEOUT)
+	/* Reset the TWI hardware on a timeout, it may be stuck in the middle of a transfer */
+	SimpleIMU_WireTransport::TRANSPORT_Wire->setWireTimeout(timeout, true);
+#elif defined(ESP32)
+	SimpleIMU_WireTransport::TRANSPORT_Wire->setTimeOut(timeout == 0 ? 0xFFFF : (timeout + 999) / 1000);
+#elif defined(ESP8266)
+	SimpleIMU_WireTransport::TRANSPORT_Wire->setClockStretchLimit(timeout);
+#else
+	(void)timeout;
+#endif
+}
+
+// Write consecutive registers
+uint8_t SimpleIMU_WireTransport::writeRegisters(uint8_t address, uint8_t reg, const uint8_t *data, uint16_t length)
+{
+	TwoWire *wire = SimpleIMU_WireTransport::TRANSPORT_Wire;
+	wire->beginTransmission(address);
+	wire->write(reg);
+	if (wire->write(data, length) != length)
+	{
+		/* End the transmission anyway, it leaves the bus idle */
+		wire->endTransmission(true);
+		return IMU_ERROR_BUS;
+	}
+	return wireStatus(wire->endTransmission(true));
+}
+
+// Read consecutive registers
+uint8_t SimpleIMU_WireTransport::readRegisters(uint8_t address, uint8_t reg, uint8_t *data, uint16_t length)
+{
+	TwoWire *wire = SimpleIMU_WireTransport::TRANSPORT_Wire;
+	wire->beginTransmission(address);
+	wire->write(reg);
+	uint8_t status = wireStatus(wire->endTransmission(false));
+	if (status != IMU_OK)
+		return status;
+	uint8_t received = wire->requestFrom((int)address, (int)length, (int)true);
+	for (uint8_t i = 0; i < received; i++)
+		data[i] = wire->read();
+	if (received == length)
+		return IMU_OK;
+#if defined(WIRE_HAS_TIMEOUT)
+	if (wire->getWireTimeoutFlag())
+	{
+		wire->clearWireTimeoutFlag();
+		return IMU_ERROR_TIMEOUT;
+	}
+#endif
+	return received == 0 ? IMU_ERROR_NACK : IMU_ERROR_SHORT_READ;
+}
+
+// Largest transfer the Wire buffer holds
+uint16_t SimpleIMU_WireTransport::getMaxTransfer()
+{
+	return IMU_WIRE_BUFFER_LENGTH;
+}
+
+// Clock out the byte a device holds SDA low for, then send a stop
+bool SimpleIMU_WireTransport::recover()
+{
+	uint8_t sda = SimpleIMU_WireTransport::TRANSPORT_SDA;
+	uint8_t scl = SimpleIMU_WireTransport::TRANSPORT_SCL;
+	if (sda == 0xFF || scl == 0xFF)
+		return false;
+
+	/* Take the pins from the TWI hardware, the lines are open drain so high is released */
+	SimpleIMU_WireTransport::TRANSPORT_Wire->end();
+	pinMode(sda, INPUT_PULLUP);
+	pinMode(scl, INPUT_PULLUP);
+
+	/* A device finishes its byte and the acknowledge bit within 9 clocks, 100 kHz */
+	for (uint8_t i = 0; i < 9 && digitalRead(sda) == LOW; i++)
+	{
+		digitalWrite(scl, LOW);
+		pinMode(scl, OUTPUT);
+		delayMicroseconds(5);
+		pinMode(scl, INPUT_PULLUP);
+		delayMicroseconds(5);
+	}
+
+	/* Stop condition, SDA rises while SCL is high */
+	digitalWrite(sda, LOW);
+	pinMode(sda, OUTPUT);
+	delayMicroseconds(5);
+	pinMode(sda, INPUT_PULLUP);
+	delayMicroseconds(5);
+	bool released = digitalRead(sda) == HIGH && digitalRead(scl) == HIGH;
+
+	SimpleIMU_WireTransport::TRANSPORT_Wire->begin();
+	if (SimpleIMU_WireTransport::TRANSPORT_Clock != 0)
+		SimpleIMU_WireTransport::TRANSPORT_Wire->setClock(SimpleIMU_WireTransport::TRANSPORT_Clock);
+	SimpleIMU_WireTransport::applyTimeout();
+	return released;
+}